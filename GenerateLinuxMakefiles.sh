@@ -0,0 +1,31 @@
+#!/bin/sh
+# Linux builds of the tools (MoonCook, MoonTests, MoonBenchmark): DirectX-Headers and DirectXMath at the tags they are
+# built against, then gmake2 makefiles. premake5 has to be on the PATH.
+set -e
+cd "$(dirname "$0")"
+
+DIRECTX_HEADERS_TAG=v1.614.0
+DIRECTXMATH_TAG=may2024
+
+checkout() {
+	path=$1
+	tag=$2
+	if [ ! -e "$path/.git" ]; then
+		url=$(git config -f .gitmodules --get "submodule.$path.url")
+		git submodule add --force "$url" "$path"
+	fi
+	git submodule update --init "$path"
+	git -C "$path" fetch --tags --quiet origin
+	git -C "$path" checkout --quiet "$tag"
+}
+
+checkout libs/DirectX-Headers "$DIRECTX_HEADERS_TAG"
+checkout libs/DirectXMath "$DIRECTXMATH_TAG"
+
+# DirectXMath expects the SAL annotations of the Windows SDK, see the README.
+if [ ! -f libs/DirectXMath/Inc/sal.h ]; then
+	echo "libs/DirectXMath/Inc/sal.h is missing, DirectXMath does not build without it on Linux" >&2
+	exit 1
+fi
+
+premake5 gmake2
@@ -1,7 +1,8 @@
 #include "mnpch.h"
 #include "Application.h"
-
-#include "DDSTextureLoader.h"
+#include "ContentHash.h"
+#include "TextureCook.h"
+#include "Utils.h"
 
 #include <iostream>
 #include <fstream>
@@ -11,42 +12,153 @@ using namespace DirectX;
 
 namespace Moon
 {
+	namespace
+	{
+		// Least recently used entries go past this size.
+		constexpr uint64_t DerivedDataCapacity = 4096ull << 20;
+	}
+
 	Application* Application::gApplication = nullptr;
 	
-	void Application::Init()
+	void Application::Init(const BenchmarkOptions& benchmark)
 	{
 		gApplication = this;
-		mWindow = new Window();
-		mRenderDoc = new RenderDoc();
-
-		InitD3D12();
-		InitCommandObjects();
-		InitQuery();
-		InitSwapchain();
-		InitDescriptorHeaps();
-		Resize();
+		mBenchmark = benchmark;
+		CpuProfiler::Get().SetThreadName("Main");
+		mStartup.Start();
+		{
+			STARTUP_PHASE(mStartup, "Job System");
+			mJobSystem = new JobSystem();
+		}
+		{
+			STARTUP_PHASE(mStartup, "Derived Data Cache");
+			mDerivedData = new DerivedDataCache("../cache", DerivedDataCapacity);
+		}
 
-		DX_CHECK(mCommandList[0]->Reset(mCommandAllocator[0].Get(), nullptr));
-		InitPipeline();
-		LoadImages();
-		LoadMeshes();
-		InitScene();
-		mCurrentFence = mQueues->GetGraphicsQueue()->ExecuteCommandList(mCommandList[0].Get());
+		// File reads and mesh cooking do not need the device, they overlap its creation.
+		StartupAssets assets;
+		JobGroup shaderJobs;
+		JobGroup imageJobs;
+		JobGroup meshJobs;
+		JobGroup psoJobs;
+		mJobSystem->Run(meshJobs, [this, &assets]() { STARTUP_PHASE(mStartup, "Cook Meshes"); CookMeshes(assets); });
+		mJobSystem->Run(imageJobs, [this, &assets]() { STARTUP_PHASE(mStartup, "Read Images"); ReadImages(assets); });
+		mJobSystem->Run(shaderJobs, [this, &assets]() { STARTUP_PHASE(mStartup, "Read Shaders"); ReadShaders(assets); });
+
+		try
+		{
+			{
+				STARTUP_PHASE(mStartup, "Window");
+				mWindow = new Window();
+				mRenderDoc = new RenderDoc();
+			}
+			{
+				STARTUP_PHASE(mStartup, "D3D12 Device");
+				InitD3D12();
+				mRenderGraph = new RenderGraph(mDevice.Get());
+			}
+			{
+				STARTUP_PHASE(mStartup, "Command Objects");
+				InitCommandObjects();
+				InitQuery();
+			}
+			{
+				STARTUP_PHASE(mStartup, "Swapchain");
+				InitSwapchain();
+				InitDescriptorHeaps();
+				Resize();
+			}
+
+			DX_CHECK(mCommandList[0]->Reset(mCommandAllocator[0].Get(), nullptr));
+			mJobSystem->Wait(shaderJobs);
+			{
+				STARTUP_PHASE(mStartup, "Root Signature");
+				InitPipeline(assets, psoJobs);
+			}
+			// The texture and buffer uploads are recorded on the init command list, they stay on this thread.
+			mJobSystem->Wait(imageJobs);
+			{
+				STARTUP_PHASE(mStartup, "Upload Images");
+				mTextureStreamer = new TextureStreamer(mDevice.Get(), mQueues->GetGraphicsQueue(), mResourceStates);
+				LoadImages(assets);
+			}
+			mJobSystem->Wait(meshJobs);
+			{
+				STARTUP_PHASE(mStartup, "Upload Meshes");
+				LoadMeshes(assets);
+			}
+			{
+				STARTUP_PHASE(mStartup, "Scene");
+				InitScene();
+			}
+			mJobSystem->Wait(psoJobs);
+			mRhiMeshPSO = std::make_unique<D3D12RhiPipelineState>(mMeshPSO.Get());
+			mRhiWireframeMeshPSO = std::make_unique<D3D12RhiPipelineState>(mWireframeMeshPSO.Get());
+		}
+		catch (...)
+		{
+			// The jobs reference the assets and their group, both go out of scope with the exception.
+			for (JobGroup* group : { &shaderJobs, &imageJobs, &meshJobs, &psoJobs })
+			{
+				try { mJobSystem->Wait(*group); }
+				catch (...) {}
+			}
+			throw;
+		}
+
+		{
+			STARTUP_PHASE(mStartup, "Submit Uploads");
+			// Every upload above leaves its buffer in COPY_DEST, they all move to their read state in one batch.
+			FlushResourceBarriers(mCommandList[0].Get(), mStateTracker);
+			mCurrentFence = mQueues->GetGraphicsQueue()->ExecuteCommandList(mCommandList[0].Get(), mStateTracker);
+			mTextureStreamer->OnSubmitted(mCurrentFence);
+		}
 
 		mCamera = new Camera(static_cast<float>(mWindow->GetWidth()), static_cast<float>(mWindow->GetHeight()));
 		mCamera->SetPosition(-5.0f, 12.0f, 2.0f);
-		mImguiDrawer = new ImguiDrawer(mWindow->GetWindowHandle(), mDevice, mBackBufferFormat);
-		mFrameStats.Init();
+		if (mBenchmark.Enabled)
+		{
+			// Frames as fast as the GPU goes, and a camera that only follows its path.
+			mVSync = false;
+			mCamera->SetInputEnabled(false);
+			mBenchmarkPath = mBenchmark.LoadCameraPath();
+		}
+		{
+			STARTUP_PHASE(mStartup, "ImGui");
+			mImguiDrawer = new ImguiDrawer(mWindow->GetWindowHandle(), mDevice, mBackBufferFormat);
+		}
 		isD3D12Initialized = true;
+
+		mStartup.Finish();
+		// On the console for benchmark runs, which also get it in their report. Otherwise only a debugger sees it.
+		if (mBenchmark.Enabled)
+		{
+			mStartup.Print(std::cout);
+		}
+		else
+		{
+			std::ostringstream startup;
+			mStartup.Print(startup);
+			::OutputDebugStringA(startup.str().c_str());
+		}
 	}
 
 	void Application::Cleanup()
 	{
 		mQueues->GetGraphicsQueue()->WaitForIdle();
+		mFrameResources.clear();
+		delete mTextureStreamer;
+		mRhiMeshPSO.reset();
+		mRhiWireframeMeshPSO.reset();
+		mRhiMeshCommandSignature.reset();
+		delete mRhiDevice;
 		delete mQueues;
 		delete mImguiDrawer;
 		delete mCamera;
-		mFrameStats.Deinit();
+		delete mJobSystem;
+		delete mDerivedData;
+		delete mRenderGraph;
+		delete mGpuProfiler;
 
 		if (mRenderDoc)
 		{
@@ -56,7 +168,7 @@ namespace Moon
 		delete mWindow;
 	}
 
-	void Application::Run()
+	int Application::Run()
 	{
 		MSG msg = { 0 };
 		mTimer.Reset();
@@ -70,14 +182,27 @@ namespace Moon
 			}
 			else
 			{
+				CpuProfiler::Get().BeginFrame();
+				PROFILE_ZONE("Frame");
+
 				mTimer.Tick();
-				mTotalCpuTimeMS += mTimer.DeltaTime()*1000;
 				if (!mAppPaused)
 				{
-					mCamera->Update(mTimer.DeltaTime());
+					mFrameStats.AddCpuFrameTime(mTimer.DeltaTime() * 1000.0f);
+					if (mBenchmark.Enabled)
+					{
+						UpdateBenchmarkCamera();
+						mCamera->Update(mBenchmark.Timestep);
+					}
+					else
+					{
+						mCamera->Update(mTimer.DeltaTime());
+					}
 					Draw();
 					GetQueryResult();
 					mFrameNumber++;
+					if (mBenchmark.Enabled)
+						EndBenchmarkFrame();
 				}
 				else
 				{
@@ -85,11 +210,15 @@ namespace Moon
 				}
 			}
 		}
+		return (int)msg.wParam;
 	}
 
 	void Application::Draw()
 	{
-		mQueues->GetGraphicsQueue()->WaitForFenceCPUBlocking(mCurrentFence);
+		{
+			PROFILE_ZONE("Wait For GPU");
+			mQueues->GetGraphicsQueue()->WaitForFenceCPUBlocking(mCurrentFence);
+		}
 
 		auto cmdList = mCommandList[mCurrBackBuffer];
 		auto cmdAllocator = mCommandAllocator[mCurrBackBuffer];
@@ -98,14 +227,14 @@ namespace Moon
 		DX_CHECK(cmdAllocator->Reset());
 		DX_CHECK(cmdList->Reset(cmdAllocator.Get(), nullptr));
 
-		// Get a timestamp at the beginning and end of the command list.
-		const UINT timestampHeapIndex = 2 * mCurrBackBuffer;
-		cmdList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, timestampHeapIndex);
+		// Opens the frame's root GPU scope, RENDER_PASS scopes nest under it.
+		mGpuProfiler->BeginFrame(cmdList.Get());
 
 		mCurrFrameResource = mFrameResources[mCurrBackBuffer].get();
 
 		//Updating Pass CB
 		{
+			PROFILE_ZONE("Update Pass CB");
 			auto passCB = mCurrFrameResource->PassCB.get();
 			mCamera->UpdateViewMatrix();
 			XMMATRIX view = mCamera->GetView();
@@ -118,24 +247,49 @@ namespace Moon
 			passCB->CopyData(0, cameraData);
 		}
 
+		//Updating Transforms
+		{
+			PROFILE_ZONE("Update Transforms");
+			mTransforms.Update(mJobSystem);
+			mTransforms.WriteChanged(mScene);
+		}
+
 		//Updatin Object CB
 		{
+			PROFILE_ZONE("Upload Object CB");
 			auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-			for (auto& e : mAllRitems)
-			{
-				if (e->NumFramesDirty > 0)
-				{
-					XMMATRIX world = XMLoadFloat4x4(&e->World);
-					XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
+			mObjectCBUploader.CollectDirty(mScene.GetNumFramesDirty(), mScene.Size());
+			mObjectCBUploader.Upload(mScene.GetWorlds(), mScene.GetTexTransforms(),
+				currObjectCB->GetMappedData(), currObjectCB->GetElementByteSize(), mJobSystem);
+		}
+
+		//Frustum culling
+		{
+			PROFILE_ZONE("Frustum Culling");
+			mCuller.Cull(FrustumCuller::MakeWorldFrustum(mCamera->GetView(), mCamera->GetProj()),
+				mScene.GetWorldBounds(), mScene.Size(), mJobSystem);
+		}
 
-					PerObjectCB objConstants;
-					XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-					XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
+		//Sorting opaque items
+		{
+			PROFILE_ZONE("Sort Opaque Items");
+			XMMATRIX view = mCamera->GetView();
+			const UINT pipeline = mWireframeRendering ? 1 : 0;
+			const BoundingBox* bounds = mScene.GetWorldBounds();
+			const uint32_t* materialIds = mScene.GetMaterialIds();
+			const uint32_t* geometryIds = mScene.GetGeometryIds();
+
+			mOpaqueDrawList.Clear();
+			mOpaqueDrawList.Reserve(mCuller.GetVisible().size());
+			for (UINT i : mCuller.GetVisible())
+			{
+				float viewDepth = XMVectorGetZ(XMVector3TransformCoord(XMLoadFloat3(&bounds[i].Center), view));
 
-					currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-					e->NumFramesDirty--;
-				}
+				uint64_t key = DrawSortKey::Make(RenderPass_Opaque, pipeline, materialIds[i], geometryIds[i],
+					DrawSortKey::QuantizeDepth(viewDepth, mCamera->GetNearZ(), mCamera->GetFarZ()));
+				mOpaqueDrawList.Add(key, i);
 			}
+			mOpaqueDrawList.Sort(mJobSystem);
 		}
 
 		auto currentBackBuffer = mSwapchainBuffer[mCurrBackBuffer].Get();
@@ -144,74 +298,160 @@ namespace Moon
 			mCurrBackBuffer,
 			mRtvDescriptorSize);
 
-		cmdList->RSSetViewports(1, &mScreenViewport);
-		cmdList->RSSetScissorRects(1, &mScissorRect);
+		// Its copies go back to PIXEL_SHADER_RESOURCE with the barriers flushed below.
+		mTextureStreamer->Update(cmdList.Get(), mStateTracker, mCurrBackBuffer);
 
-		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(currentBackBuffer,
-			D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+		// The graph starts from these states and hands the resources back in them.
+		mStateTracker.Require(currentBackBuffer, D3D12_RESOURCE_STATE_PRESENT);
+		mStateTracker.Require(mDepthStencilBuffer.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		FlushResourceBarriers(cmdList.Get(), mStateTracker);
 
-		FLOAT clearColor[] = { 0.1f, 0.1f, 0.1f, 1.0f };
-		cmdList->ClearRenderTargetView(currentBackBufferView, clearColor, 0, nullptr);
-		cmdList->ClearDepthStencilView(mDsvHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
-		cmdList->OMSetRenderTargets(1, &currentBackBufferView, true, &mDsvHeap->GetCPUDescriptorHandleForHeapStart());
+		//Frame Graph
+		mRenderGraph->Reset();
+		RenderGraphResource backBuffer = mRenderGraph->ImportResource("BackBuffer", currentBackBuffer,
+			D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+		RenderGraphResource depthBuffer = mRenderGraph->ImportResource("DepthBuffer", mDepthStencilBuffer.Get(),
+			D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
 		//BeginDraw
-		RENDER_PASS("Mesh")
-		{
-			cmdList->SetPipelineState(mWireframeRendering ? mWireframeMeshPSO.Get() : mMeshPSO.Get());
-			ID3D12DescriptorHeap* descriptorHeaps[] = { mSrvHeap.Get() };
-			cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-			cmdList->SetGraphicsRootSignature(mMeshRootSig.Get());
-			auto passCB = mCurrFrameResource->PassCB->Resource();
-			cmdList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
+		mRenderGraph->AddPass("Mesh",
+			[&](RenderGraph::PassBuilder& builder)
+			{
+				builder.Write(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+				builder.Write(depthBuffer, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+			},
+			[&](RenderGraph& graph)
+			{
+				cmdList->RSSetViewports(1, &mScreenViewport);
+				cmdList->RSSetScissorRects(1, &mScissorRect);
+
+				FLOAT clearColor[] = { 0.1f, 0.1f, 0.1f, 1.0f };
+				cmdList->ClearRenderTargetView(currentBackBufferView, clearColor, 0, nullptr);
+				cmdList->ClearDepthStencilView(mDsvHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+				cmdList->OMSetRenderTargets(1, &currentBackBufferView, true, &mDsvHeap->GetCPUDescriptorHandleForHeapStart());
+
+				ID3D12DescriptorHeap* descriptorHeaps[] = { mSrvHeap.Get() };
+				cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+				cmdList->SetGraphicsRootSignature(mMeshRootSig.Get());
+				auto passCB = mCurrFrameResource->PassCB->Resource();
+				cmdList->SetGraphicsRootConstantBufferView(2, passCB->GetGPUVirtualAddress());
+
+				UINT objCBByteSize = CalcConstantBufferByteSize(sizeof(PerObjectCB));
+				auto objectCB = mCurrFrameResource->ObjectCB->Resource();
+
+				D3D12RhiCommandList rhiCmdList(cmdList.Get());
+				RhiPipelineState* pipelineStates[] = { mRhiMeshPSO.get(), mRhiWireframeMeshPSO.get() };
+				RhiPipelineState* currentPso = nullptr;
+				UINT currentGeoId = UINT_MAX;
+				UINT currentMatId = UINT_MAX;
+				cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+				auto bindState = [&](UINT pipeline, UINT matId, UINT geoId)
+				{
+					RhiPipelineState* pso = pipelineStates[pipeline];
+					if (pso != currentPso)
+					{
+						rhiCmdList.SetPipelineState(pso);
+						currentPso = pso;
+					}
 
-			UINT objCBByteSize = CalcConstantBufferByteSize(sizeof(PerObjectCB));
-			auto objectCB = mCurrFrameResource->ObjectCB->Resource();
+					if (geoId != currentGeoId)
+					{
+						MeshGeometry* geo = mGeometriesById[geoId];
+						const D3D12_VERTEX_BUFFER_VIEW vbv = geo->VertexBufferView();
+						const D3D12_INDEX_BUFFER_VIEW ibv = geo->IndexBufferView();
+						rhiCmdList.SetVertexBuffer({ vbv.BufferLocation, vbv.SizeInBytes, vbv.StrideInBytes });
+						rhiCmdList.SetIndexBuffer({ ibv.BufferLocation, ibv.SizeInBytes, ibv.Format == DXGI_FORMAT_R16_UINT ? RhiIndexFormat::Uint16 : RhiIndexFormat::Uint32 });
+						currentGeoId = geoId;
+					}
 
-			// For each render item...
-			for (size_t i = 0; i < mOpaqueRitems.size(); ++i)
-			{
-				auto ri = mOpaqueRitems[i];
-				RENDER_PASS(ri->Name.c_str())
+					if (matId != currentMatId)
+					{
+						CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvHeap->GetGPUDescriptorHandleForHeapStart());
+						tex.Offset(mCurrBackBuffer * SrvHeapFrameSize + mMaterialsById[matId]->DiffuseSrvHeapIndex, mCbvSrvUavDescriptorSize);
+						rhiCmdList.SetGraphicsRootDescriptorTable(0, tex.ptr);
+						currentMatId = matId;
+					}
+				};
+
+				const uint32_t* indexCounts = mScene.GetIndexCounts();
+				const uint32_t* startIndexLocations = mScene.GetStartIndexLocations();
+				const int32_t* baseVertexLocations = mScene.GetBaseVertexLocations();
+
+				if (mIndirectDraws)
 				{
-					CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvHeap->GetGPUDescriptorHandleForHeapStart());
-					tex.Offset(ri->Mat->DiffuseSrvHeapIndex, mCbvSrvUavDescriptorSize);
+					mIndirectDrawBuilder.Build(mOpaqueDrawList, indexCounts, startIndexLocations, baseVertexLocations,
+						objectCB->GetGPUVirtualAddress(), objCBByteSize);
 
-					D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex * objCBByteSize;
+					auto& commands = mIndirectDrawBuilder.GetCommands();
+					mDrawCount = (uint32_t)commands.size();
+					mBatchCount = (uint32_t)mIndirectDrawBuilder.GetBatches().size();
+					memcpy(mCurrFrameResource->IndirectArgsData, commands.data(), commands.size() * sizeof(IndirectDrawCommand));
 
-					cmdList->IASetVertexBuffers(0, 1, &ri->Geo->VertexBufferView());
-					cmdList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
-					cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
-					cmdList->SetGraphicsRootDescriptorTable(0, tex);
-					cmdList->SetGraphicsRootConstantBufferView(1, objCBAddress);
-					cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+					// One ExecuteIndirect per state change, the draws themselves come from the argument buffer.
+					for (const IndirectDrawBatch& batch : mIndirectDrawBuilder.GetBatches())
+					{
+						bindState(batch.Pipeline, batch.Material, batch.Geometry);
+						rhiCmdList.ExecuteIndirect(mRhiMeshCommandSignature.get(), batch.CommandCount,
+							mCurrFrameResource->IndirectArgs.get(), batch.FirstCommand * sizeof(IndirectDrawCommand));
+					}
 				}
-			}
-		}
+				else
+				{
+					mDrawCount = (uint32_t)mOpaqueDrawList.Size();
+					mBatchCount = mDrawCount;
+					// For each scene object, in sort key order...
+					for (size_t i = 0; i < mOpaqueDrawList.Size(); ++i)
+					{
+						const uint64_t key = mOpaqueDrawList.GetKey(i);
+						const UINT obj = mOpaqueDrawList.GetItem(i);
+						RENDER_PASS(mScene.GetName(obj).c_str())
+						{
+							bindState(DrawSortKey::GetPipeline(key), DrawSortKey::GetMaterial(key), DrawSortKey::GetGeometry(key));
+
+							D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + obj * objCBByteSize;
+							rhiCmdList.SetGraphicsRootConstantBufferView(1, objCBAddress);
+							rhiCmdList.SetGraphicsRoot32BitConstant(3, obj, 0);
+							rhiCmdList.DrawIndexedInstanced(indexCounts[obj], 1, startIndexLocations[obj], baseVertexLocations[obj], 0);
+						}
+					}
+				}
+			});
 
 		//DrawImGui
-		RENDER_PASS("Imgui")
+		mRenderGraph->AddPass("Imgui",
+			[&](RenderGraph::PassBuilder& builder)
+			{
+				builder.Write(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+			},
+			[&](RenderGraph& graph)
+			{
+				mImguiDrawer->BeginDrawImgui(cmdList, mWindow->GetWidth(), mWindow->GetHeight());
+				DrawMenuBar();
+				if(showImguiDemo)
+					ImGui::ShowDemoWindow(&showImguiDemo);
+				DrawDebugInfo();
+				mImguiDrawer->EndDrawImgui(cmdList);
+			}, true);
+
 		{
-			mImguiDrawer->BeginDrawImgui(cmdList, mWindow->GetWidth(), mWindow->GetHeight());
-			DrawMenuBar();
-			if(showImguiDemo)
-				ImGui::ShowDemoWindow(&showImguiDemo);
-			DrawDebugInfo();
-			mImguiDrawer->EndDrawImgui(cmdList);
+			PROFILE_ZONE("Compile Frame Graph");
+			mRenderGraph->Compile();
 		}
-
-		//EndFrame
-		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(currentBackBuffer,
-			D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+		mRenderGraph->Execute(cmdList.Get());
 
 		//End Query
-		cmdList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, timestampHeapIndex + 1);
-		cmdList->ResolveQueryData(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, timestampHeapIndex, 2, mQueryResult.Get(), timestampHeapIndex * sizeof(UINT64));
+		mGpuProfiler->EndFrame(cmdList.Get());
 
-		mCurrentFence = mQueues->GetGraphicsQueue()->ExecuteCommandList(cmdList.Get());
+		mCurrentFence = mQueues->GetGraphicsQueue()->ExecuteCommandList(cmdList.Get(), mStateTracker);
+		mGpuProfiler->OnFrameSubmitted(mCurrentFence);
+		mTextureStreamer->OnSubmitted(mCurrentFence);
 
 		// swap the back and front buffers
-		DX_CHECK(mSwapchain->Present(mVSync?1:0, 0));
+		{
+			PROFILE_ZONE("Present");
+			DX_CHECK(mSwapchain->Present(mVSync?1:0, 0));
+		}
 		mCurrBackBuffer = (mCurrBackBuffer + 1) % BACKBUFFER_COUNT;
 	}
 
@@ -315,6 +555,7 @@ namespace Moon
 	void Application::InitCommandObjects()
 	{
 		mQueues = new Moon::CommandQueueManager(mDevice.Get());
+		mRhiDevice = new D3D12RhiDevice(mDevice.Get(), mQueues->GetGraphicsQueue());
 
 		for (int i = 0; i < BACKBUFFER_COUNT; i++)
 		{
@@ -335,24 +576,7 @@ namespace Moon
 
 	void Application::InitQuery()
 	{
-		DX_CHECK(mQueues->GetGraphicsQueue()->GetCommandQueue()->GetTimestampFrequency(&mTimestampFrequency));
-
-		// Two timestamps for each frame.
-		const UINT resultCount = 2 * BACKBUFFER_COUNT;
-		const UINT resultBufferSize = resultCount * sizeof(UINT64);
-		D3D12_QUERY_HEAP_DESC timestampHeapDesc = {};
-		timestampHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
-		timestampHeapDesc.Count = resultCount;
-
-		DX_CHECK(mDevice->CreateCommittedResource(
-			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
-			D3D12_HEAP_FLAG_NONE,
-			&CD3DX12_RESOURCE_DESC::Buffer(resultBufferSize),
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS(&mQueryResult)
-		));
-		DX_CHECK(mDevice->CreateQueryHeap(&timestampHeapDesc, IID_PPV_ARGS(&mQueryHeap)));
+		mGpuProfiler = new GpuProfiler(mDevice.Get(), mQueues->GetGraphicsQueue());
 	}
 
 	void Application::InitSwapchain()
@@ -393,7 +617,7 @@ namespace Moon
 		DX_CHECK(mDevice->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&mDsvHeap)));
 
 		D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-		srvHeapDesc.NumDescriptors = 1;
+		srvHeapDesc.NumDescriptors = SrvHeapFrameSize * BACKBUFFER_COUNT;
 		srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 		srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 		DX_CHECK(mDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvHeap)));
@@ -410,8 +634,13 @@ namespace Moon
 		DX_CHECK(mCommandList[0]->Reset(mCommandAllocator[0].Get(), nullptr));
 
 		for (int i = 0; i < BACKBUFFER_COUNT; ++i)
+		{
+			mResourceStates.Unregister(mSwapchainBuffer[i].Get());
 			mSwapchainBuffer[i].Reset();
+		}
+		mResourceStates.Unregister(mDepthStencilBuffer.Get());
 		mDepthStencilBuffer.Reset();
+		mRenderGraph->ReleaseTransients();
 
 		DX_CHECK(mSwapchain->ResizeBuffers(
 			BACKBUFFER_COUNT,
@@ -425,6 +654,7 @@ namespace Moon
 		for (UINT i = 0; i < BACKBUFFER_COUNT; i++)
 		{
 			DX_CHECK(mSwapchain->GetBuffer(i, IID_PPV_ARGS(&mSwapchainBuffer[i])));
+			mResourceStates.Register(mSwapchainBuffer[i].Get(), 1, D3D12_RESOURCE_STATE_PRESENT);
 			mDevice->CreateRenderTargetView(mSwapchainBuffer[i].Get(), nullptr, rtvHeapHandle);
 			rtvHeapHandle.Offset(1, mRtvDescriptorSize);
 		}
@@ -454,6 +684,7 @@ namespace Moon
 			D3D12_RESOURCE_STATE_COMMON,
 			&optClear,
 			IID_PPV_ARGS(mDepthStencilBuffer.GetAddressOf())));
+		mResourceStates.Register(mDepthStencilBuffer.Get(), 1, D3D12_RESOURCE_STATE_COMMON);
 
 		D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc;
 		dsvDesc.Flags = D3D12_DSV_FLAG_NONE;
@@ -462,10 +693,10 @@ namespace Moon
 		dsvDesc.Texture2D.MipSlice = 0;
 		mDevice->CreateDepthStencilView(mDepthStencilBuffer.Get(), &dsvDesc, mDsvHeap->GetCPUDescriptorHandleForHeapStart());
 
-		mCommandList[0]->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mDepthStencilBuffer.Get(),
-			D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+		mStateTracker.Require(mDepthStencilBuffer.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		FlushResourceBarriers(mCommandList[0].Get(), mStateTracker);
 
-		mCurrentFence = mQueues->GetGraphicsQueue()->ExecuteCommandList(mCommandList[0].Get());
+		mCurrentFence = mQueues->GetGraphicsQueue()->ExecuteCommandList(mCommandList[0].Get(), mStateTracker);
 
 		mScreenViewport.TopLeftX = 0;
 		mScreenViewport.TopLeftY = 0;
@@ -477,14 +708,16 @@ namespace Moon
 		mScissorRect = { 0, 0, mWindow->GetWidth(), mWindow->GetHeight() };
 	}
 
-	void Application::InitPipeline()
+	void Application::ReadShaders(StartupAssets& assets)
 	{
-		// Mesh shaders
-		ComPtr<ID3DBlob> meshVsShader = LoadShaderBinary(L"../shaders/mesh.vs.cso");
-		ComPtr<ID3DBlob> meshPsShader = LoadShaderBinary(L"../shaders/mesh.ps.cso");
+		assets.MeshVS = LoadShaderBinary(L"../shaders/mesh.vs.cso");
+		assets.MeshPS = LoadShaderBinary(L"../shaders/mesh.ps.cso");
+	}
 
-		// Mesh Input Layout
-		D3D12_INPUT_ELEMENT_DESC inputLayout[] =
+	void Application::InitPipeline(const StartupAssets& assets, JobGroup& psoJobs)
+	{
+		// Mesh Input Layout, static as the PSO jobs read it after this returns.
+		static const D3D12_INPUT_ELEMENT_DESC inputLayout[] =
 		{
 			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 			{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
@@ -495,14 +728,15 @@ namespace Moon
 		CD3DX12_DESCRIPTOR_RANGE texTable;
 		texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
 
-		CD3DX12_ROOT_PARAMETER slotRootParameter[3];// Perfomance TIP: Order from most frequent to least frequent.
+		CD3DX12_ROOT_PARAMETER slotRootParameter[4];// Perfomance TIP: Order from most frequent to least frequent.
 		slotRootParameter[0].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
 		slotRootParameter[1].InitAsConstantBufferView(0);
 		slotRootParameter[2].InitAsConstantBufferView(1);
+		slotRootParameter[3].InitAsConstants(1, 2);// Object index, written by the indirect argument buffer
 
 		auto staticSamplers = GetStaticSamplers();
 
-		CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(3, slotRootParameter,
+		CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter,
 			(UINT)staticSamplers.size(), staticSamplers.data(),
 			D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
@@ -527,13 +761,13 @@ namespace Moon
 		meshPsoDesc.pRootSignature = mMeshRootSig.Get();
 		meshPsoDesc.VS =
 		{
-			reinterpret_cast<BYTE*>(meshVsShader->GetBufferPointer()),
-			meshVsShader->GetBufferSize()
+			reinterpret_cast<BYTE*>(assets.MeshVS->GetBufferPointer()),
+			assets.MeshVS->GetBufferSize()
 		};
 		meshPsoDesc.PS =
 		{
-			reinterpret_cast<BYTE*>(meshPsShader->GetBufferPointer()),
-			meshPsShader->GetBufferSize()
+			reinterpret_cast<BYTE*>(assets.MeshPS->GetBufferPointer()),
+			assets.MeshPS->GetBufferSize()
 		};
 		meshPsoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 		meshPsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
@@ -546,59 +780,131 @@ namespace Moon
 		meshPsoDesc.SampleDesc.Count = 1;
 		meshPsoDesc.SampleDesc.Quality = 0;
 		meshPsoDesc.DSVFormat = mDepthStencilFormat;
-		DX_CHECK(mDevice->CreateGraphicsPipelineState(&meshPsoDesc, IID_PPV_ARGS(&mMeshPSO)));
+		// The device is free threaded, the driver compiles both PSOs at once. The blobs outlive psoJobs.
+		mJobSystem->Run(psoJobs, [this, meshPsoDesc]()
+		{
+			STARTUP_PHASE(mStartup, "Mesh PSO");
+			DX_CHECK(mDevice->CreateGraphicsPipelineState(&meshPsoDesc, IID_PPV_ARGS(&mMeshPSO)));
+		});
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC wireframeMeshPsoDesc = meshPsoDesc;
+		wireframeMeshPsoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
+		mJobSystem->Run(psoJobs, [this, wireframeMeshPsoDesc]()
+		{
+			STARTUP_PHASE(mStartup, "Wireframe Mesh PSO");
+			DX_CHECK(mDevice->CreateGraphicsPipelineState(&wireframeMeshPsoDesc, IID_PPV_ARGS(&mWireframeMeshPSO)));
+		});
+
+		// Mesh Command Signature, must match the IndirectDrawCommand layout
+		D3D12_INDIRECT_ARGUMENT_DESC indirectArgs[3] = {};
+		indirectArgs[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW;
+		indirectArgs[0].ConstantBufferView.RootParameterIndex = 1;
+		indirectArgs[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+		indirectArgs[1].Constant.RootParameterIndex = 3;
+		indirectArgs[1].Constant.DestOffsetIn32BitValues = 0;
+		indirectArgs[1].Constant.Num32BitValuesToSet = 1;
+		indirectArgs[2].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+		D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc = {};
+		commandSignatureDesc.ByteStride = sizeof(IndirectDrawCommand);
+		commandSignatureDesc.NumArgumentDescs = _countof(indirectArgs);
+		commandSignatureDesc.pArgumentDescs = indirectArgs;
+		DX_CHECK(mDevice->CreateCommandSignature(&commandSignatureDesc, mMeshRootSig.Get(), IID_PPV_ARGS(&mMeshCommandSignature)));
+		mRhiMeshCommandSignature = std::make_unique<D3D12RhiCommandSignature>(mMeshCommandSignature.Get(), (uint32_t)sizeof(IndirectDrawCommand));
+	}
+
+	void Application::ReadImages(StartupAssets& assets)
+	{
+		// Mapped rather than read, the texture upload copies from the page cache directly.
+		assets.LostEmpireDDS = FindCookedTexture(L"../assets/lost-empire/lost_empire-RGBA.dds");
+		assets.LostEmpireDDS.Prefetch();
+	}
 
-		meshPsoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
-		DX_CHECK(mDevice->CreateGraphicsPipelineState(&meshPsoDesc, IID_PPV_ARGS(&mWireframeMeshPSO)));
+	DDSFileMapping Application::FindCookedTexture(const std::filesystem::path& source)
+	{
+		DDSFileMapping sourceFile;
+		if (FAILED(sourceFile.Open(source.c_str())))
+			throw std::runtime_error("Unable to open texture file..");
+		if (!mDerivedData->IsEnabled())
+			return sourceFile;
+
+		// BC7 with a full mip chain, the same key mooncook gives the file with its default settings.
+		const TextureCookSettings settings;
+		const uint64_t key = GetTextureCookKey(sourceFile.GetData(), sourceFile.GetSize(), settings);
+
+		DDSFileMapping cooked;
+		const std::filesystem::path found = mDerivedData->Find(key, "dds");
+		if (!found.empty() && SUCCEEDED(cooked.Open(found.c_str())))
+			return cooked;
+
+		// Cooking BC7 takes seconds, too long for startup: mooncook fills the cache, the source is uploaded until then.
+		return sourceFile;
 	}
 
-	void Application::LoadImages()
+	void Application::LoadImages(StartupAssets& assets)
 	{
 		auto lostEmpire = std::make_unique<Texture>();
 		lostEmpire->Name = "lostEmpireTex";
 		lostEmpire->Filename = L"../assets/lost-empire/lost_empire-RGBA.dds";
-		DX_CHECK(DirectX::CreateDDSTextureFromFile12(mDevice.Get(),
-			mCommandList[mCurrBackBuffer].Get(), lostEmpire->Filename.c_str(),
-			lostEmpire->Resource, lostEmpire->UploadHeap));
+		// Only the smallest mips are copied now, the streamer brings the others in over the first frames.
+		// Heap index 0 of every frame, the material's DiffuseSrvHeapIndex.
+		std::array<D3D12_CPU_DESCRIPTOR_HANDLE, BACKBUFFER_COUNT> frameSrvs;
+		for (UINT frame = 0; frame < BACKBUFFER_COUNT; ++frame)
+			frameSrvs[frame] = CD3DX12_CPU_DESCRIPTOR_HANDLE(mSrvHeap->GetCPUDescriptorHandleForHeapStart(), frame * SrvHeapFrameSize, mCbvSrvUavDescriptorSize);
+		StreamedTexture* streamed = mTextureStreamer->Load(lostEmpire->Filename, std::move(assets.LostEmpireDDS),
+			mCommandList[mCurrBackBuffer].Get(), mStateTracker, frameSrvs);
+		lostEmpire->Resource = streamed->Resource;
 
 		mTextures[lostEmpire->Name] = std::move(lostEmpire);
-		auto lostEmpireTex = mTextures["lostEmpireTex"]->Resource;
+	}
+
+	void Application::CookMeshes(StartupAssets& assets)
+	{
+		// Parsing the OBJ file is the slow part: after the first run, the .moonmesh comes from the derived data cache.
+		const char* objFile = "../assets/lost-empire/lost_empire.obj";
+		const std::vector<uint8_t> source = ReadFileBytes(objFile);
+		ContentHasher hasher(CookedMesh::Version);
+		hasher.Update(std::string("obj"));
+		hasher.Update(source.data(), source.size());
+		const uint64_t key = hasher.Finish();
+
+		CookedMesh lostEmpire;
+		std::vector<uint8_t> cooked;
+		if (!mDerivedData->Get(key, "moonmesh", cooked) || !lostEmpire.Deserialize(cooked.data(), cooked.size()))
+		{
+			ObjMesh obj{};
+			if (!obj.LoadFromObjFile(objFile) || obj.vertices.empty())
+				throw std::runtime_error("Unable to load mesh file..");
+
+			BoundingBox::CreateFromPoints(lostEmpire.bounds, obj.vertices.size(), &obj.vertices[0].position, sizeof(Vertex));
+			lostEmpire.vertices = std::move(obj.vertices);
+			lostEmpire.indices = std::move(obj.indices);
+			cooked = lostEmpire.Serialize();
+			mDerivedData->Put(key, "moonmesh", cooked.data(), cooked.size());
+		}
 
-		CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvHeap->GetCPUDescriptorHandleForHeapStart());
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Format = lostEmpireTex->GetDesc().Format;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MostDetailedMip = 0;
-		srvDesc.Texture2D.MipLevels = lostEmpireTex->GetDesc().MipLevels;
-		srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-		mDevice->CreateShaderResourceView(lostEmpireTex.Get(), &srvDesc, hDescriptor);
+		assets.LostEmpireBounds = lostEmpire.bounds;
+		assets.LostEmpireVertices = std::move(lostEmpire.vertices);
+		assets.LostEmpireIndices = std::move(lostEmpire.indices);
 	}
 
-	void Application::LoadMeshes()
+	void Application::LoadMeshes(const StartupAssets& assets)
 	{
-		ObjMesh lostEmpire{};
-		lostEmpire.LoadFromObjFile("../assets/lost-empire/lost_empire.obj");
+		const std::vector<Vertex>& vertices = assets.LostEmpireVertices;
+		const std::vector<std::uint32_t>& indices = assets.LostEmpireIndices;
 
 		SubmeshGeometry boxSubmesh;
-		boxSubmesh.IndexCount = (UINT)lostEmpire.indices.size();
+		boxSubmesh.IndexCount = (UINT)indices.size();
 		boxSubmesh.StartIndexLocation = 0;
 		boxSubmesh.BaseVertexLocation = 0;
-
-		std::vector<std::uint32_t> indices = lostEmpire.indices;
-		std::vector<Vertex> vertices(lostEmpire.vertices.size());
-		for (size_t i = 0; i < lostEmpire.vertices.size(); ++i)
-		{
-			vertices[i].position = lostEmpire.vertices[i].position;
-			vertices[i].normal = lostEmpire.vertices[i].normal;
-			vertices[i].uv = lostEmpire.vertices[i].uv;
-		}
+		boxSubmesh.Bounds = assets.LostEmpireBounds;
 
 		const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 		const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint32_t);
 
 		auto geo = std::make_unique<MeshGeometry>();
 		geo->Name = "lostEmpire";
+		geo->GeoIndex = (int)mGeometries.size();
 
 		DX_CHECK(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
 		CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
@@ -616,6 +922,10 @@ namespace Moon
 		geo->IndexBufferByteSize = ibByteSize;
 		geo->DrawArgs["lostEmpire"] = boxSubmesh;
 
+		// Indexed by GeoIndex, the geometry id draw keys carry, whatever order the geometries are built in.
+		if (mGeometriesById.size() <= (size_t)geo->GeoIndex)
+			mGeometriesById.resize(geo->GeoIndex + 1, nullptr);
+		mGeometriesById[geo->GeoIndex] = geo.get();
 		mGeometries[geo->Name] = std::move(geo);
 	}
 
@@ -628,42 +938,162 @@ namespace Moon
 		lostEmpire->DiffuseAlbedo = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
 		lostEmpire->FresnelR0 = DirectX::XMFLOAT3(0.05f, 0.05f, 0.05f);
 		lostEmpire->Roughness = 0.2f;
+		// Indexed by MatCBIndex, the material id draw keys carry, whatever order the materials are built in.
+		if (mMaterialsById.size() <= (size_t)lostEmpire->MatCBIndex)
+			mMaterialsById.resize(lostEmpire->MatCBIndex + 1, nullptr);
+		mMaterialsById[lostEmpire->MatCBIndex] = lostEmpire.get();
 		mMaterials["lostEmpire"] = std::move(lostEmpire);
 
-		auto leRitem = std::make_unique<RenderItem>();
-		leRitem->Name = "lostEmpire";
-		leRitem->ObjCBIndex = 0;
-		leRitem->Mat = mMaterials["lostEmpire"].get();
-		leRitem->Geo = mGeometries["lostEmpire"].get();
-		leRitem->PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-		leRitem->IndexCount = leRitem->Geo->DrawArgs["lostEmpire"].IndexCount;
-		leRitem->StartIndexLocation = leRitem->Geo->DrawArgs["lostEmpire"].StartIndexLocation;
-		leRitem->BaseVertexLocation = leRitem->Geo->DrawArgs["lostEmpire"].BaseVertexLocation;
-		mAllRitems.push_back(std::move(leRitem));
-
-		for (auto& e : mAllRitems)
-			mOpaqueRitems.push_back(e.get());
+		const SubmeshGeometry& leSubmesh = mGeometries["lostEmpire"]->DrawArgs["lostEmpire"];
+		SceneObjectDesc leDesc;
+		leDesc.Name = "lostEmpire";
+		leDesc.MaterialId = mMaterials["lostEmpire"]->MatCBIndex;
+		leDesc.GeometryId = mGeometries["lostEmpire"]->GeoIndex;
+		leDesc.LocalBounds = leSubmesh.Bounds;
+		leDesc.IndexCount = leSubmesh.IndexCount;
+		leDesc.StartIndexLocation = leSubmesh.StartIndexLocation;
+		leDesc.BaseVertexLocation = leSubmesh.BaseVertexLocation;
+		SceneHandle leObject = mScene.Create(leDesc);
+		mTransforms.BindSceneObject(mTransforms.AddNode(), leObject);
 
 		for (int i = 0; i < BACKBUFFER_COUNT; ++i)
 		{
-			mFrameResources.push_back(std::make_unique<FrameResource>(mDevice.Get(), 1, (UINT)mAllRitems.size()));
+			mFrameResources.push_back(std::make_unique<FrameResource>(mDevice.Get(), mRhiDevice, 1, mScene.Size()));
 		}
 	}
 
 	void Application::GetQueryResult()
 	{
-		void* pData = nullptr;
-		const D3D12_RANGE emptyRange = {};
-		D3D12_RANGE readRange = {};
-		readRange.Begin = (2 * mCurrBackBuffer) * sizeof(UINT64);
-		readRange.End = readRange.Begin + 2 * sizeof(UINT64);
+		// The profiler reads frames back as the GPU completes them, keep the latest one.
+		if (mGpuProfiler->GetResolvedFrameCount() != mLastGpuProfileFrame)
+		{
+			mLastGpuProfileFrame = mGpuProfiler->GetResolvedFrameCount();
+			mFrameStats.AddGpuFrameTime(mGpuProfiler->GetFrameTimeMS());
+
+			if (mBenchmark.Enabled)
+			{
+				const std::vector<GpuProfiler::Node>& nodes = mGpuProfiler->GetNodes();
+				mBenchmarkPassSums.resize(nodes.size(), 0.0);
+				mBenchmarkPassCounts.resize(nodes.size(), 0);
+				for (size_t i = 1; i < nodes.size(); ++i)
+				{
+					if (nodes[i].LastFrame == mLastGpuProfileFrame)
+					{
+						mBenchmarkPassSums[i] += nodes[i].LastMS;
+						mBenchmarkPassCounts[i]++;
+					}
+				}
+			}
+		}
+	}
+
+	void Application::UpdateBenchmarkCamera()
+	{
+		XMFLOAT3 position, target;
+		mBenchmarkPath.Sample(mBenchmark.GetPathTime(mBenchmarkPath, mBenchmarkFrame), position, target);
+		mCamera->LookAt(position, target, XMFLOAT3(0.0f, 1.0f, 0.0f));
+	}
+
+	void Application::EndBenchmarkFrame()
+	{
+		mBenchmarkFrame++;
+		if (mBenchmarkFrame == mBenchmark.WarmupFrames)
+		{
+			mFrameStats.Reset();
+			mBenchmarkVisibleSum = 0;
+			mBenchmarkDrawSum = 0;
+			mBenchmarkBatchSum = 0;
+			mBenchmarkPassSums.assign(mBenchmarkPassSums.size(), 0.0);
+			mBenchmarkPassCounts.assign(mBenchmarkPassCounts.size(), 0);
+			return;
+		}
+		if (mBenchmarkFrame < mBenchmark.WarmupFrames)
+			return;
+
+		mBenchmarkVisibleSum += mCuller.GetVisible().size();
+		mBenchmarkDrawSum += mDrawCount;
+		mBenchmarkBatchSum += mBatchCount;
 
-		DX_CHECK(mQueryResult->Map(0, &readRange, &pData));
-		const UINT64* pTimestamps = reinterpret_cast<UINT64*>(static_cast<UINT8*>(pData) + readRange.Begin);
-		const UINT64 timeStampDelta = pTimestamps[1] - pTimestamps[0];
-		mQueryResult->Unmap(0, &emptyRange);
+		if (mBenchmarkFrame == mBenchmark.WarmupFrames + mBenchmark.Frames)
+		{
+			// Reads back the GPU timings of the frames still in flight.
+			mQueues->GetGraphicsQueue()->WaitForIdle();
+			GetQueryResult();
 
-		mFrameStats.AddTimestamp(float((timeStampDelta * 1000)) / (float)(mTimestampFrequency));
+			const bool written = WriteBenchmarkReport();
+			std::cout << (written ? "Benchmark report written to " : "Could not write ") << mBenchmark.OutputFile << std::endl;
+			PostQuitMessage(written ? 0 : 1);
+		}
+	}
+
+	bool Application::WriteBenchmarkReport()
+	{
+		std::ofstream out(mBenchmark.OutputFile, std::ios::out | std::ios::trunc);
+		if (!out)
+			return false;
+
+		char adapterName[256] = {};
+		WideCharToMultiByte(CP_UTF8, 0, mAdapterDesc.Description, -1, adapterName, sizeof(adapterName) - 1, nullptr, nullptr);
+
+		const double frames = (double)std::max(mBenchmark.Frames, 1u);
+		out << "{\"mode\":\"gpu\",\"frames\":" << mBenchmark.Frames
+			<< ",\"warmup_frames\":" << mBenchmark.WarmupFrames
+			<< ",\"timestep\":" << mBenchmark.Timestep
+			<< ",\"width\":" << mWindow->GetWidth()
+			<< ",\"height\":" << mWindow->GetHeight()
+			<< ",\"indirect_draws\":" << (mIndirectDraws ? "true" : "false")
+			<< ",\"adapter\":";
+		WriteJSONString(out, adapterName);
+		out << ",\"camera_path\":";
+		WriteJSONString(out, mBenchmark.CameraPathFile.empty() ? "default" : mBenchmark.CameraPathFile);
+
+		out << ",\"startup\":";
+		mStartup.WriteJSON(out);
+
+		out << ",\"frame_stats\":";
+		mFrameStats.WriteJSON(out);
+
+		out << ",\"gpu_passes_ms\":[";
+		const std::vector<GpuProfiler::Node>& nodes = mGpuProfiler->GetNodes();
+		for (size_t i = 0; i < nodes[0].Children.size(); ++i)
+		{
+			out << (i ? "," : "");
+			WriteGpuPassJSON(out, nodes[0].Children[i]);
+		}
+
+		out << "],\"draws\":{\"objects\":" << mScene.Size()
+			<< ",\"visible_avg\":" << mBenchmarkVisibleSum / frames
+			<< ",\"draws_avg\":" << mBenchmarkDrawSum / frames
+			<< ",\"batches_avg\":" << mBenchmarkBatchSum / frames
+			<< "},\"memory\":{\"process\":";
+		WriteProcessMemoryJSON(out);
+
+		DXGI_QUERY_VIDEO_MEMORY_INFO local = {};
+		DXGI_QUERY_VIDEO_MEMORY_INFO nonLocal = {};
+		mAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &local);
+		mAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &nonLocal);
+		out << ",\"video_local\":{\"usage_bytes\":" << local.CurrentUsage << ",\"budget_bytes\":" << local.Budget
+			<< "},\"video_non_local\":{\"usage_bytes\":" << nonLocal.CurrentUsage << ",\"budget_bytes\":" << nonLocal.Budget
+			<< "}}}\n";
+
+		return (bool)out;
+	}
+
+	void Application::WriteGpuPassJSON(std::ostream& out, uint32_t nodeIndex)
+	{
+		const GpuProfiler::Node& node = mGpuProfiler->GetNodes()[nodeIndex];
+		const uint32_t count = nodeIndex < mBenchmarkPassCounts.size() ? mBenchmarkPassCounts[nodeIndex] : 0;
+		out << "{\"name\":";
+		WriteJSONString(out, node.Name);
+		out << ",\"frames\":" << count
+			<< ",\"mean\":" << (count ? mBenchmarkPassSums[nodeIndex] / count : 0.0)
+			<< ",\"children\":[";
+		for (size_t i = 0; i < node.Children.size(); ++i)
+		{
+			out << (i ? "," : "");
+			WriteGpuPassJSON(out, node.Children[i]);
+		}
+		out << "]}";
 	}
 
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> Application::GetStaticSamplers()
@@ -749,6 +1179,7 @@ namespace Moon
 			D3D12_RESOURCE_STATE_COMMON,
 			nullptr,
 			IID_PPV_ARGS(defaultBuffer.GetAddressOf())));
+		mResourceStates.Register(defaultBuffer.Get(), 1, D3D12_RESOURCE_STATE_COMMON);
 
 		DX_CHECK(device->CreateCommittedResource(
 			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
@@ -763,11 +1194,10 @@ namespace Moon
 		subResourceData.RowPitch = byteSize;
 		subResourceData.SlicePitch = subResourceData.RowPitch;
 
-		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
-			D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+		mStateTracker.Require(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+		FlushResourceBarriers(cmdList, mStateTracker);
 		UpdateSubresources<1>(cmdList, defaultBuffer.Get(), uploadBuffer.Get(), 0, 0, 1, &subResourceData);
-		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
-			D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
+		mStateTracker.Require(defaultBuffer.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
 
 		return defaultBuffer;
 	}
@@ -802,6 +1232,7 @@ namespace Moon
 			{
 				ImGui::MenuItem("Show ImGui Demo", "", &showImguiDemo);
 				ImGui::MenuItem("Wireframe View", "F1", &mWireframeRendering);
+				ImGui::MenuItem("GPU-Driven Draws", "", &mIndirectDraws);
 				ImGui::EndMenu();
 			}
 			ImGui::EndMainMenuBar();
@@ -813,8 +1244,21 @@ namespace Moon
 		if (ImGui::Begin("Debug Informations"))
 		{
 			ImGui::Text("Performance");
-			ImGui::Text("CPU: %3.2f ms (avg %3.2f ms)", mTimer.DeltaTime()*1000, mTotalCpuTimeMS/mFrameNumber);
-			ImGui::Text("GPU: %3.2f ms (avg %3.2f ms)", mFrameStats.GetCurrentGpuTime(), mFrameStats.GetAverageGpuTime());
+			const FrameTimeSummary cpu = mFrameStats.GetCpu().GetSummary();
+			const FrameTimeSummary gpu = mFrameStats.GetGpu().GetSummary();
+			ImGui::Text("CPU: %3.2f ms (avg %3.2f ms, p99 %3.2f ms)", cpu.Last, cpu.Mean, cpu.P99);
+			ImGui::Text("GPU: %3.2f ms (avg %3.2f ms, p99 %3.2f ms)", gpu.Last, gpu.Mean, gpu.P99);
+			ImGui::Text("Draws: %u visible / %u, %u batches", mDrawCount, mScene.Size(), mBatchCount);
+			ImGui::Text("Streaming: %u mips pending, %.2f MB last frame, %.2f MB total", mTextureStreamer->GetPendingMipCount(),
+				mTextureStreamer->GetLastFrameBytes() / (1024.0 * 1024.0), mTextureStreamer->GetTotalBytes() / (1024.0 * 1024.0));
+			if (ImGui::CollapsingHeader("Frame Statistics"))
+				DrawFrameStats();
+			if (ImGui::CollapsingHeader("CPU Profiler"))
+				DrawCpuProfiler();
+			if (ImGui::CollapsingHeader("GPU Profiler"))
+				DrawGpuProfiler();
+			if (ImGui::CollapsingHeader("Startup"))
+				DrawStartup();
 			ImGui::Separator();
 			ImGui::Text("Gpu Information");
 			ImGui::Text("Name: %ls", mAdapterDesc.Description);
@@ -823,6 +1267,161 @@ namespace Moon
 		}
 	}
 
+	void Application::DrawFrameStats()
+	{
+		auto drawSeries = [](const char* name, const FrameTimeSeries& series)
+		{
+			const FrameTimeSummary s = series.GetSummary();
+			ImGui::Text("%s, last %u frames", name, s.Count);
+			ImGui::Text("  min %3.2f  max %3.2f  mean %3.2f ms", s.Min, s.Max, s.Mean);
+			ImGui::Text("  p50 %3.2f  p95 %3.2f  p99 %3.2f  p99.9 %3.2f ms", s.P50, s.P95, s.P99, s.P999);
+			ImGui::Text("  stutters: %llu", (unsigned long long)series.GetStutterCount());
+			if (series.GetStoredStutterCount() > 0)
+			{
+				const FrameStutter& stutter = series.GetStutter(series.GetStoredStutterCount() - 1);
+				ImGui::SameLine();
+				ImGui::Text("(last: frame %llu, %3.2f ms for a %3.2f ms median)", (unsigned long long)stutter.Frame, stutter.TimeMS, stutter.MedianMS);
+			}
+			ImGui::PlotLines(name, series.GetSampleData(), (int)series.GetSampleCount(), (int)series.GetSampleOffset(),
+				nullptr, 0.0f, s.P999 * 1.5f, ImVec2(0.0f, 60.0f));
+		};
+
+		drawSeries("CPU", mFrameStats.GetCpu());
+		drawSeries("GPU", mFrameStats.GetGpu());
+
+		float stutterFactor = mFrameStats.GetCpu().GetStutterFactor();
+		if (ImGui::SliderFloat("Stutter factor (x median)", &stutterFactor, 1.5f, 10.0f))
+			mFrameStats.SetStutterFactor(stutterFactor);
+
+		if (ImGui::Button("Export CSV"))
+			std::cout << (mFrameStats.ExportCSV("moon_frametimes.csv") ? "Frame times written to moon_frametimes.csv" : "Could not write moon_frametimes.csv") << std::endl;
+		ImGui::SameLine();
+		if (ImGui::Button("Export JSON"))
+			std::cout << (mFrameStats.ExportJSON("moon_frametimes.json") ? "Frame statistics written to moon_frametimes.json" : "Could not write moon_frametimes.json") << std::endl;
+		ImGui::SameLine();
+		if (ImGui::Button("Reset"))
+			mFrameStats.Reset();
+	}
+
+	void Application::DrawStartup()
+	{
+		ImGui::Text("Total: %3.2f ms", mStartup.GetTotalMS());
+		for (const StartupPhase& phase : mStartup.GetPhases())
+		{
+			ImGui::Text("%*s%-24s +%7.2f ms %7.2f ms%s", (int)phase.Thread * 2, "", phase.Name.c_str(),
+				phase.Begin / 1000000.0, phase.GetMS(), phase.Thread ? "  (job)" : "");
+		}
+	}
+
+	void Application::DrawCpuProfiler()
+	{
+		CpuProfiler& profiler = CpuProfiler::Get();
+
+		bool recording = profiler.IsEnabled();
+		if (ImGui::Checkbox("Record", &recording))
+			profiler.SetEnabled(recording);
+		ImGui::SameLine();
+		bool frozen = profiler.IsFrozen();
+		if (ImGui::Checkbox("Freeze", &frozen))
+			profiler.SetFrozen(frozen);
+		ImGui::SameLine();
+		if (ImGui::Button("Export Chrome Trace"))
+		{
+			const char* filename = "moon_trace.json";
+			if (profiler.ExportChromeTrace(filename))
+				std::cout << "CPU trace written to " << filename << std::endl;
+			else
+				std::cout << "Could not write " << filename << std::endl;
+		}
+
+		const uint64_t frameBegin = profiler.GetLastFrameBegin();
+		const double frameLength = (double)(profiler.GetLastFrameEnd() - frameBegin);
+		if (frameLength <= 0.0)
+			return;
+		ImGui::Text("Frame: %3.3f ms", frameLength * 1e-6);
+
+		// One lane per thread, one row per nesting level, x is time within the frame.
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+		const float rowHeight = ImGui::GetTextLineHeight() + 2.0f;
+		const float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+
+		for (const CpuProfileThreadZones& thread : profiler.GetLastFrame())
+		{
+			if (thread.Zones.empty())
+				continue;
+
+			ImGui::TextUnformatted(thread.ThreadName.c_str());
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+			uint32_t maxDepth = 0;
+
+			for (const CpuProfileZone& zone : thread.Zones)
+			{
+				maxDepth = std::max(maxDepth, zone.Depth);
+
+				const float x0 = origin.x + (float)((zone.Begin - frameBegin) / frameLength) * width;
+				const float x1 = std::max(origin.x + (float)((zone.End - frameBegin) / frameLength) * width, x0 + 1.0f);
+				const float y0 = origin.y + zone.Depth * rowHeight;
+				const ImVec2 min(x0, y0);
+				const ImVec2 max(x1, y0 + rowHeight - 1.0f);
+
+				// Same name, same color from one frame to the next.
+				uint32_t nameHash = 2166136261u;
+				for (const char* c = zone.Name; *c; ++c)
+					nameHash = (nameHash ^ (uint8_t)*c) * 16777619u;
+				const float hue = (float)(nameHash % 360) / 360.0f;
+				drawList->AddRectFilled(min, max, ImColor::HSV(hue, 0.5f, 0.7f));
+				if (x1 - x0 > 20.0f)
+				{
+					drawList->PushClipRect(min, max, true);
+					drawList->AddText(ImVec2(x0 + 2.0f, y0 + 1.0f), IM_COL32_WHITE, zone.Name);
+					drawList->PopClipRect();
+				}
+
+				if (ImGui::IsMouseHoveringRect(min, max))
+					ImGui::SetTooltip("%s: %3.3f ms", zone.Name, (zone.End - zone.Begin) * 1e-6);
+			}
+
+			ImGui::Dummy(ImVec2(width, (maxDepth + 1) * rowHeight));
+		}
+	}
+
+	void Application::DrawGpuProfiler()
+	{
+		const std::vector<GpuProfiler::Node>& nodes = mGpuProfiler->GetNodes();
+		if (nodes[0].Children.empty())
+			return;
+
+		ImGui::Text("Pass");
+		ImGui::SameLine(ImGui::GetWindowContentRegionMax().x * 0.6f);
+		ImGui::Text("Last / Avg (%u frames)", GpuProfiler::AverageWindow);
+		for (uint32_t child : nodes[0].Children)
+			DrawGpuProfileNode(child);
+	}
+
+	void Application::DrawGpuProfileNode(uint32_t nodeIndex)
+	{
+		const GpuProfiler::Node& node = mGpuProfiler->GetNodes()[nodeIndex];
+		// Passes that did not run in the last resolved frame are hidden.
+		if (node.LastFrame != mGpuProfiler->GetResolvedFrameCount())
+			return;
+
+		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen;
+		if (node.Children.empty())
+			flags |= ImGuiTreeNodeFlags_Leaf;
+
+		ImGui::PushID((int)nodeIndex);
+		const bool open = ImGui::TreeNodeEx(node.Name, flags);
+		ImGui::SameLine(ImGui::GetWindowContentRegionMax().x * 0.6f);
+		ImGui::Text("%3.3f / %3.3f ms", node.LastMS, node.AverageMS);
+		if (open)
+		{
+			for (uint32_t child : node.Children)
+				DrawGpuProfileNode(child);
+			ImGui::TreePop();
+		}
+		ImGui::PopID();
+	}
+
 	void Application::OnEvent(Event& e)
 	{
 		EventDispatcher dispatcher(e);
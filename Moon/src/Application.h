@@ -11,6 +11,21 @@
 #include "Event.h"
 #include "ImguiDrawer.h"
 #include "Window.h"
+#include "JobSystem.h"
+#include "DrawList.h"
+#include "SceneStore.h"
+#include "TransformHierarchy.h"
+#include "ObjectConstantUploader.h"
+#include "IndirectDrawBuilder.h"
+#include "RenderGraph.h"
+#include "GpuProfiler.h"
+#include "FrameStats.h"
+#include "FrustumCuller.h"
+#include "Benchmark.h"
+#include "RhiD3D12.h"
+#include "StartupProfiler.h"
+#include "TextureStreamer.h"
+#include "DerivedDataCache.h"
 
 namespace Moon
 {
@@ -26,14 +41,24 @@ namespace Moon
 		DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
 		DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 	};
+	static_assert(sizeof(PerObjectCB) == ObjectConstantUploader::ObjectDataSize, "ObjectConstantUploader writes World then TexTransform");
+	static_assert(sizeof(IndirectDrawIndexedArgs) == sizeof(D3D12_DRAW_INDEXED_ARGUMENTS), "IndirectDrawIndexedArgs must match D3D12_DRAW_INDEXED_ARGUMENTS");
 
 	struct FrameResource
 	{
 	public:
-		FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount)
+		FrameResource(ID3D12Device* device, RhiDevice* rhiDevice, UINT passCount, UINT objectCount)
 		{
 			PassCB = std::make_unique<UploadBuffer<PerPassCB>>(device, passCount, true);
 			ObjectCB = std::make_unique<UploadBuffer<PerObjectCB>>(device, objectCount, true);
+
+			RhiBufferDesc indirectArgsDesc;
+			indirectArgsDesc.Size = (uint64_t)objectCount * sizeof(IndirectDrawCommand);
+			indirectArgsDesc.Heap = RhiHeapType::Upload;
+			indirectArgsDesc.InitialState = RhiState::GenericRead;
+			indirectArgsDesc.Name = "IndirectArgs";
+			IndirectArgs = rhiDevice->CreateBuffer(indirectArgsDesc);
+			IndirectArgsData = static_cast<IndirectDrawCommand*>(IndirectArgs->Map());
 		}
 
 		FrameResource(const FrameResource& rhs) = delete;
@@ -42,81 +67,35 @@ namespace Moon
 
 		std::unique_ptr<UploadBuffer<PerObjectCB>> ObjectCB = nullptr;
 		std::unique_ptr<UploadBuffer<PerPassCB>> PassCB = nullptr;
+		std::unique_ptr<RhiResource> IndirectArgs = nullptr;
+		IndirectDrawCommand* IndirectArgsData = nullptr;
 	};
 
-	struct RenderItem
+	// Read and cooked by the startup jobs, turned into GPU resources on the main thread.
+	struct StartupAssets
 	{
-		RenderItem() = default;
-
-		DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
-		DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
-
-		int NumFramesDirty = BACKBUFFER_COUNT;
-		D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-
-		UINT ObjCBIndex = -1;
-		Material* Mat = nullptr;
-		MeshGeometry* Geo = nullptr;
-		UINT IndexCount = 0;
-		UINT StartIndexLocation = 0;
-		int BaseVertexLocation = 0;
-		std::string Name;
+		Microsoft::WRL::ComPtr<ID3DBlob> MeshVS;
+		Microsoft::WRL::ComPtr<ID3DBlob> MeshPS;
+		DirectX::DDSFileMapping LostEmpireDDS;
+		std::vector<Vertex> LostEmpireVertices;
+		std::vector<std::uint32_t> LostEmpireIndices;
+		DirectX::BoundingBox LostEmpireBounds;
 	};
 
-	struct FrameStats
+	enum RenderPassIndex
 	{
-		float* gpuTimes;
-		int timestampIndex = 0;
-
-		static const int numberOfTimestamps = 100;
-
-		void Init()
-		{	
-			gpuTimes = new float[numberOfTimestamps];
-			for (size_t i = 0; i < numberOfTimestamps; i++)
-			{
-				gpuTimes[i] = 0.0f;
-			}
-		}
-
-		void Deinit()
-		{
-			delete gpuTimes;
-		}
-
-		void AddTimestamp(float ts)
-		{
-			gpuTimes[timestampIndex++] = ts;
-			timestampIndex = timestampIndex % numberOfTimestamps;
-		}
-
-		float GetCurrentGpuTime()
-		{
-			if (timestampIndex == 0)
-				return gpuTimes[numberOfTimestamps];
-			else
-				return gpuTimes[timestampIndex - 1];
-		}
-
-		float GetAverageGpuTime()
-		{
-			float avg = 0.0f;
-			for (size_t i = 0; i < numberOfTimestamps; i++)
-			{
-				avg += gpuTimes[i];
-			}
-			return avg /= numberOfTimestamps;
-		}
-
+		RenderPass_Opaque = 0,
 	};
 
 	class Application
 	{
 	public:
-		void Init();
+		// A benchmark run drives the camera along a path with a fixed timestep and quits once its report is written.
+		void Init(const BenchmarkOptions& benchmark = BenchmarkOptions());
 		void Cleanup();
 		void Draw();
-		void Run();
+		// Returns the exit code.
+		int Run();
 
 		static Application* GetInstance() { return gApplication; }
 		void OnEvent(Event& e);
@@ -135,13 +114,26 @@ namespace Moon
 		void InitDescriptorHeaps();
 		void Resize();
 
-		void InitPipeline();
-		void LoadImages();
-		void LoadMeshes();
+		// Job side: file reads and CPU cooking only, no device nor command list access.
+		void ReadShaders(StartupAssets& assets);
+		void ReadImages(StartupAssets& assets);
+		void CookMeshes(StartupAssets& assets);
+		// The cooked texture, mapped from the derived data cache. The source itself on a miss or when the cache is disabled.
+		// Throws std::runtime_error when the source can not be opened.
+		DirectX::DDSFileMapping FindCookedTexture(const std::filesystem::path& source);
+
+		// Creates the root and command signatures, then queues the PSO creations on psoJobs.
+		void InitPipeline(const StartupAssets& assets, JobGroup& psoJobs);
+		void LoadImages(StartupAssets& assets);
+		void LoadMeshes(const StartupAssets& assets);
 		void InitScene();
 
 
 		void GetQueryResult();
+		void UpdateBenchmarkCamera();
+		void EndBenchmarkFrame();
+		bool WriteBenchmarkReport();
+		void WriteGpuPassJSON(std::ostream& out, uint32_t node);
 
 		std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 		Microsoft::WRL::ComPtr<ID3DBlob> LoadShaderBinary(const std::wstring& filename);
@@ -156,13 +148,23 @@ namespace Moon
 
 		void DrawMenuBar();
 		void DrawDebugInfo();
+		void DrawFrameStats();
+		void DrawStartup();
+		void DrawCpuProfiler();
+		void DrawGpuProfiler();
+		void DrawGpuProfileNode(uint32_t node);
 
 	private:
 		static Application* gApplication;
 		Window* mWindow = nullptr;
 		CommandQueueManager* mQueues = nullptr;
 		RenderDoc* mRenderDoc = nullptr;
+		JobSystem* mJobSystem = nullptr;
+		// Cooked textures and meshes, shared with mooncook --cache.
+		DerivedDataCache* mDerivedData = nullptr;
+		RenderGraph* mRenderGraph = nullptr;
 		Timer mTimer;
+		StartupProfiler mStartup;
 		bool isD3D12Initialized = false;
 		ImguiDrawer* mImguiDrawer = nullptr;
 		bool showImguiDemo = false;
@@ -170,6 +172,7 @@ namespace Moon
 		bool mAppPaused = false;
 		bool mWireframeRendering = false;
 		bool mVSync = true;
+		bool mIndirectDraws = true;
 
 		//D3D12 related stuff
 		Microsoft::WRL::ComPtr<IDXGIFactory6> mFactory;
@@ -192,13 +195,14 @@ namespace Moon
 
 		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mRtvHeap;
 		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mDsvHeap;
+		// SrvHeapFrameSize descriptors per frame in flight, frame after frame: the streamer rewrites a frame's SRVs while
+		// the GPU reads the others.
 		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mSrvHeap;
+		static constexpr UINT SrvHeapFrameSize = 1;
 
-		Microsoft::WRL::ComPtr<ID3D12QueryHeap> mQueryHeap;
-		Microsoft::WRL::ComPtr<ID3D12Resource> mQueryResult;
-		UINT64 mTimestampFrequency;
+		GpuProfiler* mGpuProfiler = nullptr;
+		uint64_t mLastGpuProfileFrame = 0;
 		int mFrameNumber = 0;
-		float mTotalCpuTimeMS = 0.0f;
 		FrameStats mFrameStats;
 
 		UINT mRtvDescriptorSize = 0;
@@ -208,13 +212,42 @@ namespace Moon
 		Microsoft::WRL::ComPtr<ID3D12RootSignature> mMeshRootSig;
 		Microsoft::WRL::ComPtr<ID3D12PipelineState> mMeshPSO;
 		Microsoft::WRL::ComPtr<ID3D12PipelineState> mWireframeMeshPSO;
+		Microsoft::WRL::ComPtr<ID3D12CommandSignature> mMeshCommandSignature;
+
+		// Draw recording goes through the RHI, the objects above are wrapped once created.
+		D3D12RhiDevice* mRhiDevice = nullptr;
+		std::unique_ptr<RhiPipelineState> mRhiMeshPSO;
+		std::unique_ptr<RhiPipelineState> mRhiWireframeMeshPSO;
+		std::unique_ptr<RhiCommandSignature> mRhiMeshCommandSignature;
 
 		Camera* mCamera = nullptr;
 		std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
 		std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
 		std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
-		std::vector<std::unique_ptr<RenderItem>> mAllRitems;
-		std::vector<RenderItem*> mOpaqueRitems;
+		TextureStreamer* mTextureStreamer = nullptr;
+		std::vector<Material*> mMaterialsById;
+		std::vector<MeshGeometry*> mGeometriesById;
+		SceneStore mScene{ BACKBUFFER_COUNT };
+		TransformHierarchy mTransforms;
+		ObjectConstantUploader mObjectCBUploader;
+		FrustumCuller mCuller;
+		DrawList mOpaqueDrawList;
+		IndirectDrawBuilder mIndirectDrawBuilder;
+		uint32_t mDrawCount = 0;
+		uint32_t mBatchCount = 0;
+
+		BenchmarkOptions mBenchmark;
+		CameraPath mBenchmarkPath;
+		uint32_t mBenchmarkFrame = 0;
+		uint64_t mBenchmarkVisibleSum = 0;
+		uint64_t mBenchmarkDrawSum = 0;
+		uint64_t mBenchmarkBatchSum = 0;
+		// Per GpuProfiler node, over the measured frames.
+		std::vector<double> mBenchmarkPassSums;
+		std::vector<uint32_t> mBenchmarkPassCounts;
+
+		ResourceStateRegistry mResourceStates;
+		ResourceStateTracker mStateTracker{ mResourceStates };
 
 		std::vector<std::unique_ptr<FrameResource>> mFrameResources;
 		FrameResource* mCurrFrameResource = nullptr;
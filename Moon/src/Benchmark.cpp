@@ -0,0 +1,569 @@
+#include "mnpch.h"
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+#include "BenchmarkCommon.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+using namespace DirectX;
+
+namespace Moon
+{
+	namespace
+	{
+		// Whitespace separated, double quotes group a path with spaces.
+		std::vector<std::string> SplitCommandLine(const std::string& commandLine)
+		{
+			std::vector<std::string> args;
+			std::string current;
+			bool quoted = false;
+			bool hasArg = false;
+			for (char c : commandLine)
+			{
+				if (c == '"')
+				{
+					quoted = !quoted;
+					hasArg = true;
+				}
+				else if (!quoted && (c == ' ' || c == '\t'))
+				{
+					if (hasArg)
+						args.push_back(current);
+					current.clear();
+					hasArg = false;
+				}
+				else
+				{
+					current += c;
+					hasArg = true;
+				}
+			}
+			if (hasArg)
+				args.push_back(current);
+			return args;
+		}
+
+		uint32_t ParseCount(const std::string& option, const std::string& value, uint32_t minValue)
+		{
+			char* end = nullptr;
+			const unsigned long long count = strtoull(value.c_str(), &end, 10);
+			if (value.empty() || *end != '\0' || value[0] == '-' || count < minValue || count > UINT32_MAX)
+				throw std::runtime_error(option + " expects an integer >= " + std::to_string(minValue) + ", got \"" + value + "\"");
+			return (uint32_t)count;
+		}
+
+		// Objects per cluster of the headless scene, children of one transform node.
+		constexpr uint32_t ClusterSize = 64;
+		constexpr float ClusterSpacing = 16.0f;
+		constexpr uint32_t MaterialCount = 8;
+		constexpr uint32_t GeometryCount = 4;
+		// Every geometry is a 24 vertices, 36 indices box.
+		constexpr uint32_t VertexStride = 32;
+
+		const char* const PhaseNames[] = { "camera", "transforms", "object_upload", "culling", "sort", "commands", "record" };
+
+		// Diffuse texture table of the mesh root signature.
+		constexpr uint32_t MaterialRootIndex = 0;
+		// BACKBUFFER_COUNT and D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT of the renderer, dx_utils.h would pull
+		// d3d12.h into the Linux build.
+		constexpr uint32_t FramesInFlight = 2;
+		constexpr uint32_t ConstantBufferAlignment = 256;
+	}
+
+	BenchmarkOptions BenchmarkOptions::Parse(const std::string& commandLine)
+	{
+		BenchmarkOptions options;
+		const std::vector<std::string> args = SplitCommandLine(commandLine);
+		for (size_t i = 0; i < args.size(); ++i)
+		{
+			const std::string& arg = args[i];
+			auto value = [&]() -> const std::string&
+			{
+				if (i + 1 >= args.size())
+					throw std::runtime_error(arg + " expects a value");
+				return args[++i];
+			};
+
+			if (arg == "--benchmark")
+				options.Enabled = true;
+			else if (arg == "--headless")
+				options.Enabled = options.Headless = true;
+			else if (arg == "--frames")
+				options.Frames = ParseCount(arg, value(), 1);
+			else if (arg == "--warmup")
+				options.WarmupFrames = ParseCount(arg, value(), 0);
+			else if (arg == "--objects")
+				options.Objects = ParseCount(arg, value(), 1);
+			else if (arg == "--timestep")
+			{
+				const std::string& timestep = value();
+				char* end = nullptr;
+				options.Timestep = strtof(timestep.c_str(), &end);
+				if (timestep.empty() || *end != '\0' || !(options.Timestep > 0.0f))
+					throw std::runtime_error("--timestep expects a positive number of seconds, got \"" + timestep + "\"");
+			}
+			else if (arg == "--camera-path")
+				options.CameraPathFile = value();
+			else if (arg == "--output")
+				options.OutputFile = value();
+			else
+				throw std::runtime_error("Unknown argument \"" + arg + "\"");
+		}
+		return options;
+	}
+
+	CameraPath BenchmarkOptions::LoadCameraPath() const
+	{
+		if (CameraPathFile.empty())
+			return CameraPath::MakeDefault();
+
+		CameraPath path;
+		if (!path.LoadFromFile(CameraPathFile))
+			throw std::runtime_error("Could not load camera path " + CameraPathFile);
+		return path;
+	}
+
+	float BenchmarkOptions::GetPathTime(const CameraPath& path, uint32_t frame) const
+	{
+		// In double, a float time drifts away from the keyframes on long runs.
+		const double time = (double)frame * (double)Timestep;
+		const double duration = path.GetDuration();
+		return (float)(duration > 0.0 ? fmod(time, duration) : 0.0);
+	}
+
+	void WriteProcessMemoryJSON(std::ostream& out)
+	{
+		uint64_t workingSet = 0;
+		uint64_t peakWorkingSet = 0;
+		uint64_t privateBytes = 0;
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS_EX counters = {};
+		counters.cb = sizeof(counters);
+		GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters));
+		workingSet = counters.WorkingSetSize;
+		peakWorkingSet = counters.PeakWorkingSetSize;
+		privateBytes = counters.PrivateUsage;
+#else
+		// Pages: total, resident, shared, text, lib, data and stack. Resident is the working set, data and stack what is
+		// private to the process.
+		const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+		std::ifstream statm("/proc/self/statm");
+		uint64_t size = 0, resident = 0, shared = 0, text = 0, lib = 0, data = 0;
+		if (statm >> size >> resident >> shared >> text >> lib >> data)
+		{
+			workingSet = resident * pageSize;
+			privateBytes = data * pageSize;
+		}
+
+		// statm has no peak, the high water mark of the resident set is in status, in kB.
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+		{
+			if (line.compare(0, 6, "VmHWM:") == 0)
+			{
+				peakWorkingSet = strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+				break;
+			}
+		}
+#endif
+		out << "{\"working_set_bytes\":" << workingSet
+			<< ",\"peak_working_set_bytes\":" << peakWorkingSet
+			<< ",\"private_bytes\":" << privateBytes
+			<< "}";
+	}
+
+	HeadlessBenchmark::HeadlessBenchmark(const BenchmarkOptions& options)
+		: mOptions(options)
+		, mCameraPath(options.LoadCameraPath())
+		, mCamera(1920.0f, 1080.0f)
+		, mScene(FramesInFlight)
+	{
+		CpuProfiler::Get().SetThreadName("Main");
+		mCamera.SetInputEnabled(false);
+		mJobSystem = new JobSystem();
+
+		CreateRhiObjects();
+		BuildScene();
+	}
+
+	HeadlessBenchmark::~HeadlessBenchmark()
+	{
+		delete mJobSystem;
+	}
+
+	void HeadlessBenchmark::CreateRhiObjects()
+	{
+		// Same layout as the renderer's object constant buffer, one 256 bytes slot per object.
+		mObjectCBStride = (ObjectConstantUploader::ObjectDataSize + ConstantBufferAlignment - 1) & ~(ConstantBufferAlignment - 1);
+		RhiBufferDesc objectCBDesc;
+		objectCBDesc.Size = (uint64_t)mObjectCBStride * mOptions.Objects;
+		objectCBDesc.Heap = RhiHeapType::Upload;
+		objectCBDesc.InitialState = RhiState::GenericRead;
+		objectCBDesc.Name = "ObjectCB";
+		mObjectCBBuffer = mRhiDevice.CreateBuffer(objectCBDesc);
+		mObjectCB = static_cast<uint8_t*>(mObjectCBBuffer->Map());
+
+		RhiBufferDesc indirectArgsDesc = objectCBDesc;
+		indirectArgsDesc.Size = (uint64_t)sizeof(IndirectDrawCommand) * mOptions.Objects;
+		indirectArgsDesc.Name = "IndirectArgs";
+		mIndirectArgs = mRhiDevice.CreateBuffer(indirectArgsDesc);
+
+		// Vertices then indices of every geometry, never read.
+		RhiBufferDesc geometryDesc;
+		geometryDesc.Size = GeometryCount * (24 * VertexStride + 36 * sizeof(uint16_t));
+		geometryDesc.Name = "Geometry";
+		mGeometryBuffer = mRhiDevice.CreateBuffer(geometryDesc);
+
+		mMaterialHeap = mRhiDevice.CreateDescriptorHeap(RhiDescriptorHeapType::CbvSrvUav, MaterialCount, true);
+		mPipelineState = mRhiDevice.CreatePipelineState();
+		mCommandSignature = mRhiDevice.CreateCommandSignature(sizeof(IndirectDrawCommand));
+		mCommandList = mRhiDevice.CreateCommandList();
+	}
+
+	void HeadlessBenchmark::BuildScene()
+	{
+		// Clusters of objects on a square grid centered on the origin, the default camera path circles above them.
+		const uint32_t clusterCount = (mOptions.Objects + ClusterSize - 1) / ClusterSize;
+		const uint32_t gridSize = (uint32_t)ceil(sqrt((double)clusterCount));
+		const float gridOffset = (gridSize - 1) * ClusterSpacing * 0.5f;
+
+		mScene.Reserve(mOptions.Objects);
+		mClusters.reserve(clusterCount);
+		for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+		{
+			const TransformNode clusterNode = mTransforms.AddNode();
+			mTransforms.SetTranslation(clusterNode, XMFLOAT3((cluster % gridSize) * ClusterSpacing - gridOffset, 0.0f, (cluster / gridSize) * ClusterSpacing - gridOffset));
+			mClusters.push_back(clusterNode);
+		}
+
+		for (uint32_t i = 0; i < mOptions.Objects; ++i)
+		{
+			const uint32_t cluster = i / ClusterSize;
+			const uint32_t child = i % ClusterSize;
+
+			SceneObjectDesc desc;
+			desc.Name = "Object" + std::to_string(i);
+			desc.LocalBounds = BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+			desc.MaterialId = cluster % MaterialCount;
+			desc.GeometryId = child % GeometryCount;
+			desc.IndexCount = 36;
+			desc.StartIndexLocation = desc.GeometryId * 36;
+			const SceneHandle object = mScene.Create(desc);
+
+			// 4x4x4 block of objects around the cluster center.
+			const TransformNode node = mTransforms.AddNode(mClusters[cluster]);
+			mTransforms.SetTranslation(node, XMFLOAT3((child % 4) * 3.0f - 4.5f, (child / 16) * 3.0f + 1.0f, ((child / 4) % 4) * 3.0f - 4.5f));
+			mTransforms.BindSceneObject(node, object);
+		}
+	}
+
+	void HeadlessBenchmark::RunFrame(uint32_t frame)
+	{
+		const uint64_t frameBegin = CpuProfiler::Now();
+		uint64_t phaseBegin = frameBegin;
+		auto endPhase = [&](Phase phase)
+		{
+			const uint64_t now = CpuProfiler::Now();
+			mPhases[phase].AddSample(mMeasuredFrames, ElapsedMS(phaseBegin, now));
+			phaseBegin = now;
+		};
+
+		{
+			PROFILE_ZONE("Camera");
+			XMFLOAT3 position, target;
+			mCameraPath.Sample(mOptions.GetPathTime(mCameraPath, frame), position, target);
+			mCamera.LookAt(position, target, XMFLOAT3(0.0f, 1.0f, 0.0f));
+			mCamera.Update(mOptions.Timestep);
+		}
+		endPhase(Phase_Camera);
+
+		{
+			PROFILE_ZONE("Update Transforms");
+			// One cluster in eight turns each frame, about an eighth of the objects get new constants.
+			for (uint32_t cluster = frame % 8; cluster < (uint32_t)mClusters.size(); cluster += 8)
+			{
+				XMFLOAT4 rotation;
+				XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYaw(0.0f, (float)frame * 0.01f + cluster, 0.0f));
+				mTransforms.SetRotation(mClusters[cluster], rotation);
+			}
+			mTransforms.Update(mJobSystem);
+			mTransforms.WriteChanged(mScene);
+		}
+		endPhase(Phase_Transforms);
+
+		{
+			PROFILE_ZONE("Upload Object CB");
+			mObjectCBUploader.CollectDirty(mScene.GetNumFramesDirty(), mScene.Size());
+			mObjectCBUploader.Upload(mScene.GetWorlds(), mScene.GetTexTransforms(), mObjectCB, mObjectCBStride, mJobSystem);
+		}
+		endPhase(Phase_ObjectUpload);
+
+		const XMMATRIX view = mCamera.GetView();
+		{
+			PROFILE_ZONE("Frustum Culling");
+			mCuller.Cull(FrustumCuller::MakeWorldFrustum(view, mCamera.GetProj()), mScene.GetWorldBounds(), mScene.Size(), mJobSystem);
+		}
+		endPhase(Phase_Culling);
+
+		{
+			PROFILE_ZONE("Sort Opaque Items");
+			const BoundingBox* bounds = mScene.GetWorldBounds();
+			const uint32_t* materialIds = mScene.GetMaterialIds();
+			const uint32_t* geometryIds = mScene.GetGeometryIds();
+
+			mDrawList.Clear();
+			mDrawList.Reserve(mCuller.GetVisible().size());
+			for (uint32_t i : mCuller.GetVisible())
+			{
+				const float viewDepth = XMVectorGetZ(XMVector3TransformCoord(XMLoadFloat3(&bounds[i].Center), view));
+				mDrawList.Add(DrawSortKey::Make(0, 0, materialIds[i], geometryIds[i],
+					DrawSortKey::QuantizeDepth(viewDepth, mCamera.GetNearZ(), mCamera.GetFarZ())), i);
+			}
+			mDrawList.Sort(mJobSystem);
+		}
+		endPhase(Phase_Sort);
+
+		{
+			PROFILE_ZONE("Build Indirect Commands");
+			// Host address in place of the GPU one, the builder only does arithmetic on it.
+			mIndirectDrawBuilder.Build(mDrawList, mScene.GetIndexCounts(), mScene.GetStartIndexLocations(), mScene.GetBaseVertexLocations(),
+				mObjectCBBuffer->GetGpuAddress(), mObjectCBStride);
+			const std::vector<IndirectDrawCommand>& commands = mIndirectDrawBuilder.GetCommands();
+			memcpy(mIndirectArgs->Map(), commands.data(), commands.size() * sizeof(IndirectDrawCommand));
+		}
+		endPhase(Phase_Commands);
+
+		{
+			PROFILE_ZONE("Record Draws");
+			// Same binding sequence as the renderer's mesh pass, one ExecuteIndirect per state change.
+			mCommandList->Reset();
+			mCommandList->SetPipelineState(mPipelineState.get());
+			uint32_t currentGeometry = UINT32_MAX;
+			uint32_t currentMaterial = UINT32_MAX;
+			for (const IndirectDrawBatch& batch : mIndirectDrawBuilder.GetBatches())
+			{
+				if (batch.Geometry != currentGeometry)
+				{
+					const uint64_t vertexSize = 24 * VertexStride;
+					const uint64_t indexSize = 36 * sizeof(uint16_t);
+					const uint64_t geometryAddress = mGeometryBuffer->GetGpuAddress() + batch.Geometry * (vertexSize + indexSize);
+					mCommandList->SetVertexBuffer({ geometryAddress, (uint32_t)vertexSize, VertexStride });
+					mCommandList->SetIndexBuffer({ geometryAddress + vertexSize, (uint32_t)indexSize, RhiIndexFormat::Uint16 });
+					currentGeometry = batch.Geometry;
+				}
+				if (batch.Material != currentMaterial)
+				{
+					mCommandList->SetGraphicsRootDescriptorTable(MaterialRootIndex, mMaterialHeap->GetGpuHandle(batch.Material));
+					currentMaterial = batch.Material;
+				}
+				mCommandList->ExecuteIndirect(mCommandSignature.get(), batch.CommandCount, mIndirectArgs.get(),
+					(uint64_t)batch.FirstCommand * sizeof(IndirectDrawCommand));
+			}
+			mCommandList->Close();
+			mRhiDevice.GetGraphicsQueue()->ExecuteCommandList(mCommandList.get());
+		}
+		endPhase(Phase_Record);
+
+		mFrameStats.AddCpuFrameTime(ElapsedMS(frameBegin, phaseBegin));
+		mVisibleSum += mCuller.GetVisible().size();
+		mDrawSum += mIndirectDrawBuilder.GetCommands().size();
+		mBatchSum += mIndirectDrawBuilder.GetBatches().size();
+		mMeasuredFrames++;
+	}
+
+	void HeadlessBenchmark::ResetStatistics()
+	{
+		mFrameStats.Reset();
+		for (FrameTimeSeries& phase : mPhases)
+			phase.Reset();
+		mVisibleSum = 0;
+		mDrawSum = 0;
+		mBatchSum = 0;
+		mMeasuredFrames = 0;
+		mRhiDevice.GetNullGraphicsQueue().ResetStats();
+	}
+
+	bool HeadlessBenchmark::Run()
+	{
+		const uint32_t frameCount = mOptions.WarmupFrames + mOptions.Frames;
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			if (frame == mOptions.WarmupFrames)
+				ResetStatistics();
+
+			CpuProfiler::Get().BeginFrame();
+			PROFILE_ZONE("Frame");
+			RunFrame(frame);
+		}
+
+		RunMicroBenchmarks();
+		mCompression.Run();
+		mPayload.Run();
+		mConvert.Run();
+		return WriteReport();
+	}
+
+	void HeadlessBenchmark::RunMicroBenchmarks()
+	{
+		std::mt19937 random(1234);
+		std::vector<float> runs(BenchmarkRuns);
+
+		// Draw list sort, random keys, against a comparison sort of the same pairs.
+		for (uint32_t count : { 100000u, 1000000u })
+		{
+			std::vector<uint64_t> keys(count);
+			for (uint64_t& key : keys)
+				key = ((uint64_t)random() << 32) | random();
+
+			DrawList drawList;
+			drawList.Reserve(count);
+			for (JobSystem* jobSystem : { (JobSystem*)nullptr, mJobSystem })
+			{
+				for (float& run : runs)
+				{
+					drawList.Clear();
+					for (uint32_t i = 0; i < count; ++i)
+						drawList.Add(keys[i], i);
+
+					const uint64_t begin = CpuProfiler::Now();
+					drawList.Sort(jobSystem);
+					run = ElapsedMS(begin, CpuProfiler::Now());
+				}
+				mMicroBenchmarks.emplace_back("draw_list_sort_" + std::to_string(count / 1000) + "k_" + (jobSystem ? "parallel" : "serial"), MedianMS(runs));
+			}
+
+			std::vector<std::pair<uint64_t, uint32_t>> pairs(count);
+			for (float& run : runs)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+					pairs[i] = { keys[i], i };
+
+				const uint64_t begin = CpuProfiler::Now();
+				std::stable_sort(pairs.begin(), pairs.end(), [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b)
+				{
+					return a.first < b.first;
+				});
+				run = ElapsedMS(begin, CpuProfiler::Now());
+			}
+			mMicroBenchmarks.emplace_back("draw_list_sort_" + std::to_string(count / 1000) + "k_std_stable_sort", MedianMS(runs));
+		}
+
+		// Object constants upload, 100k objects with a share of them dirty, against the per object
+		// transpose and copy loop the uploader replaced.
+		const uint32_t objectCount = std::min(100000u, mScene.Size());
+		const XMFLOAT4X4* worlds = mScene.GetWorlds();
+		const XMFLOAT4X4* texTransforms = mScene.GetTexTransforms();
+		std::vector<uint8_t> numFramesDirty(objectCount);
+		for (uint32_t percent : { 1u, 10u, 100u })
+		{
+			const std::string name = "object_upload_" + std::to_string(objectCount / 1000) + "k_" + std::to_string(percent) + "pct_dirty";
+			for (float& run : runs)
+			{
+				for (uint32_t i = 0; i < objectCount; ++i)
+					numFramesDirty[i] = (i * 100u / objectCount) % 100u < percent ? 1 : 0;
+
+				const uint64_t begin = CpuProfiler::Now();
+				mObjectCBUploader.CollectDirty(numFramesDirty.data(), objectCount);
+				mObjectCBUploader.Upload(worlds, texTransforms, mObjectCB, mObjectCBStride, mJobSystem);
+				run = ElapsedMS(begin, CpuProfiler::Now());
+			}
+			mMicroBenchmarks.emplace_back(name, MedianMS(runs));
+
+			for (float& run : runs)
+			{
+				for (uint32_t i = 0; i < objectCount; ++i)
+					numFramesDirty[i] = (i * 100u / objectCount) % 100u < percent ? 1 : 0;
+
+				const uint64_t begin = CpuProfiler::Now();
+				for (uint32_t i = 0; i < objectCount; ++i)
+				{
+					if (numFramesDirty[i] > 0)
+					{
+						XMFLOAT4X4 constants[2];
+						XMStoreFloat4x4(&constants[0], XMMatrixTranspose(XMLoadFloat4x4(&worlds[i])));
+						XMStoreFloat4x4(&constants[1], XMMatrixTranspose(XMLoadFloat4x4(&texTransforms[i])));
+						memcpy(mObjectCB + (size_t)i * mObjectCBStride, constants, sizeof(constants));
+						numFramesDirty[i]--;
+					}
+				}
+				run = ElapsedMS(begin, CpuProfiler::Now());
+			}
+			mMicroBenchmarks.emplace_back(name + "_per_object", MedianMS(runs));
+		}
+	}
+
+	bool HeadlessBenchmark::WriteReport() const
+	{
+		std::ofstream out(mOptions.OutputFile, std::ios::out | std::ios::trunc);
+		if (!out)
+			return false;
+
+		const double frames = (double)std::max<uint64_t>(mMeasuredFrames, 1);
+		out << "{\"mode\":\"headless\",\"frames\":" << mOptions.Frames
+			<< ",\"warmup_frames\":" << mOptions.WarmupFrames
+			<< ",\"timestep\":" << mOptions.Timestep
+			<< ",\"workers\":" << mJobSystem->GetWorkerCount()
+			<< ",\"camera_path\":";
+		WriteJSONString(out, mOptions.CameraPathFile.empty() ? "default" : mOptions.CameraPathFile);
+
+		out << ",\"frame_stats\":";
+		mFrameStats.WriteJSON(out);
+
+		// Summaries cover the last FrameTimeSeries::WindowSize frames, the lifetime percentiles the whole run.
+		out << ",\"phases_ms\":{";
+		for (uint32_t phase = 0; phase < Phase_Count; ++phase)
+		{
+			out << (phase ? "," : "") << "\"" << PhaseNames[phase] << "\":{\"summary\":";
+			WriteFrameTimeSummaryJSON(out, mPhases[phase].GetSummary());
+			const FrameTimeHistogram& lifetime = mPhases[phase].GetLifetimeHistogram();
+			out << ",\"lifetime_p50\":" << lifetime.GetPercentileMS(50.0)
+				<< ",\"lifetime_p99\":" << lifetime.GetPercentileMS(99.0) << "}";
+		}
+
+		out << "},\"draws\":{\"objects\":" << mScene.Size()
+			<< ",\"visible_avg\":" << mVisibleSum / frames
+			<< ",\"draws_avg\":" << mDrawSum / frames
+			<< ",\"batches_avg\":" << mBatchSum / frames
+			<< "},\"rhi\":{\"backend\":\"null\"";
+		const NullRhiStats& rhiStats = mRhiDevice.GetNullGraphicsQueue().GetStats();
+		out << ",\"command_lists\":" << rhiStats.CommandListsExecuted
+			<< ",\"commands_avg\":" << rhiStats.Commands / frames
+			<< ",\"draws_avg\":" << rhiStats.Draws / frames
+			<< "},\"memory\":{\"process\":";
+		WriteProcessMemoryJSON(out);
+
+		out << "},\"micro_benchmarks_ms\":{";
+		for (size_t i = 0; i < mMicroBenchmarks.size(); ++i)
+		{
+			out << (i ? "," : "");
+			WriteJSONString(out, mMicroBenchmarks[i].first);
+			out << ":" << mMicroBenchmarks[i].second;
+		}
+
+		out << "},\"compression\":";
+		mCompression.WriteJSON(out);
+		out << ",\"payload\":";
+		mPayload.WriteJSON(out);
+		out << ",\"convert\":";
+		mConvert.WriteJSON(out);
+		out << "}\n";
+
+		return (bool)out;
+	}
+}
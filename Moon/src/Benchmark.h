@@ -0,0 +1,130 @@
+#pragma once
+#include "Camera.h"
+#include "CameraPath.h"
+#include "FrameStats.h"
+#include "SceneStore.h"
+#include "TransformHierarchy.h"
+#include "ObjectConstantUploader.h"
+#include "FrustumCuller.h"
+#include "DrawList.h"
+#include "IndirectDrawBuilder.h"
+#include "RhiNull.h"
+#include "CompressionBenchmark.h"
+#include "PayloadBenchmark.h"
+#include "ConvertBenchmark.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Moon
+{
+	class JobSystem;
+
+	struct BenchmarkOptions
+	{
+		bool Enabled = false;
+		// CPU side of the frame only, on a synthetic scene: no window, device nor swapchain.
+		bool Headless = false;
+		// Measured frames, after the warmup ones.
+		uint32_t Frames = 1000;
+		// Not measured, pipelines and first uploads settle in there.
+		uint32_t WarmupFrames = 100;
+		// Seconds the camera moves along its path each frame, whatever the frame really took.
+		float Timestep = 1.0f / 60.0f;
+		// Object count of the headless scene.
+		uint32_t Objects = 100000;
+		// Empty for CameraPath::MakeDefault().
+		std::string CameraPathFile;
+		std::string OutputFile = "benchmark.json";
+
+		// "--benchmark [--headless] [--frames N] [--warmup N] [--timestep S] [--objects N] [--camera-path FILE] [--output FILE]"
+		// --headless implies --benchmark. Throws std::runtime_error on an unknown argument or a bad value.
+		static BenchmarkOptions Parse(const std::string& commandLine);
+
+		// Throws std::runtime_error when CameraPathFile can not be loaded.
+		CameraPath LoadCameraPath() const;
+		// Camera path time of a frame, the path loops when the run is longer than it.
+		float GetPathTime(const CameraPath& path, uint32_t frame) const;
+	};
+
+	// {"working_set_bytes":...,"peak_working_set_bytes":...,"private_bytes":...}
+	void WriteProcessMemoryJSON(std::ostream& out);
+
+	// Runs the CPU work of a frame (transforms, object constants, culling, sorting, indirect commands, draw recording)
+	// over a synthetic scene along a camera path, against the null RHI. Then a few micro benchmarks of the same building blocks,
+	// and the texture benchmarks: BC encoders, shipped payloads and format conversions.
+	// Everything is seeded and driven by the frame index, two runs do exactly the same work.
+	class HeadlessBenchmark
+	{
+	public:
+		HeadlessBenchmark(const BenchmarkOptions& options);
+		~HeadlessBenchmark();
+		HeadlessBenchmark(const HeadlessBenchmark& rhs) = delete;
+		HeadlessBenchmark& operator=(const HeadlessBenchmark& rhs) = delete;
+
+		// Returns false when the report could not be written.
+		bool Run();
+
+	private:
+		enum Phase
+		{
+			Phase_Camera = 0,
+			Phase_Transforms,
+			Phase_ObjectUpload,
+			Phase_Culling,
+			Phase_Sort,
+			Phase_Commands,
+			Phase_Record,
+			Phase_Count
+		};
+
+		void CreateRhiObjects();
+		void BuildScene();
+		void RunFrame(uint32_t frame);
+		void ResetStatistics();
+		void RunMicroBenchmarks();
+		bool WriteReport() const;
+
+		BenchmarkOptions mOptions;
+		CameraPath mCameraPath;
+		Camera mCamera;
+		JobSystem* mJobSystem = nullptr;
+
+		NullRhiDevice mRhiDevice;
+		std::unique_ptr<RhiResource> mObjectCBBuffer;
+		std::unique_ptr<RhiResource> mIndirectArgs;
+		std::unique_ptr<RhiResource> mGeometryBuffer;
+		std::unique_ptr<RhiDescriptorHeap> mMaterialHeap;
+		std::unique_ptr<RhiPipelineState> mPipelineState;
+		std::unique_ptr<RhiCommandSignature> mCommandSignature;
+		std::unique_ptr<RhiCommandList> mCommandList;
+
+		SceneStore mScene;
+		TransformHierarchy mTransforms;
+		std::vector<TransformNode> mClusters;
+		ObjectConstantUploader mObjectCBUploader;
+		// Mapped mObjectCBBuffer.
+		uint8_t* mObjectCB = nullptr;
+		uint32_t mObjectCBStride = 0;
+		FrustumCuller mCuller;
+		DrawList mDrawList;
+		IndirectDrawBuilder mIndirectDrawBuilder;
+
+		FrameStats mFrameStats;
+		FrameTimeSeries mPhases[Phase_Count];
+		uint64_t mVisibleSum = 0;
+		uint64_t mDrawSum = 0;
+		uint64_t mBatchSum = 0;
+		uint64_t mMeasuredFrames = 0;
+
+		// Name, median milliseconds.
+		std::vector<std::pair<std::string, float>> mMicroBenchmarks;
+
+		CompressionBenchmark mCompression;
+		PayloadBenchmark mPayload;
+		ConvertBenchmark mConvert;
+	};
+}
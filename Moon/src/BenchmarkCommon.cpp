@@ -0,0 +1,84 @@
+#include "mnpch.h"
+#include "BenchmarkCommon.h"
+
+#include <cmath>
+
+namespace Moon
+{
+	float MedianMS(std::vector<float> samples)
+	{
+		std::sort(samples.begin(), samples.end());
+		return samples[samples.size() / 2];
+	}
+
+	void FillBenchmarkImage(const DirectX::Image& image, std::mt19937& random)
+	{
+		for (size_t y = 0; y < image.height; ++y)
+		{
+			uint8_t* row = image.pixels + y * image.rowPitch;
+			for (size_t x = 0; x < image.width; ++x)
+			{
+				uint8_t* pixel = row + x * 4;
+				switch (x * 2 / image.width + (y * 2 / image.height) * 2)
+				{
+				case 0:
+					pixel[0] = (uint8_t)(x * 255 / (image.width - 1));
+					pixel[1] = (uint8_t)(y * 255 / (image.height - 1));
+					pixel[2] = (uint8_t)((x + y) * 255 / (image.width + image.height - 2));
+					break;
+				case 1:
+				{
+					const bool on = ((x / 3) + (y / 5)) & 1;
+					pixel[0] = on ? 200 : 30;
+					pixel[1] = on ? 40 : 180;
+					pixel[2] = on ? 90 : 250;
+					break;
+				}
+				case 2:
+					pixel[0] = (uint8_t)random();
+					pixel[1] = (uint8_t)random();
+					pixel[2] = (uint8_t)random();
+					break;
+				default:
+					pixel[0] = (uint8_t)(128.0 + 100.0 * sin(x * 0.3));
+					pixel[1] = (uint8_t)(128.0 + 100.0 * cos(y * 0.2));
+					pixel[2] = (uint8_t)(128.0 + 100.0 * sin((x + y) * 0.1));
+					break;
+				}
+
+				switch (x * 4 / image.width)
+				{
+				case 0: pixel[3] = 255; break;
+				case 1: pixel[3] = (uint8_t)(y * 255 / (image.height - 1)); break;
+				case 2: pixel[3] = ((x ^ y) & 8) ? 255 : 0; break;
+				default: pixel[3] = (uint8_t)random(); break;
+				}
+			}
+		}
+	}
+
+	double ComputeRMSE(const DirectX::Image& source, const DirectX::Image& compressed, uint32_t channels)
+	{
+		DirectX::ScratchImage decompressed;
+		if (FAILED(DirectX::Decompress(compressed, DXGI_FORMAT_R8G8B8A8_UNORM, decompressed)))
+			throw std::runtime_error("Could not decompress the compression benchmark image");
+
+		const DirectX::Image& result = *decompressed.GetImage(0, 0, 0);
+		double squaredError = 0.0;
+		for (size_t y = 0; y < source.height; ++y)
+		{
+			const uint8_t* a = source.pixels + y * source.rowPitch;
+			const uint8_t* b = result.pixels + y * result.rowPitch;
+			for (size_t x = 0; x < source.width; ++x)
+			{
+				for (size_t c = 0; c < channels; ++c)
+				{
+					const double diff = (double)a[x * 4 + c] - (double)b[x * 4 + c];
+					squaredError += diff * diff;
+				}
+			}
+		}
+
+		return sqrt(squaredError / (double)(source.width * source.height * channels));
+	}
+}
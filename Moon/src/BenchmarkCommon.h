@@ -0,0 +1,22 @@
+#pragma once
+#include "DirectXTex/DirectXTex.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace Moon
+{
+	// Timed runs of every micro benchmark, the median one is reported.
+	constexpr uint32_t BenchmarkRuns = 5;
+
+	float MedianMS(std::vector<float> samples);
+
+	// RGBA8, one quadrant each of smooth gradients, hard edges, noise and a sine pattern. Alpha is opaque,
+	// a ramp, a cut-out or noise along the other axis, so every content meets every kind of alpha.
+	void FillBenchmarkImage(const DirectX::Image& image, std::mt19937& random);
+
+	// Of a block compressed image against its RGBA8 source, over the first channels: the ones the format stores.
+	// Throws std::runtime_error when it can not be decompressed.
+	double ComputeRMSE(const DirectX::Image& source, const DirectX::Image& compressed, uint32_t channels);
+}
@@ -5,6 +5,12 @@ using namespace DirectX;
 
 namespace Moon
 {
+	namespace
+	{
+		// MK_LBUTTON of the mouse messages.
+		constexpr uintptr_t LeftButton = 0x0001;
+	}
+
 	Camera::Camera(float width, float height)
 		:mWidth(width), mHeight(height)
 	{
@@ -267,6 +273,14 @@ namespace Moon
 
 	void Camera::Update(float dt)
 	{
+		if (!mInputEnabled)
+		{
+			UpdateViewMatrix();
+			return;
+		}
+
+		// The Linux builds have no window to take keys from, their cameras are scripted.
+#ifdef _WIN32
 		float movementSpeed = mMovementSpeed;
 
 		if (GetAsyncKeyState(VK_LSHIFT) & 0x8000)
@@ -283,12 +297,18 @@ namespace Moon
 
 		if (GetAsyncKeyState('D') & 0x8000)
 			Strafe(movementSpeed * dt);
+#else
+		(void)dt;
+#endif
 
 		UpdateViewMatrix();
 	}
 
 	void Camera::OnEvent(Event& e)
 	{
+		if (!mInputEnabled)
+			return;
+
 		EventDispatcher dispatcher(e);
 		dispatcher.Dispatch<MouseButtonPressedEvent>(MN_BIND_EVENT_FN(Camera::OnMouseButtonPressedEvent));
 		dispatcher.Dispatch<MouseButtonReleasedEvent>(MN_BIND_EVENT_FN(Camera::OnMouseButtonReleasedEvent));
@@ -298,32 +318,32 @@ namespace Moon
 
 	bool Camera::OnMouseButtonPressedEvent(MouseButtonPressedEvent& e)
 	{
-		mLastMousePos.x = e.GetX();
-		mLastMousePos.y = e.GetY();
+		mLastMouseX = e.GetX();
+		mLastMouseY = e.GetY();
 		return false;
 	}
 
-	bool Camera::OnMouseButtonReleasedEvent(MouseButtonReleasedEvent& e)
+	bool Camera::OnMouseButtonReleasedEvent(MouseButtonReleasedEvent& /*e*/)
 	{
 		return false;
 	}
 
 	bool Camera::OnMouseMovedEvent(MouseMovedEvent& e)
 	{
-		if ((e.GetBtnState() & MK_LBUTTON) != 0)
+		if ((e.GetBtnState() & LeftButton) != 0)
 		{
-			float dx = DirectX::XMConvertToRadians(0.25f * static_cast<float>(e.GetX() - mLastMousePos.x));
-			float dy = DirectX::XMConvertToRadians(0.25f * static_cast<float>(e.GetY() - mLastMousePos.y));
+			float dx = DirectX::XMConvertToRadians(0.25f * static_cast<float>(e.GetX() - mLastMouseX));
+			float dy = DirectX::XMConvertToRadians(0.25f * static_cast<float>(e.GetY() - mLastMouseY));
 
 			Pitch(dy);
 			RotateY(dx);
 		}
-		mLastMousePos.x = static_cast<LONG>(e.GetX());
-		mLastMousePos.y = static_cast<LONG>(e.GetY());
+		mLastMouseX = e.GetX();
+		mLastMouseY = e.GetY();
 		return false;
 	}
 
-	bool Camera::OnMouseScrolledEvent(MouseScrolledEvent& e)
+	bool Camera::OnMouseScrolledEvent(MouseScrolledEvent& /*e*/)
 	{
 		return false;
 	}
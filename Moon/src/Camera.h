@@ -48,6 +48,8 @@ namespace Moon
 		void RotateY(float angle);
 		void UpdateViewMatrix();
 		void Update(float dt);
+		// Keyboard and mouse are ignored while disabled, for scripted cameras.
+		void SetInputEnabled(bool enabled) { mInputEnabled = enabled; }
 
 		void OnEvent(Event& e);
 
@@ -57,9 +59,11 @@ namespace Moon
 		bool OnMouseMovedEvent(MouseMovedEvent& e);
 		bool OnMouseScrolledEvent(MouseScrolledEvent& e);
 
-		POINT mLastMousePos;
+		int mLastMouseX = 0;
+		int mLastMouseY = 0;
 		float mMovementSpeed = 10.0f;
 		float dt = 0.0f;
+		bool mInputEnabled = true;
 
 	private:
 		DirectX::XMFLOAT3 mPosition = { 0.0f, 0.0f, 0.0f };
@@ -0,0 +1,117 @@
+#include "mnpch.h"
+#include "CameraPath.h"
+
+#include <fstream>
+
+using namespace DirectX;
+
+namespace Moon
+{
+	namespace
+	{
+		inline float CatmullRom(float p0, float p1, float p2, float p3, float t)
+		{
+			const float t2 = t * t;
+			const float t3 = t2 * t;
+			return 0.5f * ((2.0f * p1) + (-p0 + p2) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+		}
+
+		inline XMFLOAT3 CatmullRom(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2, const XMFLOAT3& p3, float t)
+		{
+			return XMFLOAT3(
+				CatmullRom(p0.x, p1.x, p2.x, p3.x, t),
+				CatmullRom(p0.y, p1.y, p2.y, p3.y, t),
+				CatmullRom(p0.z, p1.z, p2.z, p3.z, t));
+		}
+	}
+
+	bool CameraPath::LoadFromFile(const std::string& filename)
+	{
+		std::ifstream file(filename);
+		if (!file)
+			return false;
+
+		mKeyframes.clear();
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::istringstream stream(line);
+			CameraKeyframe keyframe;
+			if (stream >> keyframe.Time
+				>> keyframe.Position.x >> keyframe.Position.y >> keyframe.Position.z
+				>> keyframe.Target.x >> keyframe.Target.y >> keyframe.Target.z)
+			{
+				AddKeyframe(keyframe);
+			}
+		}
+		return !mKeyframes.empty();
+	}
+
+	CameraPath CameraPath::MakeDefault()
+	{
+		CameraPath path;
+		const float radius = 60.0f;
+		const float duration = 20.0f;
+		const int keyframeCount = 9;
+		for (int i = 0; i < keyframeCount; ++i)
+		{
+			const float t = (float)i / (keyframeCount - 1);
+			const float angle = t * XM_2PI;
+
+			CameraKeyframe keyframe;
+			keyframe.Time = t * duration;
+			keyframe.Position = XMFLOAT3(cosf(angle) * radius, 30.0f + 10.0f * sinf(2.0f * angle), sinf(angle) * radius);
+			keyframe.Target = XMFLOAT3(0.0f, 10.0f, 0.0f);
+			path.AddKeyframe(keyframe);
+		}
+		return path;
+	}
+
+	void CameraPath::AddKeyframe(const CameraKeyframe& keyframe)
+	{
+		auto it = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), keyframe.Time, [](float time, const CameraKeyframe& k)
+		{
+			return time < k.Time;
+		});
+		mKeyframes.insert(it, keyframe);
+	}
+
+	void CameraPath::Sample(float time, XMFLOAT3& position, XMFLOAT3& target) const
+	{
+		if (mKeyframes.empty())
+			return;
+
+		if (time <= mKeyframes.front().Time || mKeyframes.size() == 1)
+		{
+			position = mKeyframes.front().Position;
+			target = mKeyframes.front().Target;
+			return;
+		}
+		if (time >= mKeyframes.back().Time)
+		{
+			position = mKeyframes.back().Position;
+			target = mKeyframes.back().Target;
+			return;
+		}
+
+		auto it = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), time, [](float t, const CameraKeyframe& k)
+		{
+			return t < k.Time;
+		});
+		const size_t i2 = it - mKeyframes.begin();
+		const size_t i1 = i2 - 1;
+		const size_t i0 = i1 > 0 ? i1 - 1 : i1;
+		const size_t i3 = i2 + 1 < mKeyframes.size() ? i2 + 1 : i2;
+
+		const CameraKeyframe& k1 = mKeyframes[i1];
+		const CameraKeyframe& k2 = mKeyframes[i2];
+		const float span = k2.Time - k1.Time;
+		const float t = span > 0.0f ? (time - k1.Time) / span : 0.0f;
+
+		position = CatmullRom(mKeyframes[i0].Position, k1.Position, k2.Position, mKeyframes[i3].Position, t);
+		target = CatmullRom(mKeyframes[i0].Target, k1.Target, k2.Target, mKeyframes[i3].Target, t);
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <DirectXMath.h>
+
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	struct CameraKeyframe
+	{
+		float Time = 0.0f;// seconds
+		DirectX::XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };
+		DirectX::XMFLOAT3 Target = { 0.0f, 0.0f, 1.0f };
+	};
+
+	// Recorded camera motion for repeatable runs. Positions and targets follow a Catmull-Rom spline
+	// through the keyframes and hold the first/last keyframe outside of them.
+	class CameraPath
+	{
+	public:
+		// One keyframe per line: "time px py pz tx ty tz", lines starting with '#' are ignored.
+		bool LoadFromFile(const std::string& filename);
+		// A slow loop over the lost empire scene.
+		static CameraPath MakeDefault();
+
+		// Keeps the keyframes sorted by time.
+		void AddKeyframe(const CameraKeyframe& keyframe);
+
+		bool Empty() const { return mKeyframes.empty(); }
+		float GetDuration() const { return mKeyframes.empty() ? 0.0f : mKeyframes.back().Time; }
+		void Sample(float time, DirectX::XMFLOAT3& position, DirectX::XMFLOAT3& target) const;
+
+	private:
+		std::vector<CameraKeyframe> mKeyframes;
+	};
+}
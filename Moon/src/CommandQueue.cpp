@@ -3,8 +3,25 @@
 
 namespace Moon
 {
+    namespace
+    {
+        void ToResourceBarriers(const std::vector<ResourceTransition>& transitions, std::vector<D3D12_RESOURCE_BARRIER>& barriers)
+        {
+            barriers.clear();
+            for (const ResourceTransition& transition : transitions)
+            {
+                barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+                    static_cast<ID3D12Resource*>(const_cast<void*>(transition.Resource)),
+                    (D3D12_RESOURCE_STATES)transition.StateBefore,
+                    (D3D12_RESOURCE_STATES)transition.StateAfter,
+                    transition.Subresource));
+            }
+        }
+    }
+
     CommandQueue::CommandQueue(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE commandType)
     {
+        mDevice = device;
         mQueueType = commandType;
         mCommandQueue = NULL;
         mFence = NULL;
@@ -103,6 +120,70 @@ namespace Moon
         return mNextFenceValue++;
     }
 
+    uint64_t CommandQueue::ExecuteCommandList(ID3D12CommandList* commandList, ResourceStateTracker& stateTracker)
+    {
+        DX_CHECK(((ID3D12GraphicsCommandList*)commandList)->Close());
+
+        // Resolving and submitting must happen in the same order for the registry to stay right.
+        std::lock_guard<std::mutex> lockGuard(mFenceMutex);
+
+        mResolvedTransitions.clear();
+        stateTracker.Resolve(mResolvedTransitions);
+
+        if (mResolvedTransitions.empty())
+        {
+            mCommandQueue->ExecuteCommandLists(1, &commandList);
+        }
+        else
+        {
+            FixupCommandList& fixup = AcquireFixupCommandList();
+            ToResourceBarriers(mResolvedTransitions, mFixupBarriers);
+            fixup.List->ResourceBarrier((UINT)mFixupBarriers.size(), mFixupBarriers.data());
+            DX_CHECK(fixup.List->Close());
+            fixup.FenceValue = mNextFenceValue;
+
+            ID3D12CommandList* commandLists[] = { fixup.List.Get(), commandList };
+            mCommandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+        }
+
+        mCommandQueue->Signal(mFence, mNextFenceValue);
+
+        return mNextFenceValue++;
+    }
+
+    CommandQueue::FixupCommandList& CommandQueue::AcquireFixupCommandList()
+    {
+        for (FixupCommandList& fixup : mFixupCommandLists)
+        {
+            if (IsFenceComplete(fixup.FenceValue))
+            {
+                DX_CHECK(fixup.Allocator->Reset());
+                DX_CHECK(fixup.List->Reset(fixup.Allocator.Get(), nullptr));
+                return fixup;
+            }
+        }
+
+        FixupCommandList fixup;
+        DX_CHECK(mDevice->CreateCommandAllocator(mQueueType, IID_PPV_ARGS(fixup.Allocator.GetAddressOf())));
+        DX_CHECK(mDevice->CreateCommandList(0, mQueueType, fixup.Allocator.Get(), nullptr, IID_PPV_ARGS(fixup.List.GetAddressOf())));
+        mFixupCommandLists.push_back(fixup);
+        return mFixupCommandLists.back();
+    }
+
+    void FlushResourceBarriers(ID3D12GraphicsCommandList* commandList, ResourceStateTracker& stateTracker)
+    {
+        if (!stateTracker.HasPendingBarriers())
+            return;
+
+        thread_local std::vector<ResourceTransition> transitions;
+        thread_local std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        transitions.clear();
+        stateTracker.FlushBarriers(transitions);
+        ToResourceBarriers(transitions, barriers);
+        if (!barriers.empty())
+            commandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+    }
+
     CommandQueueManager::CommandQueueManager(ID3D12Device* device)
     {
         mGraphicsQueue = new CommandQueue(device, D3D12_COMMAND_LIST_TYPE_DIRECT);
@@ -1,4 +1,6 @@
+#pragma once
 #include "dx_utils.h"
+#include "ResourceStateTracker.h"
 #include <mutex>
 
 namespace Moon
@@ -25,8 +27,21 @@ namespace Moon
         ID3D12Fence* GetFence() { return mFence; }
 
         uint64_t ExecuteCommandList(ID3D12CommandList* List);
+        // Resolves the states the list expects against the global registry. The transitions it needs
+        // run first, from a small list submitted in the same ExecuteCommandLists call.
+        uint64_t ExecuteCommandList(ID3D12CommandList* List, ResourceStateTracker& stateTracker);
 
     private:
+        struct FixupCommandList
+        {
+            Microsoft::WRL::ComPtr<ID3D12CommandAllocator> Allocator;
+            Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> List;
+            uint64_t FenceValue = 0;
+        };
+
+        FixupCommandList& AcquireFixupCommandList();
+
+        ID3D12Device* mDevice;
         ID3D12CommandQueue* mCommandQueue;
         D3D12_COMMAND_LIST_TYPE mQueueType;
 
@@ -37,8 +52,15 @@ namespace Moon
         uint64_t mNextFenceValue;
         uint64_t mLastCompletedFenceValue;
         HANDLE mFenceEventHandle;
+
+        std::vector<FixupCommandList> mFixupCommandLists;
+        std::vector<ResourceTransition> mResolvedTransitions;
+        std::vector<D3D12_RESOURCE_BARRIER> mFixupBarriers;
     };
 
+    // Records the barriers queued by Require() calls in a single ResourceBarrier call.
+    void FlushResourceBarriers(ID3D12GraphicsCommandList* commandList, ResourceStateTracker& stateTracker);
+
     class CommandQueueManager
     {
     public:
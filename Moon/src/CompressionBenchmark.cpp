@@ -0,0 +1,117 @@
+#include "mnpch.h"
+#include "CompressionBenchmark.h"
+#include "BenchmarkCommon.h"
+#include "CpuProfiler.h"
+#include "Utils.h"
+
+#include <cmath>
+
+namespace Moon
+{
+	namespace
+	{
+		// Side of the benchmark image, 1024 blocks keep the reference BC7 encoder to a few seconds.
+		constexpr uint32_t ImageSize = 128;
+		// Single threaded throughput the TEX_COMPRESS_BC_FAST encoders are expected to reach, conversion to float included.
+		constexpr double BCFastTargetMPixelsPerSecond = 25.0;
+
+		struct CompressionCase
+		{
+			const char* Format;
+			DXGI_FORMAT DxgiFormat;
+			// Channels the format stores, counted from red.
+			uint32_t Channels;
+			const char* Encoder;
+			DirectX::TEX_COMPRESS_FLAGS Flags;
+		};
+
+		// Grouped by format, the reference encoder first.
+		const CompressionCase CompressionCases[] =
+		{
+			{ "bc1", DXGI_FORMAT_BC1_UNORM, 3, "reference", DirectX::TEX_COMPRESS_DEFAULT },
+			{ "bc1", DXGI_FORMAT_BC1_UNORM, 3, "reference_uniform", DirectX::TEX_COMPRESS_UNIFORM },
+			{ "bc1", DXGI_FORMAT_BC1_UNORM, 3, "bc_fast", DirectX::TEX_COMPRESS_BC_FAST },
+			{ "bc1", DXGI_FORMAT_BC1_UNORM, 3, "bc_fast_refine", DirectX::TEX_COMPRESS_BC_FAST | DirectX::TEX_COMPRESS_BC_FAST_REFINE },
+			{ "bc3", DXGI_FORMAT_BC3_UNORM, 4, "reference", DirectX::TEX_COMPRESS_DEFAULT },
+			{ "bc3", DXGI_FORMAT_BC3_UNORM, 4, "bc_fast", DirectX::TEX_COMPRESS_BC_FAST },
+			{ "bc3", DXGI_FORMAT_BC3_UNORM, 4, "bc_fast_refine", DirectX::TEX_COMPRESS_BC_FAST | DirectX::TEX_COMPRESS_BC_FAST_REFINE },
+			{ "bc4", DXGI_FORMAT_BC4_UNORM, 1, "reference", DirectX::TEX_COMPRESS_DEFAULT },
+			{ "bc4", DXGI_FORMAT_BC4_UNORM, 1, "bc_fast", DirectX::TEX_COMPRESS_BC_FAST },
+			{ "bc4", DXGI_FORMAT_BC4_UNORM, 1, "bc_fast_refine", DirectX::TEX_COMPRESS_BC_FAST | DirectX::TEX_COMPRESS_BC_FAST_REFINE },
+			{ "bc5", DXGI_FORMAT_BC5_UNORM, 2, "reference", DirectX::TEX_COMPRESS_DEFAULT },
+			{ "bc5", DXGI_FORMAT_BC5_UNORM, 2, "bc_fast", DirectX::TEX_COMPRESS_BC_FAST },
+			{ "bc5", DXGI_FORMAT_BC5_UNORM, 2, "bc_fast_refine", DirectX::TEX_COMPRESS_BC_FAST | DirectX::TEX_COMPRESS_BC_FAST_REFINE },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, 4, "reference", DirectX::TEX_COMPRESS_DEFAULT },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, 4, "reference_quick", DirectX::TEX_COMPRESS_BC7_QUICK },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, 4, "ultrafast", DirectX::TEX_COMPRESS_BC7_ULTRAFAST },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, 4, "fast", DirectX::TEX_COMPRESS_BC7_FAST },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, 4, "basic", DirectX::TEX_COMPRESS_BC7_BASIC },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, 4, "slow", DirectX::TEX_COMPRESS_BC7_SLOW },
+		};
+	}
+
+	void CompressionBenchmark::Run()
+	{
+		DirectX::ScratchImage source;
+		if (FAILED(source.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, ImageSize, ImageSize, 1, 1)))
+			throw std::runtime_error("Could not allocate the compression benchmark image");
+
+		const DirectX::Image& image = *source.GetImage(0, 0, 0);
+		std::mt19937 random(5678);
+		FillBenchmarkImage(image, random);
+
+		std::vector<float> runs(BenchmarkRuns);
+		for (const CompressionCase& test : CompressionCases)
+		{
+			DirectX::ScratchImage compressed;
+			for (float& run : runs)
+			{
+				const uint64_t begin = CpuProfiler::Now();
+				if (FAILED(DirectX::Compress(image, test.DxgiFormat, test.Flags, DirectX::TEX_THRESHOLD_DEFAULT, compressed)))
+					throw std::runtime_error(std::string(test.Format) + " compression failed with the " + test.Encoder + " encoder");
+				run = ElapsedMS(begin, CpuProfiler::Now());
+			}
+
+			Result result;
+			result.Format = test.Format;
+			result.Encoder = test.Encoder;
+			result.MS = MedianMS(runs);
+			result.RMSE = ComputeRMSE(image, *compressed.GetImage(0, 0, 0), test.Channels);
+			result.Fast = (test.Flags & DirectX::TEX_COMPRESS_BC_FAST) != 0;
+			mResults.push_back(result);
+		}
+	}
+
+	void CompressionBenchmark::WriteJSON(std::ostream& out) const
+	{
+		const double pixels = (double)ImageSize * ImageSize;
+		out << "{\"size\":" << ImageSize
+			<< ",\"bc_fast_target_mpixels_per_s\":" << BCFastTargetMPixelsPerSecond << ",\"formats\":{";
+		for (size_t i = 0; i < mResults.size(); ++i)
+		{
+			const Result& result = mResults[i];
+			const bool firstOfFormat = i == 0 || mResults[i - 1].Format != result.Format;
+			if (firstOfFormat)
+			{
+				out << (i ? "}," : "");
+				WriteJSONString(out, result.Format);
+				out << ":{";
+			}
+			else
+			{
+				out << ",";
+			}
+
+			const double mpixelsPerSecond = result.MS > 0.0f ? pixels / (result.MS * 1000.0) : 0.0;
+			WriteJSONString(out, result.Encoder);
+			out << ":{\"ms\":" << result.MS
+				<< ",\"mpixels_per_s\":" << mpixelsPerSecond
+				<< ",\"rmse\":" << result.RMSE
+				<< ",\"psnr_db\":" << (result.RMSE > 0.0 ? 20.0 * log10(255.0 / result.RMSE) : 99.0);
+			if (result.Fast)
+				out << ",\"meets_target\":" << (mpixelsPerSecond >= BCFastTargetMPixelsPerSecond ? "true" : "false");
+			out << "}";
+		}
+		out << (mResults.empty() ? "" : "}") << "}}";
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	// Every BC encoder of every format on the same image, single threaded, compared on speed and quality.
+	class CompressionBenchmark
+	{
+	public:
+		// Throws std::runtime_error when an encoder fails.
+		void Run();
+		// {"size":...,"bc_fast_target_mpixels_per_s":...,"formats":{"<format>":{"<encoder>":{...}}}}
+		void WriteJSON(std::ostream& out) const;
+
+	private:
+		struct Result
+		{
+			std::string Format;
+			std::string Encoder;
+			float MS = 0.0f;
+			double RMSE = 0.0;
+			// TEX_COMPRESS_BC_FAST, checked against the throughput target.
+			bool Fast = false;
+		};
+		// Grouped by format.
+		std::vector<Result> mResults;
+	};
+}
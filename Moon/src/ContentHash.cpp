@@ -0,0 +1,182 @@
+#include "mnpch.h"
+#include "ContentHash.h"
+
+#include <cstring>
+
+namespace Moon
+{
+	namespace
+	{
+		constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+		constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+		constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+		constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+		uint64_t Rotl(uint64_t x, int r)
+		{
+			return (x << r) | (x >> (64 - r));
+		}
+
+		uint64_t Read64(const uint8_t* p)
+		{
+			uint64_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint32_t Read32(const uint8_t* p)
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint64_t Round(uint64_t lane, uint64_t input)
+		{
+			lane += input * Prime2;
+			lane = Rotl(lane, 31);
+			return lane * Prime1;
+		}
+
+		uint64_t MergeRound(uint64_t hash, uint64_t lane)
+		{
+			hash ^= Round(0, lane);
+			return hash * Prime1 + Prime4;
+		}
+
+		// Full 32 byte stripes from p, returns the bytes it consumed.
+		size_t ConsumeStripes(uint64_t lanes[4], const uint8_t* p, size_t size)
+		{
+			const uint8_t* const begin = p;
+			for (; size >= 32; size -= 32, p += 32)
+			{
+				lanes[0] = Round(lanes[0], Read64(p));
+				lanes[1] = Round(lanes[1], Read64(p + 8));
+				lanes[2] = Round(lanes[2], Read64(p + 16));
+				lanes[3] = Round(lanes[3], Read64(p + 24));
+			}
+			return (size_t)(p - begin);
+		}
+	}
+
+	ContentHasher::ContentHasher(uint64_t seed)
+		: mSeed(seed)
+	{
+		mLanes[0] = seed + Prime1 + Prime2;
+		mLanes[1] = seed + Prime2;
+		mLanes[2] = seed;
+		mLanes[3] = seed - Prime1;
+	}
+
+	void ContentHasher::Update(const void* data, size_t size)
+	{
+		const uint8_t* p = (const uint8_t*)data;
+		mTotalSize += size;
+
+		if (mBufferSize > 0)
+		{
+			const size_t fill = std::min(size, sizeof(mBuffer) - mBufferSize);
+			memcpy(mBuffer + mBufferSize, p, fill);
+			mBufferSize += fill;
+			p += fill;
+			size -= fill;
+			if (mBufferSize < sizeof(mBuffer))
+				return;
+			ConsumeStripes(mLanes, mBuffer, sizeof(mBuffer));
+			mBufferSize = 0;
+		}
+
+		const size_t consumed = ConsumeStripes(mLanes, p, size);
+		memcpy(mBuffer, p + consumed, size - consumed);
+		mBufferSize = size - consumed;
+	}
+
+	void ContentHasher::Update(const std::string& str)
+	{
+		Update((uint64_t)str.size());
+		Update(str.data(), str.size());
+	}
+
+	uint64_t ContentHasher::Finish() const
+	{
+		uint64_t hash;
+		if (mTotalSize >= 32)
+		{
+			hash = Rotl(mLanes[0], 1) + Rotl(mLanes[1], 7) + Rotl(mLanes[2], 12) + Rotl(mLanes[3], 18);
+			for (uint64_t lane : mLanes)
+				hash = MergeRound(hash, lane);
+		}
+		else
+		{
+			hash = mSeed + Prime5;
+		}
+		hash += mTotalSize;
+
+		const uint8_t* p = mBuffer;
+		size_t size = mBufferSize;
+		for (; size >= 8; size -= 8, p += 8)
+		{
+			hash ^= Round(0, Read64(p));
+			hash = Rotl(hash, 27) * Prime1 + Prime4;
+		}
+		if (size >= 4)
+		{
+			hash ^= Read32(p) * Prime1;
+			hash = Rotl(hash, 23) * Prime2 + Prime3;
+			size -= 4;
+			p += 4;
+		}
+		for (; size > 0; --size, ++p)
+		{
+			hash ^= *p * Prime5;
+			hash = Rotl(hash, 11) * Prime1;
+		}
+
+		hash ^= hash >> 33;
+		hash *= Prime2;
+		hash ^= hash >> 29;
+		hash *= Prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	uint64_t HashContent(const void* data, size_t size, uint64_t seed)
+	{
+		ContentHasher hasher(seed);
+		hasher.Update(data, size);
+		return hasher.Finish();
+	}
+
+	std::string FormatContentHash(uint64_t hash)
+	{
+		static const char Digits[] = "0123456789abcdef";
+		std::string str(16, '0');
+		for (int i = 15; i >= 0; --i, hash >>= 4)
+			str[i] = Digits[hash & 15];
+		return str;
+	}
+
+	bool ParseContentHash(const std::string& str, uint64_t& hash)
+	{
+		if (str.size() != 16)
+			return false;
+
+		uint64_t value = 0;
+		for (char c : str)
+		{
+			uint32_t digit;
+			if (c >= '0' && c <= '9')
+				digit = c - '0';
+			else if (c >= 'a' && c <= 'f')
+				digit = c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				digit = c - 'A' + 10;
+			else
+				return false;
+			value = (value << 4) | digit;
+		}
+		hash = value;
+		return true;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Moon
+{
+	// 64-bit hash to tell changed content apart, not a cryptographic one: XXH64, which reads 32 bytes a round in four lanes.
+	// Feeding the same bytes in any number of Update() calls gives the same hash as HashContent() on all of them.
+	class ContentHasher
+	{
+	public:
+		explicit ContentHasher(uint64_t seed = 0);
+
+		void Update(const void* data, size_t size);
+		// The length goes first, so that two strings never hash like their concatenation.
+		void Update(const std::string& str);
+		void Update(uint64_t value) { Update(&value, sizeof(value)); }
+		// Does not reset the hasher, more bytes can follow.
+		uint64_t Finish() const;
+
+	private:
+		uint64_t mSeed;
+		uint64_t mLanes[4];
+		uint8_t mBuffer[32];
+		size_t mBufferSize = 0;
+		uint64_t mTotalSize = 0;
+	};
+
+	uint64_t HashContent(const void* data, size_t size, uint64_t seed = 0);
+	// 16 lower case hex digits.
+	std::string FormatContentHash(uint64_t hash);
+	// Returns false unless str is 16 hex digits.
+	bool ParseContentHash(const std::string& str, uint64_t& hash);
+}
@@ -0,0 +1,146 @@
+#include "mnpch.h"
+#include "ConvertBenchmark.h"
+#include "BenchmarkCommon.h"
+#include "CpuProfiler.h"
+#include "Utils.h"
+// The scanline functions of the generic conversion path, the baseline of the fast paths.
+#include "DirectXTex/DirectXTexP.h"
+
+#include <cstring>
+
+namespace Moon
+{
+	namespace
+	{
+		// Side of the benchmark image, large enough for the tables of the half float sources to pay off.
+		constexpr uint32_t ImageSize = 1024;
+
+		struct ConvertCase
+		{
+			const char* Name;
+			DXGI_FORMAT Source;
+			DXGI_FORMAT Target;
+		};
+
+		// Pairs DirectX::Convert() has a fast path for.
+		const ConvertCase ConvertCases[] =
+		{
+			{ "rgba8_to_bgra8", DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM },
+			{ "bgra8_to_rgba8", DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM },
+			{ "rgba8_srgb_to_linear", DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM },
+			{ "rgba8_linear_to_srgb", DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB },
+			{ "rgba8_to_rgba16f", DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT },
+			{ "rgba16f_to_rgba8", DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R8G8B8A8_UNORM },
+			{ "rgba8_to_rgba32f", DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R32G32B32A32_FLOAT },
+			{ "rgba32f_to_rgba8", DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R8G8B8A8_UNORM },
+			{ "rgb10a2_to_rgba16f", DXGI_FORMAT_R10G10B10A2_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT },
+			{ "rgba16f_to_rgb10a2", DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R10G10B10A2_UNORM },
+		};
+
+		// The generic path of DirectX::Convert() without dithering, one scanline of XMVECTOR at a time.
+		void ConvertScanlines(const DirectX::Image& source, const DirectX::Image& target)
+		{
+			auto scanline = DirectX::make_AlignedArrayXMVECTOR(source.width);
+			if (!scanline)
+				throw std::runtime_error("Could not allocate the conversion scanline");
+
+			for (size_t y = 0; y < source.height; ++y)
+			{
+				if (!DirectX::_LoadScanline(scanline.get(), source.width, source.pixels + y * source.rowPitch, source.rowPitch, source.format))
+					throw std::runtime_error("Scanline load failed");
+				DirectX::_ConvertScanline(scanline.get(), source.width, target.format, source.format, DirectX::TEX_FILTER_DEFAULT);
+				if (!DirectX::_StoreScanline(target.pixels + y * target.rowPitch, target.rowPitch, target.format, scanline.get(), source.width, DirectX::TEX_THRESHOLD_DEFAULT))
+					throw std::runtime_error("Scanline store failed");
+			}
+		}
+
+		bool SamePixels(const DirectX::Image& a, const DirectX::Image& b)
+		{
+			const size_t rowBytes = a.width * DirectX::BitsPerPixel(a.format) / 8;
+			for (size_t y = 0; y < a.height; ++y)
+			{
+				if (memcmp(a.pixels + y * a.rowPitch, b.pixels + y * b.rowPitch, rowBytes) != 0)
+					return false;
+			}
+			return true;
+		}
+	}
+
+	void ConvertBenchmark::Run()
+	{
+		DirectX::ScratchImage rgba8;
+		if (FAILED(rgba8.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, ImageSize, ImageSize, 1, 1)))
+			throw std::runtime_error("Could not allocate the conversion benchmark image");
+
+		std::mt19937 random(9012);
+		FillBenchmarkImage(*rgba8.GetImage(0, 0, 0), random);
+
+		std::vector<float> runs(BenchmarkRuns);
+		for (const ConvertCase& test : ConvertCases)
+		{
+			// Sources in other formats are converted from the RGBA8 image.
+			DirectX::ScratchImage converted;
+			const DirectX::Image* source = rgba8.GetImage(0, 0, 0);
+			if (test.Source != source->format)
+			{
+				if (FAILED(DirectX::Convert(*source, test.Source, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, converted)))
+					throw std::runtime_error(std::string("Could not make the source of ") + test.Name);
+				source = converted.GetImage(0, 0, 0);
+			}
+
+			// Target allocation timed on both sides, DirectX::Convert() does it.
+			DirectX::ScratchImage reference;
+			for (float& run : runs)
+			{
+				const uint64_t begin = CpuProfiler::Now();
+				if (FAILED(reference.Initialize2D(test.Target, ImageSize, ImageSize, 1, 1)))
+					throw std::runtime_error("Could not allocate the conversion benchmark target");
+				ConvertScanlines(*source, *reference.GetImage(0, 0, 0));
+				run = ElapsedMS(begin, CpuProfiler::Now());
+			}
+
+			Result result;
+			result.Name = test.Name;
+			result.ScanlineMS = MedianMS(runs);
+			result.BitExact = true;
+			for (DirectX::TEX_FILTER_FLAGS flags : { DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_FILTER_PARALLEL })
+			{
+				DirectX::ScratchImage target;
+				for (float& run : runs)
+				{
+					const uint64_t begin = CpuProfiler::Now();
+					if (FAILED(DirectX::Convert(*source, test.Target, flags, DirectX::TEX_THRESHOLD_DEFAULT, target)))
+						throw std::runtime_error(std::string("Conversion failed: ") + test.Name);
+					run = ElapsedMS(begin, CpuProfiler::Now());
+				}
+
+				if (flags & DirectX::TEX_FILTER_PARALLEL)
+					result.ParallelMS = MedianMS(runs);
+				else
+					result.FastMS = MedianMS(runs);
+				result.BitExact = result.BitExact && SamePixels(*reference.GetImage(0, 0, 0), *target.GetImage(0, 0, 0));
+			}
+			mResults.push_back(result);
+		}
+	}
+
+	void ConvertBenchmark::WriteJSON(std::ostream& out) const
+	{
+		const double pixels = (double)ImageSize * ImageSize;
+		out << "{\"size\":" << ImageSize << ",\"pairs\":{";
+		for (size_t i = 0; i < mResults.size(); ++i)
+		{
+			const Result& result = mResults[i];
+			out << (i ? "," : "");
+			WriteJSONString(out, result.Name);
+			out << ":{\"scanline_ms\":" << result.ScanlineMS
+				<< ",\"fast_ms\":" << result.FastMS
+				<< ",\"parallel_ms\":" << result.ParallelMS
+				<< ",\"fast_mpixels_per_s\":" << (result.FastMS > 0.0f ? pixels / (result.FastMS * 1000.0) : 0.0)
+				<< ",\"speedup\":" << (result.FastMS > 0.0f ? result.ScanlineMS / result.FastMS : 0.0f)
+				<< ",\"parallel_speedup\":" << (result.ParallelMS > 0.0f ? result.ScanlineMS / result.ParallelMS : 0.0f)
+				<< ",\"bit_exact\":" << (result.BitExact ? "true" : "false") << "}";
+		}
+		out << "}}";
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	// The format conversion fast paths of DirectX::Convert() against the generic scanline path they replace.
+	class ConvertBenchmark
+	{
+	public:
+		// Throws std::runtime_error when a conversion fails.
+		void Run();
+		// {"size":...,"pairs":{"<pair>":{...}}}, speedups are over the scanline path.
+		void WriteJSON(std::ostream& out) const;
+
+	private:
+		struct Result
+		{
+			std::string Name;
+			// Generic path of DirectX::Convert(), a scanline at a time.
+			float ScanlineMS = 0.0f;
+			float FastMS = 0.0f;
+			// TEX_FILTER_PARALLEL.
+			float ParallelMS = 0.0f;
+			// Both fast path runs wrote the pixels of the scanline path.
+			bool BitExact = false;
+		};
+		// Every format pair with a fast path, on the same image.
+		std::vector<Result> mResults;
+	};
+}
@@ -0,0 +1,199 @@
+#include "mnpch.h"
+#include "CpuProfiler.h"
+#include "Utils.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace Moon
+{
+	namespace
+	{
+		thread_local uint32_t tZoneDepth = 0;
+	}
+
+	CpuProfiler& CpuProfiler::Get()
+	{
+		static CpuProfiler profiler;
+		return profiler;
+	}
+
+	uint64_t CpuProfiler::Now()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	CpuProfiler::ThreadBuffer* CpuProfiler::GetThreadBuffer()
+	{
+		thread_local ThreadBuffer* tBuffer = nullptr;
+		if (!tBuffer)
+		{
+			// Buffers are never freed, readers may still walk the ring of a thread that exited.
+			std::lock_guard<std::mutex> lock(mThreadsMutex);
+			mThreads.push_back(std::make_unique<ThreadBuffer>());
+			tBuffer = mThreads.back().get();
+			tBuffer->Index = (uint32_t)mThreads.size() - 1;
+			tBuffer->Name = "Thread " + std::to_string(tBuffer->Index);
+		}
+		return tBuffer;
+	}
+
+	void CpuProfiler::SetThreadName(const char* name)
+	{
+		ThreadBuffer* buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(mThreadsMutex);
+		buffer->Name = name;
+	}
+
+	void CpuProfiler::RecordZone(const char* name, uint32_t depth, uint64_t begin, uint64_t end)
+	{
+		ThreadBuffer* buffer = GetThreadBuffer();
+
+		// Single writer per ring, the index is only published once the zone is complete.
+		const uint64_t index = buffer->WriteIndex.load(std::memory_order_relaxed);
+		CpuProfileZone& zone = buffer->Zones[index & (ThreadBuffer::Capacity - 1)];
+		strncpy(zone.Name, name, sizeof(zone.Name) - 1);
+		zone.Name[sizeof(zone.Name) - 1] = '\0';
+		zone.Depth = depth;
+		zone.Begin = begin;
+		zone.End = end;
+		buffer->WriteIndex.store(index + 1, std::memory_order_release);
+	}
+
+	void CpuProfiler::CopyZones(const ThreadBuffer& buffer, uint64_t since, std::vector<CpuProfileZone>& zones) const
+	{
+		const size_t firstCopied = zones.size();
+		const uint64_t end = buffer.WriteIndex.load(std::memory_order_acquire);
+		const uint64_t first = end > ThreadBuffer::Capacity ? end - ThreadBuffer::Capacity : 0;
+
+		// Zones are pushed when they close, so end times only grow along the ring.
+		uint64_t index = end;
+		while (index > first)
+		{
+			const CpuProfileZone& zone = buffer.Zones[(index - 1) & (ThreadBuffer::Capacity - 1)];
+			if (zone.End < since)
+				break;
+			zones.push_back(zone);
+			--index;
+		}
+
+		// The writer kept going while we copied, drop what it may have overwritten.
+		const uint64_t writeIndex = buffer.WriteIndex.load(std::memory_order_acquire);
+		const uint64_t firstValid = writeIndex >= ThreadBuffer::Capacity ? writeIndex - ThreadBuffer::Capacity + 1 : 0;
+		if (index < firstValid)
+			zones.resize(zones.size() - (size_t)(firstValid - index));
+
+		std::reverse(zones.begin() + firstCopied, zones.end());
+	}
+
+	void CpuProfiler::BeginFrame()
+	{
+		const uint64_t now = Now();
+		const uint64_t frameBegin = mFrameBegin;
+		mFrameBegin = now;
+		if (mFrozen)
+			return;
+
+		mLastFrameBegin = frameBegin;
+		mLastFrameEnd = now;
+
+		std::lock_guard<std::mutex> lock(mThreadsMutex);
+		mLastFrame.resize(mThreads.size());
+		for (size_t t = 0; t < mThreads.size(); ++t)
+		{
+			CpuProfileThreadZones& threadZones = mLastFrame[t];
+			threadZones.ThreadIndex = mThreads[t]->Index;
+			threadZones.ThreadName = mThreads[t]->Name;
+			threadZones.Zones.clear();
+			if (mLastFrameBegin == 0)
+				continue;
+
+			CopyZones(*mThreads[t], mLastFrameBegin, threadZones.Zones);
+			threadZones.Zones.erase(std::remove_if(threadZones.Zones.begin(), threadZones.Zones.end(), [this](const CpuProfileZone& zone)
+			{
+				return zone.Begin < mLastFrameBegin || zone.End > mLastFrameEnd;
+			}), threadZones.Zones.end());
+
+			// Parents close after their children, put them back in front.
+			std::sort(threadZones.Zones.begin(), threadZones.Zones.end(), [](const CpuProfileZone& a, const CpuProfileZone& b)
+			{
+				return a.Begin != b.Begin ? a.Begin < b.Begin : a.Depth < b.Depth;
+			});
+		}
+	}
+
+	bool CpuProfiler::ExportChromeTrace(const std::string& filename)
+	{
+		std::ofstream out(filename, std::ios::out | std::ios::trunc);
+		if (!out)
+			return false;
+
+		std::vector<CpuProfileZone> zones;
+		std::vector<std::pair<uint32_t, std::string>> threads;
+		std::vector<size_t> threadZoneEnds;
+		{
+			std::lock_guard<std::mutex> lock(mThreadsMutex);
+			for (const auto& buffer : mThreads)
+			{
+				CopyZones(*buffer, 0, zones);
+				threads.emplace_back(buffer->Index, buffer->Name);
+				threadZoneEnds.push_back(zones.size());
+			}
+		}
+
+		uint64_t base = UINT64_MAX;
+		for (const CpuProfileZone& zone : zones)
+			base = std::min(base, zone.Begin);
+
+		out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+		bool first = true;
+		size_t zoneIndex = 0;
+		for (size_t t = 0; t < threads.size(); ++t)
+		{
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threads[t].first << ",\"args\":{\"name\":";
+			WriteJSONString(out, threads[t].second);
+			out << "}}";
+			first = false;
+
+			for (; zoneIndex < threadZoneEnds[t]; ++zoneIndex)
+			{
+				const CpuProfileZone& zone = zones[zoneIndex];
+				out << ",\n{\"name\":";
+				WriteJSONString(out, zone.Name);
+				// Microseconds, the fractional part keeps the nanoseconds.
+				out << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threads[t].first
+					<< ",\"ts\":" << (zone.Begin - base) / 1000 << '.' << std::setw(3) << std::setfill('0') << (zone.Begin - base) % 1000
+					<< ",\"dur\":" << (zone.End - zone.Begin) / 1000 << '.' << std::setw(3) << std::setfill('0') << (zone.End - zone.Begin) % 1000
+					<< "}";
+			}
+		}
+		out << "\n]}\n";
+
+		return (bool)out;
+	}
+
+	ScopedCpuZone::ScopedCpuZone(const char* name)
+		: mName(name)
+		, mBegin(0)
+		, mRecording(CpuProfiler::Get().IsEnabled())
+	{
+		if (mRecording)
+		{
+			tZoneDepth++;
+			mBegin = CpuProfiler::Now();
+		}
+	}
+
+	ScopedCpuZone::~ScopedCpuZone()
+	{
+		if (mRecording)
+		{
+			const uint64_t end = CpuProfiler::Now();
+			tZoneDepth--;
+			CpuProfiler::Get().RecordZone(mName, tZoneDepth, mBegin, end);
+		}
+	}
+}
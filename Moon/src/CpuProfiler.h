@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	struct CpuProfileZone
+	{
+		// Copied when the zone closes, the name only has to live until then.
+		char Name[44];
+		uint32_t Depth;
+		uint64_t Begin;// ns
+		uint64_t End;// ns
+	};
+	static_assert(sizeof(CpuProfileZone) == 64, "One zone per cache line");
+
+	struct CpuProfileThreadZones
+	{
+		uint32_t ThreadIndex = 0;
+		std::string ThreadName;
+		std::vector<CpuProfileZone> Zones;
+	};
+
+	// Every thread records its zones in its own ring buffer: recording never locks nor allocates
+	// and the oldest zones are overwritten. Readers copy from the rings without stopping the writers.
+	class CpuProfiler
+	{
+	public:
+		static CpuProfiler& Get();
+		static uint64_t Now();
+
+		void SetEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+		bool IsEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+		// Names the calling thread in the flame view and the trace.
+		void SetThreadName(const char* name);
+
+		// Closes the previous frame, its zones become available through GetLastFrame().
+		void BeginFrame();
+		// Keeps the last frame as it is, recording goes on.
+		void SetFrozen(bool frozen) { mFrozen = frozen; }
+		bool IsFrozen() const { return mFrozen; }
+		uint64_t GetLastFrameBegin() const { return mLastFrameBegin; }
+		uint64_t GetLastFrameEnd() const { return mLastFrameEnd; }
+		// One entry per thread that recorded something, zones sorted by begin time.
+		const std::vector<CpuProfileThreadZones>& GetLastFrame() const { return mLastFrame; }
+
+		// Writes every zone still in the rings in the Chrome trace event format (chrome://tracing, Perfetto).
+		bool ExportChromeTrace(const std::string& filename);
+
+		void RecordZone(const char* name, uint32_t depth, uint64_t begin, uint64_t end);
+
+	private:
+		struct ThreadBuffer
+		{
+			static constexpr uint32_t Capacity = 1 << 14;
+
+			CpuProfileZone Zones[Capacity];
+			std::atomic<uint64_t> WriteIndex{ 0 };
+			uint32_t Index = 0;
+			std::string Name;
+		};
+
+		CpuProfiler() = default;
+
+		ThreadBuffer* GetThreadBuffer();
+		// Copies the zones of a ring that ended at or after since, oldest first.
+		void CopyZones(const ThreadBuffer& buffer, uint64_t since, std::vector<CpuProfileZone>& zones) const;
+
+		std::atomic<bool> mEnabled{ true };
+
+		// Only taken the first time a thread records a zone, and by readers.
+		std::mutex mThreadsMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> mThreads;
+
+		bool mFrozen = false;
+		uint64_t mFrameBegin = 0;
+		uint64_t mLastFrameBegin = 0;
+		uint64_t mLastFrameEnd = 0;
+		std::vector<CpuProfileThreadZones> mLastFrame;
+	};
+
+	class ScopedCpuZone
+	{
+	public:
+		ScopedCpuZone(const char* name);
+		~ScopedCpuZone();
+
+		ScopedCpuZone(const ScopedCpuZone& rhs) = delete;
+		ScopedCpuZone& operator=(const ScopedCpuZone& rhs) = delete;
+
+	private:
+		const char* mName;
+		uint64_t mBegin;
+		bool mRecording;
+	};
+}
+
+#define MN_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MN_PROFILE_CONCAT(a, b) MN_PROFILE_CONCAT_IMPL(a, b)
+
+#define PROFILE_ZONE(name) ::Moon::ScopedCpuZone MN_PROFILE_CONCAT(scopedCpuZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
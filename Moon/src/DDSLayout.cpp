@@ -0,0 +1,437 @@
+#include "mnpch.h"
+#include "DDSLayout.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Moon
+{
+	namespace
+	{
+		constexpr uint32_t MakeFourCC(char c0, char c1, char c2, char c3)
+		{
+			return (uint32_t)(uint8_t)c0 | ((uint32_t)(uint8_t)c1 << 8) | ((uint32_t)(uint8_t)c2 << 16) | ((uint32_t)(uint8_t)c3 << 24);
+		}
+
+		constexpr uint32_t DDSMagic = MakeFourCC('D', 'D', 'S', ' ');
+		constexpr uint32_t DDSZMagic = MakeFourCC('D', 'D', 'S', 'Z');
+
+		// Entry of the stream table of a compressed file.
+		struct DDSZStream
+		{
+			uint64_t Offset;
+			uint64_t Size;
+		};
+
+		static_assert(sizeof(DDSZStream) == 16, "DDSZ stream entries are two uint64_t");
+
+		// Same layout as DDS_HEADER in DDSTextureLoader.cpp, read with memcpy since the file data may not be aligned.
+		struct DDSPixelFormat
+		{
+			uint32_t Size;
+			uint32_t Flags;
+			uint32_t FourCC;
+			uint32_t RGBBitCount;
+			uint32_t RBitMask;
+			uint32_t GBitMask;
+			uint32_t BBitMask;
+			uint32_t ABitMask;
+		};
+
+		struct DDSHeader
+		{
+			uint32_t Size;
+			uint32_t Flags;
+			uint32_t Height;
+			uint32_t Width;
+			uint32_t PitchOrLinearSize;
+			uint32_t Depth;
+			uint32_t MipMapCount;
+			uint32_t Reserved1[11];
+			DDSPixelFormat PixelFormat;
+			uint32_t Caps;
+			uint32_t Caps2;
+			uint32_t Caps3;
+			uint32_t Caps4;
+			uint32_t Reserved2;
+		};
+
+		struct DDSHeaderDXT10
+		{
+			uint32_t Format;
+			uint32_t ResourceDimension;
+			uint32_t MiscFlag;
+			uint32_t ArraySize;
+			uint32_t MiscFlags2;
+		};
+
+		static_assert(sizeof(DDSPixelFormat) == 32, "DDS_PIXELFORMAT is 32 bytes");
+		static_assert(sizeof(DDSHeader) == 124, "DDS_HEADER is 124 bytes");
+		static_assert(sizeof(DDSHeaderDXT10) == 20, "DDS_HEADER_DXT10 is 20 bytes");
+
+		constexpr uint32_t DDSFourCCFlag = 0x00000004;
+		constexpr uint32_t DDSRGBFlag = 0x00000040;
+		constexpr uint32_t DDSLuminanceFlag = 0x00020000;
+		constexpr uint32_t DDSAlphaFlag = 0x00000002;
+		constexpr uint32_t DDSVolumeFlag = 0x00800000;
+		constexpr uint32_t DDSCubeMap = 0x00000200;
+		constexpr uint32_t DDSCubeMapAllFaces = 0x0000fe00;
+		constexpr uint32_t DDSMiscTextureCube = 0x4;
+
+		// D3D12_REQ_MIP_LEVELS, D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION and friends.
+		constexpr uint32_t MaxMipLevels = 15;
+		constexpr uint32_t MaxTexture1DDimension = 16384;
+		constexpr uint32_t MaxTexture2DDimension = 16384;
+		constexpr uint32_t MaxTexture3DDimension = 2048;
+		constexpr uint32_t MaxArraySize = 2048;
+
+		// The DXGI_FORMAT values the legacy header maps to.
+		enum : uint32_t
+		{
+			Format_R32G32B32A32_FLOAT = 2,
+			Format_R16G16B16A16_FLOAT = 10,
+			Format_R16G16B16A16_UNORM = 11,
+			Format_R16G16B16A16_SNORM = 13,
+			Format_R32G32_FLOAT = 16,
+			Format_R10G10B10A2_UNORM = 24,
+			Format_R8G8B8A8_UNORM = 28,
+			Format_R16G16_FLOAT = 34,
+			Format_R16G16_UNORM = 35,
+			Format_R32_FLOAT = 41,
+			Format_R8G8_UNORM = 49,
+			Format_R16_FLOAT = 54,
+			Format_R16_UNORM = 56,
+			Format_R8_UNORM = 61,
+			Format_A8_UNORM = 65,
+			Format_BC1_UNORM = 71,
+			Format_BC2_UNORM = 74,
+			Format_BC3_UNORM = 77,
+			Format_BC4_UNORM = 80,
+			Format_BC4_SNORM = 81,
+			Format_BC5_UNORM = 83,
+			Format_BC5_SNORM = 84,
+			Format_B5G6R5_UNORM = 85,
+			Format_B5G5R5A1_UNORM = 86,
+			Format_B8G8R8A8_UNORM = 87,
+			Format_B8G8R8X8_UNORM = 88,
+			Format_B4G4R4A4_UNORM = 115,
+		};
+
+		bool IsBitMask(const DDSPixelFormat& pf, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+		{
+			return pf.RBitMask == r && pf.GBitMask == g && pf.BBitMask == b && pf.ABitMask == a;
+		}
+
+		// Mirrors GetDXGIFormat() of DDSTextureLoader.cpp, minus the formats GetDXGIFormatBitsPerPixel() rejects.
+		uint32_t GetLegacyFormat(const DDSPixelFormat& pf)
+		{
+			if (pf.Flags & DDSRGBFlag)
+			{
+				if (pf.RGBBitCount == 32)
+				{
+					if (IsBitMask(pf, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) return Format_R8G8B8A8_UNORM;
+					if (IsBitMask(pf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000)) return Format_B8G8R8A8_UNORM;
+					if (IsBitMask(pf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000)) return Format_B8G8R8X8_UNORM;
+					if (IsBitMask(pf, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000)) return Format_R10G10B10A2_UNORM;
+					if (IsBitMask(pf, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000)) return Format_R16G16_UNORM;
+					if (IsBitMask(pf, 0xffffffff, 0x00000000, 0x00000000, 0x00000000)) return Format_R32_FLOAT;
+				}
+				else if (pf.RGBBitCount == 16)
+				{
+					if (IsBitMask(pf, 0x7c00, 0x03e0, 0x001f, 0x8000)) return Format_B5G5R5A1_UNORM;
+					if (IsBitMask(pf, 0xf800, 0x07e0, 0x001f, 0x0000)) return Format_B5G6R5_UNORM;
+					if (IsBitMask(pf, 0x0f00, 0x00f0, 0x000f, 0xf000)) return Format_B4G4R4A4_UNORM;
+				}
+			}
+			else if (pf.Flags & DDSLuminanceFlag)
+			{
+				if (pf.RGBBitCount == 8 && IsBitMask(pf, 0x000000ff, 0x00000000, 0x00000000, 0x00000000)) return Format_R8_UNORM;
+				if (pf.RGBBitCount == 16 && IsBitMask(pf, 0x0000ffff, 0x00000000, 0x00000000, 0x00000000)) return Format_R16_UNORM;
+				if (pf.RGBBitCount == 16 && IsBitMask(pf, 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00)) return Format_R8G8_UNORM;
+			}
+			else if (pf.Flags & DDSAlphaFlag)
+			{
+				if (pf.RGBBitCount == 8) return Format_A8_UNORM;
+			}
+			else if (pf.Flags & DDSFourCCFlag)
+			{
+				switch (pf.FourCC)
+				{
+				case MakeFourCC('D', 'X', 'T', '1'): return Format_BC1_UNORM;
+				case MakeFourCC('D', 'X', 'T', '2'):
+				case MakeFourCC('D', 'X', 'T', '3'): return Format_BC2_UNORM;
+				case MakeFourCC('D', 'X', 'T', '4'):
+				case MakeFourCC('D', 'X', 'T', '5'): return Format_BC3_UNORM;
+				case MakeFourCC('A', 'T', 'I', '1'):
+				case MakeFourCC('B', 'C', '4', 'U'): return Format_BC4_UNORM;
+				case MakeFourCC('B', 'C', '4', 'S'): return Format_BC4_SNORM;
+				case MakeFourCC('A', 'T', 'I', '2'):
+				case MakeFourCC('B', 'C', '5', 'U'): return Format_BC5_UNORM;
+				case MakeFourCC('B', 'C', '5', 'S'): return Format_BC5_SNORM;
+				case 36: return Format_R16G16B16A16_UNORM; // D3DFMT_A16B16G16R16
+				case 110: return Format_R16G16B16A16_SNORM; // D3DFMT_Q16W16V16U16
+				case 111: return Format_R16_FLOAT; // D3DFMT_R16F
+				case 112: return Format_R16G16_FLOAT; // D3DFMT_G16R16F
+				case 113: return Format_R16G16B16A16_FLOAT; // D3DFMT_A16B16G16R16F
+				case 114: return Format_R32_FLOAT; // D3DFMT_R32F
+				case 115: return Format_R32G32_FLOAT; // D3DFMT_G32R32F
+				case 116: return Format_R32G32B32A32_FLOAT; // D3DFMT_A32B32G32R32F
+				}
+			}
+			return 0;
+		}
+
+		uint32_t GetMaxMipCount(uint32_t width, uint32_t height, uint32_t depth)
+		{
+			uint32_t size = std::max(width, std::max(height, depth));
+			uint32_t count = 1;
+			while (size > 1)
+			{
+				size >>= 1;
+				++count;
+			}
+			return count;
+		}
+	}
+
+	uint32_t GetDXGIFormatBitsPerPixel(uint32_t format)
+	{
+		if (format >= 1 && format <= 4) return 128;   // R32G32B32A32
+		if (format >= 5 && format <= 8) return 96;    // R32G32B32
+		if (format >= 9 && format <= 22) return 64;   // R16G16B16A16, R32G32, R32G8X24
+		if (format >= 23 && format <= 47) return 32;  // R10G10B10A2 to R24G8
+		if (format >= 48 && format <= 59) return 16;  // R8G8, R16
+		if (format >= 60 && format <= 65) return 8;   // R8, A8
+		if (format == 67) return 32;                  // R9G9B9E5_SHAREDEXP
+		if (format == 70 || format == 71 || format == 72 || format == 79 || format == 80 || format == 81) return 4; // BC1, BC4
+		if ((format >= 73 && format <= 78) || (format >= 82 && format <= 84) || (format >= 94 && format <= 99)) return 8; // BC2, BC3, BC5, BC6H, BC7
+		if (format == 85 || format == 86 || format == 115) return 16; // B5G6R5, B5G5R5A1, B4G4R4A4
+		if (format >= 87 && format <= 93) return 32;  // B8G8R8A8, B8G8R8X8, R10G10B10_XR_BIAS_A2
+		return 0;
+	}
+
+	bool IsDXGIFormatBlockCompressed(uint32_t format)
+	{
+		return (format >= 70 && format <= 84) || (format >= 94 && format <= 99);
+	}
+
+	DDSLayout DDSLayout::Parse(const uint8_t* data, size_t size)
+	{
+		if (!data || size < sizeof(uint32_t) + sizeof(DDSHeader))
+			throw std::runtime_error("DDS: file too small for a header");
+
+		uint32_t magic;
+		memcpy(&magic, data, sizeof(magic));
+		if (magic != DDSMagic && magic != DDSZMagic)
+			throw std::runtime_error("DDS: bad magic number");
+
+		DDSHeader header;
+		memcpy(&header, data + sizeof(uint32_t), sizeof(header));
+		if (header.Size != sizeof(DDSHeader) || header.PixelFormat.Size != sizeof(DDSPixelFormat))
+			throw std::runtime_error("DDS: bad header size");
+
+		DDSLayout layout;
+		layout.Width = header.Width;
+		layout.Height = header.Height;
+		layout.MipCount = header.MipMapCount ? header.MipMapCount : 1;
+		layout.IsCompressed = magic == DDSZMagic;
+		uint64_t offset = sizeof(uint32_t) + sizeof(DDSHeader);
+
+		if ((header.PixelFormat.Flags & DDSFourCCFlag) && header.PixelFormat.FourCC == MakeFourCC('D', 'X', '1', '0'))
+		{
+			if (size < offset + sizeof(DDSHeaderDXT10))
+				throw std::runtime_error("DDS: file too small for the DX10 header");
+
+			DDSHeaderDXT10 dxt10;
+			memcpy(&dxt10, data + offset, sizeof(dxt10));
+			offset += sizeof(DDSHeaderDXT10);
+
+			layout.Format = dxt10.Format;
+			layout.ArraySize = dxt10.ArraySize;
+			if (layout.ArraySize == 0)
+				throw std::runtime_error("DDS: empty texture array");
+
+			switch (dxt10.ResourceDimension)
+			{
+			case DimensionTexture1D:
+				layout.Dimension = DimensionTexture1D;
+				layout.Height = 1;
+				break;
+			case DimensionTexture2D:
+				layout.Dimension = DimensionTexture2D;
+				if (dxt10.MiscFlag & DDSMiscTextureCube)
+				{
+					// Checked before the multiply, which would wrap for a large array size.
+					if (layout.ArraySize > MaxArraySize / 6)
+						throw std::runtime_error("DDS: texture too large");
+					layout.IsCubeMap = true;
+					layout.ArraySize *= 6;
+				}
+				break;
+			case DimensionTexture3D:
+				if (!(header.Flags & DDSVolumeFlag))
+					throw std::runtime_error("DDS: 3D texture without the volume flag");
+				if (layout.ArraySize > 1)
+					throw std::runtime_error("DDS: 3D texture arrays are not supported");
+				layout.Dimension = DimensionTexture3D;
+				layout.Depth = header.Depth;
+				break;
+			default:
+				throw std::runtime_error("DDS: unknown resource dimension");
+			}
+		}
+		else
+		{
+			layout.Format = GetLegacyFormat(header.PixelFormat);
+			if (header.Flags & DDSVolumeFlag)
+			{
+				layout.Dimension = DimensionTexture3D;
+				layout.Depth = header.Depth;
+			}
+			else if (header.Caps2 & DDSCubeMap)
+			{
+				// Partial cube maps are not supported by D3D.
+				if ((header.Caps2 & DDSCubeMapAllFaces) != DDSCubeMapAllFaces)
+					throw std::runtime_error("DDS: partial cube map");
+				layout.IsCubeMap = true;
+				layout.ArraySize = 6;
+			}
+		}
+
+		const uint32_t bitsPerPixel = GetDXGIFormatBitsPerPixel(layout.Format);
+		if (bitsPerPixel == 0)
+			throw std::runtime_error("DDS: unsupported format");
+
+		if (layout.Width == 0 || layout.Height == 0 || layout.Depth == 0)
+			throw std::runtime_error("DDS: empty texture");
+		const uint32_t maxDimension = layout.Dimension == DimensionTexture3D ? MaxTexture3DDimension
+			: layout.Dimension == DimensionTexture2D ? MaxTexture2DDimension : MaxTexture1DDimension;
+		if (layout.Width > maxDimension || layout.Height > maxDimension || layout.Depth > maxDimension || layout.ArraySize > MaxArraySize)
+			throw std::runtime_error("DDS: texture too large");
+		if (layout.MipCount > MaxMipLevels || layout.MipCount > GetMaxMipCount(layout.Width, layout.Height, layout.Depth))
+			throw std::runtime_error("DDS: too many mips");
+
+		const bool blockCompressed = IsDXGIFormatBlockCompressed(layout.Format);
+		layout.Subresources.resize((size_t)layout.MipCount * layout.ArraySize);
+
+		const uint64_t streamTable = offset;
+		if (layout.IsCompressed)
+		{
+			offset += layout.Subresources.size() * sizeof(DDSZStream);
+			if (offset > size)
+				throw std::runtime_error("DDS: file too small for the stream table");
+		}
+
+		for (uint32_t slice = 0; slice < layout.ArraySize; ++slice)
+		{
+			uint32_t width = layout.Width;
+			uint32_t height = layout.Height;
+			uint32_t depth = layout.Depth;
+			for (uint32_t mip = 0; mip < layout.MipCount; ++mip)
+			{
+				const uint32_t index = layout.GetSubresourceIndex(mip, slice);
+				DDSSubresource& sub = layout.Subresources[index];
+				sub.Width = width;
+				sub.Height = height;
+				sub.Depth = depth;
+				if (blockCompressed)
+				{
+					// 4x4 blocks, of 8 bytes for 4 bits per pixel formats and 16 bytes otherwise.
+					sub.RowPitch = std::max(1u, (width + 3) / 4) * bitsPerPixel * 2;
+					sub.RowCount = std::max(1u, (height + 3) / 4);
+				}
+				else
+				{
+					sub.RowPitch = (uint32_t)(((uint64_t)width * bitsPerPixel + 7) / 8);
+					sub.RowCount = height;
+				}
+				sub.Size = (uint64_t)sub.RowPitch * sub.RowCount * depth;
+
+				if (layout.IsCompressed)
+				{
+					DDSZStream stream;
+					memcpy(&stream, data + streamTable + (uint64_t)index * sizeof(DDSZStream), sizeof(stream));
+					if (stream.Offset < offset || stream.Offset > size || stream.Size > size - stream.Offset)
+						throw std::runtime_error("DDS: stream out of the file");
+					sub.Offset = stream.Offset;
+					sub.CompressedSize = stream.Size;
+				}
+				else
+				{
+					sub.Offset = offset;
+					offset += sub.Size;
+					if (offset > size)
+						throw std::runtime_error("DDS: file truncated");
+				}
+
+				width = std::max(1u, width / 2);
+				height = std::max(1u, height / 2);
+				depth = std::max(1u, depth / 2);
+			}
+		}
+
+		return layout;
+	}
+
+	uint32_t DDSSubresource::GetUploadRowPitch() const
+	{
+		return (RowPitch + DDSLayout::UploadPitchAlignment - 1) & ~(DDSLayout::UploadPitchAlignment - 1);
+	}
+
+	uint64_t DDSSubresource::GetUploadSize() const
+	{
+		return ((uint64_t)RowCount * Depth - 1) * GetUploadRowPitch() + RowPitch;
+	}
+
+	uint64_t DDSLayout::GetMipSize(uint32_t mip) const
+	{
+		uint64_t size = 0;
+		for (uint32_t slice = 0; slice < ArraySize; ++slice)
+			size += GetSubresource(mip, slice).Size;
+		return size;
+	}
+
+	uint32_t DDSLayout::GetTailMip(uint64_t maxBytes) const
+	{
+		uint32_t mip = MipCount - 1;
+		uint64_t size = GetMipSize(mip);
+		while (mip > 0 && size + GetMipSize(mip - 1) <= maxBytes)
+		{
+			--mip;
+			size += GetMipSize(mip);
+		}
+		return mip;
+	}
+
+	std::vector<uint8_t> CompressDDS(const uint8_t* data, size_t size, uint32_t searchDepth)
+	{
+		const DDSLayout layout = DDSLayout::Parse(data, size);
+		if (layout.IsCompressed)
+			throw std::runtime_error("DDS: file already compressed");
+
+		// The headers end where the first subresource starts.
+		const size_t headerSize = (size_t)layout.Subresources[0].Offset;
+		std::vector<uint8_t> out(headerSize + layout.Subresources.size() * sizeof(DDSZStream));
+		memcpy(out.data(), data, headerSize);
+		memcpy(out.data(), &DDSZMagic, sizeof(DDSZMagic));
+
+		std::vector<uint8_t> upload;
+		for (size_t index = 0; index < layout.Subresources.size(); ++index)
+		{
+			const DDSSubresource& sub = layout.Subresources[index];
+			const uint32_t uploadRowPitch = sub.GetUploadRowPitch();
+			const uint64_t rows = (uint64_t)sub.RowCount * sub.Depth;
+
+			// The padding of the rows is zero, which costs next to nothing once compressed.
+			upload.assign((size_t)sub.GetUploadSize(), 0);
+			for (uint64_t row = 0; row < rows; ++row)
+				memcpy(upload.data() + row * uploadRowPitch, data + sub.Offset + row * sub.RowPitch, sub.RowPitch);
+
+			const std::vector<uint8_t> stream = LZCompress(upload.data(), upload.size(), searchDepth);
+			const DDSZStream entry = { out.size(), stream.size() };
+			memcpy(out.data() + headerSize + index * sizeof(DDSZStream), &entry, sizeof(entry));
+			out.insert(out.end(), stream.begin(), stream.end());
+		}
+		return out;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "LZCodec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Moon
+{
+	// Where a subresource sits in a DDS file, and how its rows are laid out there.
+	struct DDSSubresource
+	{
+		// Bytes from the start of the file.
+		uint64_t Offset = 0;
+		// RowPitch * RowCount * Depth.
+		uint64_t Size = 0;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t Depth = 0;
+		uint32_t RowPitch = 0;
+		// Rows of blocks for block compressed formats.
+		uint32_t RowCount = 0;
+		// Compressed files only: bytes of the LZ stream at Offset.
+		uint64_t CompressedSize = 0;
+
+		// Row pitch of the stream of a compressed file once decoded, the one of a D3D12 upload footprint.
+		uint32_t GetUploadRowPitch() const;
+		// Bytes the stream decodes to: every row at the upload pitch, but the last one that stops at RowPitch.
+		uint64_t GetUploadSize() const;
+	};
+
+	// Header and mip offsets of a DDS file, without any D3D call: enough to create the resource and copy any mip from the file.
+	// Formats are DXGI_FORMAT values and dimensions D3D12_RESOURCE_DIMENSION values, kept as integers so the module builds anywhere.
+	// Also reads the compressed files CompressDDS() writes: 'DDSZ' instead of the DDS magic, the same headers, then the offset
+	// and size of the LZ stream of every subresource as two uint64_t each, in subresource order, then the streams.
+	struct DDSLayout
+	{
+		static constexpr uint32_t DimensionTexture1D = 2;
+		static constexpr uint32_t DimensionTexture2D = 3;
+		static constexpr uint32_t DimensionTexture3D = 4;
+		// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT.
+		static constexpr uint32_t UploadPitchAlignment = 256;
+
+		uint32_t Format = 0;
+		uint32_t Dimension = DimensionTexture2D;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t Depth = 1;
+		uint32_t MipCount = 1;
+		// Six per cube.
+		uint32_t ArraySize = 1;
+		bool IsCubeMap = false;
+		// Subresources are LZ streams that decode straight to upload memory, see DDSSubresource::GetUploadRowPitch().
+		bool IsCompressed = false;
+		// In D3D12 subresource order: mip + slice * MipCount.
+		std::vector<DDSSubresource> Subresources;
+
+		// Throws std::runtime_error on a malformed, truncated or unsupported file.
+		static DDSLayout Parse(const uint8_t* data, size_t size);
+
+		uint32_t GetSubresourceIndex(uint32_t mip, uint32_t slice) const { return mip + slice * MipCount; }
+		const DDSSubresource& GetSubresource(uint32_t mip, uint32_t slice) const { return Subresources[GetSubresourceIndex(mip, slice)]; }
+		// Bytes of a mip, every array slice included.
+		uint64_t GetMipSize(uint32_t mip) const;
+		// Most detailed mip of the smallest mips that fit in maxBytes together. The last mip is returned even when it alone is bigger.
+		uint32_t GetTailMip(uint64_t maxBytes) const;
+	};
+
+	// Rewrites a DDS file with every subresource LZ compressed in its upload layout, so loading decodes straight to upload memory.
+	// Throws std::runtime_error like DDSLayout::Parse(), or when the file is compressed already.
+	std::vector<uint8_t> CompressDDS(const uint8_t* data, size_t size, uint32_t searchDepth = LZDefaultSearchDepth);
+
+	// 0 for the formats a DDS texture can not use (video, palettized, packed 2x1 and unknown ones).
+	uint32_t GetDXGIFormatBitsPerPixel(uint32_t format);
+	bool IsDXGIFormatBlockCompressed(uint32_t format);
+}
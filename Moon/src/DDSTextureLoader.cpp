@@ -144,17 +144,10 @@ inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char
 };
 
 //--------------------------------------------------------------------------------------
-static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
-                                        std::unique_ptr<uint8_t[]>& ddsData,
-                                        DDS_HEADER** header,
-                                        uint8_t** bitData,
-                                        size_t* bitSize
-                                      )
+_Use_decl_annotations_
+HRESULT DDSFileMapping::Open( const wchar_t* fileName )
 {
-    if (!header || !bitData || !bitSize)
-    {
-        return E_POINTER;
-    }
+    Close();
 
     // open the file
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
@@ -192,50 +185,108 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
     GetFileSizeEx( hFile.get(), &FileSize );
 #endif
 
-    // File is too big for 32-bit allocation, so reject read
+    // Same limit as the heap copy had, it also keeps the size in a size_t on 32-bit builds
     if (FileSize.HighPart > 0)
     {
         return E_FAIL;
     }
 
-    // Need at least enough data to fill the header and magic number to be a valid DDS
-    if (FileSize.LowPart < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
+    // An empty file can not be mapped
+    if (FileSize.LowPart == 0)
     {
         return E_FAIL;
     }
 
-    // create enough space for the file data
-    ddsData.reset( new (std::nothrow) uint8_t[ FileSize.LowPart ] );
-    if (!ddsData)
+    ScopedHandle hMapping( CreateFileMappingW( hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr ) );
+    if ( !hMapping )
     {
-        return E_OUTOFMEMORY;
+        return HRESULT_FROM_WIN32( GetLastError() );
     }
 
-    // read the data in
-    DWORD BytesRead = 0;
-    if (!ReadFile( hFile.get(),
-                   ddsData.get(),
-                   FileSize.LowPart,
-                   &BytesRead,
-                   nullptr
-                 ))
+    const void* view = MapViewOfFile( hMapping.get(), FILE_MAP_READ, 0, 0, 0 );
+    if ( !view )
     {
         return HRESULT_FROM_WIN32( GetLastError() );
     }
 
-    if (BytesRead < FileSize.LowPart)
+    m_file = hFile.release();
+    m_mapping = hMapping.release();
+    m_data = static_cast<const uint8_t*>( view );
+    m_size = FileSize.LowPart;
+
+    return S_OK;
+}
+
+void DDSFileMapping::Close()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile( m_data );
+        m_data = nullptr;
+    }
+    if (m_mapping)
+    {
+        CloseHandle( m_mapping );
+        m_mapping = nullptr;
+    }
+    if (m_file)
+    {
+        CloseHandle( m_file );
+        m_file = nullptr;
+    }
+    m_size = 0;
+}
+
+void DDSFileMapping::Prefetch() const
+{
+    // Nothing to touch, and data[m_size - 1] would read before the mapping
+    if (!m_data || m_size == 0)
+    {
+        return;
+    }
+
+    SYSTEM_INFO systemInfo = {};
+    GetSystemInfo( &systemInfo );
+    const size_t pageSize = systemInfo.dwPageSize ? systemInfo.dwPageSize : 4096;
+
+    // One read per page is enough to bring it in, volatile keeps the reads from being dropped
+    const volatile uint8_t* data = m_data;
+    uint8_t sum = 0;
+    for (size_t offset = 0; offset < m_size; offset += pageSize)
+    {
+        sum ^= data[offset];
+    }
+    sum ^= data[m_size - 1];
+    (void)sum;
+}
+
+//--------------------------------------------------------------------------------------
+static HRESULT GetTextureDataFromMemory( _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+                                         _In_ size_t ddsDataSize,
+                                         const DDS_HEADER** header,
+                                         const uint8_t** bitData,
+                                         size_t* bitSize
+                                       )
+{
+    if (!ddsData || !header || !bitData || !bitSize)
+    {
+        return E_POINTER;
+    }
+
+    // Need at least enough data to fill the header and magic number to be a valid DDS
+    if (ddsDataSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
     {
         return E_FAIL;
     }
 
     // DDS files always start with the same magic number ("DDS ")
-    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData.get() );
+    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData );
     if (dwMagicNumber != DDS_MAGIC)
     {
         return E_FAIL;
     }
 
-    auto hdr = reinterpret_cast<DDS_HEADER*>( ddsData.get() + sizeof( uint32_t ) );
+    auto hdr = reinterpret_cast<const DDS_HEADER*>( ddsData + sizeof( uint32_t ) );
 
     // Verify header to validate DDS file
     if (hdr->size != sizeof(DDS_HEADER) ||
@@ -250,7 +301,7 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
         (MAKEFOURCC( 'D', 'X', '1', '0' ) == hdr->ddspf.fourCC))
     {
         // Must be long enough for both headers and magic value
-        if (FileSize.LowPart < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
+        if (ddsDataSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
         {
             return E_FAIL;
         }
@@ -262,12 +313,35 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
     *header = hdr;
     ptrdiff_t offset = sizeof( uint32_t ) + sizeof( DDS_HEADER )
                        + (bDXT10Header ? sizeof( DDS_HEADER_DXT10 ) : 0);
-    *bitData = ddsData.get() + offset;
-    *bitSize = FileSize.LowPart - offset;
+    *bitData = ddsData + offset;
+    *bitSize = ddsDataSize - offset;
 
     return S_OK;
 }
 
+//--------------------------------------------------------------------------------------
+// The subresources point straight into the mapping, which must outlive the upload.
+static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
+                                        DDSFileMapping& ddsData,
+                                        const DDS_HEADER** header,
+                                        const uint8_t** bitData,
+                                        size_t* bitSize
+                                      )
+{
+    if (!header || !bitData || !bitSize)
+    {
+        return E_POINTER;
+    }
+
+    HRESULT hr = ddsData.Open( fileName );
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    return GetTextureDataFromMemory( ddsData.GetData(), ddsData.GetSize(), header, bitData, bitSize );
+}
+
 
 //--------------------------------------------------------------------------------------
 // Return the BPP for a particular format
@@ -1937,45 +2011,21 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		return E_INVALIDARG;
 	}
 
-	uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
-	if (dwMagicNumber != DDS_MAGIC)
-	{
-		return E_FAIL;
-	}
-
-	auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
-
-	// Verify header to validate DDS file
-	if (header->size != sizeof(DDS_HEADER) ||
-		header->ddspf.size != sizeof(DDS_PIXELFORMAT))
-	{
-		return E_FAIL;
-	}
-
-	// Check for DX10 extension
-	bool bDXT10Header = false;
-	if ((header->ddspf.flags & DDS_FOURCC) &&
-		(MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+	const DDS_HEADER* header = nullptr;
+	const uint8_t* bitData = nullptr;
+	size_t bitSize = 0;
+	HRESULT hr = GetTextureDataFromMemory(ddsData, ddsDataSize, &header, &bitData, &bitSize);
+	if (FAILED(hr))
 	{
-		// Must be long enough for both headers and magic value
-		if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
-		{
-			return E_FAIL;
-		}
-
-		bDXT10Header = true;
+		return hr;
 	}
 
-	ptrdiff_t offset = sizeof(uint32_t)
-		+ sizeof(DDS_HEADER)
-		+ (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
-
-	HRESULT hr = CreateTextureFromDDS12(
+	hr = CreateTextureFromDDS12(
 		device,
 		cmdList,
 		header,
-		ddsData + offset,
-		ddsDataSize - offset,
+		bitData,
+		bitSize,
 		maxsize,
 		false,
 		texture,
@@ -2160,11 +2210,11 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 		return E_INVALIDARG;
 	}
 
-	DDS_HEADER* header = nullptr;
-	uint8_t* bitData = nullptr;
+	const DDS_HEADER* header = nullptr;
+	const uint8_t* bitData = nullptr;
 	size_t bitSize = 0;
 
-	std::unique_ptr<uint8_t[]> ddsData;
+	DDSFileMapping ddsData;
 	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsData, &header, &bitData, &bitSize);
 	if (FAILED(hr))
 	{
@@ -2292,11 +2342,11 @@ HRESULT DirectX::CreateDDSTextureFromFileEx( ID3D11Device* d3dDevice,
         return E_INVALIDARG;
     }
 
-    DDS_HEADER* header = nullptr;
-    uint8_t* bitData = nullptr;
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
     size_t bitSize = 0;
 
-    std::unique_ptr<uint8_t[]> ddsData;
+    DDSFileMapping ddsData;
     HRESULT hr = LoadTextureDataFromFile( fileName,
                                           ddsData,
                                           &header,
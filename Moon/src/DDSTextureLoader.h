@@ -29,6 +29,7 @@
 #pragma warning(push)
 #pragma warning(disable : 4005)
 #include <stdint.h>
+#include <utility>
 
 #pragma warning(pop)
 
@@ -55,6 +56,48 @@ namespace DirectX
         DDS_ALPHA_MODE_CUSTOM        = 4,
     };
 
+    // Read-only mapping of a whole file. Texture data is copied straight from the mapping
+    // into the upload heap, the file is never copied to the heap first.
+    class DDSFileMapping
+    {
+    public:
+        DDSFileMapping() = default;
+        ~DDSFileMapping() { Close(); }
+
+        DDSFileMapping(const DDSFileMapping&) = delete;
+        DDSFileMapping& operator=(const DDSFileMapping&) = delete;
+
+        DDSFileMapping(DDSFileMapping&& other) noexcept { *this = std::move(other); }
+        DDSFileMapping& operator=(DDSFileMapping&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Close();
+                std::swap(m_file, other.m_file);
+                std::swap(m_mapping, other.m_mapping);
+                std::swap(m_data, other.m_data);
+                std::swap(m_size, other.m_size);
+            }
+            return *this;
+        }
+
+        HRESULT Open( _In_z_ const wchar_t* fileName );
+        void Close();
+
+        // Faults every page of the file in, so the copy into the upload heap does not wait on the disk.
+        // Safe to call from another thread than the one creating the texture.
+        void Prefetch() const;
+
+        const uint8_t* GetData() const { return m_data; }
+        size_t GetSize() const { return m_size; }
+
+    private:
+        HANDLE m_file = nullptr;
+        HANDLE m_mapping = nullptr;
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
     // Standard version
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
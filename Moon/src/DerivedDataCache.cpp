@@ -0,0 +1,234 @@
+#include "mnpch.h"
+#include "DerivedDataCache.h"
+#include "ContentHash.h"
+
+#include <chrono>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace Moon
+{
+	namespace
+	{
+		constexpr const char* TempMarker = ".tmp";
+		// Temporary files older than this are left over from a crash rather than being written.
+		constexpr auto StaleTempAge = std::chrono::hours(1);
+	}
+
+	DerivedDataCache::DerivedDataCache(const fs::path& directory, uint64_t capacity)
+		: mDirectory(directory), mCapacity(capacity)
+	{
+		std::error_code error;
+		fs::create_directories(mDirectory, error);
+		if (!fs::is_directory(mDirectory, error))
+			return;
+		mEnabled = true;
+		mTempPrefix = ((uint64_t)std::random_device()() << 32) | std::random_device()();
+
+		struct ListedEntry
+		{
+			Entry Listed;
+			fs::file_time_type WriteTime;
+		};
+		std::vector<ListedEntry> listed;
+		const fs::file_time_type now = fs::file_time_type::clock::now();
+		for (fs::directory_iterator it(mDirectory, error), end; !error && it != end; it.increment(error))
+		{
+			if (!it->is_regular_file(error))
+				continue;
+
+			const std::string name = it->path().filename().string();
+			const fs::file_time_type writeTime = it->last_write_time(error);
+			if (name.find(TempMarker) != std::string::npos)
+			{
+				if (!error && now - writeTime > StaleTempAge)
+					fs::remove(it->path(), error);
+				continue;
+			}
+			listed.push_back({ { name, it->file_size(error) }, writeTime });
+		}
+
+		std::sort(listed.begin(), listed.end(), [](const ListedEntry& a, const ListedEntry& b) { return a.WriteTime > b.WriteTime; });
+		for (const ListedEntry& entry : listed)
+		{
+			mOrder.push_back(entry.Listed);
+			mEntries[entry.Listed.Name] = std::prev(mOrder.end());
+			mSize += entry.Listed.Size;
+		}
+
+		// The capacity may have shrunk since the last run.
+		std::vector<std::string> evicted;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			evicted = CollectEvictions();
+		}
+		for (const std::string& name : evicted)
+			fs::remove(mDirectory / name, error);
+	}
+
+	std::string DerivedDataCache::GetEntryName(uint64_t key, const std::string& extension) const
+	{
+		return FormatContentHash(key) + "." + extension;
+	}
+
+	fs::path DerivedDataCache::Find(uint64_t key, const std::string& extension)
+	{
+		if (!mEnabled)
+			return {};
+
+		const std::string name = GetEntryName(key, extension);
+		if (!Touch(name))
+			return {};
+
+		// Refreshing the write time also checks the file is still there: another process may have evicted it.
+		fs::path path = mDirectory / name;
+		std::error_code error;
+		fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+		if (error)
+		{
+			DropVanishedEntry(name);
+			return {};
+		}
+		return path;
+	}
+
+	bool DerivedDataCache::Get(uint64_t key, const std::string& extension, std::vector<uint8_t>& data)
+	{
+		const fs::path path = Find(key, extension);
+		if (path.empty())
+			return false;
+
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (file)
+		{
+			data.resize((size_t)file.tellg());
+			file.seekg(0);
+			if (file.read((char*)data.data(), (std::streamsize)data.size()))
+				return true;
+		}
+
+		DropVanishedEntry(path.filename().string());
+		return false;
+	}
+
+	fs::path DerivedDataCache::Put(uint64_t key, const std::string& extension, const void* data, size_t size)
+	{
+		if (!mEnabled)
+			return {};
+
+		const std::string name = GetEntryName(key, extension);
+		fs::path temp;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			temp = mDirectory / (name + TempMarker + FormatContentHash(mTempPrefix + mTempIndex++));
+		}
+
+		std::error_code error;
+		{
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			file.write((const char*)data, (std::streamsize)size);
+			if (!file)
+			{
+				file.close();
+				fs::remove(temp, error);
+				return {};
+			}
+		}
+
+		const fs::path path = mDirectory / name;
+		fs::rename(temp, path, error);
+		if (error)
+		{
+			fs::remove(temp, error);
+			return {};
+		}
+
+		std::vector<std::string> evicted;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			const auto found = mEntries.find(name);
+			if (found != mEntries.end())
+			{
+				mSize -= found->second->Size;
+				mOrder.erase(found->second);
+			}
+			mOrder.push_front({ name, size });
+			mEntries[name] = mOrder.begin();
+			mSize += size;
+			++mStats.Stores;
+			evicted = CollectEvictions();
+		}
+		for (const std::string& evictedName : evicted)
+			fs::remove(mDirectory / evictedName, error);
+		return path;
+	}
+
+	DerivedDataCache::Stats DerivedDataCache::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		Stats stats = mStats;
+		stats.Size = mSize;
+		return stats;
+	}
+
+	bool DerivedDataCache::Touch(const std::string& name)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			const auto found = mEntries.find(name);
+			if (found != mEntries.end())
+			{
+				mOrder.splice(mOrder.begin(), mOrder, found->second);
+				++mStats.Hits;
+				return true;
+			}
+		}
+
+		std::error_code error;
+		const uint64_t size = fs::file_size(mDirectory / name, error);
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (error)
+		{
+			++mStats.Misses;
+			return false;
+		}
+		if (mEntries.find(name) == mEntries.end())
+		{
+			mOrder.push_front({ name, size });
+			mEntries[name] = mOrder.begin();
+			mSize += size;
+		}
+		++mStats.Hits;
+		return true;
+	}
+
+	void DerivedDataCache::DropVanishedEntry(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		const auto found = mEntries.find(name);
+		if (found == mEntries.end())
+			return;
+
+		mSize -= found->second->Size;
+		mOrder.erase(found->second);
+		mEntries.erase(found);
+		--mStats.Hits;
+		++mStats.Misses;
+	}
+
+	std::vector<std::string> DerivedDataCache::CollectEvictions()
+	{
+		std::vector<std::string> evicted;
+		while (mSize > mCapacity && mOrder.size() > 1)
+		{
+			const Entry& entry = mOrder.back();
+			mSize -= entry.Size;
+			evicted.push_back(entry.Name);
+			mEntries.erase(entry.Name);
+			mOrder.pop_back();
+			++mStats.Evictions;
+		}
+		return evicted;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Moon
+{
+	// Cooked assets keyed by a content hash of what they were cooked from (source bytes, settings, cook version), as
+	// <key>.<extension> files of a local directory that the app and the cook tool share.
+	// Entries are written through a temporary file renamed in place: a reader, in this process or another one, sees
+	// a whole entry or none. Past the capacity, the least recently used entries go first; a hit refreshes the write
+	// time of its file, so the order holds across runs. Lookups only lock to update the order, the file I/O runs unlocked.
+	class DerivedDataCache
+	{
+	public:
+		struct Stats
+		{
+			uint64_t Hits = 0;
+			uint64_t Misses = 0;
+			uint64_t Stores = 0;
+			uint64_t Evictions = 0;
+			// Bytes of the entries.
+			uint64_t Size = 0;
+		};
+
+		// Creates the directory. One that can not be created leaves the cache disabled: lookups miss and stores do nothing.
+		DerivedDataCache(const std::filesystem::path& directory, uint64_t capacity);
+
+		DerivedDataCache(const DerivedDataCache& rhs) = delete;
+		DerivedDataCache& operator=(const DerivedDataCache& rhs) = delete;
+
+		bool IsEnabled() const { return mEnabled; }
+
+		// Path of the entry, to map it rather than read it, or an empty path on a miss.
+		std::filesystem::path Find(uint64_t key, const std::string& extension);
+		// Returns false on a miss.
+		bool Get(uint64_t key, const std::string& extension, std::vector<uint8_t>& data);
+		// Replaces the entry if there is one. Returns the path of the entry, or an empty path when it could not be written.
+		std::filesystem::path Put(uint64_t key, const std::string& extension, const void* data, size_t size);
+
+		Stats GetStats() const;
+
+	private:
+		struct Entry
+		{
+			std::string Name;
+			uint64_t Size = 0;
+		};
+
+		std::string GetEntryName(uint64_t key, const std::string& extension) const;
+		// Moves the entry to the front of the order, picking up entries other processes wrote since the directory was listed.
+		// Returns false for an entry it does not know of whose file is not there either; Find() checks the file of the others.
+		bool Touch(const std::string& name);
+		// A hit whose file went away before it could be read, evicted by another process: a miss after all.
+		void DropVanishedEntry(const std::string& name);
+		// Entries past the capacity, least recently used first, but for the most recent one. Called with mMutex held.
+		std::vector<std::string> CollectEvictions();
+
+		const std::filesystem::path mDirectory;
+		const uint64_t mCapacity;
+		bool mEnabled = false;
+		// Most recently used first.
+		std::list<Entry> mOrder;
+		std::unordered_map<std::string, std::list<Entry>::iterator> mEntries;
+		uint64_t mSize = 0;
+		Stats mStats;
+		// Temporary file names, unique to the process and the write.
+		uint64_t mTempPrefix = 0;
+		uint64_t mTempIndex = 0;
+		mutable std::mutex mMutex;
+	};
+}
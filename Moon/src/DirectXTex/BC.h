@@ -35,6 +35,13 @@ enum BC_FLAGS : uint32_t
     BC_FLAGS_UNIFORM            = 0x40000,  // By default, uses perceptual weighting for BC1-3; this flag makes it a uniform weighting
     BC_FLAGS_USE_3SUBSETS       = 0x80000,  // By default, BC7 skips mode 0 & 2; this flag adds those modes back
     BC_FLAGS_FORCE_BC7_MODE6    = 0x100000, // BC7 should only use mode 6; skip other modes
+    BC_FLAGS_BC7_ULTRAFAST      = 0x200000, // BC7 profiles of D3DXEncodeBC7Fast, from fastest to best quality
+    BC_FLAGS_BC7_FAST           = 0x400000,
+    BC_FLAGS_BC7_BASIC          = 0x600000,
+    BC_FLAGS_BC7_SLOW           = 0x800000,
+    BC_FLAGS_BC7_PROFILE_MASK   = 0xE00000,
+    BC_FLAGS_FAST               = 0x4000000,    // BC1, BC3, BC4U and BC5U use the integer encoders of BCFast.cpp
+    BC_FLAGS_FAST_REFINE        = 0x8000000,    // Integer encoders refit their endpoints with least squares
 };
 
 //-------------------------------------------------------------------------------------
@@ -326,5 +333,13 @@ void D3DXEncodeBC5S(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLO
 void D3DXEncodeBC6HU(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
 void D3DXEncodeBC6HS(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
 void D3DXEncodeBC7(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
+void D3DXEncodeBC7Fast(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
+    // Integer BC7 encoder, flags must hold one of the BC_FLAGS_BC7_* profiles
+
+void D3DXEncodeBC1Fast(_Out_writes_(8) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ float threshold, _In_ uint32_t flags) noexcept;
+void D3DXEncodeBC3Fast(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
+void D3DXEncodeBC4UFast(_Out_writes_(8) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
+void D3DXEncodeBC5UFast(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
+    // Integer encoders on 8-bit pixels with uniform weighting; dithering is ignored and only BC_FLAGS_FAST_REFINE is used
 
 } // namespace
@@ -3504,6 +3504,869 @@ float D3DX_BC7::RoughMSE(EncodeParams* pEP, size_t uShape, size_t uIndexMode) no
 }
 
 
+//-------------------------------------------------------------------------------------
+// BC7 fast encoder
+//-------------------------------------------------------------------------------------
+// Works on 8-bit pixels and integer endpoints, where D3DX_BC7 works on floats and tries
+// every mode and shape. Each subset gets its endpoints from the principal axis of its
+// pixels, then a few least squares refits. The multi-subset modes rank their shapes by
+// the variance a line fit leaves over, and only encode the best ranked ones. The palette
+// search, where most of the time goes, handles 4 pixels per SSE register.
+namespace
+{
+    struct BC7FastMode
+    {
+        uint8_t uSubsets;
+        uint8_t uPartitionBits;
+        uint8_t uRotationBits;
+        uint8_t uIndexModeBits;
+        uint8_t uColorBits;     // RGB, p-bit excluded
+        uint8_t uAlphaBits;     // 0 for the color only modes
+        uint8_t uPBits;         // 0 none, 1 shared by the endpoints of a subset, 2 one per endpoint
+        uint8_t uIndexBits;
+        uint8_t uIndexBits2;    // Separate alpha indices of modes 4 and 5
+    };
+
+    const BC7FastMode g_aBC7FastModes[8] =
+    {
+        { 3, 4, 0, 0, 4, 0, 2, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 2, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 2, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 2, 2, 0 },
+    };
+
+    struct BC7FastProfile
+    {
+        uint32_t uModes;        // Bit per mode tried
+        uint32_t uShapes2;      // Best ranked shapes encoded by the 2 subset modes
+        uint32_t uShapes3;      // Best ranked shapes encoded by the 3 subset modes
+        uint32_t uRefits;       // Least squares endpoint refits per subset
+        bool bAllPBits;         // Every p-bit combination, rather than the one closest to the fitted endpoints
+        bool bAllRotations;     // Modes 4 and 5 also try swapping alpha with each color channel
+    };
+
+    // Indexed by the BC_FLAGS_BC7_* profile, minus one
+    const BC7FastProfile g_aBC7FastProfiles[4] =
+    {
+        { 0x40, 0, 0, 0, false, false },    // Ultrafast: mode 6
+        { 0xE2, 4, 0, 1, false, false },    // Fast: modes 1, 5, 6 and 7
+        { 0xFA, 16, 0, 2, true, true },     // Basic: modes 1 and 3 to 7
+        { 0xFF, 64, 64, 3, true, true },    // Slow: every mode and shape
+    };
+
+    // Sums over a set of pixels, enough to get their covariance: the pixel count, the channel
+    // sums, then the upper triangle of the channel products row by row. Padded to 4 SSE registers.
+    struct BC7FastMoments
+    {
+        XM_ALIGNED_DATA(16) float aValues[16];
+
+        float Count() const noexcept { return aValues[0]; }
+        float Sum(uint32_t ch) const noexcept { return aValues[1 + ch]; }
+        float Product(uint32_t product) const noexcept { return aValues[5 + product]; }
+    };
+
+    struct BC7FastBlock
+    {
+        XM_ALIGNED_DATA(16) float aChannels[4][NUM_PIXELS_PER_BLOCK];
+        BC7FastMoments aPixelMoments[NUM_PIXELS_PER_BLOCK];
+        uint8_t aPixels[NUM_PIXELS_PER_BLOCK][4];
+        bool bOpaque;           // Every alpha is 255
+    };
+
+    struct BC7FastSubset
+    {
+        int aEndPts[2][4];      // Quantized, p-bit excluded
+        int aPBits[2];
+        uint8_t aIndices[NUM_PIXELS_PER_BLOCK];
+        uint32_t uError;
+    };
+
+    struct BC7FastCandidate
+    {
+        uint32_t uMode;
+        uint32_t uShape;
+        uint32_t uRotation;
+        uint32_t uIndexMode;
+        BC7FastSubset aSubsets[BC7_MAX_REGIONS];
+        BC7FastSubset alpha;    // Modes 4 and 5
+        uint32_t uError;
+    };
+
+    inline const int* GetBC7Weights(uint32_t uIndexBits) noexcept
+    {
+        return uIndexBits == 2 ? g_aWeights2 : uIndexBits == 3 ? g_aWeights3 : g_aWeights4;
+    }
+
+    inline int UnquantizeBC7(int value, uint32_t uBits) noexcept
+    {
+        value <<= (8 - uBits);
+        return value | (value >> uBits);
+    }
+
+    // Pixels of each subset of each shape, a bit per pixel
+    class BC7SubsetMasks
+    {
+    public:
+        BC7SubsetMasks() noexcept : m_aMasks{}
+        {
+            for (size_t p = 0; p < BC7_MAX_REGIONS; ++p)
+            {
+                for (size_t shape = 0; shape < BC7_MAX_SHAPES; ++shape)
+                {
+                    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                        m_aMasks[p][shape][g_aPartitionTable[p][shape][i]] |= uint16_t(1u << i);
+                }
+            }
+        }
+
+        uint32_t Get(uint32_t uSubsets, uint32_t uShape, uint32_t uSubset) const noexcept { return m_aMasks[uSubsets - 1][uShape][uSubset]; }
+
+    private:
+        uint16_t m_aMasks[BC7_MAX_REGIONS][BC7_MAX_SHAPES][BC7_MAX_REGIONS];
+    };
+
+    inline uint32_t GetBC7SubsetMask(uint32_t uSubsets, uint32_t uShape, uint32_t uSubset) noexcept
+    {
+        static const BC7SubsetMasks s_masks;
+        return s_masks.Get(uSubsets, uShape, uSubset);
+    }
+
+    // Float copies of the pixels and their moments, for the SSE palette search and the axis fits
+    void InitBC7FastBlock(BC7FastBlock& block) noexcept
+    {
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            float* aValues = block.aPixelMoments[i].aValues;
+            aValues[0] = 1.0f;
+            for (uint32_t ch = 0; ch < 4; ++ch)
+                aValues[1 + ch] = block.aChannels[ch][i] = float(block.aPixels[i][ch]);
+
+            for (uint32_t row = 0, product = 5; row < 4; ++row)
+            {
+                for (uint32_t col = row; col < 4; ++col, ++product)
+                    aValues[product] = block.aChannels[row][i] * block.aChannels[col][i];
+            }
+            aValues[15] = 0.0f;
+        }
+    }
+
+    // Moments are sums of integers below 2^24, exact whatever the order of the additions
+    void AccumulateBC7Moments(const BC7FastBlock& block, uint32_t pixelMask, BC7FastMoments& moments) noexcept
+    {
+#if defined(_XM_SSE_INTRINSICS_)
+        __m128 vSum[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (pixelMask & (1u << i))
+            {
+                const float* aValues = block.aPixelMoments[i].aValues;
+                for (uint32_t j = 0; j < 4; ++j)
+                    vSum[j] = _mm_add_ps(vSum[j], _mm_load_ps(aValues + j * 4));
+            }
+        }
+        for (uint32_t j = 0; j < 4; ++j)
+            _mm_store_ps(moments.aValues + j * 4, vSum[j]);
+#else
+        memset(&moments, 0, sizeof(moments));
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (pixelMask & (1u << i))
+            {
+                for (uint32_t j = 0; j < 16; ++j)
+                    moments.aValues[j] += block.aPixelMoments[i].aValues[j];
+            }
+        }
+#endif
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Nearest palette entry of every pixel in pixelMask over the channels in channelMask.
+    // Returns the summed squared error. Errors stay below 2^24, so the SSE and scalar
+    // paths compute them exactly and pick the same indices.
+    uint32_t FindBC7Indices(
+        const BC7FastBlock& block,
+        uint32_t pixelMask,
+        uint32_t channelMask,
+        const int aPalette[][4],
+        uint32_t uCount,
+        uint8_t aIndices[NUM_PIXELS_PER_BLOCK]) noexcept
+    {
+        uint32_t uError = 0;
+#if defined(_XM_SSE_INTRINSICS_)
+        // Channels out of channelMask are zero in both the pixels and the palette
+        __m128 vPalette[BC7_MAX_INDICES][4];
+        for (uint32_t k = 0; k < uCount; ++k)
+        {
+            for (uint32_t ch = 0; ch < 4; ++ch)
+                vPalette[k][ch] = _mm_set1_ps((channelMask & (1u << ch)) ? float(aPalette[k][ch]) : 0.0f);
+        }
+
+        XM_ALIGNED_DATA(16) float aErrors[4];
+        XM_ALIGNED_DATA(16) int32_t aBest[4];
+        for (uint32_t group = 0; group < NUM_PIXELS_PER_BLOCK; group += 4)
+        {
+            const uint32_t groupMask = (pixelMask >> group) & 0xF;
+            if (!groupMask)
+                continue;
+
+            __m128 vChannels[4];
+            for (uint32_t ch = 0; ch < 4; ++ch)
+                vChannels[ch] = (channelMask & (1u << ch)) ? _mm_load_ps(&block.aChannels[ch][group]) : _mm_setzero_ps();
+
+            __m128 vBestError = _mm_set1_ps(FLT_MAX);
+            __m128i vBestIndex = _mm_setzero_si128();
+            for (uint32_t k = 0; k < uCount; ++k)
+            {
+                const __m128 vDiff0 = _mm_sub_ps(vChannels[0], vPalette[k][0]);
+                const __m128 vDiff1 = _mm_sub_ps(vChannels[1], vPalette[k][1]);
+                const __m128 vDiff2 = _mm_sub_ps(vChannels[2], vPalette[k][2]);
+                const __m128 vDiff3 = _mm_sub_ps(vChannels[3], vPalette[k][3]);
+                const __m128 vError = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(vDiff0, vDiff0), _mm_mul_ps(vDiff1, vDiff1)),
+                    _mm_add_ps(_mm_mul_ps(vDiff2, vDiff2), _mm_mul_ps(vDiff3, vDiff3)));
+
+                const __m128i vLess = _mm_castps_si128(_mm_cmplt_ps(vError, vBestError));
+                vBestError = _mm_min_ps(vError, vBestError);
+                vBestIndex = _mm_or_si128(_mm_and_si128(vLess, _mm_set1_epi32(int(k))), _mm_andnot_si128(vLess, vBestIndex));
+            }
+
+            _mm_store_ps(aErrors, vBestError);
+            _mm_store_si128(reinterpret_cast<__m128i*>(aBest), vBestIndex);
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                if (groupMask & (1u << i))
+                {
+                    aIndices[group + i] = uint8_t(aBest[i]);
+                    uError += uint32_t(aErrors[i]);
+                }
+            }
+        }
+#else
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (!(pixelMask & (1u << i)))
+                continue;
+
+            uint32_t uBestError = UINT32_MAX;
+            uint8_t uBestIndex = 0;
+            for (uint32_t k = 0; k < uCount; ++k)
+            {
+                uint32_t uPixelError = 0;
+                for (uint32_t ch = 0; ch < 4; ++ch)
+                {
+                    if (channelMask & (1u << ch))
+                    {
+                        const int diff = int(block.aPixels[i][ch]) - aPalette[k][ch];
+                        uPixelError += uint32_t(diff * diff);
+                    }
+                }
+
+                if (uPixelError < uBestError)
+                {
+                    uBestError = uPixelError;
+                    uBestIndex = uint8_t(k);
+                }
+            }
+
+            aIndices[i] = uBestIndex;
+            uError += uBestError;
+        }
+#endif
+        return uError;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Mean and principal axis of a set of pixels, over the channels in channelMask.
+    // Returns the variance left off the axis, summed over the pixels.
+    float ComputeBC7Axis(
+        const BC7FastMoments& moments,
+        uint32_t channelMask,
+        uint32_t uIterations,
+        float aMean[4],
+        float aAxis[4]) noexcept
+    {
+        for (uint32_t ch = 0; ch < 4; ++ch)
+            aMean[ch] = aAxis[ch] = 0.0f;
+
+        if (moments.Count() == 0.0f)
+            return 0.0f;
+
+        const float fInvCount = 1.0f / moments.Count();
+        for (uint32_t ch = 0; ch < 4; ++ch)
+        {
+            if (channelMask & (1u << ch))
+                aMean[ch] = moments.Sum(ch) * fInvCount;
+        }
+
+        float aCov[4][4] = {};
+        float fTrace = 0.0f;
+        uint32_t uLargest = 0;
+        for (uint32_t row = 0, product = 0; row < 4; ++row)
+        {
+            for (uint32_t col = row; col < 4; ++col, ++product)
+            {
+                if ((channelMask & (1u << row)) && (channelMask & (1u << col)))
+                    aCov[row][col] = aCov[col][row] = moments.Product(product) - moments.Sum(row) * aMean[col];
+            }
+            fTrace += aCov[row][row];
+            if (aCov[row][row] > aCov[uLargest][uLargest])
+                uLargest = row;
+        }
+
+        if (fTrace <= 0.0f)
+            return 0.0f;
+
+        // Power iterations, from the channel that varies the most
+        float aVector[4];
+        for (uint32_t ch = 0; ch < 4; ++ch)
+            aVector[ch] = aCov[uLargest][ch];
+
+        for (uint32_t iteration = 0; iteration < uIterations; ++iteration)
+        {
+            float aNext[4];
+            for (uint32_t row = 0; row < 4; ++row)
+                aNext[row] = aCov[row][0] * aVector[0] + aCov[row][1] * aVector[1] + aCov[row][2] * aVector[2] + aCov[row][3] * aVector[3];
+
+            const float fLength2 = aNext[0] * aNext[0] + aNext[1] * aNext[1] + aNext[2] * aNext[2] + aNext[3] * aNext[3];
+            if (fLength2 <= 0.0f)
+                return fTrace;
+
+            const float fInvLength = 1.0f / sqrtf(fLength2);
+            for (uint32_t ch = 0; ch < 4; ++ch)
+                aVector[ch] = aNext[ch] * fInvLength;
+        }
+
+        float fLambda = 0.0f;
+        for (uint32_t row = 0; row < 4; ++row)
+        {
+            aAxis[row] = aVector[row];
+            fLambda += aVector[row] * (aCov[row][0] * aVector[0] + aCov[row][1] * aVector[1] + aCov[row][2] * aVector[2] + aCov[row][3] * aVector[3]);
+        }
+
+        return std::max(0.0f, fTrace - fLambda);
+    }
+
+    void FitBC7EndPoints(
+        const BC7FastBlock& block,
+        uint32_t pixelMask,
+        uint32_t channelMask,
+        float aEndPts[2][4]) noexcept
+    {
+        BC7FastMoments moments;
+        AccumulateBC7Moments(block, pixelMask, moments);
+
+        float aMean[4], aAxis[4];
+        ComputeBC7Axis(moments, channelMask, 4, aMean, aAxis);
+
+        float fMin = FLT_MAX;
+        float fMax = -FLT_MAX;
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (pixelMask & (1u << i))
+            {
+                float fDot = 0.0f;
+                for (uint32_t ch = 0; ch < 4; ++ch)
+                    fDot += (block.aChannels[ch][i] - aMean[ch]) * aAxis[ch];
+                fMin = std::min(fMin, fDot);
+                fMax = std::max(fMax, fDot);
+            }
+        }
+
+        for (uint32_t ch = 0; ch < 4; ++ch)
+        {
+            aEndPts[0][ch] = std::max(0.0f, std::min(255.0f, aMean[ch] + aAxis[ch] * fMin));
+            aEndPts[1][ch] = std::max(0.0f, std::min(255.0f, aMean[ch] + aAxis[ch] * fMax));
+        }
+    }
+
+    // Least squares endpoints for the given indices. False when every pixel uses the same weight.
+    bool RefitBC7EndPoints(
+        const BC7FastBlock& block,
+        uint32_t pixelMask,
+        uint32_t channelMask,
+        const uint8_t aIndices[NUM_PIXELS_PER_BLOCK],
+        uint32_t uIndexBits,
+        float aEndPts[2][4]) noexcept
+    {
+        const int* aWeights = GetBC7Weights(uIndexBits);
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float aX0[4] = {}, aX1[4] = {};
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (!(pixelMask & (1u << i)))
+                continue;
+
+            const float t = float(aWeights[aIndices[i]]) * (1.0f / 64.0f);
+            const float s = 1.0f - t;
+            a += s * s;
+            b += s * t;
+            c += t * t;
+            for (uint32_t ch = 0; ch < 4; ++ch)
+            {
+                aX0[ch] += s * block.aChannels[ch][i];
+                aX1[ch] += t * block.aChannels[ch][i];
+            }
+        }
+
+        const float fDet = a * c - b * b;
+        if (fabsf(fDet) < 1e-6f)
+            return false;
+
+        const float fInvDet = 1.0f / fDet;
+        for (uint32_t ch = 0; ch < 4; ++ch)
+        {
+            if (channelMask & (1u << ch))
+            {
+                aEndPts[0][ch] = std::max(0.0f, std::min(255.0f, (c * aX0[ch] - b * aX1[ch]) * fInvDet));
+                aEndPts[1][ch] = std::max(0.0f, std::min(255.0f, (a * aX1[ch] - b * aX0[ch]) * fInvDet));
+            }
+        }
+        return true;
+    }
+
+    // Value of uBits precision, followed by pBit when pBit >= 0, whose unquantized value is closest to fValue
+    inline int QuantizeBC7Channel(float fValue, uint32_t uBits, int pBit) noexcept
+    {
+        const int maxValue = (1 << uBits) - 1;
+        const uint32_t uFullBits = pBit >= 0 ? uBits + 1 : uBits;
+        const float fScaled = fValue * float((1 << uFullBits) - 1) / 255.0f;
+        const int center = pBit >= 0 ? int((fScaled - float(pBit)) * 0.5f + 0.5f) : int(fScaled + 0.5f);
+
+        int best = 0;
+        float fBestError = FLT_MAX;
+        for (int q = std::max(0, center - 1); q <= std::min(maxValue, center + 1); ++q)
+        {
+            const int full = pBit >= 0 ? (q << 1) | pBit : q;
+            const float fError = fabsf(float(UnquantizeBC7(full, uFullBits)) - fValue);
+            if (fError < fBestError)
+            {
+                fBestError = fError;
+                best = q;
+            }
+        }
+        return best;
+    }
+
+    // 8-bit endpoint of a subset, alpha is opaque for the color only modes
+    void ExpandBC7EndPoint(
+        const BC7FastSubset& subset,
+        uint32_t uEndPt,
+        uint32_t channelMask,
+        uint32_t uBits,
+        bool bHasPBit,
+        int aColor[4]) noexcept
+    {
+        for (uint32_t ch = 0; ch < 4; ++ch)
+        {
+            if (!(channelMask & (1u << ch)))
+                aColor[ch] = 255;
+            else if (bHasPBit)
+                aColor[ch] = UnquantizeBC7((subset.aEndPts[uEndPt][ch] << 1) | subset.aPBits[uEndPt], uBits + 1);
+            else
+                aColor[ch] = UnquantizeBC7(subset.aEndPts[uEndPt][ch], uBits);
+        }
+    }
+
+    // Quantizes the fitted endpoints with each p-bit candidate, and keeps the lowest error encoding in result
+    void TryBC7EndPoints(
+        const BC7FastBlock& block,
+        uint32_t pixelMask,
+        uint32_t channelMask,
+        uint32_t uBits,
+        uint32_t uPBits,
+        uint32_t uIndexBits,
+        const BC7FastProfile& profile,
+        const float aFitted[2][4],
+        BC7FastSubset& result) noexcept
+    {
+        int aCandidates[4][2];
+        size_t uCandidates = 0;
+        if (uPBits == 0)
+        {
+            aCandidates[uCandidates][0] = aCandidates[uCandidates][1] = -1;
+            ++uCandidates;
+        }
+        else if (block.bOpaque && (channelMask & 0x8))
+        {
+            // Alpha shares the p-bits, only set ones decode to 255
+            aCandidates[0][0] = aCandidates[0][1] = 1;
+            uCandidates = 1;
+        }
+        else if (profile.bAllPBits)
+        {
+            for (int p = 0; p < 4; ++p)
+            {
+                if (uPBits == 1 && (p & 1) != (p >> 1))
+                    continue;
+                aCandidates[uCandidates][0] = p & 1;
+                aCandidates[uCandidates][1] = p >> 1;
+                ++uCandidates;
+            }
+        }
+        else
+        {
+            // The p-bits whose quantized endpoints land closest to the fitted ones
+            float aPError[2][2] = {};
+            for (uint32_t e = 0; e < 2; ++e)
+            {
+                for (int p = 0; p < 2; ++p)
+                {
+                    for (uint32_t ch = 0; ch < 4; ++ch)
+                    {
+                        if (channelMask & (1u << ch))
+                        {
+                            const int q = QuantizeBC7Channel(aFitted[e][ch], uBits, p);
+                            const float fDiff = float(UnquantizeBC7((q << 1) | p, uBits + 1)) - aFitted[e][ch];
+                            aPError[e][p] += fDiff * fDiff;
+                        }
+                    }
+                }
+            }
+
+            if (uPBits == 1)
+            {
+                const int p = (aPError[0][1] + aPError[1][1] < aPError[0][0] + aPError[1][0]) ? 1 : 0;
+                aCandidates[0][0] = aCandidates[0][1] = p;
+            }
+            else
+            {
+                aCandidates[0][0] = (aPError[0][1] < aPError[0][0]) ? 1 : 0;
+                aCandidates[0][1] = (aPError[1][1] < aPError[1][0]) ? 1 : 0;
+            }
+            uCandidates = 1;
+        }
+
+        const int* aWeights = GetBC7Weights(uIndexBits);
+        const uint32_t uCount = 1u << uIndexBits;
+        for (size_t candidate = 0; candidate < uCandidates; ++candidate)
+        {
+            BC7FastSubset subset;
+            for (uint32_t e = 0; e < 2; ++e)
+            {
+                subset.aPBits[e] = std::max(0, aCandidates[candidate][e]);
+                for (uint32_t ch = 0; ch < 4; ++ch)
+                    subset.aEndPts[e][ch] = (channelMask & (1u << ch)) ? QuantizeBC7Channel(aFitted[e][ch], uBits, aCandidates[candidate][e]) : 0;
+            }
+
+            int aColor0[4], aColor1[4];
+            ExpandBC7EndPoint(subset, 0, channelMask, uBits, uPBits != 0, aColor0);
+            ExpandBC7EndPoint(subset, 1, channelMask, uBits, uPBits != 0, aColor1);
+
+            int aPalette[BC7_MAX_INDICES][4];
+            for (uint32_t k = 0; k < uCount; ++k)
+            {
+                for (uint32_t ch = 0; ch < 4; ++ch)
+                    aPalette[k][ch] = (aColor0[ch] * (BC67_WEIGHT_MAX - aWeights[k]) + aColor1[ch] * aWeights[k] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT;
+            }
+
+            subset.uError = FindBC7Indices(block, pixelMask, channelMask, aPalette, uCount, subset.aIndices);
+            if (subset.uError < result.uError)
+                result = subset;
+        }
+    }
+
+    uint32_t EncodeBC7Subset(
+        const BC7FastBlock& block,
+        uint32_t pixelMask,
+        uint32_t channelMask,
+        uint32_t uBits,
+        uint32_t uPBits,
+        uint32_t uIndexBits,
+        const BC7FastProfile& profile,
+        BC7FastSubset& result) noexcept
+    {
+        float aFitted[2][4];
+        FitBC7EndPoints(block, pixelMask, channelMask, aFitted);
+
+        result.uError = UINT32_MAX;
+        for (uint32_t refit = 0; ; ++refit)
+        {
+            TryBC7EndPoints(block, pixelMask, channelMask, uBits, uPBits, uIndexBits, profile, aFitted, result);
+            if (refit == profile.uRefits || result.uError == 0)
+                break;
+
+            if (!RefitBC7EndPoints(block, pixelMask, channelMask, result.aIndices, uIndexBits, aFitted))
+                break;
+        }
+        return result.uError;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // The uBest shapes of a multi-subset mode with the lowest estimated error, lowest first
+    void RankBC7Shapes(
+        const BC7FastBlock& block,
+        uint32_t uSubsets,
+        uint32_t uShapes,
+        uint32_t uBest,
+        uint32_t channelMask,
+        uint32_t aRanked[BC7_MAX_SHAPES]) noexcept
+    {
+        BC7FastMoments total;
+        AccumulateBC7Moments(block, 0xFFFF, total);
+
+        float afEstimate[BC7_MAX_SHAPES];
+        for (uint32_t shape = 0; shape < uShapes; ++shape)
+        {
+            // A single power iteration ranks about as well as a converged axis. The last subset
+            // gets the moments the others leave from the whole block.
+            BC7FastMoments last = total;
+            float aMean[4], aAxis[4];
+            afEstimate[shape] = 0.0f;
+            for (uint32_t s = 0; s + 1 < uSubsets; ++s)
+            {
+                BC7FastMoments moments;
+                AccumulateBC7Moments(block, GetBC7SubsetMask(uSubsets, shape, s), moments);
+                afEstimate[shape] += ComputeBC7Axis(moments, channelMask, 1, aMean, aAxis);
+
+                for (uint32_t j = 0; j < 16; ++j)
+                    last.aValues[j] -= moments.aValues[j];
+            }
+            afEstimate[shape] += ComputeBC7Axis(last, channelMask, 1, aMean, aAxis);
+            aRanked[shape] = shape;
+        }
+
+        std::partial_sort(aRanked, aRanked + uBest, aRanked + uShapes, [&](uint32_t a, uint32_t b)
+        {
+            return afEstimate[a] != afEstimate[b] ? afEstimate[a] < afEstimate[b] : a < b;
+        });
+    }
+
+    void EncodeBC7Mode(
+        const BC7FastBlock& block,
+        uint32_t uMode,
+        uint32_t uShape,
+        uint32_t uRotation,
+        uint32_t uIndexMode,
+        const BC7FastProfile& profile,
+        BC7FastCandidate& result) noexcept
+    {
+        const BC7FastMode& mode = g_aBC7FastModes[uMode];
+        result.uMode = uMode;
+        result.uShape = uShape;
+        result.uRotation = uRotation;
+        result.uIndexMode = uIndexMode;
+        result.uError = 0;
+
+        if (mode.uIndexBits2)
+        {
+            const uint32_t uColorIndexBits = uIndexMode ? mode.uIndexBits2 : mode.uIndexBits;
+            const uint32_t uAlphaIndexBits = uIndexMode ? mode.uIndexBits : mode.uIndexBits2;
+            result.uError += EncodeBC7Subset(block, 0xFFFF, 0x7, mode.uColorBits, 0, uColorIndexBits, profile, result.aSubsets[0]);
+            result.uError += EncodeBC7Subset(block, 0xFFFF, 0x8, mode.uAlphaBits, 0, uAlphaIndexBits, profile, result.alpha);
+            return;
+        }
+
+        const uint32_t channelMask = mode.uAlphaBits ? 0xF : 0x7;
+        for (uint32_t s = 0; s < mode.uSubsets; ++s)
+        {
+            const uint32_t pixelMask = mode.uSubsets > 1 ? GetBC7SubsetMask(mode.uSubsets, uShape, s) : 0xFFFF;
+            result.uError += EncodeBC7Subset(block, pixelMask, channelMask, mode.uColorBits, mode.uPBits, mode.uIndexBits, profile, result.aSubsets[s]);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // The anchor index of each subset drops its top bit, so it must be in the lower half of
+    // the palette. Swapping the endpoints mirrors the indices.
+    void FixBC7Anchor(BC7FastSubset& subset, uint32_t pixelMask, uint32_t uAnchor, uint32_t uIndexBits) noexcept
+    {
+        const uint32_t uMax = (1u << uIndexBits) - 1;
+        if (!(subset.aIndices[uAnchor] >> (uIndexBits - 1)))
+            return;
+
+        for (uint32_t ch = 0; ch < 4; ++ch)
+            std::swap(subset.aEndPts[0][ch], subset.aEndPts[1][ch]);
+        std::swap(subset.aPBits[0], subset.aPBits[1]);
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (pixelMask & (1u << i))
+                subset.aIndices[i] = uint8_t(uMax - subset.aIndices[i]);
+        }
+    }
+
+    class BC7FastBitWriter
+    {
+    public:
+        explicit BC7FastBitWriter(uint8_t* pBC) noexcept : m_pBC(pBC), m_uOffset(0) { memset(pBC, 0, 16); }
+
+        void Write(uint32_t value, uint32_t uBits) noexcept
+        {
+            for (uint32_t i = 0; i < uBits; ++i, ++m_uOffset)
+            {
+                assert(m_uOffset < 128);
+                m_pBC[m_uOffset >> 3] |= uint8_t(((value >> i) & 1u) << (m_uOffset & 7));
+            }
+        }
+
+    private:
+        uint8_t* m_pBC;
+        uint32_t m_uOffset;
+    };
+
+    void PackBC7Fast(uint8_t* pBC, const BC7FastCandidate& candidate) noexcept
+    {
+        const BC7FastMode& mode = g_aBC7FastModes[candidate.uMode];
+        BC7FastSubset aSubsets[BC7_MAX_REGIONS];
+        BC7FastSubset alpha = candidate.alpha;
+        uint32_t aPixelMasks[BC7_MAX_REGIONS];
+        uint32_t aAnchors[BC7_MAX_REGIONS];
+        uint32_t uColorIndexBits = mode.uIndexBits;
+        for (uint32_t s = 0; s < mode.uSubsets; ++s)
+        {
+            aSubsets[s] = candidate.aSubsets[s];
+            aPixelMasks[s] = mode.uSubsets > 1 ? GetBC7SubsetMask(mode.uSubsets, candidate.uShape, s) : 0xFFFF;
+            aAnchors[s] = s ? g_aFixUp[mode.uSubsets - 1][candidate.uShape][s] : 0;
+        }
+
+        if (mode.uIndexBits2)
+        {
+            uColorIndexBits = candidate.uIndexMode ? mode.uIndexBits2 : mode.uIndexBits;
+            FixBC7Anchor(alpha, 0xFFFF, 0, candidate.uIndexMode ? mode.uIndexBits : mode.uIndexBits2);
+        }
+        for (uint32_t s = 0; s < mode.uSubsets; ++s)
+            FixBC7Anchor(aSubsets[s], aPixelMasks[s], aAnchors[s], uColorIndexBits);
+
+        BC7FastBitWriter writer(pBC);
+        writer.Write(1u << candidate.uMode, candidate.uMode + 1);
+        writer.Write(candidate.uShape, mode.uPartitionBits);
+        writer.Write(candidate.uRotation, mode.uRotationBits);
+        writer.Write(candidate.uIndexMode, mode.uIndexModeBits);
+
+        for (uint32_t ch = 0; ch < 3; ++ch)
+        {
+            for (uint32_t s = 0; s < mode.uSubsets; ++s)
+            {
+                writer.Write(uint32_t(aSubsets[s].aEndPts[0][ch]), mode.uColorBits);
+                writer.Write(uint32_t(aSubsets[s].aEndPts[1][ch]), mode.uColorBits);
+            }
+        }
+
+        if (mode.uAlphaBits)
+        {
+            for (uint32_t s = 0; s < mode.uSubsets; ++s)
+            {
+                const BC7FastSubset& source = mode.uIndexBits2 ? alpha : aSubsets[s];
+                writer.Write(uint32_t(source.aEndPts[0][3]), mode.uAlphaBits);
+                writer.Write(uint32_t(source.aEndPts[1][3]), mode.uAlphaBits);
+            }
+        }
+
+        for (uint32_t s = 0; s < mode.uSubsets; ++s)
+        {
+            if (mode.uPBits == 2)
+            {
+                writer.Write(uint32_t(aSubsets[s].aPBits[0]), 1);
+                writer.Write(uint32_t(aSubsets[s].aPBits[1]), 1);
+            }
+            else if (mode.uPBits == 1)
+            {
+                writer.Write(uint32_t(aSubsets[s].aPBits[0]), 1);
+            }
+        }
+
+        // Index mode 1 moves the color indices to the second set
+        const bool bSwapSets = mode.uIndexBits2 && candidate.uIndexMode;
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const uint32_t s = mode.uSubsets > 1 ? g_aPartitionTable[mode.uSubsets - 1][candidate.uShape][i] : 0;
+            const uint32_t uIndex = bSwapSets ? alpha.aIndices[i] : aSubsets[s].aIndices[i];
+            writer.Write(uIndex, i == aAnchors[s] ? mode.uIndexBits - 1u : mode.uIndexBits);
+        }
+
+        if (mode.uIndexBits2)
+        {
+            for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                const uint32_t uIndex = bSwapSets ? aSubsets[0].aIndices[i] : alpha.aIndices[i];
+                writer.Write(uIndex, i ? mode.uIndexBits2 : mode.uIndexBits2 - 1u);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Returns the squared error of the encoded block
+    uint32_t EncodeBC7Fast(uint8_t* pBC, const uint8_t aPixels[NUM_PIXELS_PER_BLOCK][4], const BC7FastProfile& profile) noexcept
+    {
+        BC7FastBlock block;
+        block.bOpaque = true;
+        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            for (uint32_t ch = 0; ch < 4; ++ch)
+                block.aPixels[i][ch] = aPixels[i][ch];
+            block.bOpaque &= (aPixels[i][3] == 255);
+        }
+        InitBC7FastBlock(block);
+
+        BC7FastCandidate best = {};
+        BC7FastCandidate candidate;
+        best.uError = UINT32_MAX;
+        for (uint32_t uMode = 0; uMode < 8 && best.uError > 0; ++uMode)
+        {
+            if (!(profile.uModes & (1u << uMode)))
+                continue;
+
+            const BC7FastMode& mode = g_aBC7FastModes[uMode];
+
+            // Modes 0 to 3 decode opaque alpha, and the other 2 subset modes cover opaque blocks better than mode 7
+            if ((!block.bOpaque && uMode < 4) || (block.bOpaque && uMode == 7))
+                continue;
+
+            if (mode.uSubsets > 1)
+            {
+                const uint32_t uShapes = 1u << mode.uPartitionBits;
+                const uint32_t uTried = std::min(uShapes, mode.uSubsets == 2 ? profile.uShapes2 : profile.uShapes3);
+                if (!uTried)
+                    continue;
+
+                uint32_t aRanked[BC7_MAX_SHAPES];
+                RankBC7Shapes(block, mode.uSubsets, uShapes, uTried, mode.uAlphaBits ? 0xF : 0x7, aRanked);
+                for (uint32_t i = 0; i < uTried && best.uError > 0; ++i)
+                {
+                    EncodeBC7Mode(block, uMode, aRanked[i], 0, 0, profile, candidate);
+                    if (candidate.uError < best.uError)
+                        best = candidate;
+                }
+            }
+            else if (mode.uRotationBits)
+            {
+                const uint32_t uRotations = profile.bAllRotations ? 4u : 1u;
+                for (uint32_t uRotation = 0; uRotation < uRotations && best.uError > 0; ++uRotation)
+                {
+                    // The decoder swaps alpha back with the rotated channel
+                    BC7FastBlock rotated = block;
+                    if (uRotation)
+                    {
+                        for (uint32_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                            std::swap(rotated.aPixels[i][uRotation - 1], rotated.aPixels[i][3]);
+                        InitBC7FastBlock(rotated);
+                    }
+
+                    for (uint32_t uIndexMode = 0; uIndexMode < (1u << mode.uIndexModeBits); ++uIndexMode)
+                    {
+                        EncodeBC7Mode(rotated, uMode, 0, uRotation, uIndexMode, profile, candidate);
+                        if (candidate.uError < best.uError)
+                            best = candidate;
+                    }
+                }
+            }
+            else
+            {
+                EncodeBC7Mode(block, uMode, 0, 0, 0, profile, candidate);
+                if (candidate.uError < best.uError)
+                    best = candidate;
+            }
+        }
+
+        assert(best.uError != UINT32_MAX);
+        PackBC7Fast(pBC, best);
+        return best.uError;
+    }
+}
+
+
 //=====================================================================================
 // Entry points
 //=====================================================================================
@@ -3564,3 +4427,26 @@ void DirectX::D3DXEncodeBC7(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags
     static_assert(sizeof(D3DX_BC7) == 16, "D3DX_BC7 should be 16 bytes");
     reinterpret_cast<D3DX_BC7*>(pBC)->Encode(flags, reinterpret_cast<const HDRColorA*>(pColor));
 }
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC7Fast(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    // Ultrafast to slow are 1 to 4
+    const uint32_t uProfile = std::min<uint32_t>((flags & BC_FLAGS_BC7_PROFILE_MASK) / BC_FLAGS_BC7_ULTRAFAST, 4u);
+    assert(uProfile > 0);
+
+    uint8_t aPixels[NUM_PIXELS_PER_BLOCK][4];
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        XMUBYTEN4 pixel;
+        XMStoreUByteN4(&pixel, pColor[i]);
+        aPixels[i][0] = pixel.x;
+        aPixels[i][1] = pixel.y;
+        aPixels[i][2] = pixel.z;
+        aPixels[i][3] = pixel.w;
+    }
+
+    EncodeBC7Fast(pBC, aPixels, g_aBC7FastProfiles[uProfile ? uProfile - 1 : 0]);
+}
@@ -0,0 +1,686 @@
+//-------------------------------------------------------------------------------------
+// BCFast.cpp
+//
+// Integer block-compression for BC1, BC3, BC4 and BC5, trading the quality of the
+// reference encoders in BC.cpp and BC4BC5.cpp for throughput
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include "BC.h"
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // Constants
+    //-------------------------------------------------------------------------------------
+
+    // Index of each selection level, counted from the first endpoint to the second one
+    const uint8_t g_aBC1Indices4[4] = { 0, 2, 3, 1 };
+    const uint8_t g_aBC1Indices3[3] = { 0, 2, 1 };
+
+    // Index of each selection level, counted from the smallest endpoint, which BC4 stores second
+    const uint8_t g_aBC4Indices[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+
+    // Least squares refits of BC_FLAGS_FAST_REFINE
+    const uint32_t c_uRefinePasses = 2;
+
+
+    //-------------------------------------------------------------------------------------
+    // Structures
+    //-------------------------------------------------------------------------------------
+
+    struct BCFastBlock
+    {
+        XM_ALIGNED_DATA(16) uint8_t aPixels[NUM_PIXELS_PER_BLOCK][4];
+    };
+
+    // 565 endpoints able to interpolate each 8-bit value exactly, or as close as they get,
+    // at 1/3 of the way between them. Used for blocks of a single color.
+    struct BC1SingleColorTable
+    {
+        uint8_t aRB[256][2];
+        uint8_t aG[256][2];
+
+        BC1SingleColorTable() noexcept
+        {
+            Build(aRB, 5);
+            Build(aG, 6);
+        }
+
+        static void Build(uint8_t aTable[256][2], int bits) noexcept
+        {
+            const int count = 1 << bits;
+            for (int value = 0; value < 256; ++value)
+            {
+                int bestError = 256;
+                for (int e0 = 0; e0 < count; ++e0)
+                {
+                    for (int e1 = 0; e1 < count; ++e1)
+                    {
+                        const int v0 = Expand(e0, bits);
+                        const int v1 = Expand(e1, bits);
+                        const int error = abs((2 * v0 + v1 + 1) / 3 - value);
+                        if (error < bestError)
+                        {
+                            bestError = error;
+                            aTable[value][0] = static_cast<uint8_t>(e0);
+                            aTable[value][1] = static_cast<uint8_t>(e1);
+                        }
+                    }
+                }
+            }
+        }
+
+        static int Expand(int value, int bits) noexcept
+        {
+            return (value << (8 - bits)) | (value >> (2 * bits - 8));
+        }
+    };
+
+
+    //-------------------------------------------------------------------------------------
+    // Helpers
+    //-------------------------------------------------------------------------------------
+
+    void LoadBCFastBlock(const XMVECTOR* pColor, BCFastBlock& block) noexcept
+    {
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(block.aPixels[i]), pColor[i]);
+        }
+    }
+
+    inline uint16_t EncodeBC565(const int aColor[3]) noexcept
+    {
+        const int r = (aColor[0] * 31 + 127) / 255;
+        const int g = (aColor[1] * 63 + 127) / 255;
+        const int b = (aColor[2] * 31 + 127) / 255;
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    inline void DecodeBC565(uint16_t w565, int aColor[3]) noexcept
+    {
+        const int r = (w565 >> 11) & 31;
+        const int g = (w565 >> 5) & 63;
+        const int b = w565 & 31;
+        aColor[0] = (r << 3) | (r >> 2);
+        aColor[1] = (g << 2) | (g >> 4);
+        aColor[2] = (b << 3) | (b >> 2);
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // BC1 color
+    //-------------------------------------------------------------------------------------
+
+    // Selection level of every pixel along the segment between the decoded endpoints: its
+    // projection is compared against the projections of the midpoints between palette entries,
+    // all scaled so they stay integers. uLevels is 4 for the 4 color palette and 3 for the
+    // 3 color one.
+    void FindBC1Levels(const BCFastBlock& block, const int aEndPts[2][3], uint32_t uLevels, int aLevels[NUM_PIXELS_PER_BLOCK]) noexcept
+    {
+        const int aDir[3] = { aEndPts[1][0] - aEndPts[0][0], aEndPts[1][1] - aEndPts[0][1], aEndPts[1][2] - aEndPts[0][2] };
+        const int iStart = aEndPts[0][0] * aDir[0] + aEndPts[0][1] * aDir[1] + aEndPts[0][2] * aDir[2];
+        const int iLength = aDir[0] * aDir[0] + aDir[1] * aDir[1] + aDir[2] * aDir[2];
+        if (iLength == 0)
+        {
+            memset(aLevels, 0, sizeof(int) * NUM_PIXELS_PER_BLOCK);
+            return;
+        }
+
+        // Midpoints are at odd multiples of 1/6 of the segment for 4 levels, of 1/4 for 3 levels
+        const int iScale = (uLevels == 4) ? 6 : 4;
+        int aThresholds[3];
+        for (uint32_t k = 0; k < uLevels - 1; ++k)
+        {
+            aThresholds[k] = iScale * iStart + int(2 * k + 1) * iLength;
+        }
+
+#if defined(_XM_SSE_INTRINSICS_)
+        const __m128i vDir = _mm_setr_epi16(short(aDir[0]), short(aDir[1]), short(aDir[2]), 0, short(aDir[0]), short(aDir[1]), short(aDir[2]), 0);
+        const __m128i vZero = _mm_setzero_si128();
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; i += 4)
+        {
+            const __m128i vPixels = _mm_load_si128(reinterpret_cast<const __m128i*>(block.aPixels[i]));
+
+            // Two pixels per register: r*dr + g*dg and b*db in each 32-bit pair, then summed pairwise
+            const __m128i vLo = _mm_madd_epi16(_mm_unpacklo_epi8(vPixels, vZero), vDir);
+            const __m128i vHi = _mm_madd_epi16(_mm_unpackhi_epi8(vPixels, vZero), vDir);
+            const __m128i vEven = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(vLo), _mm_castsi128_ps(vHi), _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i vOdd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(vLo), _mm_castsi128_ps(vHi), _MM_SHUFFLE(3, 1, 3, 1)));
+            const __m128i vDot = _mm_add_epi32(vEven, vOdd);
+
+            __m128i vScaled = _mm_slli_epi32(vDot, 2);
+            if (iScale == 6)
+                vScaled = _mm_add_epi32(vScaled, _mm_slli_epi32(vDot, 1));
+
+            __m128i vLevel = vZero;
+            for (uint32_t k = 0; k < uLevels - 1; ++k)
+            {
+                vLevel = _mm_sub_epi32(vLevel, _mm_cmpgt_epi32(vScaled, _mm_set1_epi32(aThresholds[k] - 1)));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(aLevels + i), vLevel);
+        }
+#else
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const int iDot = block.aPixels[i][0] * aDir[0] + block.aPixels[i][1] * aDir[1] + block.aPixels[i][2] * aDir[2];
+            int iLevel = 0;
+            for (uint32_t k = 0; k < uLevels - 1; ++k)
+            {
+                iLevel += (iScale * iDot >= aThresholds[k]) ? 1 : 0;
+            }
+            aLevels[i] = iLevel;
+        }
+#endif
+    }
+
+    // Squared error of the pixels in uMask against the palette entries their levels select
+    uint32_t ComputeBC1Error(const BCFastBlock& block, uint32_t uMask, const int aEndPts[2][3], uint32_t uLevels, const int aLevels[NUM_PIXELS_PER_BLOCK]) noexcept
+    {
+        int aPalette[4][3];
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            const int e0 = aEndPts[0][ch];
+            const int e1 = aEndPts[1][ch];
+            if (uLevels == 4)
+            {
+                aPalette[0][ch] = e0;
+                aPalette[1][ch] = (2 * e0 + e1 + 1) / 3;
+                aPalette[2][ch] = (e0 + 2 * e1 + 1) / 3;
+                aPalette[3][ch] = e1;
+            }
+            else
+            {
+                aPalette[0][ch] = e0;
+                aPalette[1][ch] = (e0 + e1 + 1) / 2;
+                aPalette[2][ch] = e1;
+            }
+        }
+
+        uint32_t uError = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (uMask & (1u << i))
+            {
+                const int* pEntry = aPalette[aLevels[i]];
+                const int dr = block.aPixels[i][0] - pEntry[0];
+                const int dg = block.aPixels[i][1] - pEntry[1];
+                const int db = block.aPixels[i][2] - pEntry[2];
+                uError += uint32_t(dr * dr + dg * dg + db * db);
+            }
+        }
+        return uError;
+    }
+
+    // Endpoints of the pixels in uMask: the two of them projecting furthest along the principal axis,
+    // found with a few power iterations over the integer covariance seeded with the bounding box diagonal
+    void FindBC1EndPoints(const BCFastBlock& block, uint32_t uMask, int aEndPts[2][3]) noexcept
+    {
+        int iCount = 0;
+        int aSum[3] = {};
+        int aMin[3] = { 255, 255, 255 };
+        int aMax[3] = {};
+        int aProducts[6] = {};
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (!(uMask & (1u << i)))
+                continue;
+
+            const int r = block.aPixels[i][0];
+            const int g = block.aPixels[i][1];
+            const int b = block.aPixels[i][2];
+            ++iCount;
+            aSum[0] += r; aSum[1] += g; aSum[2] += b;
+            aMin[0] = std::min(aMin[0], r); aMin[1] = std::min(aMin[1], g); aMin[2] = std::min(aMin[2], b);
+            aMax[0] = std::max(aMax[0], r); aMax[1] = std::max(aMax[1], g); aMax[2] = std::max(aMax[2], b);
+            aProducts[0] += r * r; aProducts[1] += r * g; aProducts[2] += r * b;
+            aProducts[3] += g * g; aProducts[4] += g * b; aProducts[5] += b * b;
+        }
+
+        // Covariance scaled by the squared pixel count
+        const float fCov[6] =
+        {
+            float(iCount * aProducts[0] - aSum[0] * aSum[0]),
+            float(iCount * aProducts[1] - aSum[0] * aSum[1]),
+            float(iCount * aProducts[2] - aSum[0] * aSum[2]),
+            float(iCount * aProducts[3] - aSum[1] * aSum[1]),
+            float(iCount * aProducts[4] - aSum[1] * aSum[2]),
+            float(iCount * aProducts[5] - aSum[2] * aSum[2]),
+        };
+
+        float fAxis[3] = { float(aMax[0] - aMin[0]), float(aMax[1] - aMin[1]), float(aMax[2] - aMin[2]) };
+        for (size_t iteration = 0; iteration < 4; ++iteration)
+        {
+            const float r = fCov[0] * fAxis[0] + fCov[1] * fAxis[1] + fCov[2] * fAxis[2];
+            const float g = fCov[1] * fAxis[0] + fCov[3] * fAxis[1] + fCov[4] * fAxis[2];
+            const float b = fCov[2] * fAxis[0] + fCov[4] * fAxis[1] + fCov[5] * fAxis[2];
+            const float fMax = std::max(std::max(fabsf(r), fabsf(g)), fabsf(b));
+            if (fMax < FLT_MIN)
+                break;
+
+            fAxis[0] = r / fMax;
+            fAxis[1] = g / fMax;
+            fAxis[2] = b / fMax;
+        }
+
+        // Projections in 1/1024 steps of the axis, compared as integers
+        const int aAxis[3] = { int(fAxis[0] * 1024.0f), int(fAxis[1] * 1024.0f), int(fAxis[2] * 1024.0f) };
+        int iMinDot = 1 << 30;
+        int iMaxDot = -(1 << 30);
+        size_t uMinPixel = 0;
+        size_t uMaxPixel = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (!(uMask & (1u << i)))
+                continue;
+
+            const int iDot = block.aPixels[i][0] * aAxis[0] + block.aPixels[i][1] * aAxis[1] + block.aPixels[i][2] * aAxis[2];
+            if (iDot < iMinDot)
+            {
+                iMinDot = iDot;
+                uMinPixel = i;
+            }
+            if (iDot > iMaxDot)
+            {
+                iMaxDot = iDot;
+                uMaxPixel = i;
+            }
+        }
+
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            aEndPts[0][ch] = block.aPixels[uMaxPixel][ch];
+            aEndPts[1][ch] = block.aPixels[uMinPixel][ch];
+        }
+    }
+
+    // Least squares endpoints for the levels the pixels in uMask selected
+    bool RefitBC1EndPoints(const BCFastBlock& block, uint32_t uMask, uint32_t uLevels, const int aLevels[NUM_PIXELS_PER_BLOCK], int aEndPts[2][3]) noexcept
+    {
+        const float fStep = 1.0f / float(uLevels - 1);
+        float fAA = 0.0f;
+        float fAB = 0.0f;
+        float fBB = 0.0f;
+        float fA[3] = {};
+        float fB[3] = {};
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            if (!(uMask & (1u << i)))
+                continue;
+
+            const float t = float(aLevels[i]) * fStep;
+            const float s = 1.0f - t;
+            fAA += s * s;
+            fAB += s * t;
+            fBB += t * t;
+            for (size_t ch = 0; ch < 3; ++ch)
+            {
+                fA[ch] += s * float(block.aPixels[i][ch]);
+                fB[ch] += t * float(block.aPixels[i][ch]);
+            }
+        }
+
+        const float fDet = fAA * fBB - fAB * fAB;
+        if (fabsf(fDet) < 1e-6f)
+            return false;
+
+        const float fInvDet = 1.0f / fDet;
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            const float e0 = (fBB * fA[ch] - fAB * fB[ch]) * fInvDet;
+            const float e1 = (fAA * fB[ch] - fAB * fA[ch]) * fInvDet;
+            aEndPts[0][ch] = std::min(std::max(int(e0 + 0.5f), 0), 255);
+            aEndPts[1][ch] = std::min(std::max(int(e1 + 0.5f), 0), 255);
+        }
+        return true;
+    }
+
+    // Quantizes the endpoints, then selects the levels of every pixel and measures the error of those in uMask
+    uint32_t QuantizeBC1EndPoints(const BCFastBlock& block, uint32_t uMask, uint32_t uLevels,
+        const int aEndPts[2][3], uint16_t aEndPts565[2], int aLevels[NUM_PIXELS_PER_BLOCK]) noexcept
+    {
+        int aDecoded[2][3];
+        for (size_t e = 0; e < 2; ++e)
+        {
+            aEndPts565[e] = EncodeBC565(aEndPts[e]);
+            DecodeBC565(aEndPts565[e], aDecoded[e]);
+        }
+
+        FindBC1Levels(block, aDecoded, uLevels, aLevels);
+        return ComputeBC1Error(block, uMask, aDecoded, uLevels, aLevels);
+    }
+
+    // Color part of a BC1 or BC3 block. The pixels in uTransparent get the transparent index of the
+    // 3 color palette, BC3 passes none so it always gets the 4 color one.
+    void EncodeBC1Fast(D3DX_BC1* pBC, const BCFastBlock& block, uint32_t uTransparent, bool bRefine) noexcept
+    {
+        const uint32_t uOpaque = ~uTransparent & 0xFFFF;
+        const uint32_t uLevels = uTransparent ? 3 : 4;
+        const uint8_t* pIndices = uTransparent ? g_aBC1Indices3 : g_aBC1Indices4;
+
+        if (!uOpaque)
+        {
+            pBC->rgb[0] = 0;
+            pBC->rgb[1] = 0;
+            pBC->bitmap = 0xFFFFFFFF;
+            return;
+        }
+
+        uint16_t aEndPts565[2];
+        int aLevels[NUM_PIXELS_PER_BLOCK];
+
+        // Single color in the 4 color palette: endpoints interpolating it at a third of the way
+        bool bSingleColor = !uTransparent;
+        for (size_t i = 1; i < NUM_PIXELS_PER_BLOCK && bSingleColor; ++i)
+        {
+            bSingleColor = (block.aPixels[i][0] == block.aPixels[0][0])
+                && (block.aPixels[i][1] == block.aPixels[0][1])
+                && (block.aPixels[i][2] == block.aPixels[0][2]);
+        }
+
+        if (bSingleColor)
+        {
+            static const BC1SingleColorTable s_table;
+            const uint8_t* pR = s_table.aRB[block.aPixels[0][0]];
+            const uint8_t* pG = s_table.aG[block.aPixels[0][1]];
+            const uint8_t* pB = s_table.aRB[block.aPixels[0][2]];
+            aEndPts565[0] = static_cast<uint16_t>((pR[0] << 11) | (pG[0] << 5) | pB[0]);
+            aEndPts565[1] = static_cast<uint16_t>((pR[1] << 11) | (pG[1] << 5) | pB[1]);
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                aLevels[i] = 1;
+            }
+        }
+        else
+        {
+            int aEndPts[2][3];
+            FindBC1EndPoints(block, uOpaque, aEndPts);
+            uint32_t uError = QuantizeBC1EndPoints(block, uOpaque, uLevels, aEndPts, aEndPts565, aLevels);
+
+            for (uint32_t pass = 0; bRefine && pass < c_uRefinePasses && uError > 0; ++pass)
+            {
+                int aRefined[2][3];
+                if (!RefitBC1EndPoints(block, uOpaque, uLevels, aLevels, aRefined))
+                    break;
+
+                uint16_t aRefined565[2];
+                int aRefinedLevels[NUM_PIXELS_PER_BLOCK];
+                const uint32_t uRefinedError = QuantizeBC1EndPoints(block, uOpaque, uLevels, aRefined, aRefined565, aRefinedLevels);
+                if (uRefinedError >= uError)
+                    break;
+
+                uError = uRefinedError;
+                aEndPts565[0] = aRefined565[0];
+                aEndPts565[1] = aRefined565[1];
+                memcpy(aLevels, aRefinedLevels, sizeof(aLevels));
+            }
+        }
+
+        // The first endpoint is the largest for the 4 color palette, the smallest for the 3 color one.
+        // Swapping them swaps the palette around, equal ones decode to a single color anyway.
+        bool bSwap = false;
+        if (uLevels == 4)
+        {
+            if (aEndPts565[0] == aEndPts565[1])
+            {
+                memset(aLevels, 0, sizeof(aLevels));
+            }
+            bSwap = aEndPts565[0] < aEndPts565[1];
+        }
+        else
+        {
+            bSwap = aEndPts565[0] > aEndPts565[1];
+        }
+
+        uint32_t uBitmap = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            uint32_t uIndex = 3;
+            if (uOpaque & (1u << i))
+            {
+                const int iLevel = bSwap ? int(uLevels) - 1 - aLevels[i] : aLevels[i];
+                uIndex = pIndices[iLevel];
+            }
+            uBitmap |= uIndex << (2 * i);
+        }
+
+        pBC->rgb[0] = bSwap ? aEndPts565[1] : aEndPts565[0];
+        pBC->rgb[1] = bSwap ? aEndPts565[0] : aEndPts565[1];
+        pBC->bitmap = uBitmap;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // BC4 channel
+    //-------------------------------------------------------------------------------------
+
+    // Selection level of every value between the lo and hi endpoints out of 8, values outside of
+    // them get the nearest endpoint. 14 * (value - lo) is compared against odd multiples of hi - lo,
+    // which stays within 16 bits.
+    void FindBC4Levels(const uint8_t aValues[NUM_PIXELS_PER_BLOCK], int lo, int hi, uint8_t aLevels[NUM_PIXELS_PER_BLOCK]) noexcept
+    {
+        const int iRange = hi - lo;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        const __m128i vValues = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aValues));
+        const __m128i vZero = _mm_setzero_si128();
+        const __m128i vLo = _mm_set1_epi16(short(lo));
+        const __m128i vScale = _mm_set1_epi16(14);
+        const __m128i vOffsets[2] =
+        {
+            _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(vValues, vZero), vLo), vScale),
+            _mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(vValues, vZero), vLo), vScale),
+        };
+
+        __m128i vLevels[2] = { vZero, vZero };
+        for (int k = 1; k < 8; ++k)
+        {
+            const __m128i vThreshold = _mm_set1_epi16(short((2 * k - 1) * iRange - 1));
+            vLevels[0] = _mm_sub_epi16(vLevels[0], _mm_cmpgt_epi16(vOffsets[0], vThreshold));
+            vLevels[1] = _mm_sub_epi16(vLevels[1], _mm_cmpgt_epi16(vOffsets[1], vThreshold));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aLevels), _mm_packus_epi16(vLevels[0], vLevels[1]));
+#else
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const int iOffset = 14 * (int(aValues[i]) - lo);
+            uint8_t uLevel = 0;
+            for (int k = 1; k < 8; ++k)
+            {
+                uLevel += (iOffset >= (2 * k - 1) * iRange) ? 1 : 0;
+            }
+            aLevels[i] = uLevel;
+        }
+#endif
+    }
+
+    uint32_t ComputeBC4Error(const uint8_t aValues[NUM_PIXELS_PER_BLOCK], int lo, int hi, const uint8_t aLevels[NUM_PIXELS_PER_BLOCK]) noexcept
+    {
+        uint32_t uError = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const int iValue = (aLevels[i] * hi + (7 - aLevels[i]) * lo + 3) / 7;
+            const int iDiff = int(aValues[i]) - iValue;
+            uError += uint32_t(iDiff * iDiff);
+        }
+        return uError;
+    }
+
+    // Least squares endpoints for the levels the values selected, false when they collapse
+    bool RefitBC4EndPoints(const uint8_t aValues[NUM_PIXELS_PER_BLOCK], const uint8_t aLevels[NUM_PIXELS_PER_BLOCK], int& lo, int& hi) noexcept
+    {
+        float fAA = 0.0f;
+        float fAB = 0.0f;
+        float fBB = 0.0f;
+        float fA = 0.0f;
+        float fB = 0.0f;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const float t = float(aLevels[i]) * (1.0f / 7.0f);
+            const float s = 1.0f - t;
+            fAA += s * s;
+            fAB += s * t;
+            fBB += t * t;
+            fA += s * float(aValues[i]);
+            fB += t * float(aValues[i]);
+        }
+
+        const float fDet = fAA * fBB - fAB * fAB;
+        if (fabsf(fDet) < 1e-6f)
+            return false;
+
+        const float fInvDet = 1.0f / fDet;
+        lo = std::min(std::max(int((fBB * fA - fAB * fB) * fInvDet + 0.5f), 0), 255);
+        hi = std::min(std::max(int((fAA * fB - fAB * fA) * fInvDet + 0.5f), 0), 255);
+        return hi > lo;
+    }
+
+    // BC4 block of one 8-bit channel, always in the 8 value mode with the channel extremes as endpoints
+    void EncodeBC4Fast(uint8_t* pBC, const uint8_t aValues[NUM_PIXELS_PER_BLOCK], bool bRefine) noexcept
+    {
+        int lo;
+        int hi;
+#if defined(_XM_SSE_INTRINSICS_)
+        const __m128i vValues = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aValues));
+        __m128i vMin = _mm_min_epu8(vValues, _mm_srli_si128(vValues, 8));
+        __m128i vMax = _mm_max_epu8(vValues, _mm_srli_si128(vValues, 8));
+        vMin = _mm_min_epu8(vMin, _mm_srli_si128(vMin, 4));
+        vMax = _mm_max_epu8(vMax, _mm_srli_si128(vMax, 4));
+        vMin = _mm_min_epu8(vMin, _mm_srli_si128(vMin, 2));
+        vMax = _mm_max_epu8(vMax, _mm_srli_si128(vMax, 2));
+        vMin = _mm_min_epu8(vMin, _mm_srli_si128(vMin, 1));
+        vMax = _mm_max_epu8(vMax, _mm_srli_si128(vMax, 1));
+        lo = _mm_cvtsi128_si32(vMin) & 0xFF;
+        hi = _mm_cvtsi128_si32(vMax) & 0xFF;
+#else
+        lo = 255;
+        hi = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            lo = std::min<int>(lo, aValues[i]);
+            hi = std::max<int>(hi, aValues[i]);
+        }
+#endif
+
+        uint8_t aLevels[NUM_PIXELS_PER_BLOCK] = {};
+        if (hi > lo)
+        {
+            FindBC4Levels(aValues, lo, hi, aLevels);
+
+            uint32_t uError = bRefine ? ComputeBC4Error(aValues, lo, hi, aLevels) : 0;
+            for (uint32_t pass = 0; bRefine && pass < c_uRefinePasses && uError > 0; ++pass)
+            {
+                int refinedLo;
+                int refinedHi;
+                if (!RefitBC4EndPoints(aValues, aLevels, refinedLo, refinedHi))
+                    break;
+
+                uint8_t aRefinedLevels[NUM_PIXELS_PER_BLOCK];
+                FindBC4Levels(aValues, refinedLo, refinedHi, aRefinedLevels);
+                const uint32_t uRefinedError = ComputeBC4Error(aValues, refinedLo, refinedHi, aRefinedLevels);
+                if (uRefinedError >= uError)
+                    break;
+
+                uError = uRefinedError;
+                lo = refinedLo;
+                hi = refinedHi;
+                memcpy(aLevels, aRefinedLevels, sizeof(aLevels));
+            }
+        }
+
+        // Equal endpoints select the 6 value mode, where index 0 still decodes to the first endpoint
+        uint64_t uBitmap = 0;
+        if (hi > lo)
+        {
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                uBitmap |= uint64_t(g_aBC4Indices[aLevels[i]]) << (3 * i);
+            }
+        }
+
+        pBC[0] = static_cast<uint8_t>(hi);
+        pBC[1] = static_cast<uint8_t>(lo);
+        for (size_t i = 0; i < 6; ++i)
+        {
+            pBC[2 + i] = static_cast<uint8_t>(uBitmap >> (8 * i));
+        }
+    }
+
+    void EncodeBC4FastChannel(uint8_t* pBC, const BCFastBlock& block, size_t uChannel, bool bRefine) noexcept
+    {
+        uint8_t aValues[NUM_PIXELS_PER_BLOCK];
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            aValues[i] = block.aPixels[i][uChannel];
+        }
+        EncodeBC4Fast(pBC, aValues, bRefine);
+    }
+}
+
+
+//=====================================================================================
+// Entry points
+//=====================================================================================
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC1Fast(uint8_t *pBC, const XMVECTOR *pColor, float threshold, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    BCFastBlock block;
+    LoadBCFastBlock(pColor, block);
+
+    uint32_t uTransparent = 0;
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        if (XMVectorGetW(pColor[i]) < threshold)
+            uTransparent |= 1u << i;
+    }
+
+    EncodeBC1Fast(reinterpret_cast<D3DX_BC1*>(pBC), block, uTransparent, (flags & BC_FLAGS_FAST_REFINE) != 0);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3Fast(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    BCFastBlock block;
+    LoadBCFastBlock(pColor, block);
+
+    const bool bRefine = (flags & BC_FLAGS_FAST_REFINE) != 0;
+    auto pBC3 = reinterpret_cast<D3DX_BC3*>(pBC);
+    EncodeBC4FastChannel(pBC, block, 3, bRefine);
+    EncodeBC1Fast(&pBC3->bc1, block, 0, bRefine);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC4UFast(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    BCFastBlock block;
+    LoadBCFastBlock(pColor, block);
+
+    EncodeBC4FastChannel(pBC, block, 0, (flags & BC_FLAGS_FAST_REFINE) != 0);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC5UFast(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    BCFastBlock block;
+    LoadBCFastBlock(pColor, block);
+
+    const bool bRefine = (flags & BC_FLAGS_FAST_REFINE) != 0;
+    EncodeBC4FastChannel(pBC, block, 0, bRefine);
+    EncodeBC4FastChannel(pBC + 8, block, 1, bRefine);
+}
@@ -551,6 +551,10 @@ namespace DirectX
         TEX_FILTER_FLOAT_X2BIAS     = 0x200,
             // Enable *2 - 1 conversion cases for unorm<->float and positive-only float formats
 
+        TEX_FILTER_BOX_INTEGER      = 0x400,
+            // Box mipmaps of 8-bit UNORM (non-sRGB) formats average in integers, rounding halves up
+            // Faster, but a texel can be 1 off the default float path, which rounds halves to even
+
         TEX_FILTER_RGB_COPY_RED     = 0x1000,
         TEX_FILTER_RGB_COPY_GREEN   = 0x2000,
         TEX_FILTER_RGB_COPY_BLUE    = 0x4000,
@@ -570,6 +574,10 @@ namespace DirectX
         TEX_FILTER_TRIANGLE         = 0x500000,
             // Filtering mode to use for any required image resizing
 
+        TEX_FILTER_LANCZOS3         = 0x600000,
+        TEX_FILTER_MITCHELL         = 0x700000,
+            // Resize only: 3-lobe windowed sinc, and Mitchell-Netravali cubic (B = C = 1/3), both widened when shrinking
+
         TEX_FILTER_SRGB_IN          = 0x1000000,
         TEX_FILTER_SRGB_OUT         = 0x2000000,
         TEX_FILTER_SRGB             = (TEX_FILTER_SRGB_IN | TEX_FILTER_SRGB_OUT),
@@ -582,6 +590,12 @@ namespace DirectX
 
         TEX_FILTER_FORCE_WIC        = 0x20000000,
             // Forces use of the WIC path even when logic would have picked a non-WIC path when both are an option
+
+        TEX_FILTER_PARALLEL         = 0x40000000,
+            // The non-WIC mipmap generation, resizing and conversion fast paths are free to use multithreading (by default they do not use multithreading)
+            // Shares one pool of worker threads, one per hardware thread, working on bands of rows of every array slice of a level at once
+            // (on whole array slices for TEX_FILTER_TRIANGLE mipmaps, 3D volume mipmaps are not threaded, one image at a time for conversions)
+            // Decompress and EvaluateImage honor it as well
     };
 
     constexpr unsigned long TEX_FILTER_DITHER_MASK  = 0xF0000;
@@ -683,24 +697,62 @@ namespace DirectX
         TEX_COMPRESS_BC7_QUICK          = 0x100000,
             // Minimal modes (usually mode 6) for BC7 compression
 
+        TEX_COMPRESS_BC7_ULTRAFAST      = 0x200000,
+        TEX_COMPRESS_BC7_FAST           = 0x400000,
+        TEX_COMPRESS_BC7_BASIC          = 0x600000,
+        TEX_COMPRESS_BC7_SLOW           = 0x800000,
+        TEX_COMPRESS_BC7_PROFILE_MASK   = 0xE00000,
+            // Integer BC7 encoder instead of the exhaustive one, from fastest to best quality; BC7_QUICK and BC7_USE_3SUBSETS are ignored
+            // Ultrafast only uses mode 6, fast adds modes 1, 5 and 7 on a few shapes, basic adds modes 3 and 4, slow tries every mode and shape
+
         TEX_COMPRESS_SRGB_IN            = 0x1000000,
         TEX_COMPRESS_SRGB_OUT           = 0x2000000,
         TEX_COMPRESS_SRGB               = (TEX_COMPRESS_SRGB_IN | TEX_COMPRESS_SRGB_OUT),
             // if the input format type is IsSRGB(), then SRGB_IN is on by default
             // if the output format type is IsSRGB(), then SRGB_OUT is on by default
 
+        TEX_COMPRESS_BC_FAST            = 0x4000000,
+            // Integer encoders for BC1, BC3, BC4_UNORM and BC5_UNORM: principal axis endpoints on 8-bit pixels and
+            // table driven indices; dithering and perceptual weighting are ignored, BC2 and the SNORM formats are unaffected
+
+        TEX_COMPRESS_BC_FAST_REFINE     = 0x8000000,
+            // Adds least squares endpoint refinement passes to TEX_COMPRESS_BC_FAST
+
         TEX_COMPRESS_PARALLEL           = 0x10000000,
             // Compress is free to use multithreading to improve performance (by default it does not use multithreading)
+            // Shares one pool of worker threads, one per hardware thread, working on tiles of block rows of every image at once
     };
 
+    typedef std::function<bool __cdecl(size_t blocksDone, size_t blockCount)> TEX_COMPRESS_PROGRESS;
+        // Called on the thread that called Compress, between tiles and once all blocks are done
+        // Returning false cancels the compression: the remaining tiles are skipped and Compress returns E_ABORT
+        // Must not throw
+
     HRESULT __cdecl Compress(
         _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold,
         _Out_ ScratchImage& cImage) noexcept;
     HRESULT __cdecl Compress(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold, _Out_ ScratchImage& cImages) noexcept;
+    HRESULT __cdecl Compress(
+        _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold,
+        _Out_ ScratchImage& cImage, _In_opt_ const TEX_COMPRESS_PROGRESS& progress) noexcept;
+    HRESULT __cdecl Compress(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold, _Out_ ScratchImage& cImages,
+        _In_opt_ const TEX_COMPRESS_PROGRESS& progress) noexcept;
         // Note that threshold is only used by BC1. TEX_THRESHOLD_DEFAULT is a typical value to use
 
+    HRESULT __cdecl RateDistortionOptimize(
+        _In_ const Image& srcImage, _In_ const Image& cImage, _In_ TEX_COMPRESS_FLAGS compress, _In_ float lambda) noexcept;
+    HRESULT __cdecl RateDistortionOptimize(
+        _In_reads_(nimages) const Image* srcImages, _In_reads_(nimages) const Image* cImages, _In_ size_t nimages,
+        _In_ TEX_COMPRESS_FLAGS compress, _In_ float lambda) noexcept;
+        // Rewrites in place the blocks Compress made out of srcImage, so that a byte oriented LZ compressor shrinks them further
+        // A block becomes a copy of one of the 32 before it or of the ones above, or takes the index bits of one (BC1 to BC5),
+        // when the error it adds, squared and in 8-bit units, is below lambda times the bits it saves. 0 leaves the blocks as they are
+        // compress only supplies the TEX_COMPRESS_SRGB flags given to Compress
+
 #if defined(__d3d11_h__) || defined(__d3d11_x_h__)
     HRESULT __cdecl Compress(
         _In_ ID3D11Device* pDevice, _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress,
@@ -715,6 +767,12 @@ namespace DirectX
     HRESULT __cdecl Decompress(
         _In_reads_(nimages) const Image* cImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ DXGI_FORMAT format, _Out_ ScratchImage& images) noexcept;
+    HRESULT __cdecl Decompress(
+        _In_ const Image& cImage, _In_ DXGI_FORMAT format, _In_ TEX_FILTER_FLAGS filter, _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl Decompress(
+        _In_reads_(nimages) const Image* cImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DXGI_FORMAT format, _In_ TEX_FILTER_FLAGS filter, _Out_ ScratchImage& images) noexcept;
+        // filter only honors TEX_FILTER_PARALLEL, which decodes tiles of block rows of every image at once
 
     //---------------------------------------------------------------------------------
     // Normal map operations
@@ -785,6 +843,10 @@ namespace DirectX
         CMSE_IMAGE1_X2_BIAS         = 0x100,
         CMSE_IMAGE2_X2_BIAS         = 0x200,
             // Indicates that image should be scaled and biased before comparison (i.e. UNORM -> SNORM)
+
+        CMSE_PARALLEL               = 0x1000,
+            // Shares one pool of worker threads, one per hardware thread, working on bands of rows (and decompressing BC inputs the same way)
+            // Bands and the order their sums are added in do not depend on it, so neither does the result
     };
 
     HRESULT __cdecl ComputeMSE(_In_ const Image& image1, _In_ const Image& image2, _Out_ float& mse, _Out_writes_opt_(4) float* mseV, _In_ CMSE_FLAGS flags = CMSE_DEFAULT) noexcept;
@@ -795,6 +857,16 @@ namespace DirectX
     HRESULT __cdecl EvaluateImage(
         _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc);
+    HRESULT __cdecl EvaluateImage(
+        _In_ const Image& image,
+        _In_ std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc,
+        _In_ TEX_FILTER_FLAGS filter);
+    HRESULT __cdecl EvaluateImage(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc,
+        _In_ TEX_FILTER_FLAGS filter);
+        // filter only honors TEX_FILTER_PARALLEL: pixelFunc is then called from several threads at once, on bands of rows
+        // of one image at a time, in no particular order. It must be thread safe; an exception it throws fails with E_FAIL
 
     HRESULT __cdecl TransformImage(
         _In_ const Image& image,
@@ -11,10 +11,8 @@
 
 #include "DirectXTexP.h"
 
-#ifdef _OPENMP
-#include <omp.h>
-#pragma warning(disable : 4616 6993)
-#endif
+#include <atomic>
+#include <vector>
 
 #include "BC.h"
 
@@ -30,7 +28,15 @@ namespace
         static_assert(static_cast<int>(TEX_COMPRESS_UNIFORM) == static_cast<int>(BC_FLAGS_UNIFORM), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_USE_3SUBSETS) == static_cast<int>(BC_FLAGS_USE_3SUBSETS), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUICK) == static_cast<int>(BC_FLAGS_FORCE_BC7_MODE6), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
-        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6));
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_ULTRAFAST) == static_cast<int>(BC_FLAGS_BC7_ULTRAFAST), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_FAST) == static_cast<int>(BC_FLAGS_BC7_FAST), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_BASIC) == static_cast<int>(BC_FLAGS_BC7_BASIC), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_SLOW) == static_cast<int>(BC_FLAGS_BC7_SLOW), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC7_PROFILE_MASK) == static_cast<int>(BC_FLAGS_BC7_PROFILE_MASK), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC_FAST) == static_cast<int>(BC_FLAGS_FAST), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_BC_FAST_REFINE) == static_cast<int>(BC_FLAGS_FAST_REFINE), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6 | BC_FLAGS_BC7_PROFILE_MASK
+            | BC_FLAGS_FAST | BC_FLAGS_FAST_REFINE));
     }
 
     inline TEX_FILTER_FLAGS GetSRGBFlags(_In_ TEX_COMPRESS_FLAGS compress) noexcept
@@ -66,11 +72,110 @@ namespace
         return true;
     }
 
+    inline bool DetermineDecoderSettings(_In_ DXGI_FORMAT format, _Out_ BC_DECODE& pfDecode, _Out_ size_t& blocksize) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    pfDecode = D3DXDecodeBC1;   blocksize = 8;   break;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    pfDecode = D3DXDecodeBC2;   blocksize = 16;  break;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    pfDecode = D3DXDecodeBC3;   blocksize = 16;  break;
+        case DXGI_FORMAT_BC4_UNORM:         pfDecode = D3DXDecodeBC4U;  blocksize = 8;   break;
+        case DXGI_FORMAT_BC4_SNORM:         pfDecode = D3DXDecodeBC4S;  blocksize = 8;   break;
+        case DXGI_FORMAT_BC5_UNORM:         pfDecode = D3DXDecodeBC5U;  blocksize = 16;  break;
+        case DXGI_FORMAT_BC5_SNORM:         pfDecode = D3DXDecodeBC5S;  blocksize = 16;  break;
+        case DXGI_FORMAT_BC6H_UF16:         pfDecode = D3DXDecodeBC6HU; blocksize = 16;  break;
+        case DXGI_FORMAT_BC6H_SF16:         pfDecode = D3DXDecodeBC6HS; blocksize = 16;  break;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    pfDecode = D3DXDecodeBC7;   blocksize = 16;  break;
+        default:                            pfDecode = nullptr;         blocksize = 0;   return false;
+        }
+
+        return true;
+    }
+
 
     //-------------------------------------------------------------------------------------
+    // Loads the 4x4 block of pixels at sptr, replicating the edge pixels of a partial block
+    bool LoadBlock(
+        _Out_writes_(16) XMVECTOR* temp,
+        const uint8_t* sptr,
+        const uint8_t* pEnd,
+        size_t rowPitch,
+        DXGI_FORMAT format,
+        size_t pw,
+        size_t ph) noexcept
+    {
+        ptrdiff_t bytesLeft = pEnd - sptr;
+        assert(bytesLeft > 0);
+        size_t bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft));
+        if (!_LoadScanline(&temp[0], pw, sptr, bytesToRead, format))
+            return false;
+
+        if (ph > 1)
+        {
+            bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch);
+            if (!_LoadScanline(&temp[4], pw, sptr + rowPitch, bytesToRead, format))
+                return false;
+
+            if (ph > 2)
+            {
+                bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 2);
+                if (!_LoadScanline(&temp[8], pw, sptr + rowPitch * 2, bytesToRead, format))
+                    return false;
+
+                if (ph > 3)
+                {
+                    bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 3);
+                    if (!_LoadScanline(&temp[12], pw, sptr + rowPitch * 3, bytesToRead, format))
+                        return false;
+                }
+            }
+        }
+
+        if (pw != 4 || ph != 4)
+        {
+            // Replicate pixels for partial block
+            static const size_t uSrc[] = { 0, 0, 0, 1 };
+
+            if (pw < 4)
+            {
+                for (size_t t = 0; t < ph && t < 4; ++t)
+                {
+                    for (size_t s = pw; s < 4; ++s)
+                    {
+#pragma prefast(suppress: 26000, "PREFAST false positive")
+                        temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
+                    }
+                }
+            }
+
+            if (ph < 4)
+            {
+                for (size_t t = ph; t < 4; ++t)
+                {
+                    for (size_t s = 0; s < 4; ++s)
+                    {
+#pragma prefast(suppress: 26000, "PREFAST false positive")
+                        temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Compresses the rows of 4x4 blocks [blockRowBegin, blockRowEnd)
     HRESULT CompressBC(
         const Image& image,
         const Image& result,
+        size_t blockRowBegin,
+        size_t blockRowEnd,
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
         float threshold) noexcept
@@ -95,7 +200,7 @@ namespace
         // Round to bytes
         sbpp = (sbpp + 7) / 8;
 
-        uint8_t *pDest = result.pixels;
+        uint8_t *pDest = result.pixels + result.rowPitch * blockRowBegin;
 
         // Determine BC format encoder
         BC_ENCODE pfEncode;
@@ -104,11 +209,28 @@ namespace
         if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
             return HRESULT_E_NOT_SUPPORTED;
 
+        if (pfEncode == D3DXEncodeBC7 && (bcflags & BC_FLAGS_BC7_PROFILE_MASK))
+            pfEncode = D3DXEncodeBC7Fast;
+
+        // BC1 takes the alpha threshold, so it is not a BC_ENCODE
+        auto pfEncodeBC1 = D3DXEncodeBC1;
+        if (bcflags & BC_FLAGS_FAST)
+        {
+            pfEncodeBC1 = D3DXEncodeBC1Fast;
+            if (pfEncode == D3DXEncodeBC3)
+                pfEncode = D3DXEncodeBC3Fast;
+            else if (pfEncode == D3DXEncodeBC4U)
+                pfEncode = D3DXEncodeBC4UFast;
+            else if (pfEncode == D3DXEncodeBC5U)
+                pfEncode = D3DXEncodeBC5UFast;
+        }
+
         XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-        const uint8_t *pSrc = image.pixels;
-        const uint8_t *pEnd = image.pixels + image.slicePitch;
         const size_t rowPitch = image.rowPitch;
-        for (size_t h = 0; h < image.height; h += 4)
+        const uint8_t *pSrc = image.pixels + rowPitch * 4 * blockRowBegin;
+        const uint8_t *pEnd = image.pixels + image.slicePitch;
+        const size_t hEnd = std::min<size_t>(image.height, blockRowEnd * 4);
+        for (size_t h = blockRowBegin * 4; h < hEnd; h += 4)
         {
             const uint8_t *sptr = pSrc;
             uint8_t* dptr = pDest;
@@ -119,69 +241,15 @@ namespace
                 size_t pw = std::min<size_t>(4, image.width - w);
                 assert(pw > 0 && ph > 0);
 
-                ptrdiff_t bytesLeft = pEnd - sptr;
-                assert(bytesLeft > 0);
-                size_t bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft));
-                if (!_LoadScanline(&temp[0], pw, sptr, bytesToRead, format))
+                if (!LoadBlock(temp, sptr, pEnd, rowPitch, format, pw, ph))
                     return E_FAIL;
 
-                if (ph > 1)
-                {
-                    bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch);
-                    if (!_LoadScanline(&temp[4], pw, sptr + rowPitch, bytesToRead, format))
-                        return E_FAIL;
-
-                    if (ph > 2)
-                    {
-                        bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 2);
-                        if (!_LoadScanline(&temp[8], pw, sptr + rowPitch * 2, bytesToRead, format))
-                            return E_FAIL;
-
-                        if (ph > 3)
-                        {
-                            bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 3);
-                            if (!_LoadScanline(&temp[12], pw, sptr + rowPitch * 3, bytesToRead, format))
-                                return E_FAIL;
-                        }
-                    }
-                }
-
-                if (pw != 4 || ph != 4)
-                {
-                    // Replicate pixels for partial block
-                    static const size_t uSrc[] = { 0, 0, 0, 1 };
-
-                    if (pw < 4)
-                    {
-                        for (size_t t = 0; t < ph && t < 4; ++t)
-                        {
-                            for (size_t s = pw; s < 4; ++s)
-                            {
-#pragma prefast(suppress: 26000, "PREFAST false positive")
-                                temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
-                            }
-                        }
-                    }
-
-                    if (ph < 4)
-                    {
-                        for (size_t t = ph; t < 4; ++t)
-                        {
-                            for (size_t s = 0; s < 4; ++s)
-                            {
-#pragma prefast(suppress: 26000, "PREFAST false positive")
-                                temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
-                            }
-                        }
-                    }
-                }
-
                 _ConvertScanline(temp, 16, result.format, format, cflags | srgb);
 
                 if (pfEncode)
                     pfEncode(dptr, temp, bcflags);
                 else
-                    D3DXEncodeBC1(dptr, temp, threshold, bcflags);
+                    pfEncodeBC1(dptr, temp, threshold, bcflags);
 
                 sptr += sbpp * 4;
                 dptr += blocksize;
@@ -194,15 +262,165 @@ namespace
         return S_OK;
     }
 
+    //-------------------------------------------------------------------------------------
+    // Rows of blocks compressed by one task. A few hundred blocks keep the scheduling cost low,
+    // and a tile reads contiguous source rows and writes a contiguous range of blocks.
+    constexpr size_t c_BlocksPerTile = 256;
+
+    struct BCTile
+    {
+        size_t image;
+        size_t blockRowBegin;
+        size_t blockRowEnd;
+        size_t blocks;
+    };
+
+    // Splits every image into tiles of whole block rows, in image order
+    HRESULT GetTiles(
+        const Image* images,
+        size_t nimages,
+        std::vector<BCTile>& tiles,
+        size_t& blockCount) noexcept
+    {
+        tiles.clear();
+        blockCount = 0;
+        try
+        {
+            for (size_t index = 0; index < nimages; ++index)
+            {
+                const size_t blocksWide = std::max<size_t>(1, (images[index].width + 3) / 4);
+                const size_t blocksHigh = std::max<size_t>(1, (images[index].height + 3) / 4);
+                const size_t rowsPerTile = std::max<size_t>(1, c_BlocksPerTile / blocksWide);
+                for (size_t row = 0; row < blocksHigh; row += rowsPerTile)
+                {
+                    const size_t rowEnd = std::min(blocksHigh, row + rowsPerTile);
+                    tiles.push_back({ index, row, rowEnd, (rowEnd - row) * blocksWide });
+                }
+                blockCount += blocksWide * blocksHigh;
+            }
+        }
+        catch (...)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT CompressBC_Tiled(
+        const Image* srcImages,
+        const Image* destImages,
+        size_t nimages,
+        bool parallel,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float threshold,
+        const TEX_COMPRESS_PROGRESS& progress) noexcept
+    {
+        std::vector<BCTile> tiles;
+        size_t blockCount = 0;
+        HRESULT hr = GetTiles(srcImages, nimages, tiles, blockCount);
+        if (FAILED(hr))
+            return hr;
+
+        std::atomic<size_t> blocksDone(0);
+        std::function<bool()> tileProgress;
+        if (progress)
+        {
+            try
+            {
+                tileProgress = [&]() { return progress(blocksDone.load(), blockCount); };
+            }
+            catch (...)
+            {
+                return E_OUTOFMEMORY;
+            }
+        }
+
+        hr = _ParallelFor(tiles.size(), parallel, [&](size_t tileIndex) -> HRESULT
+            {
+                const BCTile& tile = tiles[tileIndex];
+                const HRESULT tileResult = CompressBC(srcImages[tile.image], destImages[tile.image], tile.blockRowBegin, tile.blockRowEnd,
+                    bcflags, srgb, threshold);
+                blocksDone += tile.blocks;
+                return tileResult;
+            }, tileProgress);
+
+        if (SUCCEEDED(hr) && progress && !progress(blockCount, blockCount))
+            return E_ABORT;
+
+        return hr;
+    }
+
 
     //-------------------------------------------------------------------------------------
-#ifdef _OPENMP
-    HRESULT CompressBC_Parallel(
+    // Rate-distortion optimization. Blocks are rewritten in raster order so that a byte oriented
+    // LZ compressor finds more matches: a block may become a copy of an earlier block, or take the
+    // index bits of one, whenever the error it adds costs less than lambda times the bits it saves.
+    // The rate model is the one of LZ4-like streams: 8 bits per literal byte, and a token plus a
+    // 16-bit offset per match.
+    constexpr size_t c_RDOWindow = 32;              // previous blocks tried, besides the three above
+    constexpr size_t c_RDOMaxDistance = 65535;      // bytes, the furthest a 16-bit offset reaches
+    constexpr float c_RDOLiteralBits = 8.f;
+    constexpr float c_RDOMatchBits = 24.f;
+
+    struct BCField
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    // Index bits the block can take from another one, each one byte aligned and at least 4 bytes long like an
+    // LZ match. BC6H and BC7 have none: where their indices start depends on the mode.
+    size_t GetIndexFields(_In_ DXGI_FORMAT format, _Outptr_result_maybenull_ const BCField*& fields) noexcept
+    {
+        static const BCField s_BC1[] = { { 4, 4 } };
+        static const BCField s_BC2[] = { { 0, 8 }, { 12, 4 } };
+        static const BCField s_BC3[] = { { 2, 6 }, { 12, 4 } };
+        static const BCField s_BC4[] = { { 2, 6 } };
+        static const BCField s_BC5[] = { { 2, 6 }, { 10, 6 } };
+
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    fields = s_BC1; return std::size(s_BC1);
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    fields = s_BC2; return std::size(s_BC2);
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    fields = s_BC3; return std::size(s_BC3);
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:         fields = s_BC4; return std::size(s_BC4);
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:         fields = s_BC5; return std::size(s_BC5);
+        default:                            fields = nullptr; return 0;
+        }
+    }
+
+    // Squared error in 8-bit units over the visible pixels and the channels the format stores
+    float BlockError(
+        _In_reads_(16) const XMVECTOR* source,
+        _In_reads_(16) const XMVECTOR* decoded,
+        FXMVECTOR channels,
+        size_t pw,
+        size_t ph) noexcept
+    {
+        XMVECTOR sum = XMVectorZero();
+        for (size_t y = 0; y < ph; ++y)
+        {
+            for (size_t x = 0; x < pw; ++x)
+            {
+                const XMVECTOR diff = XMVectorMultiply(XMVectorSubtract(source[y * 4 + x], decoded[y * 4 + x]), channels);
+                sum = XMVectorMultiplyAdd(diff, diff, sum);
+            }
+        }
+        return XMVectorGetX(XMVector4Dot(sum, g_XMOne)) * 255.f * 255.f;
+    }
+
+    HRESULT OptimizeBC(
         const Image& image,
         const Image& result,
-        uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
-        float threshold) noexcept
+        float lambda) noexcept
     {
         if (!image.pixels || !result.pixels)
             return E_POINTER;
@@ -224,109 +442,117 @@ namespace
         // Round to bytes
         sbpp = (sbpp + 7) / 8;
 
-        const uint8_t *pEnd = image.pixels + image.slicePitch;
-
-        // Determine BC format encoder
+        // Same conversion of the source pixels as CompressBC, and the matching decoder
         BC_ENCODE pfEncode;
         size_t blocksize;
         TEX_FILTER_FLAGS cflags;
         if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
             return HRESULT_E_NOT_SUPPORTED;
 
-        // Refactored version of loop to support parallel independance
-        const size_t nBlocks = std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+        BC_DECODE pfDecode;
+        if (!DetermineDecoderSettings(result.format, pfDecode, blocksize))
+            return HRESULT_E_NOT_SUPPORTED;
 
-        bool fail = false;
+        const BCField* fields;
+        const size_t fieldCount = GetIndexFields(result.format, fields);
 
-#pragma omp parallel for
-        for (int nb = 0; nb < static_cast<int>(nBlocks); ++nb)
+        XMVECTOR channels;
+        switch (result.format)
         {
-            int nbWidth = std::max<int>(1, int((image.width + 3) / 4));
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:     channels = g_XMIdentityR0; break;
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:     channels = XMVectorAdd(g_XMIdentityR0, g_XMIdentityR1); break;
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:     channels = g_XMOne3; break;
+        default:                        channels = g_XMOne; break;
+        }
 
-            int y = nb / nbWidth;
-            int x = (nb - (y*nbWidth)) * 4;
-            y *= 4;
+        const size_t blocksWide = std::max<size_t>(1, (image.width + 3) / 4);
+        const size_t blocksHigh = std::max<size_t>(1, (image.height + 3) / 4);
 
-            assert((x >= 0) && (x < int(image.width)));
-            assert((y >= 0) && (y < int(image.height)));
+        // Decoded pixels of every block a candidate can come from, then of the source block and of a candidate
+        const size_t ringSize = std::max(c_RDOWindow, blocksWide + 1) + 1;
+        auto scratch = make_AlignedArrayXMVECTOR(uint64_t(ringSize + 2) * 16);
+        if (!scratch)
+            return E_OUTOFMEMORY;
 
-            size_t rowPitch = image.rowPitch;
-            const uint8_t *pSrc = image.pixels + (size_t(y)*rowPitch) + (size_t(x)*sbpp);
+        XMVECTOR* source = scratch.get() + ringSize * 16;
+        XMVECTOR* decoded = source + 16;
 
-            uint8_t *pDest = result.pixels + (size_t(nb)*blocksize);
+        const uint8_t *pEnd = image.pixels + image.slicePitch;
+        for (size_t by = 0; by < blocksHigh; ++by)
+        {
+            const size_t ph = std::min<size_t>(4, image.height - by * 4);
+            for (size_t bx = 0; bx < blocksWide; ++bx)
+            {
+                const size_t pw = std::min<size_t>(4, image.width - bx * 4);
+                const size_t index = by * blocksWide + bx;
+                uint8_t* block = result.pixels + result.rowPitch * by + blocksize * bx;
 
-            size_t ph = std::min<size_t>(4, image.height - size_t(y));
-            size_t pw = std::min<size_t>(4, image.width - size_t(x));
-            assert(pw > 0 && ph > 0);
+                if (!LoadBlock(source, image.pixels + image.rowPitch * 4 * by + sbpp * 4 * bx, pEnd, image.rowPitch, format, pw, ph))
+                    return E_FAIL;
 
-            ptrdiff_t bytesLeft = pEnd - pSrc;
-            assert(bytesLeft > 0);
-            size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
+                _ConvertScanline(source, 16, result.format, format, cflags | srgb);
 
-            XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-            if (!_LoadScanline(&temp[0], pw, pSrc, bytesToRead, format))
-                fail = true;
+                XMVECTOR* current = scratch.get() + (index % ringSize) * 16;
+                pfDecode(current, block);
 
-            if (ph > 1)
-            {
-                bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
-                if (!_LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, format))
-                    fail = true;
+                uint8_t best[16];
+                memcpy(best, block, blocksize);
+                float bestCost = BlockError(source, current, channels, pw, ph) + lambda * c_RDOLiteralBits * float(blocksize);
 
-                if (ph > 2)
+                auto tryCandidate = [&](const uint8_t* bytes, const XMVECTOR* pixels, float bits)
                 {
-                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
-                    if (!_LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, format))
-                        fail = true;
-
-                    if (ph > 3)
+                    const float cost = BlockError(source, pixels, channels, pw, ph) + lambda * bits;
+                    if (cost < bestCost)
                     {
-                        bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
-                        if (!_LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, format))
-                            fail = true;
+                        bestCost = cost;
+                        memcpy(best, bytes, blocksize);
                     }
-                }
-            }
-
-            if (pw != 4 || ph != 4)
-            {
-                // Replicate pixels for partial block
-                static const size_t uSrc[] = { 0, 0, 0, 1 };
+                };
 
-                if (pw < 4)
+                // The last blocks, then the three above for textures wider than the window
+                const size_t above[] = { blocksWide - 1, blocksWide, blocksWide + 1 };
+                for (size_t n = 0; n < c_RDOWindow + std::size(above); ++n)
                 {
-                    for (size_t t = 0; t < ph && t < 4; ++t)
+                    const size_t distance = (n < c_RDOWindow) ? n + 1 : above[n - c_RDOWindow];
+                    if (distance > index || distance * blocksize > c_RDOMaxDistance)
+                        continue;
+                    if (n >= c_RDOWindow && distance <= c_RDOWindow)
+                        continue;
+
+                    const size_t candidateIndex = index - distance;
+                    const uint8_t* candidate = result.pixels + result.rowPitch * (candidateIndex / blocksWide)
+                        + blocksize * (candidateIndex % blocksWide);
+
+                    // A copy of the whole block
+                    tryCandidate(candidate, scratch.get() + (candidateIndex % ringSize) * 16, c_RDOMatchBits);
+
+                    // Its index bits on the endpoints of the block
+                    for (size_t f = 0; f < fieldCount; ++f)
                     {
-                        for (size_t s = pw; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
-                        }
+                        if (memcmp(block + fields[f].offset, candidate + fields[f].offset, fields[f].size) == 0)
+                            continue;
+
+                        uint8_t mixed[16];
+                        memcpy(mixed, block, blocksize);
+                        memcpy(mixed + fields[f].offset, candidate + fields[f].offset, fields[f].size);
+                        pfDecode(decoded, mixed);
+                        tryCandidate(mixed, decoded, c_RDOLiteralBits * float(blocksize - fields[f].size) + c_RDOMatchBits);
                     }
                 }
 
-                if (ph < 4)
+                if (memcmp(best, block, blocksize) != 0)
                 {
-                    for (size_t t = ph; t < 4; ++t)
-                    {
-                        for (size_t s = 0; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
-                        }
-                    }
+                    memcpy(block, best, blocksize);
+                    pfDecode(current, block);
                 }
             }
-
-            _ConvertScanline(temp, 16, result.format, format, cflags | srgb);
-
-            if (pfEncode)
-                pfEncode(pDest, temp, bcflags);
-            else
-                D3DXEncodeBC1(pDest, temp, threshold, bcflags);
         }
 
-        return (fail) ? E_FAIL : S_OK;
+        return S_OK;
     }
-#endif // _OPENMP
 
 
     //-------------------------------------------------------------------------------------
@@ -378,7 +604,12 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
-    HRESULT DecompressBC(_In_ const Image& cImage, _In_ const Image& result) noexcept
+    // Decompresses the rows of 4x4 blocks [blockRowBegin, blockRowEnd)
+    HRESULT DecompressBC(
+        _In_ const Image& cImage,
+        _In_ const Image& result,
+        size_t blockRowBegin,
+        size_t blockRowEnd) noexcept
     {
         if (!cImage.pixels || !result.pixels)
             return E_POINTER;
@@ -400,9 +631,8 @@ namespace
         // Round to bytes
         dbpp = (dbpp + 7) / 8;
 
-        uint8_t *pDest = result.pixels;
-        if (!pDest)
-            return E_POINTER;
+        const size_t rowPitch = result.rowPitch;
+        uint8_t *pDest = result.pixels + rowPitch * 4 * blockRowBegin;
 
         // Promote "typeless" BC formats
         DXGI_FORMAT cformat;
@@ -421,30 +651,13 @@ namespace
         // Determine BC format decoder
         BC_DECODE pfDecode;
         size_t sbpp;
-        switch (cformat)
-        {
-        case DXGI_FORMAT_BC1_UNORM:
-        case DXGI_FORMAT_BC1_UNORM_SRGB:    pfDecode = D3DXDecodeBC1;   sbpp = 8;   break;
-        case DXGI_FORMAT_BC2_UNORM:
-        case DXGI_FORMAT_BC2_UNORM_SRGB:    pfDecode = D3DXDecodeBC2;   sbpp = 16;  break;
-        case DXGI_FORMAT_BC3_UNORM:
-        case DXGI_FORMAT_BC3_UNORM_SRGB:    pfDecode = D3DXDecodeBC3;   sbpp = 16;  break;
-        case DXGI_FORMAT_BC4_UNORM:         pfDecode = D3DXDecodeBC4U;  sbpp = 8;   break;
-        case DXGI_FORMAT_BC4_SNORM:         pfDecode = D3DXDecodeBC4S;  sbpp = 8;   break;
-        case DXGI_FORMAT_BC5_UNORM:         pfDecode = D3DXDecodeBC5U;  sbpp = 16;  break;
-        case DXGI_FORMAT_BC5_SNORM:         pfDecode = D3DXDecodeBC5S;  sbpp = 16;  break;
-        case DXGI_FORMAT_BC6H_UF16:         pfDecode = D3DXDecodeBC6HU; sbpp = 16;  break;
-        case DXGI_FORMAT_BC6H_SF16:         pfDecode = D3DXDecodeBC6HS; sbpp = 16;  break;
-        case DXGI_FORMAT_BC7_UNORM:
-        case DXGI_FORMAT_BC7_UNORM_SRGB:    pfDecode = D3DXDecodeBC7;   sbpp = 16;  break;
-        default:
+        if (!DetermineDecoderSettings(cformat, pfDecode, sbpp))
             return HRESULT_E_NOT_SUPPORTED;
-        }
 
         XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-        const uint8_t *pSrc = cImage.pixels;
-        const size_t rowPitch = result.rowPitch;
-        for (size_t h = 0; h < cImage.height; h += 4)
+        const uint8_t *pSrc = cImage.pixels + cImage.rowPitch * blockRowBegin;
+        const size_t hEnd = std::min<size_t>(cImage.height, blockRowEnd * 4);
+        for (size_t h = blockRowBegin * 4; h < hEnd; h += 4)
         {
             const uint8_t *sptr = pSrc;
             uint8_t* dptr = pDest;
@@ -489,6 +702,27 @@ namespace
 
         return S_OK;
     }
+
+    //-------------------------------------------------------------------------------------
+    // Same tiles as CompressBC_Tiled, the blocks decode independently of one another
+    HRESULT DecompressBC_Tiled(
+        const Image* cImages,
+        const Image* destImages,
+        size_t nimages,
+        bool parallel) noexcept
+    {
+        std::vector<BCTile> tiles;
+        size_t blockCount = 0;
+        HRESULT hr = GetTiles(cImages, nimages, tiles, blockCount);
+        if (FAILED(hr))
+            return hr;
+
+        return _ParallelFor(tiles.size(), parallel, [&](size_t tileIndex) -> HRESULT
+            {
+                const BCTile& tile = tiles[tileIndex];
+                return DecompressBC(cImages[tile.image], destImages[tile.image], tile.blockRowBegin, tile.blockRowEnd);
+            });
+    }
 }
 
 //-------------------------------------------------------------------------------------
@@ -597,6 +831,18 @@ HRESULT DirectX::Compress(
     TEX_COMPRESS_FLAGS compress,
     float threshold,
     ScratchImage& image) noexcept
+{
+    return Compress(srcImage, format, compress, threshold, image, nullptr);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::Compress(
+    const Image& srcImage,
+    DXGI_FORMAT format,
+    TEX_COMPRESS_FLAGS compress,
+    float threshold,
+    ScratchImage& image,
+    const TEX_COMPRESS_PROGRESS& progress) noexcept
 {
     if (IsCompressed(srcImage.format) || !IsCompressed(format))
         return E_INVALIDARG;
@@ -618,18 +864,8 @@ HRESULT DirectX::Compress(
     }
 
     // Compress single image
-    if (compress & TEX_COMPRESS_PARALLEL)
-    {
-#ifndef _OPENMP
-        return E_NOTIMPL;
-#else
-        hr = CompressBC_Parallel(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-#endif // _OPENMP
-    }
-    else
-    {
-        hr = CompressBC(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-    }
+    hr = CompressBC_Tiled(&srcImage, img, 1, (compress & TEX_COMPRESS_PARALLEL) != 0,
+        GetBCFlags(compress), GetSRGBFlags(compress), threshold, progress);
 
     if (FAILED(hr))
         image.Release();
@@ -646,6 +882,20 @@ HRESULT DirectX::Compress(
     TEX_COMPRESS_FLAGS compress,
     float threshold,
     ScratchImage& cImages) noexcept
+{
+    return Compress(srcImages, nimages, metadata, format, compress, threshold, cImages, nullptr);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::Compress(
+    const Image* srcImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DXGI_FORMAT format,
+    TEX_COMPRESS_FLAGS compress,
+    float threshold,
+    ScratchImage& cImages,
+    const TEX_COMPRESS_PROGRESS& progress) noexcept
 {
     if (!srcImages || !nimages)
         return E_INVALIDARG;
@@ -689,32 +939,70 @@ HRESULT DirectX::Compress(
             cImages.Release();
             return E_FAIL;
         }
+    }
 
-        if ((compress & TEX_COMPRESS_PARALLEL))
-        {
-#ifndef _OPENMP
-            return E_NOTIMPL;
-#else
-            if (compress & TEX_COMPRESS_PARALLEL)
-            {
-                hr = CompressBC_Parallel(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-                if (FAILED(hr))
-                {
-                    cImages.Release();
-                    return  hr;
-                }
-            }
-#endif // _OPENMP
-        }
-        else
-        {
-            hr = CompressBC(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-            if (FAILED(hr))
-            {
-                cImages.Release();
-                return hr;
-            }
-        }
+    // Every mip and array slice at once, the small mips fill the gaps left by the large ones
+    hr = CompressBC_Tiled(srcImages, dest, nimages, (compress & TEX_COMPRESS_PARALLEL) != 0,
+        GetBCFlags(compress), GetSRGBFlags(compress), threshold, progress);
+    if (FAILED(hr))
+    {
+        cImages.Release();
+        return hr;
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Rate-distortion optimization
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::RateDistortionOptimize(
+    const Image& srcImage,
+    const Image& cImage,
+    TEX_COMPRESS_FLAGS compress,
+    float lambda) noexcept
+{
+    return RateDistortionOptimize(&srcImage, &cImage, 1, compress, lambda);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::RateDistortionOptimize(
+    const Image* srcImages,
+    const Image* cImages,
+    size_t nimages,
+    TEX_COMPRESS_FLAGS compress,
+    float lambda) noexcept
+{
+    if (!srcImages || !cImages || !nimages || lambda < 0.f)
+        return E_INVALIDARG;
+
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        const Image& src = srcImages[index];
+        const Image& dest = cImages[index];
+
+        if (IsCompressed(src.format) || !IsCompressed(dest.format))
+            return E_INVALIDARG;
+
+        if (IsTypeless(dest.format)
+            || IsTypeless(src.format) || IsPlanar(src.format) || IsPalettized(src.format))
+            return HRESULT_E_NOT_SUPPORTED;
+
+        if (src.width != dest.width || src.height != dest.height)
+            return E_FAIL;
+    }
+
+    if (lambda == 0.f)
+        return S_OK;
+
+    // Each image on its own, as a block only borrows from the blocks before it
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        const HRESULT hr = OptimizeBC(srcImages[index], cImages[index], GetSRGBFlags(compress), lambda);
+        if (FAILED(hr))
+            return hr;
     }
 
     return S_OK;
@@ -729,6 +1017,16 @@ HRESULT DirectX::Decompress(
     const Image& cImage,
     DXGI_FORMAT format,
     ScratchImage& image) noexcept
+{
+    return Decompress(cImage, format, TEX_FILTER_DEFAULT, image);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::Decompress(
+    const Image& cImage,
+    DXGI_FORMAT format,
+    TEX_FILTER_FLAGS filter,
+    ScratchImage& image) noexcept
 {
     if (!IsCompressed(cImage.format) || IsCompressed(format))
         return E_INVALIDARG;
@@ -765,7 +1063,7 @@ HRESULT DirectX::Decompress(
     }
 
     // Decompress single image
-    hr = DecompressBC(cImage, *img);
+    hr = DecompressBC_Tiled(&cImage, img, 1, (filter & TEX_FILTER_PARALLEL) != 0);
     if (FAILED(hr))
         image.Release();
 
@@ -779,6 +1077,18 @@ HRESULT DirectX::Decompress(
     const TexMetadata& metadata,
     DXGI_FORMAT format,
     ScratchImage& images) noexcept
+{
+    return Decompress(cImages, nimages, metadata, format, TEX_FILTER_DEFAULT, images);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::Decompress(
+    const Image* cImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DXGI_FORMAT format,
+    TEX_FILTER_FLAGS filter,
+    ScratchImage& images) noexcept
 {
     if (!cImages || !nimages)
         return E_INVALIDARG;
@@ -842,13 +1152,14 @@ HRESULT DirectX::Decompress(
             images.Release();
             return E_FAIL;
         }
+    }
 
-        hr = DecompressBC(src, dest[index]);
-        if (FAILED(hr))
-        {
-            images.Release();
-            return hr;
-        }
+    // Every mip and array slice at once, like Compress
+    hr = DecompressBC_Tiled(cImages, dest, nimages, (filter & TEX_FILTER_PARALLEL) != 0);
+    if (FAILED(hr))
+    {
+        images.Release();
+        return hr;
     }
 
     return S_OK;
@@ -4693,6 +4693,400 @@ namespace
         return S_OK;
     }
 
+    //-------------------------------------------------------------------------------------
+    // Fast paths for common format pairs, picked before the WIC and generic paths
+    //-------------------------------------------------------------------------------------
+
+    // Pixels of a band of rows, the unit of work handed to the threads
+    constexpr size_t c_FastConvertBandPixels = 65536;
+
+    enum FAST_CONVERT_CLASS : uint32_t
+    {
+        FAST_CONVERT_NONE = 0,
+        FAST_CONVERT_UBYTE4,    // R8G8B8A8_UNORM(_SRGB), B8G8R8A8_UNORM(_SRGB)
+        FAST_CONVERT_HALF4,     // R16G16B16A16_FLOAT
+        FAST_CONVERT_FLOAT4,    // R32G32B32A32_FLOAT
+        FAST_CONVERT_UDEC4,     // R10G10B10A2_UNORM
+    };
+
+    FAST_CONVERT_CLASS GetFastConvertClass(_In_ DXGI_FORMAT format, _Out_ bool& bgr) noexcept
+    {
+        bgr = false;
+        switch (format)
+        {
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            bgr = true;
+            return FAST_CONVERT_UBYTE4;
+
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return FAST_CONVERT_UBYTE4;
+
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return FAST_CONVERT_HALF4;
+
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return FAST_CONVERT_FLOAT4;
+
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            return FAST_CONVERT_UDEC4;
+
+        default:
+            return FAST_CONVERT_NONE;
+        }
+    }
+
+    struct FastConversion;
+
+    typedef void(*FastConvertRow)(const FastConversion& conv, const uint8_t* pSrc, uint8_t* pDest, size_t width);
+
+    // With 4 component formats on both sides and no dithering, each component of a target pixel only depends on one component
+    // of the source pixel. So but for FLOAT4 sources a conversion is a lookup table, made by the generic path itself run over
+    // every value a source component can take, which keeps the results bit-exact with it whatever the flags.
+    struct FastConversion
+    {
+        FastConvertRow              row;
+        size_t                      order[4];   // Source component (byte for UBYTE4) read for each target component (byte)
+        std::unique_ptr<uint8_t[]>  table;      // Target pixel of the generic path for each source value, in every component
+        bool                        srgbIn;     // FLOAT4 sources, replaying _ConvertScanline
+        bool                        srgbOut;
+        bool                        x2bias;
+        bool                        bgr;
+    };
+
+    //--- Rows ---
+    // UBYTE4 -> UBYTE4 with an identity table: bytes are copied, red and blue swapped or not
+    void ConvertRowSwizzleUByte4(const FastConversion& conv, const uint8_t* pSrc, uint8_t* pDest, size_t width)
+    {
+        if (conv.order[0] == 0)
+        {
+            memcpy(pDest, pSrc, width * sizeof(uint32_t));
+            return;
+        }
+
+        size_t x = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        const __m128i maskAG = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+        const __m128i maskBR = _mm_set1_epi32(0x00FF00FF);
+
+        // 4 pixels at a time, red and blue are the low bytes of the two 16-bit halves of a pixel
+        for (; x + 4 <= width; x += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + x * 4));
+            __m128i br = _mm_and_si128(v, maskBR);
+            br = _mm_shufflelo_epi16(br, _MM_SHUFFLE(2, 3, 0, 1));
+            br = _mm_shufflehi_epi16(br, _MM_SHUFFLE(2, 3, 0, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_or_si128(_mm_and_si128(v, maskAG), br));
+        }
+#endif
+
+        auto sPtr = reinterpret_cast<const uint32_t*>(pSrc);
+        auto dPtr = reinterpret_cast<uint32_t*>(pDest);
+        for (; x < width; ++x)
+        {
+            const uint32_t v = sPtr[x];
+            dPtr[x] = (v & 0xFF00FF00) | ((v >> 16) & 0xFF) | ((v & 0xFF) << 16);
+        }
+    }
+
+    // UBYTE4 -> UBYTE4, HALF4 or FLOAT4 through a 256 entries table, T being a target component
+    template<typename T>
+    void ConvertRowUByte4Table(const FastConversion& conv, const uint8_t* pSrc, uint8_t* pDest, size_t width)
+    {
+        auto table = reinterpret_cast<const T*>(conv.table.get());
+        auto dPtr = reinterpret_cast<T*>(pDest);
+        const size_t o0 = conv.order[0];
+        const size_t o1 = conv.order[1];
+        const size_t o2 = conv.order[2];
+        const size_t o3 = conv.order[3];
+        for (size_t x = 0; x < width; ++x, pSrc += 4, dPtr += 4)
+        {
+            dPtr[0] = table[size_t(pSrc[o0]) * 4];
+            dPtr[1] = table[size_t(pSrc[o1]) * 4 + 1];
+            dPtr[2] = table[size_t(pSrc[o2]) * 4 + 2];
+            dPtr[3] = table[size_t(pSrc[o3]) * 4 + 3];
+        }
+    }
+
+    // HALF4 -> UBYTE4 through a 65536 entries table
+    void ConvertRowHalf4ToUByte4(const FastConversion& conv, const uint8_t* pSrc, uint8_t* pDest, size_t width)
+    {
+        const uint8_t* table = conv.table.get();
+        auto sPtr = reinterpret_cast<const uint16_t*>(pSrc);
+        const size_t o0 = conv.order[0];
+        const size_t o1 = conv.order[1];
+        const size_t o2 = conv.order[2];
+        const size_t o3 = conv.order[3];
+        for (size_t x = 0; x < width; ++x, sPtr += 4, pDest += 4)
+        {
+            pDest[0] = table[size_t(sPtr[o0]) * 4];
+            pDest[1] = table[size_t(sPtr[o1]) * 4 + 1];
+            pDest[2] = table[size_t(sPtr[o2]) * 4 + 2];
+            pDest[3] = table[size_t(sPtr[o3]) * 4 + 3];
+        }
+    }
+
+    // HALF4 -> UDEC4 through a 65536 entries table, each component masked out of its packed entry
+    void ConvertRowHalf4ToUDec4(const FastConversion& conv, const uint8_t* pSrc, uint8_t* pDest, size_t width)
+    {
+        auto table = reinterpret_cast<const uint32_t*>(conv.table.get());
+        auto sPtr = reinterpret_cast<const uint16_t*>(pSrc);
+        auto dPtr = reinterpret_cast<uint32_t*>(pDest);
+        for (size_t x = 0; x < width; ++x, sPtr += 4)
+        {
+            dPtr[x] = (table[sPtr[0]] & 0x3FF)
+                | (table[sPtr[1]] & 0xFFC00)
+                | (table[sPtr[2]] & 0x3FF00000)
+                | (table[sPtr[3]] & 0xC0000000);
+        }
+    }
+
+    // UDEC4 -> HALF4 through a 1024 entries table (alpha in the first 4)
+    void ConvertRowUDec4ToHalf4(const FastConversion& conv, const uint8_t* pSrc, uint8_t* pDest, size_t width)
+    {
+        auto table = reinterpret_cast<const uint16_t*>(conv.table.get());
+        auto sPtr = reinterpret_cast<const uint32_t*>(pSrc);
+        auto dPtr = reinterpret_cast<uint16_t*>(pDest);
+        for (size_t x = 0; x < width; ++x, dPtr += 4)
+        {
+            const uint32_t v = sPtr[x];
+            dPtr[0] = table[size_t(v & 0x3FF) * 4];
+            dPtr[1] = table[size_t((v >> 10) & 0x3FF) * 4 + 1];
+            dPtr[2] = table[size_t((v >> 20) & 0x3FF) * 4 + 2];
+            dPtr[3] = table[size_t(v >> 30) * 4 + 3];
+        }
+    }
+
+    // FLOAT4 -> UBYTE4, the steps of _LoadScanline, _ConvertScanline and _StoreScanline one pixel at a time
+    void ConvertRowFloat4ToUByte4(const FastConversion& conv, const uint8_t* pSrc, uint8_t* pDest, size_t width)
+    {
+        auto sPtr = reinterpret_cast<const XMFLOAT4*>(pSrc);
+        auto dPtr = reinterpret_cast<XMUBYTEN4*>(pDest);
+        for (size_t x = 0; x < width; ++x)
+        {
+            XMVECTOR v = XMLoadFloat4(sPtr++);
+
+            if (conv.srgbIn)
+                v = XMColorSRGBToRGB(v);
+
+            if (conv.x2bias)
+            {
+                v = XMVectorClamp(v, g_XMNegativeOne, g_XMOne);
+                v = XMVectorMultiplyAdd(v, g_XMOneHalf, g_XMOneHalf);
+            }
+            else
+            {
+                v = XMVectorSaturate(v);
+            }
+
+            if (conv.srgbOut)
+                v = XMColorRGBToSRGB(v);
+
+            if (conv.bgr)
+                v = XMVectorSwizzle<2, 1, 0, 3>(v);
+
+            v = XMVectorAdd(v, g_8BitBias);
+            XMStoreUByteN4(dPtr++, v);
+        }
+    }
+
+    //--- Dispatch ---
+    struct FastConvertData
+    {
+        FAST_CONVERT_CLASS  sclass;
+        FAST_CONVERT_CLASS  tclass;
+        size_t              tableEntries;   // Source values the table covers, 0 for none
+        FastConvertRow      row;
+    };
+
+    const FastConvertData g_FastConvertTable[] =
+    {
+        { FAST_CONVERT_UBYTE4,  FAST_CONVERT_UBYTE4,    256,    ConvertRowUByte4Table<uint8_t> },
+        { FAST_CONVERT_UBYTE4,  FAST_CONVERT_HALF4,     256,    ConvertRowUByte4Table<uint16_t> },
+        { FAST_CONVERT_UBYTE4,  FAST_CONVERT_FLOAT4,    256,    ConvertRowUByte4Table<uint32_t> },
+        { FAST_CONVERT_HALF4,   FAST_CONVERT_UBYTE4,    65536,  ConvertRowHalf4ToUByte4 },
+        { FAST_CONVERT_HALF4,   FAST_CONVERT_UDEC4,     65536,  ConvertRowHalf4ToUDec4 },
+        { FAST_CONVERT_FLOAT4,  FAST_CONVERT_UBYTE4,    0,      ConvertRowFloat4ToUByte4 },
+        { FAST_CONVERT_UDEC4,   FAST_CONVERT_HALF4,     1024,   ConvertRowUDec4ToHalf4 },
+    };
+
+    // Source pixels with every component set to their index (alpha wrapping around for UDEC4)
+    void FillFastConvertSource(FAST_CONVERT_CLASS sclass, size_t entries, uint8_t* pixels) noexcept
+    {
+        switch (sclass)
+        {
+        case FAST_CONVERT_UBYTE4:
+            for (size_t i = 0; i < entries; ++i)
+                reinterpret_cast<uint32_t*>(pixels)[i] = static_cast<uint32_t>(i) * 0x01010101;
+            break;
+
+        case FAST_CONVERT_HALF4:
+            for (size_t i = 0; i < entries * 4; ++i)
+                reinterpret_cast<uint16_t*>(pixels)[i] = static_cast<uint16_t>(i >> 2);
+            break;
+
+        case FAST_CONVERT_UDEC4:
+            for (size_t i = 0; i < entries; ++i)
+            {
+                auto v = static_cast<uint32_t>(i);
+                reinterpret_cast<uint32_t*>(pixels)[i] = v | (v << 10) | (v << 20) | (v << 30);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Picks the fast path of a conversion and builds its table, false to use the other paths
+    bool PrepareFastConversion(
+        _In_ DXGI_FORMAT sformat,
+        _In_ DXGI_FORMAT tformat,
+        _In_ TEX_FILTER_FLAGS filter,
+        _In_ float threshold,
+        _In_ uint64_t pixels,
+        _Out_ FastConversion& conv) noexcept
+    {
+        conv = {};
+
+        if (filter & (TEX_FILTER_DITHER | TEX_FILTER_DITHER_DIFFUSION | TEX_FILTER_FORCE_WIC))
+        {
+            // Dithering depends on the position of the pixel
+            return false;
+        }
+
+        bool sbgr, tbgr;
+        const FAST_CONVERT_CLASS sclass = GetFastConvertClass(sformat, sbgr);
+        const FAST_CONVERT_CLASS tclass = GetFastConvertClass(tformat, tbgr);
+
+        const FastConvertData* data = nullptr;
+        for (const auto& it : g_FastConvertTable)
+        {
+            if (it.sclass == sclass && it.tclass == tclass)
+            {
+                data = &it;
+                break;
+            }
+        }
+
+        // Building the table runs the generic path over as many pixels as it has entries
+        if (!data || pixels < uint64_t(data->tableEntries) * 2)
+            return false;
+
+        static const size_t s_rgba[4] = { 0, 1, 2, 3 };
+        static const size_t s_bgra[4] = { 2, 1, 0, 3 };
+        const size_t* sorder = sbgr ? s_bgra : s_rgba;
+        const size_t* torder = tbgr ? s_bgra : s_rgba;
+        for (size_t j = 0; j < 4; ++j)
+            conv.order[j] = sorder[torder[j]];
+
+        conv.row = data->row;
+        conv.bgr = tbgr;
+
+        if (!data->tableEntries)
+        {
+            // See _ConvertScanline
+            if (IsSRGB(sformat))
+                filter |= TEX_FILTER_SRGB_IN;
+
+            if (IsSRGB(tformat))
+                filter |= TEX_FILTER_SRGB_OUT;
+
+            if ((filter & (TEX_FILTER_SRGB_IN | TEX_FILTER_SRGB_OUT)) == (TEX_FILTER_SRGB_IN | TEX_FILTER_SRGB_OUT))
+            {
+                filter &= ~(TEX_FILTER_SRGB_IN | TEX_FILTER_SRGB_OUT);
+            }
+
+            conv.srgbIn = (filter & TEX_FILTER_SRGB_IN) != 0;
+            conv.srgbOut = (filter & TEX_FILTER_SRGB_OUT) != 0;
+            conv.x2bias = (filter & TEX_FILTER_FLOAT_X2BIAS) != 0;
+            return true;
+        }
+
+        // Table images are up to 256 pixels wide, which keeps the scanline of the generic path small
+        const size_t entries = data->tableEntries;
+        const size_t width = std::min<size_t>(entries, 256);
+        const size_t sbpp = BitsPerPixel(sformat) / 8;
+        const size_t tbpp = BitsPerPixel(tformat) / 8;
+
+        std::unique_ptr<uint8_t[]> source(new (std::nothrow) uint8_t[entries * sbpp]);
+        conv.table.reset(new (std::nothrow) uint8_t[entries * tbpp]);
+        if (!source || !conv.table)
+            return false;
+
+        FillFastConvertSource(sclass, entries, source.get());
+
+        const Image srcTable = { width, entries / width, sformat, width * sbpp, entries * sbpp, source.get() };
+        const Image destTable = { width, entries / width, tformat, width * tbpp, entries * tbpp, conv.table.get() };
+        if (FAILED(ConvertCustom(srcTable, filter, destTable, threshold, 0)))
+            return false;
+
+        if (sclass == FAST_CONVERT_UBYTE4 && tclass == FAST_CONVERT_UBYTE4)
+        {
+            bool identity = true;
+            for (size_t i = 0; i < entries * 4 && identity; ++i)
+                identity = (conv.table[i] == (i >> 2));
+
+            if (identity)
+            {
+                conv.row = ConvertRowSwizzleUByte4;
+                conv.table.reset();
+            }
+        }
+
+        return true;
+    }
+
+    //--- Bands of rows ---
+    struct FastConvertJob
+    {
+        const Image*            srcImage;
+        const Image*            destImage;
+        const FastConversion*   conv;
+        size_t                  rowsPerBand;
+    };
+
+    HRESULT ConvertUsingFastPath(
+        _In_ const Image& srcImage,
+        _In_ const FastConversion& conv,
+        _In_ TEX_FILTER_FLAGS filter,
+        _In_ const Image& destImage) noexcept
+    {
+        assert(srcImage.width == destImage.width);
+        assert(srcImage.height == destImage.height);
+
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
+
+        if (!srcImage.width || !srcImage.height)
+            return S_OK;
+
+        const FastConvertJob job = { &srcImage, &destImage, &conv, std::max<size_t>(1, c_FastConvertBandPixels / srcImage.width) };
+        const size_t bands = (srcImage.height + job.rowsPerBand - 1) / job.rowsPerBand;
+
+        return _ParallelFor(bands, (filter & TEX_FILTER_PARALLEL) != 0, [&job](size_t band) -> HRESULT
+            {
+                const Image& src = *job.srcImage;
+                const Image& dest = *job.destImage;
+
+                const size_t yBegin = band * job.rowsPerBand;
+                const size_t yEnd = std::min(yBegin + job.rowsPerBand, src.height);
+
+                const uint8_t* pSrc = src.pixels + yBegin * src.rowPitch;
+                uint8_t* pDest = dest.pixels + yBegin * dest.rowPitch;
+                for (size_t y = yBegin; y < yEnd; ++y)
+                {
+                    job.conv->row(*job.conv, pSrc, pDest, src.width);
+                    pSrc += src.rowPitch;
+                    pDest += dest.rowPitch;
+                }
+
+                return S_OK;
+            });
+    }
+
     //-------------------------------------------------------------------------------------
     DXGI_FORMAT _PlanarToSingle(_In_ DXGI_FORMAT format) noexcept
     {
@@ -4886,8 +5280,13 @@ HRESULT DirectX::Convert(
         return E_POINTER;
     }
 
+    FastConversion fast;
     WICPixelFormatGUID pfGUID, targetGUID;
-    if (UseWICConversion(filter, srcImage.format, format, pfGUID, targetGUID))
+    if (PrepareFastConversion(srcImage.format, format, filter, threshold, uint64_t(srcImage.width) * uint64_t(srcImage.height), fast))
+    {
+        hr = ConvertUsingFastPath(srcImage, fast, filter, *rimage);
+    }
+    else if (UseWICConversion(filter, srcImage.format, format, pfGUID, targetGUID))
     {
         hr = ConvertUsingWIC(srcImage, pfGUID, targetGUID, filter, threshold, *rimage);
     }
@@ -4950,8 +5349,18 @@ HRESULT DirectX::Convert(
         return E_POINTER;
     }
 
+    // The table of a fast path is built once for all the images
+    uint64_t pixels = 0;
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        pixels += uint64_t(srcImages[index].width) * uint64_t(srcImages[index].height);
+    }
+
+    FastConversion fast;
+    bool usefast = PrepareFastConversion(metadata.format, format, filter, threshold, pixels, fast);
+
     WICPixelFormatGUID pfGUID, targetGUID;
-    bool usewic = !metadata.IsPMAlpha() && UseWICConversion(filter, metadata.format, format, pfGUID, targetGUID);
+    bool usewic = !usefast && !metadata.IsPMAlpha() && UseWICConversion(filter, metadata.format, format, pfGUID, targetGUID);
 
     switch (metadata.dimension)
     {
@@ -4981,7 +5390,11 @@ HRESULT DirectX::Convert(
                 return E_FAIL;
             }
 
-            if (usewic)
+            if (usefast)
+            {
+                hr = ConvertUsingFastPath(src, fast, filter, dst);
+            }
+            else if (usewic)
             {
                 hr = ConvertUsingWIC(src, pfGUID, targetGUID, filter, threshold, dst);
             }
@@ -5034,7 +5447,11 @@ HRESULT DirectX::Convert(
                     return E_FAIL;
                 }
 
-                if (usewic)
+                if (usefast)
+                {
+                    hr = ConvertUsingFastPath(src, fast, filter, dst);
+                }
+                else if (usewic)
                 {
                     hr = ConvertUsingWIC(src, pfGUID, targetGUID, filter, threshold, dst);
                 }
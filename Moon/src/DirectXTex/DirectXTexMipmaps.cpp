@@ -14,6 +14,7 @@
 #include "filters.h"
 
 using namespace DirectX;
+using namespace DirectX::PackedVector;
 using Microsoft::WRL::ComPtr;
 
 namespace
@@ -680,7 +681,9 @@ namespace
             break;
 
         case TEX_FILTER_TRIANGLE:
-            // WIC does not implement this filter
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            // WIC does not implement these filters
             return false;
         }
 
@@ -889,8 +892,29 @@ namespace
         return S_OK;
     }
 
-    //--- 2D Point Filter ---
-    HRESULT Generate2DMipsPointFilter(size_t levels, const ScratchImage& mipChain, size_t item) noexcept
+    //--- 2D mip levels in bands of rows ---
+    // A level only reads the one above it, so the bands of rows of a level, across every item, are independent
+    constexpr size_t c_MipPixelsPerBand = 16384;
+
+    typedef HRESULT(*MipRowsFunc)(const Image& src, const Image& dest, TEX_FILTER_FLAGS filter, size_t yBegin, size_t yEnd);
+
+    struct MipBand
+    {
+        size_t item;
+        size_t yBegin;
+        size_t yEnd;
+    };
+
+    struct MipBandJob
+    {
+        const ScratchImage* mipChain;
+        size_t level;
+        TEX_FILTER_FLAGS filter;
+        MipRowsFunc rows;
+        std::vector<MipBand> bands;
+    };
+
+    HRESULT Generate2DMipsInBands(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, MipRowsFunc rows) noexcept
     {
         if (!mipChain.GetImages())
             return E_INVALIDARG;
@@ -899,8 +923,60 @@ namespace
 
         assert(levels > 1);
 
-        size_t width = mipChain.GetMetadata().width;
-        size_t height = mipChain.GetMetadata().height;
+        const size_t nitems = mipChain.GetMetadata().arraySize;
+
+        MipBandJob job = { &mipChain, 0, filter, rows, {} };
+
+        for (size_t level = 1; level < levels; ++level)
+        {
+            job.level = level;
+            job.bands.clear();
+
+            try
+            {
+                for (size_t item = 0; item < nitems; ++item)
+                {
+                    const Image* dest = mipChain.GetImage(level, item, 0);
+                    if (!dest)
+                        return E_POINTER;
+
+                    const size_t rowsPerBand = std::max<size_t>(1, c_MipPixelsPerBand / dest->width);
+                    for (size_t y = 0; y < dest->height; y += rowsPerBand)
+                    {
+                        job.bands.push_back({ item, y, std::min(dest->height, y + rowsPerBand) });
+                    }
+                }
+            }
+            catch (...)
+            {
+                return E_OUTOFMEMORY;
+            }
+
+            HRESULT hr = _ParallelFor(job.bands.size(), (filter & TEX_FILTER_PARALLEL) != 0, [&job](size_t index) -> HRESULT
+                {
+                    const MipBand& band = job.bands[index];
+
+                    const Image* src = job.mipChain->GetImage(job.level - 1, band.item, 0);
+                    const Image* dest = job.mipChain->GetImage(job.level, band.item, 0);
+
+                    if (!src || !dest)
+                        return E_POINTER;
+
+                    return job.rows(*src, *dest, job.filter, band.yBegin, band.yEnd);
+                });
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+
+    //--- 2D Point Filter ---
+    HRESULT Generate2DMipRowsPointFilter(const Image& src, const Image& dest, TEX_FILTER_FLAGS, size_t yBegin, size_t yEnd) noexcept
+    {
+        const size_t width = src.width;
+        const size_t height = src.height;
 
         // Allocate temporary space (2 scanlines)
         auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
@@ -911,84 +987,273 @@ namespace
 
         XMVECTOR* row = target + width;
 
-        // Resize base image to each target mip level
-        for (size_t level = 1; level < levels; ++level)
-        {
 #ifdef _DEBUG
-            memset(row, 0xCD, sizeof(XMVECTOR)*width);
+        memset(row, 0xCD, sizeof(XMVECTOR)*width);
 #endif
 
-            // 2D point filter
-            const Image* src = mipChain.GetImage(level - 1, item, 0);
-            const Image* dest = mipChain.GetImage(level, item, 0);
+        // 2D point filter
+        const uint8_t* pSrc = src.pixels;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * yBegin;
 
-            if (!src || !dest)
-                return E_POINTER;
+        size_t rowPitch = src.rowPitch;
 
-            const uint8_t* pSrc = src->pixels;
-            uint8_t* pDest = dest->pixels;
+        size_t nwidth = dest.width;
+        size_t nheight = dest.height;
 
-            size_t rowPitch = src->rowPitch;
+        size_t xinc = (width << 16) / nwidth;
+        size_t yinc = (height << 16) / nheight;
 
-            size_t nwidth = (width > 1) ? (width >> 1) : 1;
-            size_t nheight = (height > 1) ? (height >> 1) : 1;
+        size_t lasty = size_t(-1);
+
+        size_t sy = yinc * yBegin;
+        for (size_t y = yBegin; y < yEnd; ++y)
+        {
+            if ((lasty ^ sy) >> 16)
+            {
+                if (!_LoadScanline(row, width, pSrc + (rowPitch * (sy >> 16)), rowPitch, src.format))
+                    return E_FAIL;
+                lasty = sy;
+            }
+
+            size_t sx = 0;
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                target[x] = row[sx >> 16];
+                sx += xinc;
+            }
+
+            if (!_StoreScanline(pDest, dest.rowPitch, dest.format, target, nwidth))
+                return E_FAIL;
+            pDest += dest.rowPitch;
+
+            sy += yinc;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT Generate2DMipsPointFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    {
+        return Generate2DMipsInBands(levels, filter, mipChain, Generate2DMipRowsPointFilter);
+    }
+
+
+    //--- 2D Box Filter fast paths ---
+    // Average the 2x2 blocks of a pair of source rows straight into a destination row, skipping the XMVECTOR
+    // scanlines of the generic path. row1 is row0 for a level one texel high, and step is 0 for one texel wide.
+    typedef void(*BoxRowFunc)(uint8_t* pDest, const uint8_t* row0, const uint8_t* row1, size_t nwidth, size_t step);
 
-            size_t xinc = (width << 16) / nwidth;
-            size_t yinc = (height << 16) / nheight;
+    const XMVECTORF32 g_HalfMin  = { { { -65504.f, -65504.f, -65504.f, -65504.f } } };
+    const XMVECTORF32 g_HalfMax  = { { { 65504.f, 65504.f, 65504.f, 65504.f } } };
+    const XMVECTORF32 g_8BitBias = { { { 0.5f / 255.f, 0.5f / 255.f, 0.5f / 255.f, 0.5f / 255.f } } };
 
-            size_t lasty = size_t(-1);
+    // 8-bit UNORM without sRGB: integer average, rounding halves up, only with TEX_FILTER_BOX_INTEGER
+    void BoxRowUByte4(uint8_t* pDest, const uint8_t* row0, const uint8_t* row1, size_t nwidth, size_t step) noexcept
+    {
+        size_t x = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        if (step)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i half = _mm_set1_epi16(2);
 
-            size_t sy = 0;
-            for (size_t y = 0; y < nheight; ++y)
+            // 4 source texels of each row, 2 destination texels at a time
+            for (; x + 2 <= nwidth; x += 2)
             {
-                if ((lasty ^ sy) >> 16)
-                {
-                    if (!_LoadScanline(row, width, pSrc + (rowPitch * (sy >> 16)), rowPitch, src->format))
-                        return E_FAIL;
-                    lasty = sy;
-                }
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
 
-                size_t sx = 0;
-                for (size_t x = 0; x < nwidth; ++x)
-                {
-                    target[x] = row[sx >> 16];
-                    sx += xinc;
-                }
+                const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
 
-                if (!_StoreScanline(pDest, dest->rowPitch, dest->format, target, nwidth))
-                    return E_FAIL;
-                pDest += dest->rowPitch;
+                __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, half), 2);
 
-                sy += yinc;
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_packus_epi16(sum, sum));
             }
+        }
+#endif
 
-            if (height > 1)
-                height >>= 1;
+        for (; x < nwidth; ++x)
+        {
+            const uint8_t* p0 = row0 + x * 8;
+            const uint8_t* p1 = row1 + x * 8;
+            const uint8_t* p2 = p0 + step * 4;
+            const uint8_t* p3 = p1 + step * 4;
 
-            if (width > 1)
-                width >>= 1;
+            for (size_t c = 0; c < 4; ++c)
+            {
+                pDest[x * 4 + c] = static_cast<uint8_t>((p0[c] + p1[c] + p2[c] + p3[c] + 2) >> 2);
+            }
         }
+    }
 
-        return S_OK;
+    // 8-bit sRGB: decoding through a table of what _LoadScanlineLinear computes for every byte,
+    // then the same average and encode as the generic path
+    struct SRGBDecodeTable
+    {
+        // By byte position: R, G and B (or B, G and R) are decoded, alpha is not
+        float linear[4][256];
+
+        SRGBDecodeTable() noexcept
+        {
+            for (size_t i = 0; i < 256; ++i)
+            {
+                const auto b = static_cast<uint8_t>(i);
+                const XMUBYTEN4 packed(b, b, b, b);
+
+                XMFLOAT4 value;
+                XMStoreFloat4(&value, XMColorSRGBToRGB(XMLoadUByteN4(&packed)));
+
+                linear[0][i] = value.x;
+                linear[1][i] = value.y;
+                linear[2][i] = value.z;
+                linear[3][i] = value.w;
+            }
+        }
+
+        XMVECTOR XM_CALLCONV Load(const uint8_t* p) const noexcept
+        {
+            return XMVectorSet(linear[0][p[0]], linear[1][p[1]], linear[2][p[2]], linear[3][p[3]]);
+        }
+    };
+
+    void BoxRowUByte4SRGB(uint8_t* pDest, const uint8_t* row0, const uint8_t* row1, size_t nwidth, size_t step) noexcept
+    {
+        static const SRGBDecodeTable s_decode;
+
+        auto dPtr = reinterpret_cast<XMUBYTEN4*>(pDest);
+
+        for (size_t x = 0; x < nwidth; ++x)
+        {
+            const uint8_t* p0 = row0 + x * 8;
+            const uint8_t* p1 = row1 + x * 8;
+
+            XMVECTOR v;
+            AVERAGE4(v, s_decode.Load(p0), s_decode.Load(p1), s_decode.Load(p0 + step * 4), s_decode.Load(p1 + step * 4))
+
+            v = XMColorRGBToSRGB(v);
+            v = XMVectorAdd(v, g_8BitBias);
+            XMStoreUByteN4(dPtr++, v);
+        }
     }
 
+    void BoxRowHalf4(uint8_t* pDest, const uint8_t* row0, const uint8_t* row1, size_t nwidth, size_t step) noexcept
+    {
+        auto r0 = reinterpret_cast<const XMHALF4*>(row0);
+        auto r1 = reinterpret_cast<const XMHALF4*>(row1);
+        auto dPtr = reinterpret_cast<XMHALF4*>(pDest);
+
+        for (size_t x = 0; x < nwidth; ++x)
+        {
+            const size_t x2 = x << 1;
 
-    //--- 2D Box Filter ---
-    HRESULT Generate2DMipsBoxFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+            XMVECTOR v;
+            AVERAGE4(v, XMLoadHalf4(r0 + x2), XMLoadHalf4(r1 + x2), XMLoadHalf4(r0 + x2 + step), XMLoadHalf4(r1 + x2 + step))
+
+            v = XMVectorClamp(v, g_HalfMin, g_HalfMax);
+            XMStoreHalf4(dPtr++, v);
+        }
+    }
+
+    void BoxRowFloat(uint8_t* pDest, const uint8_t* row0, const uint8_t* row1, size_t nwidth, size_t step) noexcept
     {
-        if (!mipChain.GetImages())
-            return E_INVALIDARG;
+        auto r0 = reinterpret_cast<const float*>(row0);
+        auto r1 = reinterpret_cast<const float*>(row1);
+        auto dPtr = reinterpret_cast<float*>(pDest);
 
-        // This assumes that the base image is already placed into the mipChain at the top level... (see _Setup2DMips)
+        size_t x = 0;
 
-        assert(levels > 1);
+#if defined(_XM_SSE_INTRINSICS_)
+        if (step)
+        {
+            // 8 source texels of each row, 4 destination texels at a time, added in the order of AVERAGE4
+            for (; x + 4 <= nwidth; x += 4)
+            {
+                const __m128 a0 = _mm_loadu_ps(r0 + x * 2);
+                const __m128 a1 = _mm_loadu_ps(r0 + x * 2 + 4);
+                const __m128 b0 = _mm_loadu_ps(r1 + x * 2);
+                const __m128 b1 = _mm_loadu_ps(r1 + x * 2 + 4);
+
+                __m128 v = _mm_add_ps(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+                v = _mm_add_ps(v, _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)));
+                v = _mm_add_ps(v, _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+                _mm_storeu_ps(dPtr + x, _mm_mul_ps(v, g_boxScale));
+            }
+        }
+#endif
+
+        for (; x < nwidth; ++x)
+        {
+            const size_t x2 = x << 1;
+            dPtr[x] = (((r0[x2] + r1[x2]) + r0[x2 + step]) + r1[x2 + step]) * 0.25f;
+        }
+    }
+
+    BoxRowFunc GetBoxRowFastPath(DXGI_FORMAT format, TEX_FILTER_FLAGS filter) noexcept
+    {
+        const bool srgbIn = (filter & TEX_FILTER_SRGB_IN) != 0;
+        const bool srgbOut = (filter & TEX_FILTER_SRGB_OUT) != 0;
+
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            if (!srgbIn && !srgbOut)
+                return (filter & TEX_FILTER_BOX_INTEGER) ? BoxRowUByte4 : nullptr;
+            return (srgbIn && srgbOut) ? BoxRowUByte4SRGB : nullptr;
+
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return BoxRowUByte4SRGB;
+
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return (!srgbIn && !srgbOut) ? BoxRowHalf4 : nullptr;
+
+        case DXGI_FORMAT_R32_FLOAT:
+            return (!srgbIn && !srgbOut) ? BoxRowFloat : nullptr;
+
+        default:
+            return nullptr;
+        }
+    }
 
-        size_t width = mipChain.GetMetadata().width;
-        size_t height = mipChain.GetMetadata().height;
+
+    //--- 2D Box Filter ---
+    HRESULT Generate2DMipRowsBoxFilter(const Image& src, const Image& dest, TEX_FILTER_FLAGS filter, size_t yBegin, size_t yEnd) noexcept
+    {
+        const size_t width = src.width;
+        const size_t height = src.height;
 
         if (!ispow2(width) || !ispow2(height))
             return E_FAIL;
 
+        size_t rowPitch = src.rowPitch;
+
+        size_t nwidth = dest.width;
+
+        // A level one texel high averages each row with itself
+        const size_t rowStep = (height > 1) ? 2 : 1;
+
+        const uint8_t* pSrc = src.pixels + rowPitch * rowStep * yBegin;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * yBegin;
+
+        BoxRowFunc fastPath = GetBoxRowFastPath(src.format, filter);
+        if (fastPath)
+        {
+            const size_t step = (width > 1) ? 1 : 0;
+
+            for (size_t y = yBegin; y < yEnd; ++y)
+            {
+                fastPath(pDest, pSrc, (height > 1) ? pSrc + rowPitch : pSrc, nwidth, step);
+                pSrc += rowPitch * rowStep;
+                pDest += dest.rowPitch;
+            }
+
+            return S_OK;
+        }
+
         // Allocate temporary space (3 scanlines)
         auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 3);
         if (!scanline)
@@ -999,86 +1264,60 @@ namespace
         XMVECTOR* urow0 = target + width;
         XMVECTOR* urow1 = target + width * 2;
 
+        if (height <= 1)
+        {
+            urow1 = urow0;
+        }
+
         const XMVECTOR* urow2 = urow0 + 1;
         const XMVECTOR* urow3 = urow1 + 1;
 
-        // Resize base image to each target mip level
-        for (size_t level = 1; level < levels; ++level)
+        if (width <= 1)
         {
-            if (height <= 1)
-            {
-                urow1 = urow0;
-            }
-
-            if (width <= 1)
-            {
-                urow2 = urow0;
-                urow3 = urow1;
-            }
-
-            // 2D box filter
-            const Image* src = mipChain.GetImage(level - 1, item, 0);
-            const Image* dest = mipChain.GetImage(level, item, 0);
-
-            if (!src || !dest)
-                return E_POINTER;
-
-            const uint8_t* pSrc = src->pixels;
-            uint8_t* pDest = dest->pixels;
-
-            size_t rowPitch = src->rowPitch;
+            urow2 = urow0;
+            urow3 = urow1;
+        }
 
-            size_t nwidth = (width > 1) ? (width >> 1) : 1;
-            size_t nheight = (height > 1) ? (height >> 1) : 1;
+        // 2D box filter
+        for (size_t y = yBegin; y < yEnd; ++y)
+        {
+            if (!_LoadScanlineLinear(urow0, width, pSrc, rowPitch, src.format, filter))
+                return E_FAIL;
+            pSrc += rowPitch;
 
-            for (size_t y = 0; y < nheight; ++y)
+            if (urow0 != urow1)
             {
-                if (!_LoadScanlineLinear(urow0, width, pSrc, rowPitch, src->format, filter))
+                if (!_LoadScanlineLinear(urow1, width, pSrc, rowPitch, src.format, filter))
                     return E_FAIL;
                 pSrc += rowPitch;
+            }
 
-                if (urow0 != urow1)
-                {
-                    if (!_LoadScanlineLinear(urow1, width, pSrc, rowPitch, src->format, filter))
-                        return E_FAIL;
-                    pSrc += rowPitch;
-                }
-
-                for (size_t x = 0; x < nwidth; ++x)
-                {
-                    size_t x2 = x << 1;
-
-                    AVERAGE4(target[x], urow0[x2], urow1[x2], urow2[x2], urow3[x2])
-                }
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                size_t x2 = x << 1;
 
-                if (!_StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
-                    return E_FAIL;
-                pDest += dest->rowPitch;
+                AVERAGE4(target[x], urow0[x2], urow1[x2], urow2[x2], urow3[x2])
             }
 
-            if (height > 1)
-                height >>= 1;
-
-            if (width > 1)
-                width >>= 1;
+            if (!_StoreScanlineLinear(pDest, dest.rowPitch, dest.format, target, nwidth, filter))
+                return E_FAIL;
+            pDest += dest.rowPitch;
         }
 
         return S_OK;
     }
 
-
-    //--- 2D Linear Filter ---
-    HRESULT Generate2DMipsLinearFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+    HRESULT Generate2DMipsBoxFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
     {
-        if (!mipChain.GetImages())
-            return E_INVALIDARG;
-
-        // This assumes that the base image is already placed into the mipChain at the top level... (see _Setup2DMips)
+        return Generate2DMipsInBands(levels, filter, mipChain, Generate2DMipRowsBoxFilter);
+    }
 
-        assert(levels > 1);
 
-        size_t width = mipChain.GetMetadata().width;
-        size_t height = mipChain.GetMetadata().height;
+    //--- 2D Linear Filter ---
+    HRESULT Generate2DMipRowsLinearFilter(const Image& src, const Image& dest, TEX_FILTER_FLAGS filter, size_t yBegin, size_t yEnd) noexcept
+    {
+        const size_t width = src.width;
+        const size_t height = src.height;
 
         // Allocate temporary space (3 scanlines, plus X and Y filters)
         auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 3);
@@ -1097,99 +1336,81 @@ namespace
         XMVECTOR* row0 = target + width;
         XMVECTOR* row1 = target + width * 2;
 
-        // Resize base image to each target mip level
-        for (size_t level = 1; level < levels; ++level)
-        {
-            // 2D linear filter
-            const Image* src = mipChain.GetImage(level - 1, item, 0);
-            const Image* dest = mipChain.GetImage(level, item, 0);
-
-            if (!src || !dest)
-                return E_POINTER;
-
-            const uint8_t* pSrc = src->pixels;
-            uint8_t* pDest = dest->pixels;
+        // 2D linear filter
+        const uint8_t* pSrc = src.pixels;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * yBegin;
 
-            size_t rowPitch = src->rowPitch;
+        size_t rowPitch = src.rowPitch;
 
-            size_t nwidth = (width > 1) ? (width >> 1) : 1;
-            _CreateLinearFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, lfX);
+        size_t nwidth = dest.width;
+        _CreateLinearFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, lfX);
 
-            size_t nheight = (height > 1) ? (height >> 1) : 1;
-            _CreateLinearFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, lfY);
+        size_t nheight = dest.height;
+        _CreateLinearFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, lfY);
 
 #ifdef _DEBUG
-            memset(row0, 0xCD, sizeof(XMVECTOR)*width);
-            memset(row1, 0xDD, sizeof(XMVECTOR)*width);
+        memset(row0, 0xCD, sizeof(XMVECTOR)*width);
+        memset(row1, 0xDD, sizeof(XMVECTOR)*width);
 #endif
 
-            size_t u0 = size_t(-1);
-            size_t u1 = size_t(-1);
-
-            for (size_t y = 0; y < nheight; ++y)
-            {
-                auto& toY = lfY[y];
-
-                if (toY.u0 != u0)
-                {
-                    if (toY.u0 != u1)
-                    {
-                        u0 = toY.u0;
-
-                        if (!_LoadScanlineLinear(row0, width, pSrc + (rowPitch * u0), rowPitch, src->format, filter))
-                            return E_FAIL;
-                    }
-                    else
-                    {
-                        u0 = u1;
-                        u1 = size_t(-1);
+        size_t u0 = size_t(-1);
+        size_t u1 = size_t(-1);
 
-                        std::swap(row0, row1);
-                    }
-                }
+        for (size_t y = yBegin; y < yEnd; ++y)
+        {
+            auto& toY = lfY[y];
 
-                if (toY.u1 != u1)
+            if (toY.u0 != u0)
+            {
+                if (toY.u0 != u1)
                 {
-                    u1 = toY.u1;
+                    u0 = toY.u0;
 
-                    if (!_LoadScanlineLinear(row1, width, pSrc + (rowPitch * u1), rowPitch, src->format, filter))
+                    if (!_LoadScanlineLinear(row0, width, pSrc + (rowPitch * u0), rowPitch, src.format, filter))
                         return E_FAIL;
                 }
-
-                for (size_t x = 0; x < nwidth; ++x)
+                else
                 {
-                    auto& toX = lfX[x];
+                    u0 = u1;
+                    u1 = size_t(-1);
 
-                    BILINEAR_INTERPOLATE(target[x], toX, toY, row0, row1)
+                    std::swap(row0, row1);
                 }
+            }
 
-                if (!_StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
+            if (toY.u1 != u1)
+            {
+                u1 = toY.u1;
+
+                if (!_LoadScanlineLinear(row1, width, pSrc + (rowPitch * u1), rowPitch, src.format, filter))
                     return E_FAIL;
-                pDest += dest->rowPitch;
             }
 
-            if (height > 1)
-                height >>= 1;
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                auto& toX = lfX[x];
 
-            if (width > 1)
-                width >>= 1;
+                BILINEAR_INTERPOLATE(target[x], toX, toY, row0, row1)
+            }
+
+            if (!_StoreScanlineLinear(pDest, dest.rowPitch, dest.format, target, nwidth, filter))
+                return E_FAIL;
+            pDest += dest.rowPitch;
         }
 
         return S_OK;
     }
 
-    //--- 2D Cubic Filter ---
-    HRESULT Generate2DMipsCubicFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
+    HRESULT Generate2DMipsLinearFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
     {
-        if (!mipChain.GetImages())
-            return E_INVALIDARG;
-
-        // This assumes that the base image is already placed into the mipChain at the top level... (see _Setup2DMips)
-
-        assert(levels > 1);
+        return Generate2DMipsInBands(levels, filter, mipChain, Generate2DMipRowsLinearFilter);
+    }
 
-        size_t width = mipChain.GetMetadata().width;
-        size_t height = mipChain.GetMetadata().height;
+    //--- 2D Cubic Filter ---
+    HRESULT Generate2DMipRowsCubicFilter(const Image& src, const Image& dest, TEX_FILTER_FLAGS filter, size_t yBegin, size_t yEnd) noexcept
+    {
+        const size_t width = src.width;
+        const size_t height = src.height;
 
         // Allocate temporary space (5 scanlines, plus X and Y filters)
         auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 5);
@@ -1210,159 +1431,147 @@ namespace
         XMVECTOR* row2 = target + width * 3;
         XMVECTOR* row3 = target + width * 4;
 
-        // Resize base image to each target mip level
-        for (size_t level = 1; level < levels; ++level)
-        {
-            // 2D cubic filter
-            const Image* src = mipChain.GetImage(level - 1, item, 0);
-            const Image* dest = mipChain.GetImage(level, item, 0);
-
-            if (!src || !dest)
-                return E_POINTER;
+        // 2D cubic filter
+        const uint8_t* pSrc = src.pixels;
+        uint8_t* pDest = dest.pixels + dest.rowPitch * yBegin;
 
-            const uint8_t* pSrc = src->pixels;
-            uint8_t* pDest = dest->pixels;
+        size_t rowPitch = src.rowPitch;
 
-            size_t rowPitch = src->rowPitch;
+        size_t nwidth = dest.width;
+        _CreateCubicFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cfX);
 
-            size_t nwidth = (width > 1) ? (width >> 1) : 1;
-            _CreateCubicFilter(width, nwidth, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cfX);
-
-            size_t nheight = (height > 1) ? (height >> 1) : 1;
-            _CreateCubicFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cfY);
+        size_t nheight = dest.height;
+        _CreateCubicFilter(height, nheight, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cfY);
 
 #ifdef _DEBUG
-            memset(row0, 0xCD, sizeof(XMVECTOR)*width);
-            memset(row1, 0xDD, sizeof(XMVECTOR)*width);
-            memset(row2, 0xED, sizeof(XMVECTOR)*width);
-            memset(row3, 0xFD, sizeof(XMVECTOR)*width);
+        memset(row0, 0xCD, sizeof(XMVECTOR)*width);
+        memset(row1, 0xDD, sizeof(XMVECTOR)*width);
+        memset(row2, 0xED, sizeof(XMVECTOR)*width);
+        memset(row3, 0xFD, sizeof(XMVECTOR)*width);
 #endif
 
-            size_t u0 = size_t(-1);
-            size_t u1 = size_t(-1);
-            size_t u2 = size_t(-1);
-            size_t u3 = size_t(-1);
+        size_t u0 = size_t(-1);
+        size_t u1 = size_t(-1);
+        size_t u2 = size_t(-1);
+        size_t u3 = size_t(-1);
 
-            for (size_t y = 0; y < nheight; ++y)
+        for (size_t y = yBegin; y < yEnd; ++y)
+        {
+            auto& toY = cfY[y];
+            // Scanline 1
+            if (toY.u0 != u0)
             {
-                auto& toY = cfY[y];
-
-                // Scanline 1
-                if (toY.u0 != u0)
+                if (toY.u0 != u1 && toY.u0 != u2 && toY.u0 != u3)
                 {
-                    if (toY.u0 != u1 && toY.u0 != u2 && toY.u0 != u3)
-                    {
-                        u0 = toY.u0;
+                    u0 = toY.u0;
 
-                        if (!_LoadScanlineLinear(row0, width, pSrc + (rowPitch * u0), rowPitch, src->format, filter))
-                            return E_FAIL;
-                    }
-                    else if (toY.u0 == u1)
-                    {
-                        u0 = u1;
-                        u1 = size_t(-1);
-
-                        std::swap(row0, row1);
-                    }
-                    else if (toY.u0 == u2)
-                    {
-                        u0 = u2;
-                        u2 = size_t(-1);
-
-                        std::swap(row0, row2);
-                    }
-                    else if (toY.u0 == u3)
-                    {
-                        u0 = u3;
-                        u3 = size_t(-1);
+                    if (!_LoadScanlineLinear(row0, width, pSrc + (rowPitch * u0), rowPitch, src.format, filter))
+                        return E_FAIL;
+                }
+                else if (toY.u0 == u1)
+                {
+                    u0 = u1;
+                    u1 = size_t(-1);
 
-                        std::swap(row0, row3);
-                    }
+                    std::swap(row0, row1);
                 }
+                else if (toY.u0 == u2)
+                {
+                    u0 = u2;
+                    u2 = size_t(-1);
 
-                // Scanline 2
-                if (toY.u1 != u1)
+                    std::swap(row0, row2);
+                }
+                else if (toY.u0 == u3)
                 {
-                    if (toY.u1 != u2 && toY.u1 != u3)
-                    {
-                        u1 = toY.u1;
+                    u0 = u3;
+                    u3 = size_t(-1);
 
-                        if (!_LoadScanlineLinear(row1, width, pSrc + (rowPitch * u1), rowPitch, src->format, filter))
-                            return E_FAIL;
-                    }
-                    else if (toY.u1 == u2)
-                    {
-                        u1 = u2;
-                        u2 = size_t(-1);
+                    std::swap(row0, row3);
+                }
+            }
 
-                        std::swap(row1, row2);
-                    }
-                    else if (toY.u1 == u3)
-                    {
-                        u1 = u3;
-                        u3 = size_t(-1);
+            // Scanline 2
+            if (toY.u1 != u1)
+            {
+                if (toY.u1 != u2 && toY.u1 != u3)
+                {
+                    u1 = toY.u1;
 
-                        std::swap(row1, row3);
-                    }
+                    if (!_LoadScanlineLinear(row1, width, pSrc + (rowPitch * u1), rowPitch, src.format, filter))
+                        return E_FAIL;
                 }
-
-                // Scanline 3
-                if (toY.u2 != u2)
+                else if (toY.u1 == u2)
                 {
-                    if (toY.u2 != u3)
-                    {
-                        u2 = toY.u2;
+                    u1 = u2;
+                    u2 = size_t(-1);
 
-                        if (!_LoadScanlineLinear(row2, width, pSrc + (rowPitch * u2), rowPitch, src->format, filter))
-                            return E_FAIL;
-                    }
-                    else
-                    {
-                        u2 = u3;
-                        u3 = size_t(-1);
+                    std::swap(row1, row2);
+                }
+                else if (toY.u1 == u3)
+                {
+                    u1 = u3;
+                    u3 = size_t(-1);
 
-                        std::swap(row2, row3);
-                    }
+                    std::swap(row1, row3);
                 }
+            }
 
-                // Scanline 4
-                if (toY.u3 != u3)
+            // Scanline 3
+            if (toY.u2 != u2)
+            {
+                if (toY.u2 != u3)
                 {
-                    u3 = toY.u3;
+                    u2 = toY.u2;
 
-                    if (!_LoadScanlineLinear(row3, width, pSrc + (rowPitch * u3), rowPitch, src->format, filter))
+                    if (!_LoadScanlineLinear(row2, width, pSrc + (rowPitch * u2), rowPitch, src.format, filter))
                         return E_FAIL;
                 }
-
-                for (size_t x = 0; x < nwidth; ++x)
+                else
                 {
-                    auto& toX = cfX[x];
+                    u2 = u3;
+                    u3 = size_t(-1);
 
-                    XMVECTOR C0, C1, C2, C3;
-
-                    CUBIC_INTERPOLATE(C0, toX.x, row0[toX.u0], row0[toX.u1], row0[toX.u2], row0[toX.u3])
-                    CUBIC_INTERPOLATE(C1, toX.x, row1[toX.u0], row1[toX.u1], row1[toX.u2], row1[toX.u3])
-                    CUBIC_INTERPOLATE(C2, toX.x, row2[toX.u0], row2[toX.u1], row2[toX.u2], row2[toX.u3])
-                    CUBIC_INTERPOLATE(C3, toX.x, row3[toX.u0], row3[toX.u1], row3[toX.u2], row3[toX.u3])
-
-                    CUBIC_INTERPOLATE(target[x], toY.x, C0, C1, C2, C3)
+                    std::swap(row2, row3);
                 }
+            }
 
-                if (!_StoreScanlineLinear(pDest, dest->rowPitch, dest->format, target, nwidth, filter))
+            // Scanline 4
+            if (toY.u3 != u3)
+            {
+                u3 = toY.u3;
+
+                if (!_LoadScanlineLinear(row3, width, pSrc + (rowPitch * u3), rowPitch, src.format, filter))
                     return E_FAIL;
-                pDest += dest->rowPitch;
             }
 
-            if (height > 1)
-                height >>= 1;
+            for (size_t x = 0; x < nwidth; ++x)
+            {
+                auto& toX = cfX[x];
 
-            if (width > 1)
-                width >>= 1;
+                XMVECTOR C0, C1, C2, C3;
+
+                CUBIC_INTERPOLATE(C0, toX.x, row0[toX.u0], row0[toX.u1], row0[toX.u2], row0[toX.u3])
+                CUBIC_INTERPOLATE(C1, toX.x, row1[toX.u0], row1[toX.u1], row1[toX.u2], row1[toX.u3])
+                CUBIC_INTERPOLATE(C2, toX.x, row2[toX.u0], row2[toX.u1], row2[toX.u2], row2[toX.u3])
+                CUBIC_INTERPOLATE(C3, toX.x, row3[toX.u0], row3[toX.u1], row3[toX.u2], row3[toX.u3])
+
+                CUBIC_INTERPOLATE(target[x], toY.x, C0, C1, C2, C3)
+            }
+
+            if (!_StoreScanlineLinear(pDest, dest.rowPitch, dest.format, target, nwidth, filter))
+                return E_FAIL;
+            pDest += dest.rowPitch;
         }
 
         return S_OK;
     }
 
+    HRESULT Generate2DMipsCubicFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    {
+        return Generate2DMipsInBands(levels, filter, mipChain, Generate2DMipRowsCubicFilter);
+    }
+
 
     //--- 2D Triangle Filter ---
     HRESULT Generate2DMipsTriangleFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain, size_t item) noexcept
@@ -1578,6 +1787,25 @@ namespace
     }
 
 
+    // Triangle filtering spreads each source texel over a varying number of destination rows: items are the unit of work
+    struct TriangleJob
+    {
+        size_t levels;
+        TEX_FILTER_FLAGS filter;
+        const ScratchImage* mipChain;
+    };
+
+    HRESULT Generate2DMipsTriangleFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    {
+        const TriangleJob job = { levels, filter, &mipChain };
+
+        return _ParallelFor(mipChain.GetMetadata().arraySize, (filter & TEX_FILTER_PARALLEL) != 0, [&job](size_t item) -> HRESULT
+            {
+                return Generate2DMipsTriangleFilter(job.levels, job.filter, *job.mipChain, item);
+            });
+    }
+
+
     //-------------------------------------------------------------------------------------
     // Generate volume mip-map helpers
     //-------------------------------------------------------------------------------------
@@ -2917,7 +3145,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsBoxFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsBoxFilter(levels, filter, mipChain);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2927,7 +3155,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsPointFilter(levels, mipChain, 0);
+            hr = Generate2DMipsPointFilter(levels, filter, mipChain);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2937,7 +3165,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsLinearFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsLinearFilter(levels, filter, mipChain);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2947,7 +3175,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsCubicFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsCubicFilter(levels, filter, mipChain);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -2957,7 +3185,7 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            hr = Generate2DMipsTriangleFilter(levels, filter, mipChain, 0);
+            hr = Generate2DMipsTriangleFilter(levels, filter, mipChain);
             if (FAILED(hr))
                 mipChain.Release();
             return hr;
@@ -3132,12 +3360,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                hr = Generate2DMipsBoxFilter(levels, filter, mipChain, item);
-                if (FAILED(hr))
-                    mipChain.Release();
-            }
+            hr = Generate2DMipsBoxFilter(levels, filter, mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
             return hr;
 
         case TEX_FILTER_POINT:
@@ -3145,12 +3370,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                hr = Generate2DMipsPointFilter(levels, mipChain, item);
-                if (FAILED(hr))
-                    mipChain.Release();
-            }
+            hr = Generate2DMipsPointFilter(levels, filter, mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
             return hr;
 
         case TEX_FILTER_LINEAR:
@@ -3158,12 +3380,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                hr = Generate2DMipsLinearFilter(levels, filter, mipChain, item);
-                if (FAILED(hr))
-                    mipChain.Release();
-            }
+            hr = Generate2DMipsLinearFilter(levels, filter, mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
             return hr;
 
         case TEX_FILTER_CUBIC:
@@ -3171,12 +3390,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                hr = Generate2DMipsCubicFilter(levels, filter, mipChain, item);
-                if (FAILED(hr))
-                    mipChain.Release();
-            }
+            hr = Generate2DMipsCubicFilter(levels, filter, mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
             return hr;
 
         case TEX_FILTER_TRIANGLE:
@@ -3184,12 +3400,9 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                hr = Generate2DMipsTriangleFilter(levels, filter, mipChain, item);
-                if (FAILED(hr))
-                    mipChain.Release();
-            }
+            hr = Generate2DMipsTriangleFilter(levels, filter, mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
             return hr;
 
         default:
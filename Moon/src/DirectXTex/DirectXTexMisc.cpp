@@ -22,6 +22,36 @@ namespace
 {
     const XMVECTORF32 g_Gamma22 = { { { 2.2f, 2.2f, 2.2f, 1.f } } };
 
+    //-------------------------------------------------------------------------------------
+    // Pixels per band of rows of ComputeMSE_ and EvaluateImage_. Bands are the same with or without threads,
+    // and ComputeMSE_ adds up their sums in band order, so threading does not change its result.
+    constexpr size_t c_BandPixels = 16384;
+
+    struct MSEBand
+    {
+        double sum[4];
+    };
+
+    // Gamma correction and scale and bias of ComputeMSE_, in place
+    void PrepareMSEScanline(_Inout_updates_(width) XMVECTOR* pixels, size_t width, bool srgb, bool x2bias) noexcept
+    {
+        static const XMVECTORF32 two = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
+
+        for (size_t i = 0; i < width; ++i)
+        {
+            XMVECTOR v = pixels[i];
+            if (srgb)
+            {
+                v = XMVectorPow(v, g_Gamma22);
+            }
+            if (x2bias)
+            {
+                v = XMVectorMultiplyAdd(v, two, g_XMNegativeOne);
+            }
+            pixels[i] = v;
+        }
+    }
+
     //-------------------------------------------------------------------------------------
     HRESULT ComputeMSE_(
         const Image& image1,
@@ -37,10 +67,9 @@ namespace
         assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
 
         const size_t width = image1.width;
-
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        const size_t height = image1.height;
+        if (!width || !height)
+            return E_INVALIDARG;
 
         // Flags implied from image formats
         switch (image1.format)
@@ -89,114 +118,124 @@ namespace
             break;
         }
 
-        const uint8_t *pSrc1 = image1.pixels;
-        const size_t rowPitch1 = image1.rowPitch;
+        // Ignored channels are masked out of the differences, instead of testing the flags for every pixel
+        const XMVECTOR channels = XMVectorSelectControl(
+            (flags & CMSE_IGNORE_RED) ? 0u : 1u,
+            (flags & CMSE_IGNORE_GREEN) ? 0u : 1u,
+            (flags & CMSE_IGNORE_BLUE) ? 0u : 1u,
+            (flags & CMSE_IGNORE_ALPHA) ? 0u : 1u);
 
-        const uint8_t *pSrc2 = image2.pixels;
-        const size_t rowPitch2 = image2.rowPitch;
+        const size_t rowsPerBand = std::max<size_t>(1, c_BandPixels / width);
+        const size_t bandCount = (height + rowsPerBand - 1) / rowsPerBand;
 
-        XMVECTOR acc = g_XMZero;
-        static XMVECTORF32 two = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
+        std::unique_ptr<MSEBand[]> bands(new (std::nothrow) MSEBand[bandCount]);
+        if (!bands)
+            return E_OUTOFMEMORY;
 
-        for (size_t h = 0; h < image1.height; ++h)
-        {
-            XMVECTOR* ptr1 = scanline.get();
-            if (!_LoadScanline(ptr1, width, pSrc1, rowPitch1, image1.format))
-                return E_FAIL;
+        HRESULT hr = _ParallelFor(bandCount, (flags & CMSE_PARALLEL) != 0, [&](size_t band) -> HRESULT
+            {
+                auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+                if (!scanline)
+                    return E_OUTOFMEMORY;
 
-            XMVECTOR* ptr2 = scanline.get() + width;
-            if (!_LoadScanline(ptr2, width, pSrc2, rowPitch2, image2.format))
-                return E_FAIL;
+                XMVECTOR* ptr1 = scanline.get();
+                XMVECTOR* ptr2 = scanline.get() + width;
 
-            for (size_t i = 0; i < width; ++i)
-            {
-                XMVECTOR v1 = *(ptr1++);
-                if (flags & CMSE_IMAGE1_SRGB)
-                {
-                    v1 = XMVectorPow(v1, g_Gamma22);
-                }
-                if (flags & CMSE_IMAGE1_X2_BIAS)
-                {
-                    v1 = XMVectorMultiplyAdd(v1, two, g_XMNegativeOne);
-                }
+                const size_t yBegin = band * rowsPerBand;
+                const size_t yEnd = std::min(yBegin + rowsPerBand, height);
 
-                XMVECTOR v2 = *(ptr2++);
-                if (flags & CMSE_IMAGE2_SRGB)
-                {
-                    v2 = XMVectorPow(v2, g_Gamma22);
-                }
-                if (flags & CMSE_IMAGE2_X2_BIAS)
-                {
-                    v2 = XMVectorMultiplyAdd(v2, two, g_XMNegativeOne);
-                }
+                const uint8_t *pSrc1 = image1.pixels + yBegin * image1.rowPitch;
+                const uint8_t *pSrc2 = image2.pixels + yBegin * image2.rowPitch;
 
-                // sum[ (I1 - I2)^2 ]
-                XMVECTOR v = XMVectorSubtract(v1, v2);
-                if (flags & CMSE_IGNORE_RED)
-                {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskX);
-                }
-                if (flags & CMSE_IGNORE_GREEN)
-                {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskY);
-                }
-                if (flags & CMSE_IGNORE_BLUE)
+                MSEBand& result = bands[band];
+                result = {};
+                for (size_t y = yBegin; y < yEnd; ++y)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskZ);
-                }
-                if (flags & CMSE_IGNORE_ALPHA)
-                {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskW);
+                    if (!_LoadScanline(ptr1, width, pSrc1, image1.rowPitch, image1.format))
+                        return E_FAIL;
+
+                    if (!_LoadScanline(ptr2, width, pSrc2, image2.rowPitch, image2.format))
+                        return E_FAIL;
+
+                    if (flags & (CMSE_IMAGE1_SRGB | CMSE_IMAGE1_X2_BIAS))
+                        PrepareMSEScanline(ptr1, width, (flags & CMSE_IMAGE1_SRGB) != 0, (flags & CMSE_IMAGE1_X2_BIAS) != 0);
+
+                    if (flags & (CMSE_IMAGE2_SRGB | CMSE_IMAGE2_X2_BIAS))
+                        PrepareMSEScanline(ptr2, width, (flags & CMSE_IMAGE2_SRGB) != 0, (flags & CMSE_IMAGE2_X2_BIAS) != 0);
+
+                    // sum[ (I1 - I2)^2 ], two independent accumulators to hide the latency of the multiply-adds
+                    XMVECTOR acc0 = g_XMZero;
+                    XMVECTOR acc1 = g_XMZero;
+                    size_t i = 0;
+                    for (; i + 1 < width; i += 2)
+                    {
+                        const XMVECTOR v0 = XMVectorAndInt(XMVectorSubtract(ptr1[i], ptr2[i]), channels);
+                        const XMVECTOR v1 = XMVectorAndInt(XMVectorSubtract(ptr1[i + 1], ptr2[i + 1]), channels);
+                        acc0 = XMVectorMultiplyAdd(v0, v0, acc0);
+                        acc1 = XMVectorMultiplyAdd(v1, v1, acc1);
+                    }
+                    if (i < width)
+                    {
+                        const XMVECTOR v0 = XMVectorAndInt(XMVectorSubtract(ptr1[i], ptr2[i]), channels);
+                        acc0 = XMVectorMultiplyAdd(v0, v0, acc0);
+                    }
+
+                    // Rows are added up in double, a float sum over millions of pixels would lose the small errors
+                    XMFLOAT4 rowSum;
+                    XMStoreFloat4(&rowSum, XMVectorAdd(acc0, acc1));
+                    result.sum[0] += rowSum.x;
+                    result.sum[1] += rowSum.y;
+                    result.sum[2] += rowSum.z;
+                    result.sum[3] += rowSum.w;
+
+                    pSrc1 += image1.rowPitch;
+                    pSrc2 += image2.rowPitch;
                 }
 
-                acc = XMVectorMultiplyAdd(v, v, acc);
-            }
+                return S_OK;
+            });
+        if (FAILED(hr))
+            return hr;
 
-            pSrc1 += rowPitch1;
-            pSrc2 += rowPitch2;
+        double sum[4] = {};
+        for (size_t band = 0; band < bandCount; ++band)
+        {
+            for (size_t c = 0; c < 4; ++c)
+                sum[c] += bands[band].sum[c];
         }
 
         // MSE = sum[ (I1 - I2)^2 ] / w*h
-        XMVECTOR d = XMVectorReplicate(float(image1.width * image1.height));
-        XMVECTOR v = XMVectorDivide(acc, d);
+        const double pixels = double(width) * double(height);
+        float _mseV[4];
+        for (size_t c = 0; c < 4; ++c)
+            _mseV[c] = float(sum[c] / pixels);
+
         if (mseV)
         {
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(mseV), v);
-            mse = mseV[0] + mseV[1] + mseV[2] + mseV[3];
-        }
-        else
-        {
-            XMFLOAT4 _mseV;
-            XMStoreFloat4(&_mseV, v);
-            mse = _mseV.x + _mseV.y + _mseV.z + _mseV.w;
+            memcpy(mseV, _mseV, sizeof(_mseV));
         }
+        mse = _mseV[0] + _mseV[1] + _mseV[2] + _mseV[3];
 
         return S_OK;
     }
 
     //-------------------------------------------------------------------------------------
-    HRESULT EvaluateImage_(
+    HRESULT EvaluateRows(
         const Image& image,
-        std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)>& pixelFunc)
+        std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)>& pixelFunc,
+        size_t yBegin,
+        size_t yEnd)
     {
-        if (!pixelFunc)
-            return E_INVALIDARG;
-
-        if (!image.pixels)
-            return E_POINTER;
-
-        assert(!IsCompressed(image.format));
-
         const size_t width = image.width;
 
         auto scanline = make_AlignedArrayXMVECTOR(width);
         if (!scanline)
             return E_OUTOFMEMORY;
 
-        const uint8_t *pSrc = image.pixels;
+        const uint8_t *pSrc = image.pixels + yBegin * image.rowPitch;
         const size_t rowPitch = image.rowPitch;
 
-        for (size_t h = 0; h < image.height; ++h)
+        for (size_t h = yBegin; h < yEnd; ++h)
         {
             if (!_LoadScanline(scanline.get(), width, pSrc, rowPitch, image.format))
                 return E_FAIL;
@@ -209,6 +248,41 @@ namespace
         return S_OK;
     }
 
+    HRESULT EvaluateImage_(
+        const Image& image,
+        std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)>& pixelFunc,
+        bool parallel)
+    {
+        if (!pixelFunc)
+            return E_INVALIDARG;
+
+        if (!image.pixels)
+            return E_POINTER;
+
+        assert(!IsCompressed(image.format));
+
+        if (!parallel || !image.width)
+            return EvaluateRows(image, pixelFunc, 0, image.height);
+
+        const size_t rowsPerBand = std::max<size_t>(1, c_BandPixels / image.width);
+        const size_t bandCount = (image.height + rowsPerBand - 1) / rowsPerBand;
+
+        return _ParallelFor(bandCount, true, [&](size_t band) -> HRESULT
+            {
+                const size_t yBegin = band * rowsPerBand;
+                const size_t yEnd = std::min(yBegin + rowsPerBand, image.height);
+                try
+                {
+                    return EvaluateRows(image, pixelFunc, yBegin, yEnd);
+                }
+                catch (...)
+                {
+                    // An exception can not cross threads, it fails the evaluation instead
+                    return E_FAIL;
+                }
+            });
+    }
+
 
     //-------------------------------------------------------------------------------------
     HRESULT TransformImage_(
@@ -405,18 +479,20 @@ HRESULT DirectX::ComputeMSE(
         || IsTypeless(image1.format) || IsTypeless(image2.format))
         return HRESULT_E_NOT_SUPPORTED;
 
+    const TEX_FILTER_FLAGS decompress = (flags & CMSE_PARALLEL) ? TEX_FILTER_PARALLEL : TEX_FILTER_DEFAULT;
+
     if (IsCompressed(image1.format))
     {
         if (IsCompressed(image2.format))
         {
             // Case 1: both images are compressed, expand to RGBA32F
             ScratchImage temp1;
-            HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, temp1);
+            HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, decompress, temp1);
             if (FAILED(hr))
                 return hr;
 
             ScratchImage temp2;
-            hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, temp2);
+            hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, decompress, temp2);
             if (FAILED(hr))
                 return hr;
 
@@ -431,7 +507,7 @@ HRESULT DirectX::ComputeMSE(
         {
             // Case 2: image1 is compressed, expand to RGBA32F
             ScratchImage temp;
-            HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
+            HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, decompress, temp);
             if (FAILED(hr))
                 return hr;
 
@@ -448,7 +524,7 @@ HRESULT DirectX::ComputeMSE(
         {
             // Case 3: image2 is compressed, expand to RGBA32F
             ScratchImage temp;
-            HRESULT hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
+            HRESULT hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, decompress, temp);
             if (FAILED(hr))
                 return hr;
 
@@ -474,6 +550,15 @@ _Use_decl_annotations_
 HRESULT DirectX::EvaluateImage(
     const Image& image,
     std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc)
+{
+    return EvaluateImage(image, pixelFunc, TEX_FILTER_DEFAULT);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::EvaluateImage(
+    const Image& image,
+    std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc,
+    TEX_FILTER_FLAGS filter)
 {
     if (image.width > UINT32_MAX
         || image.height > UINT32_MAX)
@@ -485,10 +570,12 @@ HRESULT DirectX::EvaluateImage(
     if (IsPlanar(image.format) || IsPalettized(image.format) || IsTypeless(image.format))
         return HRESULT_E_NOT_SUPPORTED;
 
+    const bool parallel = (filter & TEX_FILTER_PARALLEL) != 0;
+
     if (IsCompressed(image.format))
     {
         ScratchImage temp;
-        HRESULT hr = Decompress(image, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
+        HRESULT hr = Decompress(image, DXGI_FORMAT_R32G32B32A32_FLOAT, filter & TEX_FILTER_PARALLEL, temp);
         if (FAILED(hr))
             return hr;
 
@@ -496,11 +583,11 @@ HRESULT DirectX::EvaluateImage(
         if (!img)
             return E_POINTER;
 
-        return EvaluateImage_(*img, pixelFunc);
+        return EvaluateImage_(*img, pixelFunc, parallel);
     }
     else
     {
-        return EvaluateImage_(image, pixelFunc);
+        return EvaluateImage_(image, pixelFunc, parallel);
     }
 }
 
@@ -510,6 +597,17 @@ HRESULT DirectX::EvaluateImage(
     size_t nimages,
     const TexMetadata& metadata,
     std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc)
+{
+    return EvaluateImage(images, nimages, metadata, pixelFunc, TEX_FILTER_DEFAULT);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::EvaluateImage(
+    const Image* images,
+    size_t nimages,
+    const TexMetadata& metadata,
+    std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc,
+    TEX_FILTER_FLAGS filter)
 {
     if (!images || !nimages)
         return E_INVALIDARG;
@@ -527,11 +625,13 @@ HRESULT DirectX::EvaluateImage(
     if (metadata.IsVolumemap() && metadata.depth > UINT16_MAX)
         return E_INVALIDARG;
 
+    const bool parallel = (filter & TEX_FILTER_PARALLEL) != 0;
+
     ScratchImage temp;
     DXGI_FORMAT format = metadata.format;
     if (IsCompressed(format))
     {
-        HRESULT hr = Decompress(images, nimages, metadata, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
+        HRESULT hr = Decompress(images, nimages, metadata, DXGI_FORMAT_R32G32B32A32_FLOAT, filter & TEX_FILTER_PARALLEL, temp);
         if (FAILED(hr))
             return hr;
 
@@ -555,7 +655,7 @@ HRESULT DirectX::EvaluateImage(
             if ((img.width > UINT32_MAX) || (img.height > UINT32_MAX))
                 return E_FAIL;
 
-            HRESULT hr = EvaluateImage_(img, pixelFunc);
+            HRESULT hr = EvaluateImage_(img, pixelFunc, parallel);
             if (FAILED(hr))
                 return hr;
         }
@@ -579,7 +679,7 @@ HRESULT DirectX::EvaluateImage(
                 if ((img.width > UINT32_MAX) || (img.height > UINT32_MAX))
                     return E_FAIL;
 
-                HRESULT hr = EvaluateImage_(img, pixelFunc);
+                HRESULT hr = EvaluateImage_(img, pixelFunc, parallel);
                 if (FAILED(hr))
                     return hr;
             }
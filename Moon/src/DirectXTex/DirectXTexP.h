@@ -298,6 +298,16 @@ namespace DirectX
         _In_ const TexMetadata& metadata, _In_ CP_FLAGS cpFlags,
         _Out_writes_(nImages) Image* images, _In_ size_t nImages) noexcept;
 
+    //---------------------------------------------------------------------------------
+    // Threading helper functions
+    HRESULT __cdecl _ParallelFor(
+        _In_ size_t count, _In_ bool parallel, _In_ const std::function<HRESULT(size_t index)>& body,
+        _In_opt_ const std::function<bool()>& progress = nullptr) noexcept;
+        // Calls body for every index in [0, count) on the calling thread and, when parallel is set, on the workers of
+        // a pool shared by every call, one per hardware thread, created on first use
+        // Stops handing out indices at the first failure and returns it; body must not throw
+        // progress is called on the calling thread after each index it ran, returning false stops with E_ABORT
+
     //---------------------------------------------------------------------------------
     // Conversion helper functions
 
@@ -235,7 +235,9 @@ namespace
             break;
 
         case TEX_FILTER_TRIANGLE:
-            // WIC does not implement this filter
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            // WIC does not implement these filters
             return false;
         }
 
@@ -365,427 +367,627 @@ namespace
     }
 
 
-    //--- Linear Filter ---
-    HRESULT ResizeLinearFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    //-------------------------------------------------------------------------------------
+    // Separable resampling
+    //-------------------------------------------------------------------------------------
+    // Linear, cubic, triangle, Lanczos3 and Mitchell filtering are separable: a table of source texels and weights per
+    // destination column and one per destination row, built once, filter the rows and then the columns. Destination rows
+    // are worked on in bands: the source rows a band reads are filtered horizontally into a buffer sized to stay in cache,
+    // then the band is filtered vertically from it. Bands are independent, and run in parallel with TEX_FILTER_PARALLEL.
+    //
+    // RGBA8 and BGRA8 without sRGB conversion stay integer, with weights in 1.14 fixed point and 6 bits of fraction
+    // kept between the two passes. Any other format goes through XMVECTOR scanlines.
+    //
+    // The integer inner loops use SSE2 when DirectXMath does, weighting pairs of taps with pmaddwd.
+
+    constexpr size_t c_ResampleBandBytes = 256 * 1024;
+    constexpr int c_ResampleWeightBits = 14;
+    constexpr int c_ResampleFractionBits = 6;
+
+    struct ResampleAxis
     {
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
+        size_t                          taps;
+        std::unique_ptr<uint32_t[]>     index;          // taps source texels per destination texel
+        std::unique_ptr<float[]>        weight;         // zero weights pad the destination texels with fewer taps
+        std::unique_ptr<int16_t[]>      fixedWeight;    // weight in 1.14 fixed point
 
-        // Allocate temporary space (3 scanlines, plus X and Y filters)
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * 2 + destImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        ResampleAxis() noexcept : taps(0) {}
+
+        HRESULT Allocate(size_t dest, size_t ntaps) noexcept
+        {
+            const uint64_t count = uint64_t(dest) * uint64_t(ntaps);
+            if (count > UINT32_MAX)
+                return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+            index.reset(new (std::nothrow) uint32_t[static_cast<size_t>(count)]());
+            weight.reset(new (std::nothrow) float[static_cast<size_t>(count)]());
+            fixedWeight.reset(new (std::nothrow) int16_t[static_cast<size_t>(count)]());
+            if (!index || !weight || !fixedWeight)
+                return E_OUTOFMEMORY;
 
-        std::unique_ptr<LinearFilter[]> lf(new (std::nothrow) LinearFilter[destImage.width + destImage.height]);
+            taps = ntaps;
+            return S_OK;
+        }
+    };
+
+    //--- Filter tables ---
+    HRESULT CreateLinearAxis(size_t source, size_t dest, bool wrap, ResampleAxis& axis) noexcept
+    {
+        std::unique_ptr<LinearFilter[]> lf(new (std::nothrow) LinearFilter[dest]);
         if (!lf)
             return E_OUTOFMEMORY;
 
-        LinearFilter* lfX = lf.get();
-        LinearFilter* lfY = lf.get() + destImage.width;
+        _CreateLinearFilter(source, dest, wrap, lf.get());
 
-        _CreateLinearFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, lfX);
-        _CreateLinearFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, lfY);
-
-        XMVECTOR* target = scanline.get();
+        HRESULT hr = axis.Allocate(dest, 2);
+        if (FAILED(hr))
+            return hr;
 
-        XMVECTOR* row0 = target + destImage.width;
-        XMVECTOR* row1 = row0 + srcImage.width;
+        for (size_t u = 0; u < dest; ++u)
+        {
+            axis.index[u * 2] = static_cast<uint32_t>(lf[u].u0);
+            axis.index[u * 2 + 1] = static_cast<uint32_t>(lf[u].u1);
+            axis.weight[u * 2] = lf[u].weight0;
+            axis.weight[u * 2 + 1] = lf[u].weight1;
+        }
 
-#ifdef _DEBUG
-        memset(row0, 0xCD, sizeof(XMVECTOR)*srcImage.width);
-        memset(row1, 0xDD, sizeof(XMVECTOR)*srcImage.width);
-#endif
+        return S_OK;
+    }
 
-        const uint8_t* pSrc = srcImage.pixels;
-        uint8_t* pDest = destImage.pixels;
+    HRESULT CreateCubicAxis(size_t source, size_t dest, bool wrap, bool mirror, ResampleAxis& axis) noexcept
+    {
+        std::unique_ptr<CubicFilter[]> cf(new (std::nothrow) CubicFilter[dest]);
+        if (!cf)
+            return E_OUTOFMEMORY;
 
-        size_t rowPitch = srcImage.rowPitch;
+        _CreateCubicFilter(source, dest, wrap, mirror, cf.get());
 
-        size_t u0 = size_t(-1);
-        size_t u1 = size_t(-1);
+        HRESULT hr = axis.Allocate(dest, 4);
+        if (FAILED(hr))
+            return hr;
 
-        for (size_t y = 0; y < destImage.height; ++y)
+        for (size_t u = 0; u < dest; ++u)
         {
-            auto& toY = lfY[y];
+            auto& toX = cf[u];
+
+            uint32_t* index = axis.index.get() + u * 4;
+            index[0] = static_cast<uint32_t>(toX.u0);
+            index[1] = static_cast<uint32_t>(toX.u1);
+            index[2] = static_cast<uint32_t>(toX.u2);
+            index[3] = static_cast<uint32_t>(toX.u3);
+
+            // The polynomial of CUBIC_INTERPOLATE, as a weight per texel
+            const float x = toX.x;
+            const float x2 = x * x;
+            const float x3 = x2 * x;
+
+            float* weight = axis.weight.get() + u * 4;
+            weight[0] = -x / 3.f + x2 / 2.f - x3 / 6.f;
+            weight[1] = 1.f - x / 2.f - x2 + x3 / 2.f;
+            weight[2] = x + x2 / 2.f - x3 / 2.f;
+            weight[3] = -x / 6.f + x3 / 6.f;
+        }
 
-            if (toY.u0 != u0)
-            {
-                if (toY.u0 != u1)
-                {
-                    u0 = toY.u0;
+        return S_OK;
+    }
 
-                    if (!_LoadScanlineLinear(row0, srcImage.width, pSrc + (rowPitch * u0), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else
-                {
-                    u0 = u1;
-                    u1 = size_t(-1);
+    HRESULT CreateTriangleAxis(size_t source, size_t dest, bool wrap, ResampleAxis& axis) noexcept
+    {
+        using namespace TriangleFilter;
 
-                    std::swap(row0, row1);
-                }
-            }
+        std::unique_ptr<Filter> tf;
+        HRESULT hr = _Create(source, dest, wrap, tf);
+        if (FAILED(hr))
+            return hr;
 
-            if (toY.u1 != u1)
-            {
-                u1 = toY.u1;
+        // The filter lists the destination texels of every source texel, count the source texels of every destination one
+        std::unique_ptr<size_t[]> count(new (std::nothrow) size_t[dest]());
+        if (!count)
+            return E_OUTOFMEMORY;
 
-                if (!_LoadScanlineLinear(row1, srcImage.width, pSrc + (rowPitch * u1), rowPitch, srcImage.format, filter))
-                    return E_FAIL;
-            }
+        auto fromEnd = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(tf.get()) + tf->sizeInBytes);
 
-            for (size_t x = 0; x < destImage.width; ++x)
+        size_t taps = 1;
+        for (const FilterFrom* from = tf->from; from < fromEnd; )
+        {
+            for (size_t j = 0; j < from->count; ++j)
             {
-                auto& toX = lfX[x];
+                size_t v = from->to[j].u;
+                assert(v < dest);
+                taps = std::max(taps, ++count[v]);
+            }
+
+            from = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(from) + from->sizeInBytes);
+        }
 
-                BILINEAR_INTERPOLATE(target[x], toX, toY, row0, row1)
+        hr = axis.Allocate(dest, taps);
+        if (FAILED(hr))
+            return hr;
+
+        memset(count.get(), 0, sizeof(size_t) * dest);
+
+        size_t u = 0;
+        for (const FilterFrom* from = tf->from; from < fromEnd; ++u)
+        {
+            for (size_t j = 0; j < from->count; ++j)
+            {
+                size_t v = from->to[j].u;
+                size_t t = count[v]++;
+                axis.index[v * taps + t] = static_cast<uint32_t>(u);
+                axis.weight[v * taps + t] = from->to[j].weight;
             }
 
-            if (!_StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
-                return E_FAIL;
-            pDest += destImage.rowPitch;
+            from = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(from) + from->sizeInBytes);
+        }
+
+        // Padding taps read a texel the destination texel uses anyway, so a band never loads a row just for them
+        for (size_t v = 0; v < dest; ++v)
+        {
+            for (size_t t = std::max<size_t>(count[v], 1); t < taps; ++t)
+            {
+                axis.index[v * taps + t] = axis.index[v * taps];
+            }
         }
 
         return S_OK;
     }
 
+    float Lanczos3(float x) noexcept
+    {
+        x = fabsf(x);
+        if (x < 1e-5f)
+            return 1.f;
+        if (x >= 3.f)
+            return 0.f;
+
+        const float px = XM_PI * x;
+        return 3.f * sinf(px) * sinf(px / 3.f) / (px * px);
+    }
 
-    //--- Cubic Filter ---
-    HRESULT ResizeCubicFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    float Mitchell(float x) noexcept
     {
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
+        // Mitchell-Netravali cubic with B = C = 1/3
+        x = fabsf(x);
+        if (x < 1.f)
+            return ((7.f * x - 12.f) * x * x + 16.f / 3.f) / 6.f;
+        if (x < 2.f)
+            return (((-7.f / 3.f * x + 12.f) * x - 20.f) * x + 32.f / 3.f) / 6.f;
+        return 0.f;
+    }
 
-        // Allocate temporary space (5 scanlines, plus X and Y filters)
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * 4 + destImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+    HRESULT CreateKernelAxis(size_t source, size_t dest, bool wrap, bool mirror, float radius, float(*kernel)(float), ResampleAxis& axis) noexcept
+    {
+        const float scale = float(source) / float(dest);
 
-        std::unique_ptr<CubicFilter[]> cf(new (std::nothrow) CubicFilter[destImage.width + destImage.height]);
-        if (!cf)
-            return E_OUTOFMEMORY;
+        // Minifying stretches the kernel over the source footprint of a destination texel
+        const float stretch = std::max(scale, 1.f);
+        const float support = radius * stretch;
 
-        CubicFilter* cfX = cf.get();
-        CubicFilter* cfY = cf.get() + destImage.width;
+        HRESULT hr = axis.Allocate(dest, size_t(ceilf(support * 2.f)) + 1);
+        if (FAILED(hr))
+            return hr;
 
-        _CreateCubicFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cfX);
-        _CreateCubicFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cfY);
+        const size_t taps = axis.taps;
+        const auto maxu = ptrdiff_t(source) - 1;
 
-        XMVECTOR* target = scanline.get();
+        for (size_t u = 0; u < dest; ++u)
+        {
+            const float center = (float(u) + 0.5f) * scale - 0.5f;
+            const ptrdiff_t first = ptrdiff_t(floorf(center - support)) + 1;
 
-        XMVECTOR* row0 = target + destImage.width;
-        XMVECTOR* row1 = row0 + srcImage.width;
-        XMVECTOR* row2 = row0 + srcImage.width * 2;
-        XMVECTOR* row3 = row0 + srcImage.width * 3;
+            uint32_t* index = axis.index.get() + u * taps;
+            float* weight = axis.weight.get() + u * taps;
 
-#ifdef _DEBUG
-        memset(row0, 0xCD, sizeof(XMVECTOR)*srcImage.width);
-        memset(row1, 0xDD, sizeof(XMVECTOR)*srcImage.width);
-        memset(row2, 0xED, sizeof(XMVECTOR)*srcImage.width);
-        memset(row3, 0xFD, sizeof(XMVECTOR)*srcImage.width);
-#endif
+            float total = 0.f;
+            for (size_t t = 0; t < taps; ++t)
+            {
+                const ptrdiff_t i = first + ptrdiff_t(t);
+                index[t] = static_cast<uint32_t>(bounduvw(i, maxu, wrap, mirror));
+                weight[t] = kernel((float(i) - center) / stretch);
+                total += weight[t];
+            }
 
-        const uint8_t* pSrc = srcImage.pixels;
-        uint8_t* pDest = destImage.pixels;
+            if (total != 0.f)
+            {
+                for (size_t t = 0; t < taps; ++t)
+                {
+                    weight[t] /= total;
+                }
+            }
+        }
 
-        size_t rowPitch = srcImage.rowPitch;
+        return S_OK;
+    }
+
+    HRESULT CreateResampleAxis(unsigned long filter_select, size_t source, size_t dest, bool wrap, bool mirror, ResampleAxis& axis) noexcept
+    {
+        switch (filter_select)
+        {
+        case TEX_FILTER_LINEAR:
+            // Mirror is the same case as clamp for linear
+            return CreateLinearAxis(source, dest, wrap, axis);
 
-        size_t u0 = size_t(-1);
-        size_t u1 = size_t(-1);
-        size_t u2 = size_t(-1);
-        size_t u3 = size_t(-1);
+        case TEX_FILTER_CUBIC:
+            return CreateCubicAxis(source, dest, wrap, mirror, axis);
 
-        for (size_t y = 0; y < destImage.height; ++y)
+        case TEX_FILTER_TRIANGLE:
+            return CreateTriangleAxis(source, dest, wrap, axis);
+
+        case TEX_FILTER_LANCZOS3:
+            return CreateKernelAxis(source, dest, wrap, mirror, 3.f, Lanczos3, axis);
+
+        case TEX_FILTER_MITCHELL:
+            return CreateKernelAxis(source, dest, wrap, mirror, 2.f, Mitchell, axis);
+
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+    }
+
+    // Rounds the weights of every destination texel so their fixed-point sum is the rounded float sum
+    void ComputeFixedWeights(ResampleAxis& axis, size_t dest) noexcept
+    {
+        const float one = float(1 << c_ResampleWeightBits);
+
+        for (size_t u = 0; u < dest; ++u)
         {
-            auto& toY = cfY[y];
+            const float* weight = axis.weight.get() + u * axis.taps;
+            int16_t* fixedWeight = axis.fixedWeight.get() + u * axis.taps;
 
-            // Scanline 1
-            if (toY.u0 != u0)
+            float total = 0.f;
+            long fixedTotal = 0;
+            size_t largest = 0;
+            for (size_t t = 0; t < axis.taps; ++t)
             {
-                if (toY.u0 != u1 && toY.u0 != u2 && toY.u0 != u3)
-                {
-                    u0 = toY.u0;
+                total += weight[t];
+                fixedWeight[t] = static_cast<int16_t>(lroundf(weight[t] * one));
+                fixedTotal += fixedWeight[t];
+                if (fabsf(weight[t]) > fabsf(weight[largest]))
+                    largest = t;
+            }
 
-                    if (!_LoadScanlineLinear(row0, srcImage.width, pSrc + (rowPitch * u0), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else if (toY.u0 == u1)
-                {
-                    u0 = u1;
-                    u1 = size_t(-1);
+            fixedWeight[largest] = static_cast<int16_t>(fixedWeight[largest] + lroundf(total * one) - fixedTotal);
+        }
+    }
 
-                    std::swap(row0, row1);
-                }
-                else if (toY.u0 == u2)
-                {
-                    u0 = u2;
-                    u2 = size_t(-1);
+    //--- Float passes, over XMVECTOR scanlines ---
+    void ResampleRow(XMVECTOR* pDest, const XMVECTOR* pSrc, const ResampleAxis& axis, size_t width) noexcept
+    {
+        const size_t taps = axis.taps;
 
-                    std::swap(row0, row2);
-                }
-                else if (toY.u0 == u3)
-                {
-                    u0 = u3;
-                    u3 = size_t(-1);
+        for (size_t x = 0; x < width; ++x)
+        {
+            const uint32_t* index = axis.index.get() + x * taps;
+            const float* weight = axis.weight.get() + x * taps;
 
-                    std::swap(row0, row3);
-                }
+            XMVECTOR sum = XMVectorZero();
+            for (size_t t = 0; t < taps; ++t)
+            {
+                sum = XMVectorMultiplyAdd(pSrc[index[t]], XMVectorReplicate(weight[t]), sum);
             }
 
-            // Scanline 2
-            if (toY.u1 != u1)
+            pDest[x] = sum;
+        }
+    }
+
+    void ResampleColumns(XMVECTOR* pDest, const XMVECTOR* pBuffer, size_t width, const uint32_t* slots, const float* weight, size_t taps) noexcept
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            XMVECTOR acc = XMVectorZero();
+            for (size_t t = 0; t < taps; ++t)
             {
-                if (toY.u1 != u2 && toY.u1 != u3)
-                {
-                    u1 = toY.u1;
+                acc = XMVectorMultiplyAdd(pBuffer[slots[t] * width + x], XMVectorReplicate(weight[t]), acc);
+            }
 
-                    if (!_LoadScanlineLinear(row1, srcImage.width, pSrc + (rowPitch * u1), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else if (toY.u1 == u2)
-                {
-                    u1 = u2;
-                    u2 = size_t(-1);
+            pDest[x] = acc;
+        }
+    }
 
-                    std::swap(row1, row2);
-                }
-                else if (toY.u1 == u3)
-                {
-                    u1 = u3;
-                    u3 = size_t(-1);
+    //--- Integer passes, 4 channels of 8 bits ---
+    inline int32_t PackWeights(int16_t w0, int16_t w1) noexcept
+    {
+        return static_cast<int32_t>(uint32_t(uint16_t(w0)) | (uint32_t(uint16_t(w1)) << 16));
+    }
 
-                    std::swap(row1, row3);
-                }
+#if defined(_XM_SSE_INTRINSICS_)
+    inline __m128i LoadTexel(const uint8_t* pSrc, uint32_t index) noexcept
+    {
+        int32_t value;
+        memcpy(&value, pSrc + size_t(index) * 4, sizeof(value));
+        return _mm_cvtsi32_si128(value);
+    }
+
+    // The channels of two texels interleaved as 16-bit values, for pmaddwd to weight and sum them
+    inline __m128i LoadTexelPair(const uint8_t* pSrc, uint32_t index0, uint32_t index1) noexcept
+    {
+        return _mm_unpacklo_epi8(_mm_unpacklo_epi8(LoadTexel(pSrc, index0), LoadTexel(pSrc, index1)), _mm_setzero_si128());
+    }
+#endif
+
+    void ResampleRowUByte4(int16_t* pDest, const uint8_t* pSrc, const ResampleAxis& axis, size_t width) noexcept
+    {
+        constexpr int shift = c_ResampleWeightBits - c_ResampleFractionBits;
+
+        const size_t taps = axis.taps;
+
+        for (size_t x = 0; x < width; ++x)
+        {
+            const uint32_t* index = axis.index.get() + x * taps;
+            const int16_t* weight = axis.fixedWeight.get() + x * taps;
+
+#if defined(_XM_SSE_INTRINSICS_)
+            __m128i acc = _mm_set1_epi32(1 << (shift - 1));
+
+            size_t t = 0;
+
+            for (; t + 2 <= taps; t += 2)
+            {
+                const __m128i w = _mm_set1_epi32(PackWeights(weight[t], weight[t + 1]));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(LoadTexelPair(pSrc, index[t], index[t + 1]), w));
             }
 
-            // Scanline 3
-            if (toY.u2 != u2)
+            if (t < taps)
             {
-                if (toY.u2 != u3)
-                {
-                    u2 = toY.u2;
+                const __m128i w = _mm_set1_epi32(PackWeights(weight[t], 0));
+                acc = _mm_add_epi32(acc, _mm_madd_epi16(LoadTexelPair(pSrc, index[t], index[t]), w));
+            }
 
-                    if (!_LoadScanlineLinear(row2, srcImage.width, pSrc + (rowPitch * u2), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else
+            acc = _mm_srai_epi32(acc, shift);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_packs_epi32(acc, acc));
+#else
+            int32_t acc[4] = { 1 << (shift - 1), 1 << (shift - 1), 1 << (shift - 1), 1 << (shift - 1) };
+            for (size_t t = 0; t < taps; ++t)
+            {
+                const uint8_t* texel = pSrc + size_t(index[t]) * 4;
+                for (size_t c = 0; c < 4; ++c)
                 {
-                    u2 = u3;
-                    u3 = size_t(-1);
-
-                    std::swap(row2, row3);
+                    acc[c] += int32_t(texel[c]) * weight[t];
                 }
             }
 
-            // Scanline 4
-            if (toY.u3 != u3)
+            for (size_t c = 0; c < 4; ++c)
             {
-                u3 = toY.u3;
-
-                if (!_LoadScanlineLinear(row3, srcImage.width, pSrc + (rowPitch * u3), rowPitch, srcImage.format, filter))
-                    return E_FAIL;
+                pDest[x * 4 + c] = static_cast<int16_t>(std::min(std::max(acc[c] >> shift, -32768), 32767));
             }
+#endif
+        }
+    }
 
-            for (size_t x = 0; x < destImage.width; ++x)
-            {
-                auto& toX = cfX[x];
+    void ResampleColumnsUByte4(uint8_t* pDest, const int16_t* pBuffer, size_t width, const uint32_t* slots, const int16_t* weight, size_t taps) noexcept
+    {
+        constexpr int shift = c_ResampleWeightBits + c_ResampleFractionBits;
+
+        const size_t stride = width * 4;
 
-                XMVECTOR C0, C1, C2, C3;
+        size_t x = 0;
 
-                CUBIC_INTERPOLATE(C0, toX.x, row0[toX.u0], row0[toX.u1], row0[toX.u2], row0[toX.u3])
-                CUBIC_INTERPOLATE(C1, toX.x, row1[toX.u0], row1[toX.u1], row1[toX.u2], row1[toX.u3])
-                CUBIC_INTERPOLATE(C2, toX.x, row2[toX.u0], row2[toX.u1], row2[toX.u2], row2[toX.u3])
-                CUBIC_INTERPOLATE(C3, toX.x, row3[toX.u0], row3[toX.u1], row3[toX.u2], row3[toX.u3])
+#if defined(_XM_SSE_INTRINSICS_)
+        // Two texels at a time
+        for (; x + 2 <= width; x += 2)
+        {
+            __m128i lo = _mm_set1_epi32(1 << (shift - 1));
+            __m128i hi = lo;
 
-                CUBIC_INTERPOLATE(target[x], toY.x, C0, C1, C2, C3)
+            for (size_t t = 0; t < taps; t += 2)
+            {
+                const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuffer + slots[t] * stride + x * 4));
+                const __m128i r1 = (t + 1 < taps)
+                    ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuffer + slots[t + 1] * stride + x * 4))
+                    : _mm_setzero_si128();
+                const __m128i w = _mm_set1_epi32(PackWeights(weight[t], (t + 1 < taps) ? weight[t + 1] : int16_t(0)));
+                lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(r0, r1), w));
+                hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(r0, r1), w));
             }
 
-            if (!_StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
-                return E_FAIL;
-            pDest += destImage.rowPitch;
+            const __m128i v = _mm_packs_epi32(_mm_srai_epi32(lo, shift), _mm_srai_epi32(hi, shift));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pDest + x * 4), _mm_packus_epi16(v, v));
         }
+#endif
 
-        return S_OK;
-    }
+        for (; x < width; ++x)
+        {
+            for (size_t c = 0; c < 4; ++c)
+            {
+                int32_t acc = 1 << (shift - 1);
+                for (size_t t = 0; t < taps; ++t)
+                {
+                    acc += int32_t(pBuffer[slots[t] * stride + x * 4 + c]) * weight[t];
+                }
 
+                pDest[x * 4 + c] = static_cast<uint8_t>(std::min(std::max(acc >> shift, 0), 255));
+            }
+        }
+    }
 
-    //--- Triangle Filter ---
-    HRESULT ResizeTriangleFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    //--- Bands of destination rows ---
+    struct ResampleJob
     {
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
-
-        using namespace TriangleFilter;
+        const Image*        srcImage;
+        const Image*        destImage;
+        TEX_FILTER_FLAGS    filter;
+        const ResampleAxis* axisX;
+        const ResampleAxis* axisY;
+        size_t              rowsPerBand;
+        bool                integer;
+        bool                alphaBias;
+    };
+
+    HRESULT ResampleBandFloat(const ResampleJob& job, size_t yBegin, size_t yEnd, const uint32_t* rows, size_t nrows, const uint32_t* slots) noexcept
+    {
+        const Image& srcImage = *job.srcImage;
+        const Image& destImage = *job.destImage;
 
-        // Allocate initial temporary space (1 scanline, accumulation rows, plus X and Y filters)
-        auto scanline = make_AlignedArrayXMVECTOR(srcImage.width);
+        // Allocate temporary space (1 source scanline, 1 target scanline, plus a buffer scanline per source row)
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) + uint64_t(destImage.width) * (uint64_t(nrows) + 1));
         if (!scanline)
             return E_OUTOFMEMORY;
 
-        std::unique_ptr<TriangleRow[]> rowActive(new (std::nothrow) TriangleRow[destImage.height]);
-        if (!rowActive)
-            return E_OUTOFMEMORY;
-
-        TriangleRow * rowFree = nullptr;
-
-        std::unique_ptr<Filter> tfX;
-        HRESULT hr = _Create(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, tfX);
-        if (FAILED(hr))
-            return hr;
-
-        std::unique_ptr<Filter> tfY;
-        hr = _Create(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, tfY);
-        if (FAILED(hr))
-            return hr;
-
         XMVECTOR* row = scanline.get();
+        XMVECTOR* target = row + srcImage.width;
+        XMVECTOR* buffer = target + destImage.width;
 
-#ifdef _DEBUG
-        memset(row, 0xCD, sizeof(XMVECTOR)*srcImage.width);
-#endif
-
-        auto xFromEnd = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(tfX.get()) + tfX->sizeInBytes);
-        auto yFromEnd = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(tfY.get()) + tfY->sizeInBytes);
-
-        // Count times rows get written
-        for (FilterFrom* yFrom = tfY->from; yFrom < yFromEnd; )
+        for (size_t r = 0; r < nrows; ++r)
         {
-            for (size_t j = 0; j < yFrom->count; ++j)
-            {
-                size_t v = yFrom->to[j].u;
-                assert(v < destImage.height);
-                ++rowActive[v].remaining;
-            }
+            if (!_LoadScanlineLinear(row, srcImage.width, srcImage.pixels + srcImage.rowPitch * rows[r], srcImage.rowPitch, srcImage.format, job.filter))
+                return E_FAIL;
 
-            yFrom = reinterpret_cast<FilterFrom*>(reinterpret_cast<uint8_t*>(yFrom) + yFrom->sizeInBytes);
+            ResampleRow(buffer + r * destImage.width, row, *job.axisX, destImage.width);
         }
 
-        // Filter image
-        const uint8_t* pSrc = srcImage.pixels;
-        size_t rowPitch = srcImage.rowPitch;
-        const uint8_t* pEndSrc = pSrc + rowPitch * srcImage.height;
+        const size_t taps = job.axisY->taps;
 
-        uint8_t* pDest = destImage.pixels;
+        uint8_t* pDest = destImage.pixels + destImage.rowPitch * yBegin;
 
-        for (FilterFrom* yFrom = tfY->from; yFrom < yFromEnd; )
+        for (size_t y = yBegin; y < yEnd; ++y)
         {
-            // Create accumulation rows as needed
-            for (size_t j = 0; j < yFrom->count; ++j)
+            ResampleColumns(target, buffer, destImage.width, slots + (y - yBegin) * taps, job.axisY->weight.get() + y * taps, taps);
+
+            if (job.alphaBias)
             {
-                size_t v = yFrom->to[j].u;
-                assert(v < destImage.height);
-                TriangleRow* rowAcc = &rowActive[v];
+                // Need to slightly bias results for floating-point error accumulation which can
+                // be visible with harshly quantized values
+                static const XMVECTORF32 Bias = { { { 0.f, 0.f, 0.f, 0.1f } } };
 
-                if (!rowAcc->scanline)
+                XMVECTOR* ptr = target;
+                for (size_t i = 0; i < destImage.width; ++i, ++ptr)
                 {
-                    if (rowFree)
-                    {
-                        // Steal and reuse scanline from 'free row' list
-                        assert(rowFree->scanline != nullptr);
-                        rowAcc->scanline.reset(rowFree->scanline.release());
-                        rowFree = rowFree->next;
-                    }
-                    else
-                    {
-                        auto nscanline = make_AlignedArrayXMVECTOR(destImage.width);
-                        if (!nscanline)
-                            return E_OUTOFMEMORY;
-                        rowAcc->scanline.swap(nscanline);
-                    }
-
-                    memset(rowAcc->scanline.get(), 0, sizeof(XMVECTOR) * destImage.width);
+                    *ptr = XMVectorAdd(*ptr, Bias);
                 }
             }
 
-            // Load source scanline
-            if ((pSrc + rowPitch) > pEndSrc)
+            // This performs any required clamping
+            if (!_StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, job.filter))
                 return E_FAIL;
+            pDest += destImage.rowPitch;
+        }
 
-            if (!_LoadScanlineLinear(row, srcImage.width, pSrc, rowPitch, srcImage.format, filter))
-                return E_FAIL;
+        return S_OK;
+    }
 
-            pSrc += rowPitch;
+    HRESULT ResampleBandUByte4(const ResampleJob& job, size_t yBegin, size_t yEnd, const uint32_t* rows, size_t nrows, const uint32_t* slots) noexcept
+    {
+        const Image& srcImage = *job.srcImage;
+        const Image& destImage = *job.destImage;
 
-            // Process row
-            size_t x = 0;
-            for (FilterFrom* xFrom = tfX->from; xFrom < xFromEnd; ++x)
-            {
-                for (size_t j = 0; j < yFrom->count; ++j)
-                {
-                    size_t v = yFrom->to[j].u;
-                    assert(v < destImage.height);
-                    float yweight = yFrom->to[j].weight;
+        const uint64_t bufferSize = uint64_t(destImage.width) * uint64_t(nrows) * 4;
+        if (bufferSize > SIZE_MAX / sizeof(int16_t))
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
 
-                    XMVECTOR* accPtr = rowActive[v].scanline.get();
-                    if (!accPtr)
-                        return E_POINTER;
+        std::unique_ptr<int16_t[]> buffer(new (std::nothrow) int16_t[static_cast<size_t>(bufferSize)]);
+        if (!buffer)
+            return E_OUTOFMEMORY;
 
-                    for (size_t k = 0; k < xFrom->count; ++k)
-                    {
-                        size_t u = xFrom->to[k].u;
-                        assert(u < destImage.width);
+        for (size_t r = 0; r < nrows; ++r)
+        {
+            ResampleRowUByte4(buffer.get() + r * destImage.width * 4, srcImage.pixels + srcImage.rowPitch * rows[r], *job.axisX, destImage.width);
+        }
 
-                        XMVECTOR weight = XMVectorReplicate(yweight * xFrom->to[k].weight);
+        const size_t taps = job.axisY->taps;
 
-                        assert(x < srcImage.width);
-                        accPtr[u] = XMVectorMultiplyAdd(row[x], weight, accPtr[u]);
-                    }
-                }
+        uint8_t* pDest = destImage.pixels + destImage.rowPitch * yBegin;
 
-                xFrom = reinterpret_cast<FilterFrom*>(reinterpret_cast<uint8_t*>(xFrom) + xFrom->sizeInBytes);
-            }
+        for (size_t y = yBegin; y < yEnd; ++y)
+        {
+            ResampleColumnsUByte4(pDest, buffer.get(), destImage.width, slots + (y - yBegin) * taps, job.axisY->fixedWeight.get() + y * taps, taps);
+            pDest += destImage.rowPitch;
+        }
 
-            // Write completed accumulation rows
-            for (size_t j = 0; j < yFrom->count; ++j)
-            {
-                size_t v = yFrom->to[j].u;
-                assert(v < destImage.height);
-                TriangleRow* rowAcc = &rowActive[v];
+        return S_OK;
+    }
 
-                assert(rowAcc->remaining > 0);
-                --rowAcc->remaining;
+    HRESULT ResampleBand(const ResampleJob& job, size_t band) noexcept
+    {
+        const size_t yBegin = band * job.rowsPerBand;
+        const size_t yEnd = std::min(yBegin + job.rowsPerBand, job.destImage->height);
 
-                if (!rowAcc->remaining)
-                {
-                    XMVECTOR* pAccSrc = rowAcc->scanline.get();
-                    if (!pAccSrc)
-                        return E_POINTER;
-
-                    switch (destImage.format)
-                    {
-                    case DXGI_FORMAT_R10G10B10A2_UNORM:
-                    case DXGI_FORMAT_R10G10B10A2_UINT:
-                    {
-                        // Need to slightly bias results for floating-point error accumulation which can
-                        // be visible with harshly quantized values
-                        static const XMVECTORF32 Bias = { { { 0.f, 0.f, 0.f, 0.1f } } };
-
-                        XMVECTOR* ptr = pAccSrc;
-                        for (size_t i = 0; i < destImage.width; ++i, ++ptr)
-                        {
-                            *ptr = XMVectorAdd(*ptr, Bias);
-                        }
-                    }
-                    break;
-
-                    default:
-                        break;
-                    }
-
-                    // This performs any required clamping
-                    if (!_StoreScanlineLinear(pDest + (destImage.rowPitch * v), destImage.rowPitch, destImage.format, pAccSrc, destImage.width, filter))
-                        return E_FAIL;
-
-                    // Put row on freelist to reuse it's allocated scanline
-                    rowAcc->next = rowFree;
-                    rowFree = rowAcc;
-                }
-            }
+        const size_t taps = job.axisY->taps;
+        const size_t count = (yEnd - yBegin) * taps;
 
-            yFrom = reinterpret_cast<FilterFrom*>(reinterpret_cast<uint8_t*>(yFrom) + yFrom->sizeInBytes);
+        // Source rows the band reads, in increasing order, and the one each vertical tap reads from
+        std::unique_ptr<uint32_t[]> rows(new (std::nothrow) uint32_t[count]);
+        std::unique_ptr<uint32_t[]> slots(new (std::nothrow) uint32_t[count]);
+        if (!rows || !slots)
+            return E_OUTOFMEMORY;
+
+        const uint32_t* index = job.axisY->index.get() + yBegin * taps;
+        memcpy(rows.get(), index, sizeof(uint32_t) * count);
+        std::sort(rows.get(), rows.get() + count);
+        const auto nrows = static_cast<size_t>(std::unique(rows.get(), rows.get() + count) - rows.get());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            slots[i] = static_cast<uint32_t>(std::lower_bound(rows.get(), rows.get() + nrows, index[i]) - rows.get());
         }
 
-        return S_OK;
+        if (job.integer)
+            return ResampleBandUByte4(job, yBegin, yEnd, rows.get(), nrows, slots.get());
+
+        return ResampleBandFloat(job, yBegin, yEnd, rows.get(), nrows, slots.get());
+    }
+
+    bool UseIntegerResample(DXGI_FORMAT format, TEX_FILTER_FLAGS filter) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            return (filter & TEX_FILTER_SRGB) == 0;
+
+        default:
+            return false;
+        }
+    }
+
+    //--- Separable filters ---
+    HRESULT ResizeSeparableFilter(const Image& srcImage, unsigned long filter_select, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    {
+        assert(srcImage.pixels && destImage.pixels);
+        assert(srcImage.format == destImage.format);
+
+        ResampleAxis axisX;
+        HRESULT hr = CreateResampleAxis(filter_select, srcImage.width, destImage.width,
+            (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, axisX);
+        if (FAILED(hr))
+            return hr;
+
+        ResampleAxis axisY;
+        hr = CreateResampleAxis(filter_select, srcImage.height, destImage.height,
+            (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, axisY);
+        if (FAILED(hr))
+            return hr;
+
+        ResampleJob job = {};
+        job.srcImage = &srcImage;
+        job.destImage = &destImage;
+        job.filter = filter;
+        job.axisX = &axisX;
+        job.axisY = &axisY;
+        job.integer = UseIntegerResample(srcImage.format, filter);
+        job.alphaBias = (filter_select == TEX_FILTER_TRIANGLE)
+            && (destImage.format == DXGI_FORMAT_R10G10B10A2_UNORM || destImage.format == DXGI_FORMAT_R10G10B10A2_UINT);
+
+        if (job.integer)
+        {
+            ComputeFixedWeights(axisX, destImage.width);
+            ComputeFixedWeights(axisY, destImage.height);
+        }
+
+        // Bands whose source rows stay in cache, but big enough that the rows two bands share are a small part of the work
+        const size_t rowBytes = destImage.width * (job.integer ? sizeof(int16_t) * 4 : sizeof(XMVECTOR));
+        const size_t budgetRows = std::max<size_t>(c_ResampleBandBytes / rowBytes, 1);
+        const float rowsPerDest = std::max(float(srcImage.height) / float(destImage.height), 1.f);
+
+        size_t rowsPerBand = (budgetRows > axisY.taps) ? size_t(float(budgetRows - axisY.taps) / rowsPerDest) : 0;
+        rowsPerBand = std::max(rowsPerBand, size_t(ceilf(float(axisY.taps) / rowsPerDest)));
+        job.rowsPerBand = std::min(std::max<size_t>(rowsPerBand, 1), destImage.height);
+
+        const size_t bands = (destImage.height + job.rowsPerBand - 1) / job.rowsPerBand;
+
+        return _ParallelFor(bands, (filter & TEX_FILTER_PARALLEL) != 0, [&job](size_t band) -> HRESULT
+            {
+                return ResampleBand(job, band);
+            });
     }
 
 
@@ -814,13 +1016,11 @@ namespace
             return ResizeBoxFilter(srcImage, filter, destImage);
 
         case TEX_FILTER_LINEAR:
-            return ResizeLinearFilter(srcImage, filter, destImage);
-
         case TEX_FILTER_CUBIC:
-            return ResizeCubicFilter(srcImage, filter, destImage);
-
         case TEX_FILTER_TRIANGLE:
-            return ResizeTriangleFilter(srcImage, filter, destImage);
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            return ResizeSeparableFilter(srcImage, filter_select, filter, destImage);
 
         default:
             return HRESULT_E_NOT_SUPPORTED;
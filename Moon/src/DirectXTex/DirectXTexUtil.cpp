@@ -11,6 +11,13 @@
 
 #include "DirectXTexP.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
 static_assert(XBOX_DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT == DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT, "Xbox mismatch detected");
 static_assert(XBOX_DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT == DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT, "Xbox mismatch detected");
@@ -332,6 +339,203 @@ void DirectX::SetWICFactory(_In_opt_ IWICImagingFactory* pWIC) noexcept
 #endif // WIN32
 
 
+//=====================================================================================
+// Threading Utilities
+//=====================================================================================
+
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // One _ParallelFor call. The caller and the pool workers that pick it up claim indices one at a time,
+    // the caller returns once every index is done: past that the workers only keep the job itself alive
+    class ParallelJob
+    {
+    public:
+        ParallelJob(const std::function<HRESULT(size_t index)>& body, size_t count) noexcept :
+            m_body(&body),
+            m_count(count),
+            m_nextIndex(0),
+            m_doneCount(0),
+            m_stop(false),
+            m_result(S_OK)
+        {
+        }
+
+        // Runs the next index, false once they are all claimed
+        bool RunNext() noexcept
+        {
+            const size_t index = m_nextIndex++;
+            if (index >= m_count)
+                return false;
+
+            if (!m_stop)
+            {
+                const HRESULT hr = (*m_body)(index);
+                if (FAILED(hr))
+                    Fail(hr);
+            }
+
+            if (++m_doneCount == m_count)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_finished.notify_all();
+            }
+            return true;
+        }
+
+        // No more indices are run, the first failure is the result
+        void Fail(HRESULT hr) noexcept
+        {
+            HRESULT expected = S_OK;
+            m_result.compare_exchange_strong(expected, hr);
+            m_stop = true;
+        }
+
+        bool IsStopped() const noexcept { return m_stop; }
+
+        HRESULT Wait() noexcept
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_finished.wait(lock, [this]() { return m_doneCount.load() == m_count; });
+            return m_result.load();
+        }
+
+    private:
+        const std::function<HRESULT(size_t index)>* m_body;
+        size_t m_count;
+        std::atomic<size_t> m_nextIndex;
+        std::atomic<size_t> m_doneCount;
+        std::atomic<bool> m_stop;
+        std::atomic<HRESULT> m_result;
+        std::mutex m_mutex;
+        std::condition_variable m_finished;
+    };
+
+    //-------------------------------------------------------------------------------------
+    // Worker threads shared by every _ParallelFor call, one per hardware thread besides the calling one,
+    // created on first use. Calls from several threads at once, or from inside a body, share them
+    class ThreadPool
+    {
+    public:
+        static ThreadPool& Get() noexcept
+        {
+            static ThreadPool s_pool;
+            return s_pool;
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_shutdown = true;
+            }
+            m_wake.notify_all();
+            for (auto& thread : m_threads)
+                thread.join();
+        }
+
+        size_t GetWorkerCount() const noexcept { return m_threads.size(); }
+
+        // Up to helpers workers join the job, however many are idle. The caller gets through it alone otherwise
+        void Submit(const std::shared_ptr<ParallelJob>& job, size_t helpers) noexcept
+        {
+            try
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (size_t i = 0; i < helpers; ++i)
+                    m_queue.push_back(job);
+            }
+            catch (...)
+            {
+            }
+            m_wake.notify_all();
+        }
+
+    private:
+        ThreadPool() noexcept :
+            m_shutdown(false)
+        {
+            const size_t threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+            try
+            {
+                m_threads.reserve(threadCount);
+                for (size_t i = 0; i < threadCount; ++i)
+                    m_threads.emplace_back([this]() { WorkerMain(); });
+            }
+            catch (...)
+            {
+                // Fewer workers than hoped for, callers still get through every index
+            }
+        }
+
+        void WorkerMain() noexcept
+        {
+            for (;;)
+            {
+                std::shared_ptr<ParallelJob> job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wake.wait(lock, [this]() { return m_shutdown || !m_queue.empty(); });
+                    if (m_shutdown)
+                        return;
+                    job = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+
+                while (job->RunNext())
+                {
+                }
+            }
+        }
+
+        std::vector<std::thread> m_threads;
+        std::deque<std::shared_ptr<ParallelJob>> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_shutdown;
+    };
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::_ParallelFor(
+    size_t count,
+    bool parallel,
+    const std::function<HRESULT(size_t index)>& body,
+    const std::function<bool()>& progress) noexcept
+{
+    if (!count)
+        return S_OK;
+
+    std::shared_ptr<ParallelJob> job;
+    try
+    {
+        job = std::make_shared<ParallelJob>(body, count);
+    }
+    catch (...)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    if (parallel && count > 1)
+    {
+        ThreadPool& pool = ThreadPool::Get();
+        pool.Submit(job, std::min(pool.GetWorkerCount(), count - 1));
+    }
+
+    // The calling thread works too, and reports progress between its indices
+    while (job->RunNext())
+    {
+        if (progress && !job->IsStopped() && !progress())
+            job->Fail(E_ABORT);
+    }
+
+    return job->Wait();
+}
+
+
 //=====================================================================================
 // DXGI Format Utilities
 //=====================================================================================
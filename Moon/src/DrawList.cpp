@@ -0,0 +1,159 @@
+#include "mnpch.h"
+#include "DrawList.h"
+#include "JobSystem.h"
+
+namespace Moon
+{
+	namespace
+	{
+		constexpr uint32_t RadixBits = 8;
+		constexpr uint32_t RadixSize = 1u << RadixBits;
+		constexpr uint32_t RadixPasses = 64 / RadixBits;
+
+		// Below this size spreading the sort over the workers costs more than it saves.
+		constexpr size_t ParallelSortThreshold = 64 * 1024;
+
+		inline uint32_t Digit(uint64_t key, uint32_t pass)
+		{
+			return (uint32_t)(key >> (pass * RadixBits)) & (RadixSize - 1);
+		}
+	}
+
+	void DrawList::Clear()
+	{
+		mKeys.clear();
+		mItems.clear();
+	}
+
+	void DrawList::Reserve(size_t count)
+	{
+		mKeys.reserve(count);
+		mItems.reserve(count);
+	}
+
+	void DrawList::Add(uint64_t key, uint32_t item)
+	{
+		mKeys.push_back(key);
+		mItems.push_back(item);
+	}
+
+	void DrawList::Sort(JobSystem* jobSystem)
+	{
+		if (mKeys.size() < 2)
+			return;
+
+		mKeysScratch.resize(mKeys.size());
+		mItemsScratch.resize(mItems.size());
+
+		if (jobSystem && jobSystem->GetWorkerCount() > 0 && mKeys.size() >= ParallelSortThreshold)
+			SortParallel(jobSystem);
+		else
+			SortSerial();
+	}
+
+	void DrawList::SortSerial()
+	{
+		const size_t count = mKeys.size();
+
+		// One read of the keys builds the histograms of every pass.
+		mHistograms.assign(RadixPasses * RadixSize, 0);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint64_t key = mKeys[i];
+			for (uint32_t pass = 0; pass < RadixPasses; ++pass)
+				mHistograms[pass * RadixSize + Digit(key, pass)]++;
+		}
+
+		for (uint32_t pass = 0; pass < RadixPasses; ++pass)
+		{
+			uint32_t* histogram = &mHistograms[pass * RadixSize];
+
+			// Every key has the same digit, this pass would be a plain copy.
+			if (histogram[Digit(mKeys[0], pass)] == count)
+				continue;
+
+			uint32_t offset = 0;
+			for (uint32_t b = 0; b < RadixSize; ++b)
+			{
+				const uint32_t bucketCount = histogram[b];
+				histogram[b] = offset;
+				offset += bucketCount;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const uint32_t dst = histogram[Digit(mKeys[i], pass)]++;
+				mKeysScratch[dst] = mKeys[i];
+				mItemsScratch[dst] = mItems[i];
+			}
+
+			mKeys.swap(mKeysScratch);
+			mItems.swap(mItemsScratch);
+		}
+	}
+
+	void DrawList::SortParallel(JobSystem* jobSystem)
+	{
+		const uint32_t count = (uint32_t)mKeys.size();
+		const uint32_t chunkCount = jobSystem->GetWorkerCount() + 1;
+		const uint32_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+		mHistograms.resize(chunkCount * RadixSize);
+
+		for (uint32_t pass = 0; pass < RadixPasses; ++pass)
+		{
+			std::fill(mHistograms.begin(), mHistograms.end(), 0);
+
+			jobSystem->ParallelFor(chunkCount, 1, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				for (uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+				{
+					uint32_t* histogram = &mHistograms[chunk * RadixSize];
+					const uint32_t begin = std::min(chunk * chunkSize, count);
+					const uint32_t end = std::min(begin + chunkSize, count);
+					for (uint32_t i = begin; i < end; ++i)
+						histogram[Digit(mKeys[i], pass)]++;
+				}
+			});
+
+			const uint32_t firstDigit = Digit(mKeys[0], pass);
+			uint32_t firstDigitCount = 0;
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+				firstDigitCount += mHistograms[chunk * RadixSize + firstDigit];
+			if (firstDigitCount == count)
+				continue;
+
+			// Bucket-major prefix sum: chunk N writes its part of a bucket right after chunk N-1, keeping the sort stable.
+			uint32_t offset = 0;
+			for (uint32_t b = 0; b < RadixSize; ++b)
+			{
+				for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+				{
+					uint32_t& slot = mHistograms[chunk * RadixSize + b];
+					const uint32_t bucketCount = slot;
+					slot = offset;
+					offset += bucketCount;
+				}
+			}
+
+			jobSystem->ParallelFor(chunkCount, 1, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+			{
+				for (uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+				{
+					uint32_t* offsets = &mHistograms[chunk * RadixSize];
+					const uint32_t begin = std::min(chunk * chunkSize, count);
+					const uint32_t end = std::min(begin + chunkSize, count);
+					for (uint32_t i = begin; i < end; ++i)
+					{
+						const uint32_t dst = offsets[Digit(mKeys[i], pass)]++;
+						mKeysScratch[dst] = mKeys[i];
+						mItemsScratch[dst] = mItems[i];
+					}
+				}
+			});
+
+			mKeys.swap(mKeysScratch);
+			mItems.swap(mItemsScratch);
+		}
+	}
+}
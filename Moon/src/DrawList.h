@@ -0,0 +1,83 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Moon
+{
+	class JobSystem;
+
+	// Packed 64-bit draw key, most significant field first so sorting groups state changes:
+	// [63..60] pass | [59..52] pipeline state | [51..40] material | [39..28] geometry | [27..0] depth
+	namespace DrawSortKey
+	{
+		constexpr uint32_t DepthBits = 28;
+		constexpr uint32_t GeometryBits = 12;
+		constexpr uint32_t MaterialBits = 12;
+		constexpr uint32_t PipelineBits = 8;
+		constexpr uint32_t PassBits = 4;
+
+		constexpr uint32_t DepthShift = 0;
+		constexpr uint32_t GeometryShift = DepthShift + DepthBits;
+		constexpr uint32_t MaterialShift = GeometryShift + GeometryBits;
+		constexpr uint32_t PipelineShift = MaterialShift + MaterialBits;
+		constexpr uint32_t PassShift = PipelineShift + PipelineBits;
+
+		// Maps a view space depth to [0, 2^DepthBits) so that closer items sort first.
+		inline uint32_t QuantizeDepth(float viewDepth, float nearZ, float farZ)
+		{
+			float t = (viewDepth - nearZ) / (farZ - nearZ);
+			t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+			// In double, 2^28 - 1 rounds up to 2^28 in float and the far plane would wrap to depth 0.
+			return (uint32_t)(t * (double)((1u << DepthBits) - 1));
+		}
+
+		// Every field must fit its bits, a wider id would alias another one and batch with it.
+		inline uint64_t Make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t geometry, uint32_t depth)
+		{
+			assert(pass < (1u << PassBits) && pipeline < (1u << PipelineBits));
+			assert(material < (1u << MaterialBits) && geometry < (1u << GeometryBits) && depth < (1u << DepthBits));
+			return ((uint64_t)(pass & ((1u << PassBits) - 1)) << PassShift)
+				| ((uint64_t)(pipeline & ((1u << PipelineBits) - 1)) << PipelineShift)
+				| ((uint64_t)(material & ((1u << MaterialBits) - 1)) << MaterialShift)
+				| ((uint64_t)(geometry & ((1u << GeometryBits) - 1)) << GeometryShift)
+				| ((uint64_t)(depth & ((1u << DepthBits) - 1)) << DepthShift);
+		}
+
+		inline uint32_t GetPass(uint64_t key) { return (uint32_t)(key >> PassShift) & ((1u << PassBits) - 1); }
+		inline uint32_t GetPipeline(uint64_t key) { return (uint32_t)(key >> PipelineShift) & ((1u << PipelineBits) - 1); }
+		inline uint32_t GetMaterial(uint64_t key) { return (uint32_t)(key >> MaterialShift) & ((1u << MaterialBits) - 1); }
+		inline uint32_t GetGeometry(uint64_t key) { return (uint32_t)(key >> GeometryShift) & ((1u << GeometryBits) - 1); }
+		inline uint32_t GetDepth(uint64_t key) { return (uint32_t)(key >> DepthShift) & ((1u << DepthBits) - 1); }
+	}
+
+	// List of (key, item index) pairs sorted with a stable LSD radix sort.
+	// Scratch buffers are kept between frames so a steady-state frame does not allocate.
+	class DrawList
+	{
+	public:
+		void Clear();
+		void Reserve(size_t count);
+		void Add(uint64_t key, uint32_t item);
+
+		// jobSystem is optional, big lists are split across its workers when provided.
+		void Sort(JobSystem* jobSystem = nullptr);
+
+		size_t Size() const { return mKeys.size(); }
+		bool Empty() const { return mKeys.empty(); }
+		uint64_t GetKey(size_t i) const { return mKeys[i]; }
+		uint32_t GetItem(size_t i) const { return mItems[i]; }
+		const std::vector<uint32_t>& GetItems() const { return mItems; }
+
+	private:
+		void SortSerial();
+		void SortParallel(JobSystem* jobSystem);
+
+		std::vector<uint64_t> mKeys;
+		std::vector<uint32_t> mItems;
+		std::vector<uint64_t> mKeysScratch;
+		std::vector<uint32_t> mItemsScratch;
+		std::vector<uint32_t> mHistograms;
+	};
+}
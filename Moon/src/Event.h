@@ -1,6 +1,6 @@
 #pragma once 
+#include <cstdint>
 #include <sstream>
-#include <Windows.h>
 
 #define BIT(x) (1 << x)
 
@@ -98,19 +98,19 @@ namespace Moon
 	class KeyEvent :public Event
 	{
 	public:
-		WPARAM GetKey() const { return mKey; }
+		uintptr_t GetKey() const { return mKey; }
 		EVENT_CLASS_CATEGORY(EventCategoryKeyboard | EventCategoryInput)
 	protected:
-		KeyEvent(const WPARAM key)
+		KeyEvent(const uintptr_t key)
 			:mKey(key) {}
 
-		WPARAM mKey;
+		uintptr_t mKey;
 	};
 
 	class KeyPressedEvent : public KeyEvent
 	{
 	public:
-		KeyPressedEvent(const WPARAM key, const uint16_t repeatCount)
+		KeyPressedEvent(const uintptr_t key, const uint16_t repeatCount)
 			: KeyEvent(key), mRepeatCount(repeatCount) {}
 
 		uint16_t GetRepeatCount() const { return mRepeatCount; }
@@ -130,7 +130,7 @@ namespace Moon
 	class KeyReleasedEvent : public KeyEvent
 	{
 	public:
-		KeyReleasedEvent(const WPARAM key)
+		KeyReleasedEvent(const uintptr_t key)
 			: KeyEvent(key) {}
 
 		std::string ToString() const override
@@ -146,12 +146,12 @@ namespace Moon
 	class MouseMovedEvent : public Event
 	{
 	public:
-		MouseMovedEvent(WPARAM btnState, const int x, const int y)
+		MouseMovedEvent(uintptr_t btnState, const int x, const int y)
 			:mBtnState(btnState), mMouseX(x), mMouseY(y) {}
 
 		int GetX() const { return mMouseX; }
 		int GetY() const { return mMouseY; }
-		WPARAM GetBtnState() const { return mBtnState; }
+		uintptr_t GetBtnState() const { return mBtnState; }
 
 		std::string ToString() const override
 		{
@@ -164,7 +164,7 @@ namespace Moon
 			EVENT_CLASS_CATEGORY(EventCategoryMouse | EventCategoryInput)
 
 	private:
-		WPARAM mBtnState;
+		uintptr_t mBtnState;
 		int mMouseX;
 		int mMouseY;
 	};
@@ -195,17 +195,17 @@ namespace Moon
 	class MouseButtonEvent : public Event
 	{
 	public:
-		WPARAM GetBtnState() const { return mBtnState; }
+		uintptr_t GetBtnState() const { return mBtnState; }
 		int GetX() const { return mMouseX; }
 		int GetY() const { return mMouseY; }
 
 		EVENT_CLASS_CATEGORY(EventCategoryMouse | EventCategoryInput | EventCategoryMouseButton)
 
 	protected:
-		MouseButtonEvent(WPARAM btnState, const int x, const int y)
+		MouseButtonEvent(uintptr_t btnState, const int x, const int y)
 			:mBtnState(btnState), mMouseX(x), mMouseY(y) {}
 
-		WPARAM mBtnState;
+		uintptr_t mBtnState;
 		int mMouseX;
 		int mMouseY;
 	};
@@ -213,7 +213,7 @@ namespace Moon
 	class MouseButtonPressedEvent : public MouseButtonEvent
 	{
 	public:
-		MouseButtonPressedEvent(WPARAM btnState, const int x, const int y)
+		MouseButtonPressedEvent(uintptr_t btnState, const int x, const int y)
 			:MouseButtonEvent(btnState, x, y) {}
 
 		std::string ToString() const override
@@ -229,7 +229,7 @@ namespace Moon
 	class MouseButtonReleasedEvent : public MouseButtonEvent
 	{
 	public:
-		MouseButtonReleasedEvent(WPARAM btnState, const int x, const int y)
+		MouseButtonReleasedEvent(uintptr_t btnState, const int x, const int y)
 			:MouseButtonEvent(btnState, x, y) {}
 
 		std::string ToString() const override
@@ -0,0 +1,260 @@
+#include "mnpch.h"
+#include "FrameStats.h"
+
+#include <cmath>
+#include <fstream>
+
+namespace Moon
+{
+	uint32_t FrameTimeHistogram::GetBucketIndex(uint32_t microseconds)
+	{
+		if (microseconds < SubBucketCount)
+			return microseconds;
+
+		// Shift until the value fits in the upper half of the sub buckets.
+		uint32_t exponent = 1;
+		while ((microseconds >> exponent) >= SubBucketCount)
+			exponent++;
+		if (exponent > MaxExponent)
+			return BucketCount - 1;
+
+		return SubBucketCount + (exponent - 1) * SubBucketHalfCount + ((microseconds >> exponent) - SubBucketHalfCount);
+	}
+
+	uint32_t FrameTimeHistogram::GetBucketLowerBound(uint32_t bucket)
+	{
+		if (bucket < SubBucketCount)
+			return bucket;
+
+		const uint32_t exponent = (bucket - SubBucketCount) / SubBucketHalfCount + 1;
+		const uint32_t subBucket = (bucket - SubBucketCount) % SubBucketHalfCount + SubBucketHalfCount;
+		return subBucket << exponent;
+	}
+
+	uint32_t FrameTimeHistogram::GetBucketUpperBound(uint32_t bucket)
+	{
+		if (bucket < SubBucketCount)
+			return bucket + 1;
+
+		const uint32_t exponent = (bucket - SubBucketCount) / SubBucketHalfCount + 1;
+		const uint32_t subBucket = (bucket - SubBucketCount) % SubBucketHalfCount + SubBucketHalfCount;
+		return (subBucket + 1) << exponent;
+	}
+
+	void FrameTimeHistogram::Clear()
+	{
+		mCounts.fill(0);
+		mTotalCount = 0;
+	}
+
+	void FrameTimeHistogram::Add(uint32_t microseconds)
+	{
+		mCounts[GetBucketIndex(microseconds)]++;
+		mTotalCount++;
+	}
+
+	void FrameTimeHistogram::Remove(uint32_t microseconds)
+	{
+		mCounts[GetBucketIndex(microseconds)]--;
+		mTotalCount--;
+	}
+
+	float FrameTimeHistogram::GetPercentileMS(double percentile) const
+	{
+		if (mTotalCount == 0)
+			return 0.0f;
+
+		const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(percentile / 100.0 * (double)mTotalCount));
+		uint64_t cumulative = 0;
+		for (uint32_t bucket = 0; bucket < BucketCount; ++bucket)
+		{
+			cumulative += mCounts[bucket];
+			if (cumulative >= rank)
+				return (GetBucketLowerBound(bucket) + GetBucketUpperBound(bucket)) * 0.5f / 1000.0f;
+		}
+		return GetBucketLowerBound(BucketCount - 1) / 1000.0f;
+	}
+
+	uint32_t FrameTimeSeries::ToMicroseconds(float ms)
+	{
+		const double us = (double)ms * 1000.0 + 0.5;
+		return us <= 0.0 ? 0 : (us >= (double)UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+	}
+
+	void FrameTimeSeries::Reset()
+	{
+		mNextSample = 0;
+		mSampleCount = 0;
+		mWindowHistogram.Clear();
+		mLifetimeHistogram.Clear();
+		mStutterCount = 0;
+	}
+
+	void FrameTimeSeries::AddSample(uint64_t frame, float ms)
+	{
+		// Compared to the median before the sample joins the window, a long hitch does not hide itself.
+		if (mSampleCount >= StutterWarmupSamples)
+		{
+			const float median = mWindowHistogram.GetPercentileMS(50.0);
+			if (ms > median * mStutterFactor)
+			{
+				FrameStutter& stutter = mStutters[mStutterCount % MaxStutters];
+				stutter.Frame = frame;
+				stutter.TimeMS = ms;
+				stutter.MedianMS = median;
+				mStutterCount++;
+			}
+		}
+
+		if (mSampleCount == WindowSize)
+			mWindowHistogram.Remove(ToMicroseconds(mSamples[mNextSample]));
+		else
+			mSampleCount++;
+
+		mSamples[mNextSample] = ms;
+		mSampleFrames[mNextSample] = frame;
+		mNextSample = (mNextSample + 1) % WindowSize;
+
+		const uint32_t us = ToMicroseconds(ms);
+		mWindowHistogram.Add(us);
+		mLifetimeHistogram.Add(us);
+	}
+
+	FrameTimeSummary FrameTimeSeries::GetSummary() const
+	{
+		FrameTimeSummary summary;
+		summary.Count = mSampleCount;
+		if (mSampleCount == 0)
+			return summary;
+
+		double sum = 0.0;
+		for (uint32_t i = 0; i < mSampleCount; ++i)
+		{
+			mSorted[i] = mSamples[i];
+			sum += mSamples[i];
+		}
+		std::sort(mSorted.begin(), mSorted.begin() + mSampleCount);
+
+		// Nearest rank.
+		auto percentile = [this](double p)
+		{
+			const uint32_t rank = (uint32_t)std::ceil(p / 100.0 * mSampleCount);
+			return mSorted[std::max(rank, 1u) - 1];
+		};
+
+		summary.Last = mSamples[(mNextSample + WindowSize - 1) % WindowSize];
+		summary.Min = mSorted[0];
+		summary.Max = mSorted[mSampleCount - 1];
+		summary.Mean = (float)(sum / mSampleCount);
+		summary.P50 = percentile(50.0);
+		summary.P95 = percentile(95.0);
+		summary.P99 = percentile(99.0);
+		summary.P999 = percentile(99.9);
+		return summary;
+	}
+
+	const FrameStutter& FrameTimeSeries::GetStutter(uint32_t i) const
+	{
+		const uint64_t first = mStutterCount - GetStoredStutterCount();
+		return mStutters[(first + i) % MaxStutters];
+	}
+
+	void WriteFrameTimeSummaryJSON(std::ostream& out, const FrameTimeSummary& summary)
+	{
+		out << "{\"count\":" << summary.Count
+			<< ",\"min\":" << summary.Min
+			<< ",\"max\":" << summary.Max
+			<< ",\"mean\":" << summary.Mean
+			<< ",\"p50\":" << summary.P50
+			<< ",\"p95\":" << summary.P95
+			<< ",\"p99\":" << summary.P99
+			<< ",\"p99_9\":" << summary.P999
+			<< "}";
+	}
+
+	void FrameStats::AddCpuFrameTime(float ms)
+	{
+		mCpu.AddSample(mFrameCount++, ms);
+	}
+
+	void FrameStats::AddGpuFrameTime(float ms)
+	{
+		mGpu.AddSample(mFrameCount, ms);
+	}
+
+	void FrameStats::SetStutterFactor(float factor)
+	{
+		mCpu.SetStutterFactor(factor);
+		mGpu.SetStutterFactor(factor);
+	}
+
+	void FrameStats::Reset()
+	{
+		mCpu.Reset();
+		mGpu.Reset();
+		mFrameCount = 0;
+	}
+
+	bool FrameStats::ExportCSV(const std::string& filename) const
+	{
+		std::ofstream out(filename, std::ios::out | std::ios::trunc);
+		if (!out)
+			return false;
+
+		out << "series,frame,ms\n";
+		const std::pair<const char*, const FrameTimeSeries*> series[] = { { "cpu", &mCpu }, { "gpu", &mGpu } };
+		for (const auto& s : series)
+		{
+			for (uint32_t i = 0; i < s.second->GetSampleCount(); ++i)
+				out << s.first << ',' << s.second->GetSampleFrame(i) << ',' << s.second->GetSample(i) << '\n';
+		}
+		return (bool)out;
+	}
+
+	bool FrameStats::ExportJSON(const std::string& filename) const
+	{
+		std::ofstream out(filename, std::ios::out | std::ios::trunc);
+		if (!out)
+			return false;
+
+		WriteJSON(out);
+		return (bool)out;
+	}
+
+	void FrameStats::WriteJSON(std::ostream& out) const
+	{
+		auto writeSeries = [&out](const char* name, const FrameTimeSeries& series)
+		{
+			out << "\"" << name << "\":{\"summary\":";
+			WriteFrameTimeSummaryJSON(out, series.GetSummary());
+			out << ",\"stutter_factor\":" << series.GetStutterFactor()
+				<< ",\"stutter_count\":" << series.GetStutterCount()
+				<< ",\"stutters\":[";
+			for (uint32_t i = 0; i < series.GetStoredStutterCount(); ++i)
+			{
+				const FrameStutter& stutter = series.GetStutter(i);
+				out << (i ? "," : "") << "{\"frame\":" << stutter.Frame << ",\"ms\":" << stutter.TimeMS << ",\"median_ms\":" << stutter.MedianMS << "}";
+			}
+
+			// Lifetime histogram, [lower_us, upper_us, count] for every non empty bucket.
+			out << "],\"histogram_us\":[";
+			const FrameTimeHistogram& histogram = series.GetLifetimeHistogram();
+			bool first = true;
+			for (uint32_t bucket = 0; bucket < FrameTimeHistogram::BucketCount; ++bucket)
+			{
+				if (histogram.GetCount(bucket) == 0)
+					continue;
+				out << (first ? "" : ",") << "[" << FrameTimeHistogram::GetBucketLowerBound(bucket) << ","
+					<< FrameTimeHistogram::GetBucketUpperBound(bucket) << "," << histogram.GetCount(bucket) << "]";
+				first = false;
+			}
+			out << "]}";
+		};
+
+		out << "{\"frames\":" << mFrameCount << ",\"window\":" << FrameTimeSeries::WindowSize << ",";
+		writeSeries("cpu_ms", mCpu);
+		out << ",";
+		writeSeries("gpu_ms", mGpu);
+		out << "}\n";
+	}
+}
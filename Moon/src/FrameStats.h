@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Moon
+{
+	// Log-linear histogram of frame times in microseconds (HDR histogram layout): exact below 128us,
+	// then 64 buckets per power of two, so any value is known within 1.6%. Fixed size, never allocates.
+	class FrameTimeHistogram
+	{
+	public:
+		static constexpr uint32_t SubBucketBits = 7;
+		static constexpr uint32_t SubBucketCount = 1 << SubBucketBits;
+		static constexpr uint32_t SubBucketHalfCount = SubBucketCount / 2;
+		// Everything above ~134 seconds lands in the last bucket.
+		static constexpr uint32_t MaxExponent = 20;
+		static constexpr uint32_t BucketCount = SubBucketCount + MaxExponent * SubBucketHalfCount;
+
+		static uint32_t GetBucketIndex(uint32_t microseconds);
+		static uint32_t GetBucketLowerBound(uint32_t bucket);
+		// Exclusive.
+		static uint32_t GetBucketUpperBound(uint32_t bucket);
+
+		void Clear();
+		void Add(uint32_t microseconds);
+		void Remove(uint32_t microseconds);
+
+		uint64_t GetTotalCount() const { return mTotalCount; }
+		uint64_t GetCount(uint32_t bucket) const { return mCounts[bucket]; }
+		// percentile in [0, 100], nearest rank, returns the middle of the bucket holding it.
+		float GetPercentileMS(double percentile) const;
+
+	private:
+		std::array<uint64_t, BucketCount> mCounts = {};
+		uint64_t mTotalCount = 0;
+	};
+
+	struct FrameTimeSummary
+	{
+		uint32_t Count = 0;
+		float Last = 0.0f;
+		float Min = 0.0f;
+		float Max = 0.0f;
+		float Mean = 0.0f;
+		float P50 = 0.0f;
+		float P95 = 0.0f;
+		float P99 = 0.0f;
+		float P999 = 0.0f;
+	};
+
+	struct FrameStutter
+	{
+		uint64_t Frame = 0;
+		float TimeMS = 0.0f;
+		float MedianMS = 0.0f;
+	};
+
+	// One frame time metric: rolling window of the last samples, lifetime histogram and stutter detection.
+	class FrameTimeSeries
+	{
+	public:
+		static constexpr uint32_t WindowSize = 1024;
+		static constexpr uint32_t MaxStutters = 256;
+		// The median is meaningless before that.
+		static constexpr uint32_t StutterWarmupSamples = 30;
+
+		void Reset();
+		void AddSample(uint64_t frame, float ms);
+
+		// A sample is a stutter when it is above factor times the rolling median.
+		void SetStutterFactor(float factor) { mStutterFactor = factor; }
+		float GetStutterFactor() const { return mStutterFactor; }
+
+		// Exact statistics over the rolling window.
+		FrameTimeSummary GetSummary() const;
+
+		const FrameTimeHistogram& GetWindowHistogram() const { return mWindowHistogram; }
+		const FrameTimeHistogram& GetLifetimeHistogram() const { return mLifetimeHistogram; }
+
+		// Samples of the rolling window, oldest first.
+		uint32_t GetSampleCount() const { return mSampleCount; }
+		float GetSample(uint32_t i) const { return mSamples[GetSampleSlot(i)]; }
+		uint64_t GetSampleFrame(uint32_t i) const { return mSampleFrames[GetSampleSlot(i)]; }
+		// Contiguous storage, for plotting with an offset of GetSampleOffset().
+		const float* GetSampleData() const { return mSamples.data(); }
+		uint32_t GetSampleOffset() const { return mSampleCount < WindowSize ? 0 : mNextSample; }
+
+		// Every stutter is counted, only the last MaxStutters are kept. Oldest first.
+		uint64_t GetStutterCount() const { return mStutterCount; }
+		uint32_t GetStoredStutterCount() const { return (uint32_t)std::min<uint64_t>(mStutterCount, MaxStutters); }
+		const FrameStutter& GetStutter(uint32_t i) const;
+
+	private:
+		uint32_t GetSampleSlot(uint32_t i) const { return (GetSampleOffset() + i) % WindowSize; }
+		static uint32_t ToMicroseconds(float ms);
+
+		std::array<float, WindowSize> mSamples = {};
+		std::array<uint64_t, WindowSize> mSampleFrames = {};
+		uint32_t mNextSample = 0;
+		uint32_t mSampleCount = 0;
+		// Sorting scratch for the percentiles.
+		mutable std::array<float, WindowSize> mSorted = {};
+
+		FrameTimeHistogram mWindowHistogram;
+		FrameTimeHistogram mLifetimeHistogram;
+
+		float mStutterFactor = 2.5f;
+		std::array<FrameStutter, MaxStutters> mStutters = {};
+		uint64_t mStutterCount = 0;
+	};
+
+	// {"count":...,"min":...,"p99_9":...}
+	void WriteFrameTimeSummaryJSON(std::ostream& out, const FrameTimeSummary& summary);
+
+	// CPU and GPU frame times of the application.
+	class FrameStats
+	{
+	public:
+		// One call per frame, it also numbers frames.
+		void AddCpuFrameTime(float ms);
+		// GPU times arrive frames later, they are tagged with the frame they were read in.
+		void AddGpuFrameTime(float ms);
+
+		void SetStutterFactor(float factor);
+		void Reset();
+
+		uint64_t GetFrameCount() const { return mFrameCount; }
+		const FrameTimeSeries& GetCpu() const { return mCpu; }
+		const FrameTimeSeries& GetGpu() const { return mGpu; }
+
+		// Rolling window samples: series,frame,ms
+		bool ExportCSV(const std::string& filename) const;
+		// Summaries, stutters and non empty lifetime histogram buckets.
+		bool ExportJSON(const std::string& filename) const;
+		void WriteJSON(std::ostream& out) const;
+
+	private:
+		FrameTimeSeries mCpu;
+		FrameTimeSeries mGpu;
+		uint64_t mFrameCount = 0;
+	};
+}
@@ -0,0 +1,42 @@
+#include "mnpch.h"
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace Moon
+{
+	BoundingFrustum FrustumCuller::MakeWorldFrustum(FXMMATRIX view, CXMMATRIX proj)
+	{
+		BoundingFrustum viewFrustum;
+		BoundingFrustum::CreateFromMatrix(viewFrustum, proj);
+
+		XMVECTOR determinant;
+		BoundingFrustum worldFrustum;
+		viewFrustum.Transform(worldFrustum, XMMatrixInverse(&determinant, view));
+		return worldFrustum;
+	}
+
+	void FrustumCuller::Cull(const BoundingFrustum& frustum, const BoundingBox* bounds, uint32_t count, JobSystem* jobSystem)
+	{
+		mVisibleFlags.resize(count);
+		auto cullRange = [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+				mVisibleFlags[i] = frustum.Intersects(bounds[i]) ? 1 : 0;
+		};
+
+		if (jobSystem)
+			jobSystem->ParallelFor(count, 4096, cullRange);
+		else
+			cullRange(0, count);
+
+		// Compacted serially, keeps the scene order for a stable sort afterwards.
+		mVisible.clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (mVisibleFlags[i])
+				mVisible.push_back(i);
+		}
+	}
+}
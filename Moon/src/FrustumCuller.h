@@ -0,0 +1,27 @@
+#pragma once
+#include <DirectXCollision.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Moon
+{
+	class JobSystem;
+
+	// Visibility of world space bounding boxes against the camera frustum.
+	class FrustumCuller
+	{
+	public:
+		// Builds the world space frustum of a camera from its (left handed) view and projection matrices.
+		static DirectX::BoundingFrustum MakeWorldFrustum(DirectX::FXMMATRIX view, DirectX::CXMMATRIX proj);
+
+		// Fills GetVisible() with the indices of the boxes intersecting the frustum, in increasing order.
+		void Cull(const DirectX::BoundingFrustum& frustum, const DirectX::BoundingBox* bounds, uint32_t count, JobSystem* jobSystem = nullptr);
+
+		const std::vector<uint32_t>& GetVisible() const { return mVisible; }
+
+	private:
+		std::vector<uint8_t> mVisibleFlags;
+		std::vector<uint32_t> mVisible;
+	};
+}
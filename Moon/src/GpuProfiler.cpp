@@ -0,0 +1,214 @@
+#include "mnpch.h"
+#include "GpuProfiler.h"
+
+namespace Moon
+{
+	GpuProfiler* GpuProfiler::gActive = nullptr;
+
+	void BeginGpuProfileScope(ID3D12GraphicsCommandList* cmdList, const char* name)
+	{
+		if (GpuProfiler* profiler = GpuProfiler::GetActive())
+			profiler->BeginScope(cmdList, name);
+	}
+
+	void EndGpuProfileScope(ID3D12GraphicsCommandList* cmdList)
+	{
+		if (GpuProfiler* profiler = GpuProfiler::GetActive())
+			profiler->EndScope(cmdList);
+	}
+
+	GpuProfiler::GpuProfiler(ID3D12Device* device, CommandQueue* queue)
+		: mQueue(queue)
+	{
+		DX_CHECK(queue->GetCommandQueue()->GetTimestampFrequency(&mTimestampFrequency));
+
+		const UINT queryCount = FrameCount * MaxScopesPerFrame * 2;
+		D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+		queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+		queryHeapDesc.Count = queryCount;
+		DX_CHECK(device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&mQueryHeap)));
+
+		DX_CHECK(device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(queryCount * sizeof(uint64_t)),
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr,
+			IID_PPV_ARGS(&mReadback)));
+
+		// Mapped for the profiler's lifetime, a frame's range is only read once its fence has passed.
+		void* data = nullptr;
+		DX_CHECK(mReadback->Map(0, nullptr, &data));
+		mReadbackData = static_cast<const uint64_t*>(data);
+
+		for (FrameQueries& frame : mFrames)
+			frame.Scopes.resize(MaxScopesPerFrame);
+		mScopeStack.reserve(64);
+		mScopeNodes.resize(MaxScopesPerFrame);
+		mNodes.emplace_back();
+
+		gActive = this;
+	}
+
+	GpuProfiler::~GpuProfiler()
+	{
+		if (gActive == this)
+			gActive = nullptr;
+
+		const D3D12_RANGE emptyRange = {};
+		mReadback->Unmap(0, &emptyRange);
+	}
+
+	void GpuProfiler::BeginFrame(ID3D12GraphicsCommandList* cmdList)
+	{
+		// Oldest first, so the rolling averages see frames in order.
+		for (uint32_t i = 1; i <= FrameCount; ++i)
+		{
+			const uint32_t frame = (mCurrentFrame + i) % FrameCount;
+			if (mFrames[frame].Pending && mQueue->IsFenceComplete(mFrames[frame].FenceValue))
+				ReadFrame(frame);
+		}
+
+		mCurrentFrame = (uint32_t)(mFrameIndex++ % FrameCount);
+		FrameQueries& frame = mFrames[mCurrentFrame];
+		if (frame.Pending)
+		{
+			// The GPU is more than FrameCount frames behind, its queries are about to be overwritten.
+			mQueue->WaitForFenceCPUBlocking(frame.FenceValue);
+			ReadFrame(mCurrentFrame);
+		}
+
+		frame.ScopeCount = 0;
+		mScopeStack.clear();
+		mRecordingList = cmdList;
+		BeginScope(cmdList, "Frame");
+	}
+
+	void GpuProfiler::EndFrame(ID3D12GraphicsCommandList* cmdList)
+	{
+		EndScope(cmdList);
+		mRecordingList = nullptr;
+
+		FrameQueries& frame = mFrames[mCurrentFrame];
+		if (frame.ScopeCount == 0)
+			return;
+
+		const UINT firstQuery = GetQueryIndex(mCurrentFrame, 0);
+		cmdList->ResolveQueryData(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, frame.ScopeCount * 2,
+			mReadback.Get(), firstQuery * sizeof(uint64_t));
+	}
+
+	void GpuProfiler::OnFrameSubmitted(uint64_t fenceValue)
+	{
+		FrameQueries& frame = mFrames[mCurrentFrame];
+		frame.FenceValue = fenceValue;
+		frame.Pending = frame.ScopeCount > 0;
+	}
+
+	void GpuProfiler::BeginScope(ID3D12GraphicsCommandList* cmdList, const char* name)
+	{
+		// Only the frame's command list is profiled, markers recorded elsewhere (init, uploads) are ignored.
+		if (cmdList != mRecordingList)
+			return;
+
+		FrameQueries& frame = mFrames[mCurrentFrame];
+		if (frame.ScopeCount == MaxScopesPerFrame)
+		{
+			mScopeStack.push_back(InvalidIndex);
+			return;
+		}
+
+		const uint32_t scope = frame.ScopeCount++;
+		strncpy(frame.Scopes[scope].Name, name, sizeof(frame.Scopes[scope].Name) - 1);
+		frame.Scopes[scope].Name[sizeof(frame.Scopes[scope].Name) - 1] = '\0';
+		frame.Scopes[scope].Parent = InvalidIndex;
+		for (auto it = mScopeStack.rbegin(); it != mScopeStack.rend(); ++it)
+		{
+			// Closest parent that got its queries.
+			if (*it != InvalidIndex)
+			{
+				frame.Scopes[scope].Parent = *it;
+				break;
+			}
+		}
+		mScopeStack.push_back(scope);
+
+		cmdList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, GetQueryIndex(mCurrentFrame, scope));
+	}
+
+	void GpuProfiler::EndScope(ID3D12GraphicsCommandList* cmdList)
+	{
+		if (cmdList != mRecordingList || mScopeStack.empty())
+			return;
+
+		const uint32_t scope = mScopeStack.back();
+		mScopeStack.pop_back();
+		if (scope != InvalidIndex)
+			cmdList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, GetQueryIndex(mCurrentFrame, scope) + 1);
+	}
+
+	float GpuProfiler::GetFrameTimeMS() const
+	{
+		return mNodes[0].Children.empty() ? 0.0f : mNodes[mNodes[0].Children[0]].LastMS;
+	}
+
+	uint32_t GpuProfiler::FindOrAddChild(uint32_t parent, const char* name)
+	{
+		for (uint32_t child : mNodes[parent].Children)
+		{
+			if (strcmp(mNodes[child].Name, name) == 0)
+				return child;
+		}
+
+		const uint32_t node = (uint32_t)mNodes.size();
+		mNodes.emplace_back();
+		strcpy(mNodes[node].Name, name);
+		mNodes[node].Parent = parent;
+		mNodes[parent].Children.push_back(node);
+		return node;
+	}
+
+	void GpuProfiler::ReadFrame(uint32_t frameIndex)
+	{
+		FrameQueries& frame = mFrames[frameIndex];
+		frame.Pending = false;
+		mResolvedFrameCount++;
+
+		const uint64_t* timestamps = mReadbackData + GetQueryIndex(frameIndex, 0);
+		const double msPerTick = 1000.0 / (double)mTimestampFrequency;
+
+		// Parents are always opened before their children, their node exists by then.
+		for (uint32_t scope = 0; scope < frame.ScopeCount; ++scope)
+		{
+			const Scope& s = frame.Scopes[scope];
+			const uint32_t parentNode = s.Parent == InvalidIndex ? 0 : mScopeNodes[s.Parent];
+			const uint32_t nodeIndex = FindOrAddChild(parentNode, s.Name);
+			mScopeNodes[scope] = nodeIndex;
+
+			const uint64_t begin = timestamps[scope * 2];
+			const uint64_t end = timestamps[scope * 2 + 1];
+			const float ms = end > begin ? (float)((end - begin) * msPerTick) : 0.0f;
+
+			Node& node = mNodes[nodeIndex];
+			// Same pass several times in a frame (one per draw...), they add up.
+			if (node.LastFrame == mResolvedFrameCount)
+			{
+				node.LastMS += ms;
+				node.SampleSum += ms;
+				node.Samples[(node.SampleCount - 1) % AverageWindow] += ms;
+			}
+			else
+			{
+				const uint32_t slot = node.SampleCount % AverageWindow;
+				if (node.SampleCount >= AverageWindow)
+					node.SampleSum -= node.Samples[slot];
+				node.Samples[slot] = ms;
+				node.SampleSum += ms;
+				node.SampleCount++;
+				node.LastMS = ms;
+				node.LastFrame = mResolvedFrameCount;
+			}
+			node.AverageMS = node.SampleSum / (float)std::min(node.SampleCount, AverageWindow);
+		}
+	}
+}
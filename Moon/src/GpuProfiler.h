@@ -0,0 +1,95 @@
+#pragma once
+#include "dx_utils.h"
+#include "CommandQueue.h"
+
+namespace Moon
+{
+	// Per pass GPU timings. Every scope writes a timestamp when it opens and when it closes,
+	// scopes nest like the passes they measure. Frames rotate through a ring of query ranges resolved
+	// into a persistently mapped readback buffer, a frame is read once its fence has passed.
+	class GpuProfiler
+	{
+	public:
+		static constexpr uint32_t MaxScopesPerFrame = 1024;
+		static constexpr uint32_t FrameCount = BACKBUFFER_COUNT + 1;
+		static constexpr uint32_t AverageWindow = 64;
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		// Scopes with the same name under the same parent across frames.
+		struct Node
+		{
+			char Name[44] = {};
+			uint32_t Parent = InvalidIndex;
+			std::vector<uint32_t> Children;
+
+			float LastMS = 0.0f;
+			float AverageMS = 0.0f;
+			// Frame in which the scope was last seen, see GetResolvedFrameCount().
+			uint64_t LastFrame = 0;
+
+			float Samples[AverageWindow] = {};
+			uint32_t SampleCount = 0;
+			float SampleSum = 0.0f;
+		};
+
+		GpuProfiler(ID3D12Device* device, CommandQueue* queue);
+		~GpuProfiler();
+		GpuProfiler(const GpuProfiler& rhs) = delete;
+		GpuProfiler& operator=(const GpuProfiler& rhs) = delete;
+
+		// Receives the scopes opened by ScopedPerfMarker/RENDER_PASS.
+		static GpuProfiler* GetActive() { return gActive; }
+
+		// Reads back every frame the GPU is done with, then opens the root scope of the new frame.
+		void BeginFrame(ID3D12GraphicsCommandList* cmdList);
+		// Closes the root scope and resolves the frame's queries.
+		void EndFrame(ID3D12GraphicsCommandList* cmdList);
+		// Fence signaled by the submission of the command list passed to EndFrame().
+		void OnFrameSubmitted(uint64_t fenceValue);
+
+		void BeginScope(ID3D12GraphicsCommandList* cmdList, const char* name);
+		void EndScope(ID3D12GraphicsCommandList* cmdList);
+
+		// Node 0 is an unnamed root, the frame scope is its only child.
+		const std::vector<Node>& GetNodes() const { return mNodes; }
+		uint64_t GetResolvedFrameCount() const { return mResolvedFrameCount; }
+		float GetFrameTimeMS() const;
+
+	private:
+		struct Scope
+		{
+			char Name[44];
+			uint32_t Parent;
+		};
+
+		struct FrameQueries
+		{
+			std::vector<Scope> Scopes;
+			uint32_t ScopeCount = 0;
+			uint64_t FenceValue = 0;
+			bool Pending = false;
+		};
+
+		void ReadFrame(uint32_t frame);
+		uint32_t FindOrAddChild(uint32_t parent, const char* name);
+		uint32_t GetQueryIndex(uint32_t frame, uint32_t scope) const { return (frame * MaxScopesPerFrame + scope) * 2; }
+
+		static GpuProfiler* gActive;
+
+		CommandQueue* mQueue = nullptr;
+		Microsoft::WRL::ComPtr<ID3D12QueryHeap> mQueryHeap;
+		Microsoft::WRL::ComPtr<ID3D12Resource> mReadback;
+		const uint64_t* mReadbackData = nullptr;
+		uint64_t mTimestampFrequency = 1;
+
+		FrameQueries mFrames[FrameCount];
+		uint32_t mCurrentFrame = 0;
+		uint64_t mFrameIndex = 0;
+		ID3D12GraphicsCommandList* mRecordingList = nullptr;
+		std::vector<uint32_t> mScopeStack;
+
+		std::vector<Node> mNodes;
+		std::vector<uint32_t> mScopeNodes;
+		uint64_t mResolvedFrameCount = 0;
+	};
+}
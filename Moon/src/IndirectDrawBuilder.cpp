@@ -0,0 +1,46 @@
+#include "mnpch.h"
+#include "IndirectDrawBuilder.h"
+#include "DrawList.h"
+
+namespace Moon
+{
+	void IndirectDrawBuilder::Build(const DrawList& drawList,
+		const uint32_t* indexCounts, const uint32_t* startIndexLocations, const int32_t* baseVertexLocations,
+		uint64_t objectCBAddress, uint32_t objectCBStride)
+	{
+		const uint32_t count = (uint32_t)drawList.Size();
+		mCommands.resize(count);
+		mBatches.clear();
+
+		// The depth bits do not change any state, everything above them does.
+		constexpr uint64_t stateMask = ~((1ull << DrawSortKey::GeometryShift) - 1);
+		uint64_t batchState = 0;
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const uint64_t key = drawList.GetKey(i);
+			const uint32_t obj = drawList.GetItem(i);
+
+			IndirectDrawCommand& cmd = mCommands[i];
+			cmd.ObjectCBAddress = objectCBAddress + (uint64_t)obj * objectCBStride;
+			cmd.ObjectIndex = obj;
+			cmd.Draw.IndexCountPerInstance = indexCounts[obj];
+			cmd.Draw.InstanceCount = 1;
+			cmd.Draw.StartIndexLocation = startIndexLocations[obj];
+			cmd.Draw.BaseVertexLocation = baseVertexLocations[obj];
+			cmd.Draw.StartInstanceLocation = 0;
+
+			if (mBatches.empty() || (key & stateMask) != batchState)
+			{
+				IndirectDrawBatch batch;
+				batch.FirstCommand = i;
+				batch.Pipeline = DrawSortKey::GetPipeline(key);
+				batch.Material = DrawSortKey::GetMaterial(key);
+				batch.Geometry = DrawSortKey::GetGeometry(key);
+				mBatches.push_back(batch);
+				batchState = key & stateMask;
+			}
+			mBatches.back().CommandCount++;
+		}
+	}
+}
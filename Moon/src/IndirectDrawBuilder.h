@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Moon
+{
+	class DrawList;
+
+	// Same layout as D3D12_DRAW_INDEXED_ARGUMENTS, kept free of D3D12 headers so the builder runs anywhere.
+	struct IndirectDrawIndexedArgs
+	{
+		uint32_t IndexCountPerInstance = 0;
+		uint32_t InstanceCount = 0;
+		uint32_t StartIndexLocation = 0;
+		int32_t BaseVertexLocation = 0;
+		uint32_t StartInstanceLocation = 0;
+	};
+
+	// One record of the argument buffer, matching the command signature:
+	// root CBV (object constants), one root constant (object index), then DrawIndexed.
+	struct IndirectDrawCommand
+	{
+		uint64_t ObjectCBAddress = 0;
+		uint32_t ObjectIndex = 0;
+		IndirectDrawIndexedArgs Draw;
+	};
+	static_assert(sizeof(IndirectDrawCommand) == 32, "IndirectDrawCommand must stay tightly packed");
+
+	// Consecutive commands sharing pipeline, material and geometry, submitted with one ExecuteIndirect.
+	struct IndirectDrawBatch
+	{
+		uint32_t FirstCommand = 0;
+		uint32_t CommandCount = 0;
+		uint32_t Pipeline = 0;
+		uint32_t Material = 0;
+		uint32_t Geometry = 0;
+	};
+
+	class IndirectDrawBuilder
+	{
+	public:
+		// Turns a sorted draw list into argument records and batches.
+		// The per-object arrays are indexed by the draw list items.
+		void Build(const DrawList& drawList,
+			const uint32_t* indexCounts, const uint32_t* startIndexLocations, const int32_t* baseVertexLocations,
+			uint64_t objectCBAddress, uint32_t objectCBStride);
+
+		const std::vector<IndirectDrawCommand>& GetCommands() const { return mCommands; }
+		const std::vector<IndirectDrawBatch>& GetBatches() const { return mBatches; }
+
+	private:
+		std::vector<IndirectDrawCommand> mCommands;
+		std::vector<IndirectDrawBatch> mBatches;
+	};
+}
@@ -0,0 +1,187 @@
+#include "mnpch.h"
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+
+namespace Moon
+{
+	namespace
+	{
+		struct ParallelForState
+		{
+			const std::function<void(uint32_t, uint32_t)>* Fn = nullptr;
+			uint32_t Count = 0;
+			uint32_t GrainSize = 0;
+			uint32_t ChunkCount = 0;
+			std::atomic<uint32_t> NextChunk = 0;
+			std::atomic<uint32_t> DoneChunks = 0;
+			std::mutex DoneMutex;
+			std::condition_variable DoneCV;
+
+			// Returns false once there is no chunk left to claim.
+			bool RunOneChunk()
+			{
+				const uint32_t chunk = NextChunk.fetch_add(1);
+				if (chunk >= ChunkCount)
+					return false;
+
+				const uint32_t begin = chunk * GrainSize;
+				const uint32_t end = std::min(begin + GrainSize, Count);
+				(*Fn)(begin, end);
+
+				if (DoneChunks.fetch_add(1) + 1 == ChunkCount)
+				{
+					std::lock_guard<std::mutex> lock(DoneMutex);
+					DoneCV.notify_all();
+				}
+				return true;
+			}
+		};
+	}
+
+	JobSystem::JobSystem(uint32_t workerCount)
+	{
+		if (workerCount == 0)
+		{
+			const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		mWorkers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i)
+			mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mJobsMutex);
+			mStopping = true;
+		}
+		mJobsCV.notify_all();
+
+		for (auto& worker : mWorkers)
+			worker.join();
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& fn)
+	{
+		if (count == 0)
+			return;
+
+		grainSize = std::max(grainSize, 1u);
+		const uint32_t chunkCount = (count + grainSize - 1) / grainSize;
+		if (chunkCount == 1 || mWorkers.empty())
+		{
+			fn(0, count);
+			return;
+		}
+
+		auto state = std::make_shared<ParallelForState>();
+		state->Fn = &fn;
+		state->Count = count;
+		state->GrainSize = grainSize;
+		state->ChunkCount = chunkCount;
+
+		// Helpers that start after every chunk is claimed exit straight away, they only keep the state alive.
+		const uint32_t helperCount = std::min(chunkCount - 1, GetWorkerCount());
+		for (uint32_t i = 0; i < helperCount; ++i)
+		{
+			Enqueue([state]()
+			{
+				while (state->RunOneChunk()) {}
+			});
+		}
+
+		while (state->RunOneChunk()) {}
+
+		std::unique_lock<std::mutex> lock(state->DoneMutex);
+		state->DoneCV.wait(lock, [&state]() { return state->DoneChunks.load() == state->ChunkCount; });
+	}
+
+	void JobSystem::Run(JobGroup& group, std::function<void()> job)
+	{
+		group.mPending.fetch_add(1, std::memory_order_relaxed);
+		Enqueue([&group, job = std::move(job)]()
+		{
+			try
+			{
+				job();
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(group.mMutex);
+				if (!group.mException)
+					group.mException = std::current_exception();
+			}
+
+			// Under the lock, Wait() can not return and destroy the group before the notification is sent.
+			std::lock_guard<std::mutex> lock(group.mMutex);
+			if (group.mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				group.mDoneCV.notify_all();
+		});
+	}
+
+	void JobSystem::Wait(JobGroup& group)
+	{
+		// Helping keeps the waiting thread busy, and avoids a deadlock when waiting from inside a job.
+		while (!group.IsDone() && TryRunOneJob()) {}
+
+		{
+			std::unique_lock<std::mutex> lock(group.mMutex);
+			group.mDoneCV.wait(lock, [&group]() { return group.IsDone(); });
+		}
+
+		if (group.mException)
+		{
+			std::exception_ptr exception = group.mException;
+			group.mException = nullptr;
+			std::rethrow_exception(exception);
+		}
+	}
+
+	bool JobSystem::TryRunOneJob()
+	{
+		std::function<void()> job;
+		{
+			std::lock_guard<std::mutex> lock(mJobsMutex);
+			if (mJobs.empty())
+				return false;
+
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+		}
+		PROFILE_ZONE("Job");
+		job();
+		return true;
+	}
+
+	void JobSystem::Enqueue(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mJobsMutex);
+			mJobs.push_back(std::move(job));
+		}
+		mJobsCV.notify_one();
+	}
+
+	void JobSystem::WorkerLoop(uint32_t workerIndex)
+	{
+		CpuProfiler::Get().SetThreadName(("Worker " + std::to_string(workerIndex)).c_str());
+
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(mJobsMutex);
+				mJobsCV.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+				if (mStopping && mJobs.empty())
+					return;
+
+				job = std::move(mJobs.front());
+				mJobs.pop_front();
+			}
+			PROFILE_ZONE("Job");
+			job();
+		}
+	}
+}
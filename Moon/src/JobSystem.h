@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Moon
+{
+	// Jobs started with JobSystem::Run() and waited on together.
+	// Must outlive its jobs: wait on it before it goes out of scope.
+	class JobGroup
+	{
+	public:
+		JobGroup() = default;
+		JobGroup(const JobGroup& rhs) = delete;
+		JobGroup& operator=(const JobGroup& rhs) = delete;
+
+		bool IsDone() const { return mPending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint32_t> mPending{ 0 };
+		std::mutex mMutex;
+		std::condition_variable mDoneCV;
+		// First exception thrown by a job of the group, rethrown by Wait().
+		std::exception_ptr mException;
+	};
+
+	class JobSystem
+	{
+	public:
+		// workerCount == 0 uses one worker per hardware thread, minus the calling thread.
+		JobSystem(uint32_t workerCount = 0);
+		~JobSystem();
+
+		JobSystem(const JobSystem& rhs) = delete;
+		JobSystem& operator=(const JobSystem& rhs) = delete;
+
+		uint32_t GetWorkerCount() const { return (uint32_t)mWorkers.size(); }
+
+		// Splits [0, count) in chunks of grainSize and calls fn(begin, end) for each of them.
+		// The calling thread works on chunks too and only returns once every chunk is done,
+		// so it is safe to call from inside another job.
+		void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& fn);
+
+		// Queues a job of the group. Exceptions it throws are kept for Wait().
+		void Run(JobGroup& group, std::function<void()> job);
+		// Runs queued jobs on the calling thread until every job of the group is done,
+		// then rethrows the first exception one of them threw.
+		void Wait(JobGroup& group);
+
+	private:
+		void Enqueue(std::function<void()> job);
+		// Returns false when the queue is empty.
+		bool TryRunOneJob();
+		void WorkerLoop(uint32_t workerIndex);
+
+		std::vector<std::thread> mWorkers;
+		std::deque<std::function<void()>> mJobs;
+		std::mutex mJobsMutex;
+		std::condition_variable mJobsCV;
+		bool mStopping = false;
+	};
+}
@@ -0,0 +1,297 @@
+#include "mnpch.h"
+#include "LZCodec.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace Moon
+{
+	namespace
+	{
+		constexpr uint32_t HashBits = 16;
+		// Power of two past LZMaxOffset, the chain links of a window wrap around it.
+		constexpr uint32_t WindowSize = 1u << 16;
+		constexpr uint32_t NoPosition = 0xFFFFFFFF;
+
+		uint32_t Read32(const uint8_t* p)
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint64_t Read64(const uint8_t* p)
+		{
+			uint64_t value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		uint32_t Hash(uint32_t sequence)
+		{
+			return (sequence * 2654435761u) >> (32 - HashBits);
+		}
+
+		struct LZMatch
+		{
+			size_t Length = 0;
+			size_t Offset = 0;
+		};
+
+		// Hash chains over the last window of positions, newest first.
+		class MatchFinder
+		{
+		public:
+			MatchFinder(const uint8_t* data, size_t size, uint32_t searchDepth)
+				: mData(data), mSize(size), mSearchDepth(std::max(1u, searchDepth))
+				, mHead(1u << HashBits, NoPosition), mChain(WindowSize, NoPosition)
+			{
+			}
+
+			void Insert(size_t pos)
+			{
+				if (pos + LZMinMatch > mSize)
+					return;
+				uint32_t& head = mHead[Hash(Read32(mData + pos))];
+				mChain[pos & (WindowSize - 1)] = head;
+				head = (uint32_t)pos;
+			}
+
+			// Longest match for pos among the positions inserted before it.
+			LZMatch Find(size_t pos) const
+			{
+				LZMatch best;
+				if (pos + LZMinMatch > mSize)
+					return best;
+
+				const uint8_t* current = mData + pos;
+				const uint32_t sequence = Read32(current);
+				const size_t maxLength = mSize - pos;
+				uint32_t candidate = mHead[Hash(sequence)];
+				for (uint32_t depth = 0; depth < mSearchDepth && candidate != NoPosition; ++depth)
+				{
+					const size_t offset = pos - candidate;
+					if (offset == 0 || offset > LZMaxOffset)
+						break;
+
+					const uint8_t* previous = mData + candidate;
+					if (Read32(previous) == sequence && previous[best.Length] == current[best.Length])
+					{
+						size_t length = LZMinMatch;
+						while (length + 8 <= maxLength && Read64(previous + length) == Read64(current + length))
+							length += 8;
+						while (length < maxLength && previous[length] == current[length])
+							++length;
+
+						if (length > best.Length)
+						{
+							best.Length = length;
+							best.Offset = offset;
+							if (length == maxLength)
+								break;
+						}
+					}
+
+					const uint32_t next = mChain[candidate & (WindowSize - 1)];
+					// A link older than the window was overwritten by a newer position.
+					if (next == NoPosition || next >= candidate)
+						break;
+					candidate = next;
+				}
+				return best;
+			}
+
+		private:
+			const uint8_t* mData;
+			size_t mSize;
+			uint32_t mSearchDepth;
+			std::vector<uint32_t> mHead;
+			std::vector<uint32_t> mChain;
+		};
+
+		void WriteLength(std::vector<uint8_t>& out, size_t length)
+		{
+			for (; length >= 255; length -= 255)
+				out.push_back(255);
+			out.push_back((uint8_t)length);
+		}
+
+		void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, const LZMatch& match)
+		{
+			const size_t matchCode = match.Length ? match.Length - LZMinMatch : 0;
+			out.push_back((uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+			if (literalCount >= 15)
+				WriteLength(out, literalCount - 15);
+			out.insert(out.end(), literals, literals + literalCount);
+
+			if (match.Length)
+			{
+				out.push_back((uint8_t)(match.Offset & 0xFF));
+				out.push_back((uint8_t)(match.Offset >> 8));
+				if (matchCode >= 15)
+					WriteLength(out, matchCode - 15);
+			}
+		}
+
+		size_t ReadLength(const uint8_t*& ip, const uint8_t* ipEnd)
+		{
+			size_t length = 0;
+			uint8_t value;
+			do
+			{
+				if (ip == ipEnd)
+					throw std::runtime_error("LZ: truncated length");
+				value = *ip++;
+				length += value;
+			} while (value == 255);
+			return length;
+		}
+
+		// 16 bytes at a time, reading and writing up to 16 bytes past length: the caller checked there is room for them.
+		void WildCopy16(uint8_t* dst, const uint8_t* src, size_t length)
+		{
+			uint8_t* const end = dst + length;
+			do
+			{
+				memcpy(dst, src, 16);
+				dst += 16;
+				src += 16;
+			} while (dst < end);
+		}
+	}
+
+	std::vector<uint8_t> LZCompress(const uint8_t* data, size_t size, uint32_t searchDepth)
+	{
+		std::vector<uint8_t> out;
+		out.reserve(size + size / 255 + 16);
+
+		MatchFinder finder(data, size, searchDepth);
+		const bool lazy = searchDepth > 1;
+		size_t literalStart = 0;
+		size_t pos = 0;
+		while (pos < size)
+		{
+			LZMatch match = finder.Find(pos);
+			finder.Insert(pos);
+			if (match.Length < LZMinMatch)
+			{
+				++pos;
+				continue;
+			}
+
+			// A longer match one byte later is worth a literal.
+			if (lazy && pos + 1 < size)
+			{
+				const LZMatch next = finder.Find(pos + 1);
+				if (next.Length > match.Length + 1)
+				{
+					++pos;
+					continue;
+				}
+			}
+
+			WriteSequence(out, data + literalStart, pos - literalStart, match);
+			for (size_t i = pos + 1; i < pos + match.Length; ++i)
+				finder.Insert(i);
+			pos += match.Length;
+			literalStart = pos;
+		}
+
+		if (literalStart < size)
+			WriteSequence(out, data + literalStart, size - literalStart, LZMatch());
+
+		return out;
+	}
+
+	void LZDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+	{
+		const uint8_t* ip = src;
+		const uint8_t* const ipEnd = src + srcSize;
+		uint8_t* op = dst;
+		uint8_t* const opEnd = dst + dstSize;
+
+		while (ip < ipEnd)
+		{
+			const uint32_t token = *ip++;
+
+			// Short literal runs and short matches, the bulk of the sequences, copy a fixed 16 bytes without looking at their length.
+			size_t literals = token >> 4;
+			if (literals < 15 && (size_t)(ipEnd - ip) >= 16 + 2 && (size_t)(opEnd - op) >= 16 + 32)
+			{
+				memcpy(op, ip, 16);
+				ip += literals;
+				op += literals;
+
+				const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+				const size_t code = token & 15;
+				if (code < 15 && offset >= 16 && offset <= (size_t)(op - dst))
+				{
+					ip += 2;
+					const uint8_t* match = op - offset;
+					memcpy(op, match, 16);
+					memcpy(op + 16, match + 16, 16);
+					op += code + LZMinMatch;
+					continue;
+				}
+
+				// Either the last sequence or a match the general path deals with.
+				if (ip == ipEnd)
+					break;
+			}
+			else
+			{
+				if (literals == 15)
+					literals += ReadLength(ip, ipEnd);
+				if (literals > (size_t)(ipEnd - ip) || literals > (size_t)(opEnd - op))
+					throw std::runtime_error("LZ: literals out of bounds");
+
+				if ((size_t)(ipEnd - ip) >= literals + 16 && (size_t)(opEnd - op) >= literals + 16)
+					WildCopy16(op, ip, literals);
+				else
+					memcpy(op, ip, literals);
+				ip += literals;
+				op += literals;
+
+				if (ip == ipEnd)
+					break;
+			}
+
+			if (ipEnd - ip < 2)
+				throw std::runtime_error("LZ: truncated match offset");
+			const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > (size_t)(op - dst))
+				throw std::runtime_error("LZ: match offset out of bounds");
+
+			size_t length = (token & 15) + LZMinMatch;
+			if ((token & 15) == 15)
+				length += ReadLength(ip, ipEnd);
+			if (length > (size_t)(opEnd - op))
+				throw std::runtime_error("LZ: match out of bounds");
+
+			const uint8_t* match = op - offset;
+			if (offset >= 16 && (size_t)(opEnd - op) >= length + 16)
+			{
+				WildCopy16(op, match, length);
+			}
+			else if (offset == 1)
+			{
+				memset(op, *match, length);
+			}
+			else
+			{
+				// The bytes from match on repeat every offset bytes, each copy can take twice as many as the previous one.
+				for (size_t copied = 0; copied < length;)
+				{
+					const size_t chunk = std::min(length - copied, copied + offset);
+					memcpy(op + copied, match, chunk);
+					copied += chunk;
+				}
+			}
+			op += length;
+		}
+
+		if (op != opEnd)
+			throw std::runtime_error("LZ: stream shorter than the expected size");
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Moon
+{
+	// Byte oriented LZ77 codec for texture payloads, in the spirit of LZ4: no entropy coding, so decoding is little more than memcpy.
+	// A stream is a list of sequences, each a token byte (literal count in the high nibble, match length minus 4 in the low one,
+	// 15 meaning more length bytes follow, each adding up to 255), the literals, then a 16-bit little endian match offset.
+	// The last sequence stops after its literals.
+	constexpr uint32_t LZMinMatch = 4;
+	constexpr uint32_t LZMaxOffset = 65535;
+	// Match candidates tried per position. 1 is a plain greedy parse, larger values search hash chains and parse lazily.
+	constexpr uint32_t LZDefaultSearchDepth = 16;
+
+	std::vector<uint8_t> LZCompress(const uint8_t* data, size_t size, uint32_t searchDepth = LZDefaultSearchDepth);
+	// Decodes exactly dstSize bytes to dst. Throws std::runtime_error on a corrupt stream, never reading or writing out of bounds.
+	void LZDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+}
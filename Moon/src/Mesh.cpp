@@ -3,6 +3,7 @@
 
 #include <tiny_obj_loader.h>
 #include "tiny_obj_loader.cc"
+#include <cstring>
 #include <iostream>
 
 bool ObjMesh::LoadFromObjFile(const char* filename)
@@ -61,4 +62,55 @@ bool ObjMesh::LoadFromObjFile(const char* filename)
 		}
 	}
 	return true;
-}
\ No newline at end of file
+}
+
+namespace
+{
+	constexpr uint32_t MoonMeshMagic = 0x534D4E4D;// "MNMS"
+
+	struct MoonMeshHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VertexCount;
+		uint32_t IndexCount;
+		DirectX::XMFLOAT3 Center;
+		DirectX::XMFLOAT3 Extents;
+	};
+}
+
+std::vector<uint8_t> CookedMesh::Serialize() const
+{
+	MoonMeshHeader header = { MoonMeshMagic, Version, (uint32_t)vertices.size(), (uint32_t)indices.size(), bounds.Center, bounds.Extents };
+	const size_t vertexBytes = vertices.size() * sizeof(Vertex);
+	const size_t indexBytes = indices.size() * sizeof(uint32_t);
+
+	std::vector<uint8_t> data(sizeof(header) + vertexBytes + indexBytes);
+	memcpy(data.data(), &header, sizeof(header));
+	memcpy(data.data() + sizeof(header), vertices.data(), vertexBytes);
+	memcpy(data.data() + sizeof(header) + vertexBytes, indices.data(), indexBytes);
+	return data;
+}
+
+bool CookedMesh::Deserialize(const uint8_t* data, size_t size)
+{
+	MoonMeshHeader header;
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+	if (header.Magic != MoonMeshMagic || header.Version != Version)
+		return false;
+
+	const size_t vertexBytes = (size_t)header.VertexCount * sizeof(Vertex);
+	const size_t indexBytes = (size_t)header.IndexCount * sizeof(uint32_t);
+	if (size != sizeof(header) + vertexBytes + indexBytes)
+		return false;
+
+	vertices.resize(header.VertexCount);
+	indices.resize(header.IndexCount);
+	memcpy(vertices.data(), data + sizeof(header), vertexBytes);
+	memcpy(indices.data(), data + sizeof(header) + vertexBytes, indexBytes);
+	bounds.Center = header.Center;
+	bounds.Extents = header.Extents;
+	return true;
+}
@@ -20,6 +20,22 @@ struct ObjMesh
 	bool LoadFromObjFile(const char* filename);
 };
 
+// Vertices and indices as the GPU takes them, with their bounds: what an OBJ file cooks to, kept as a .moonmesh file.
+struct CookedMesh
+{
+	// Bump when the file layout or the cooking changes, so that cached meshes cook again.
+	static constexpr uint32_t Version = 1;
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	DirectX::BoundingBox bounds;
+
+	// "MNMS", Version, the vertex and index counts, the bounds center and extents, then the vertices and the indices.
+	std::vector<uint8_t> Serialize() const;
+	// Returns false on a truncated file or one of another version.
+	bool Deserialize(const uint8_t* data, size_t size);
+};
+
 struct SubmeshGeometry
 {
 	UINT IndexCount = 0;
@@ -31,6 +47,7 @@ struct SubmeshGeometry
 struct MeshGeometry
 {
 	std::string Name;
+	int GeoIndex = -1;
 
 	Microsoft::WRL::ComPtr<ID3DBlob> VertexBufferCPU = nullptr;
 	Microsoft::WRL::ComPtr<ID3DBlob> IndexBufferCPU = nullptr;
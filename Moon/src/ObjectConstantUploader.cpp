@@ -0,0 +1,117 @@
+#include "mnpch.h"
+#include "ObjectConstantUploader.h"
+#include "JobSystem.h"
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
+using namespace DirectX;
+
+namespace Moon
+{
+	namespace
+	{
+		// Objects per job, each one is 128 bytes of streamed data.
+		constexpr uint32_t UploadGrainSize = 2048;
+
+		inline uint32_t FirstSetBit(uint32_t mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return (uint32_t)index;
+#else
+			return (uint32_t)__builtin_ctz(mask);
+#endif
+		}
+
+		inline void StreamTransposed(const XMFLOAT4X4& m, float* dst)
+		{
+			__m128 r0 = _mm_loadu_ps(&m._11);
+			__m128 r1 = _mm_loadu_ps(&m._21);
+			__m128 r2 = _mm_loadu_ps(&m._31);
+			__m128 r3 = _mm_loadu_ps(&m._41);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_stream_ps(dst + 0, r0);
+			_mm_stream_ps(dst + 4, r1);
+			_mm_stream_ps(dst + 8, r2);
+			_mm_stream_ps(dst + 12, r3);
+		}
+
+		inline void StreamObject(const XMFLOAT4X4* worlds, const XMFLOAT4X4* texTransforms, uint32_t index, uint8_t* dst, uint32_t stride)
+		{
+			float* objectDst = reinterpret_cast<float*>(dst + (size_t)index * stride);
+			StreamTransposed(worlds[index], objectDst);
+			StreamTransposed(texTransforms[index], objectDst + 16);
+		}
+	}
+
+	void ObjectConstantUploader::CollectDirty(uint8_t* numFramesDirty, uint32_t count)
+	{
+		mDirtyIndices.clear();
+
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi8(1);
+
+		// 16 counters at a time, clean blocks are skipped with a single compare.
+		uint32_t i = 0;
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i dirty = _mm_loadu_si128(reinterpret_cast<const __m128i*>(numFramesDirty + i));
+			uint32_t mask = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(dirty, zero)) & 0xFFFF;
+			if (mask == 0)
+				continue;
+
+			// Saturating subtract leaves clean counters at 0.
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(numFramesDirty + i), _mm_subs_epu8(dirty, one));
+
+			while (mask)
+			{
+				mDirtyIndices.push_back(i + FirstSetBit(mask));
+				mask &= mask - 1;
+			}
+		}
+
+		for (; i < count; ++i)
+		{
+			if (numFramesDirty[i] > 0)
+			{
+				mDirtyIndices.push_back(i);
+				numFramesDirty[i]--;
+			}
+		}
+	}
+
+	void ObjectConstantUploader::Upload(const XMFLOAT4X4* worlds, const XMFLOAT4X4* texTransforms,
+		uint8_t* dst, uint32_t stride, JobSystem* jobSystem)
+	{
+		assert(((uintptr_t)dst & 15) == 0 && (stride & 15) == 0);
+
+		const uint32_t* indices = mDirtyIndices.data();
+		auto uploadRange = [=](uint32_t begin, uint32_t end)
+		{
+			uint32_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				StreamObject(worlds, texTransforms, indices[i + 0], dst, stride);
+				StreamObject(worlds, texTransforms, indices[i + 1], dst, stride);
+				StreamObject(worlds, texTransforms, indices[i + 2], dst, stride);
+				StreamObject(worlds, texTransforms, indices[i + 3], dst, stride);
+			}
+			for (; i < end; ++i)
+				StreamObject(worlds, texTransforms, indices[i], dst, stride);
+
+			// Streaming stores are weakly ordered, flush them before the GPU work gets submitted.
+			_mm_sfence();
+		};
+
+		const uint32_t count = (uint32_t)mDirtyIndices.size();
+		if (jobSystem)
+			jobSystem->ParallelFor(count, UploadGrainSize, uploadRange);
+		else
+			uploadRange(0, count);
+	}
+}
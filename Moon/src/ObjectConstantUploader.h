@@ -0,0 +1,33 @@
+#pragma once
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Moon
+{
+	class JobSystem;
+
+	// Batched object constant upload.
+	// Dirty objects are collected in ascending order first, then their transposed World/TexTransform
+	// pairs are streamed with non-temporal stores so that write-combined upload memory is filled
+	// in whole cache lines, in address order, without being read back into the cache.
+	class ObjectConstantUploader
+	{
+	public:
+		// Bytes written per object: transposed World followed by transposed TexTransform.
+		static constexpr uint32_t ObjectDataSize = 2 * sizeof(DirectX::XMFLOAT4X4);
+
+		// Appends every object with numFramesDirty > 0 and decrements its counter.
+		void CollectDirty(uint8_t* numFramesDirty, uint32_t count);
+
+		// dst is the mapped buffer, object i is written at dst + i * stride. dst and stride must be 16-byte aligned.
+		void Upload(const DirectX::XMFLOAT4X4* worlds, const DirectX::XMFLOAT4X4* texTransforms,
+			uint8_t* dst, uint32_t stride, JobSystem* jobSystem = nullptr);
+
+		const std::vector<uint32_t>& GetDirtyIndices() const { return mDirtyIndices; }
+
+	private:
+		std::vector<uint32_t> mDirtyIndices;
+	};
+}
@@ -0,0 +1,130 @@
+#include "mnpch.h"
+#include "PayloadBenchmark.h"
+#include "BenchmarkCommon.h"
+#include "CpuProfiler.h"
+#include "LZCodec.h"
+#include "Utils.h"
+
+#include <cstring>
+
+namespace Moon
+{
+	namespace
+	{
+		// Same image as the compression benchmark.
+		constexpr uint32_t ImageSize = 128;
+
+		struct PayloadCase
+		{
+			const char* Format;
+			DXGI_FORMAT DxgiFormat;
+			// Channels the format stores, counted from red.
+			uint32_t Channels;
+			const char* Encoder;
+			DirectX::TEX_COMPRESS_FLAGS Flags;
+		};
+
+		// With the encoders a cook would use.
+		const PayloadCase PayloadCases[] =
+		{
+			{ "bc1", DXGI_FORMAT_BC1_UNORM, 3, "bc_fast", DirectX::TEX_COMPRESS_BC_FAST },
+			{ "bc3", DXGI_FORMAT_BC3_UNORM, 4, "bc_fast", DirectX::TEX_COMPRESS_BC_FAST },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, 4, "fast", DirectX::TEX_COMPRESS_BC7_FAST },
+		};
+		// 0 is the payload of the encoder alone.
+		const float RDOLambdas[] = { 0.0f, 4.0f, 16.0f, 64.0f };
+		// Sequential reads of a PCIe 3.0 x4 NVMe drive, LZ decoding has to outrun them.
+		constexpr double NVMeTargetGBPerSecond = 3.5;
+		// Decodes per timed run, the payload of the benchmark image alone is too small to time.
+		constexpr uint32_t LZDecodeRepeats = 64;
+	}
+
+	void PayloadBenchmark::Run()
+	{
+		DirectX::ScratchImage source;
+		if (FAILED(source.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, ImageSize, ImageSize, 1, 1)))
+			throw std::runtime_error("Could not allocate the payload benchmark image");
+
+		const DirectX::Image& image = *source.GetImage(0, 0, 0);
+		std::mt19937 random(5678);
+		FillBenchmarkImage(image, random);
+
+		std::vector<float> runs(BenchmarkRuns);
+		for (const PayloadCase& test : PayloadCases)
+		{
+			DirectX::ScratchImage compressed;
+			if (FAILED(DirectX::Compress(image, test.DxgiFormat, test.Flags, DirectX::TEX_THRESHOLD_DEFAULT, compressed)))
+				throw std::runtime_error(std::string(test.Format) + " compression failed with the " + test.Encoder + " encoder");
+
+			// Every lambda starts over from the blocks of the encoder.
+			const DirectX::Image& blocks = *compressed.GetImage(0, 0, 0);
+			const std::vector<uint8_t> encoded(blocks.pixels, blocks.pixels + blocks.slicePitch);
+			std::vector<uint8_t> decoded(blocks.slicePitch);
+			for (float lambda : RDOLambdas)
+			{
+				for (float& run : runs)
+				{
+					memcpy(blocks.pixels, encoded.data(), encoded.size());
+					const uint64_t begin = CpuProfiler::Now();
+					if (FAILED(DirectX::RateDistortionOptimize(image, blocks, test.Flags, lambda)))
+						throw std::runtime_error(std::string(test.Format) + " rate-distortion optimization failed");
+					run = ElapsedMS(begin, CpuProfiler::Now());
+				}
+
+				Result result;
+				result.Format = test.Format;
+				result.Encoder = test.Encoder;
+				result.Lambda = lambda;
+				result.RdoMS = MedianMS(runs);
+				result.RMSE = ComputeRMSE(image, blocks, test.Channels);
+
+				const std::vector<uint8_t> stream = LZCompress(blocks.pixels, blocks.slicePitch);
+				result.Ratio = (double)stream.size() / (double)blocks.slicePitch;
+				for (float& run : runs)
+				{
+					const uint64_t begin = CpuProfiler::Now();
+					for (uint32_t i = 0; i < LZDecodeRepeats; ++i)
+						LZDecompress(stream.data(), stream.size(), decoded.data(), decoded.size());
+					run = ElapsedMS(begin, CpuProfiler::Now());
+				}
+				if (memcmp(decoded.data(), blocks.pixels, decoded.size()) != 0)
+					throw std::runtime_error(std::string(test.Format) + " payload did not survive the LZ round trip");
+
+				const float decodeMS = MedianMS(runs);
+				result.DecodeGBPerSecond = decodeMS > 0.0f ? (double)decoded.size() * LZDecodeRepeats / (decodeMS * 1000000.0) : 0.0;
+				mResults.push_back(result);
+			}
+		}
+	}
+
+	void PayloadBenchmark::WriteJSON(std::ostream& out) const
+	{
+		out << "{\"size\":" << ImageSize
+			<< ",\"nvme_target_gb_per_s\":" << NVMeTargetGBPerSecond << ",\"formats\":{";
+		for (size_t i = 0; i < mResults.size(); ++i)
+		{
+			const Result& result = mResults[i];
+			const bool firstOfFormat = i == 0 || mResults[i - 1].Format != result.Format;
+			if (firstOfFormat)
+			{
+				out << (i ? "]}," : "");
+				WriteJSONString(out, result.Format);
+				out << ":{\"encoder\":";
+				WriteJSONString(out, result.Encoder);
+				out << ",\"lambdas\":[";
+			}
+			else
+			{
+				out << ",";
+			}
+
+			out << "{\"lambda\":" << result.Lambda
+				<< ",\"rdo_ms\":" << result.RdoMS
+				<< ",\"lz_ratio\":" << result.Ratio
+				<< ",\"rmse\":" << result.RMSE
+				<< ",\"decode_gb_per_s\":" << result.DecodeGBPerSecond
+				<< ",\"meets_target\":" << (result.DecodeGBPerSecond >= NVMeTargetGBPerSecond ? "true" : "false") << "}";
+		}
+		out << (mResults.empty() ? "" : "]}") << "}}";
+	}
+}
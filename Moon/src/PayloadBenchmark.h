@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	// The shipped payload of the BC formats a cook produces: rate-distortion optimization at every lambda, then the
+	// LZ ratio and decode throughput of the blocks it leaves.
+	class PayloadBenchmark
+	{
+	public:
+		// Throws std::runtime_error when an encoder fails or a payload does not survive the LZ round trip.
+		void Run();
+		// {"size":...,"nvme_target_gb_per_s":...,"formats":{"<format>":{"encoder":...,"lambdas":[...]}}}
+		void WriteJSON(std::ostream& out) const;
+
+	private:
+		struct Result
+		{
+			std::string Format;
+			std::string Encoder;
+			float Lambda = 0.0f;
+			float RdoMS = 0.0f;
+			// LZ stream bytes over block bytes.
+			double Ratio = 1.0;
+			double RMSE = 0.0;
+			double DecodeGBPerSecond = 0.0;
+		};
+		// Grouped by format, one per lambda.
+		std::vector<Result> mResults;
+	};
+}
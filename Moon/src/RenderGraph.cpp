@@ -0,0 +1,198 @@
+#include "mnpch.h"
+#include "RenderGraph.h"
+
+using namespace Microsoft::WRL;
+
+namespace Moon
+{
+	void RenderGraph::PassBuilder::Read(RenderGraphResource resource, D3D12_RESOURCE_STATES state)
+	{
+		mCompiler.AddRead(mPass, resource, (uint32_t)state);
+	}
+
+	void RenderGraph::PassBuilder::Write(RenderGraphResource resource, D3D12_RESOURCE_STATES state)
+	{
+		mCompiler.AddWrite(mPass, resource, (uint32_t)state);
+	}
+
+	void RenderGraph::PassBuilder::Clear(RenderGraphResource resource, D3D12_RESOURCE_STATES state)
+	{
+		mCompiler.AddClear(mPass, resource, (uint32_t)state);
+	}
+
+	RenderGraph::RenderGraph(ID3D12Device* device)
+		: mDevice(device)
+	{
+	}
+
+	void RenderGraph::Reset()
+	{
+		mFrameIndex++;
+		mRetired.erase(std::remove_if(mRetired.begin(), mRetired.end(), [this](const auto& retired)
+		{
+			return retired.first + BACKBUFFER_COUNT < mFrameIndex;
+		}), mRetired.end());
+
+		mCompiler.Reset();
+		mResources.clear();
+		mTransientDescs.clear();
+		mPassExecutes.clear();
+	}
+
+	RenderGraphResource RenderGraph::ImportResource(const std::string& name, ID3D12Resource* resource,
+		D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState)
+	{
+		RenderGraphResourceDesc desc;
+		desc.Name = name;
+		desc.Imported = true;
+		desc.InitialState = (uint32_t)initialState;
+		desc.FinalState = (uint32_t)finalState;
+
+		mResources.push_back(resource);
+		mTransientDescs.emplace_back();
+		return mCompiler.AddResource(desc);
+	}
+
+	RenderGraphResource RenderGraph::CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* optimizedClearValue)
+	{
+		const D3D12_RESOURCE_ALLOCATION_INFO allocInfo = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+		RenderGraphResourceDesc graphDesc;
+		graphDesc.Name = name;
+		graphDesc.SizeInBytes = allocInfo.SizeInBytes;
+		graphDesc.Alignment = allocInfo.Alignment;
+
+		TransientTexture transient;
+		transient.Desc = desc;
+		transient.HasClearValue = optimizedClearValue != nullptr;
+		if (optimizedClearValue)
+			transient.ClearValue = *optimizedClearValue;
+
+		mResources.push_back(nullptr);
+		mTransientDescs.push_back(transient);
+		return mCompiler.AddResource(graphDesc);
+	}
+
+	void RenderGraph::AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute, bool hasSideEffects)
+	{
+		PassBuilder builder(mCompiler, mCompiler.AddPass(name, hasSideEffects));
+		setup(builder);
+		mPassExecutes.push_back(std::move(execute));
+	}
+
+	void RenderGraph::Compile()
+	{
+		mCompiler.Compile();
+		CreateTransients();
+	}
+
+	void RenderGraph::CreateTransients()
+	{
+		const uint64_t heapSize = mCompiler.GetTransientHeapSize();
+		if (heapSize > mTransientHeapSize)
+		{
+			// Every placed resource lives in the old heap, they all go away with it.
+			Retire(mTransientHeap);
+			for (auto& cached : mTransientCache)
+				Retire(cached.second.Resource);
+			mTransientCache.clear();
+
+			D3D12_HEAP_DESC heapDesc = {};
+			heapDesc.SizeInBytes = heapSize;
+			heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+			heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+			heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+			DX_CHECK(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(mTransientHeap.ReleaseAndGetAddressOf())));
+			mTransientHeapSize = heapSize;
+		}
+
+		for (uint32_t r = 0; r < mCompiler.GetResourceCount(); ++r)
+		{
+			const RenderGraphResourceDesc& desc = mCompiler.GetResourceDesc(r);
+			if (desc.Imported || mCompiler.GetLifetime(r).FirstUse == InvalidRenderGraphIndex)
+				continue;
+
+			const TransientTexture& transient = mTransientDescs[r];
+			const uint64_t heapOffset = mCompiler.GetHeapOffset(r);
+			const uint32_t state = mCompiler.GetTransientState(r);
+
+			CachedTransient& cached = mTransientCache[desc.Name];
+			const bool reusable = cached.Resource
+				&& cached.HeapOffset == heapOffset
+				&& cached.State == state
+				&& memcmp(&cached.Desc, &transient.Desc, sizeof(D3D12_RESOURCE_DESC)) == 0;
+
+			if (!reusable)
+			{
+				Retire(cached.Resource);
+				cached.Resource.Reset();
+				DX_CHECK(mDevice->CreatePlacedResource(
+					mTransientHeap.Get(),
+					heapOffset,
+					&transient.Desc,
+					(D3D12_RESOURCE_STATES)state,
+					transient.HasClearValue ? &transient.ClearValue : nullptr,
+					IID_PPV_ARGS(cached.Resource.GetAddressOf())));
+				cached.Desc = transient.Desc;
+				cached.HeapOffset = heapOffset;
+				cached.State = state;
+			}
+
+			mResources[r] = cached.Resource.Get();
+		}
+	}
+
+	void RenderGraph::Execute(ID3D12GraphicsCommandList* cmdList)
+	{
+		auto flushBarriers = [this, cmdList](size_t batchIndex)
+		{
+			mBarrierScratch.clear();
+			for (const RenderGraphBarrier& barrier : mCompiler.GetBarrierBatch(batchIndex))
+			{
+				if (barrier.BarrierType == RenderGraphBarrier::Type::Aliasing)
+				{
+					ID3D12Resource* before = barrier.ResourceBefore != InvalidRenderGraphIndex ? mResources[barrier.ResourceBefore] : nullptr;
+					mBarrierScratch.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, mResources[barrier.Resource]));
+					continue;
+				}
+
+				D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+				if (barrier.SplitFlag == RenderGraphBarrier::Split::Begin)
+					flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+				else if (barrier.SplitFlag == RenderGraphBarrier::Split::End)
+					flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+
+				mBarrierScratch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(mResources[barrier.Resource],
+					(D3D12_RESOURCE_STATES)barrier.StateBefore, (D3D12_RESOURCE_STATES)barrier.StateAfter,
+					D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, flags));
+			}
+
+			if (!mBarrierScratch.empty())
+				cmdList->ResourceBarrier((UINT)mBarrierScratch.size(), mBarrierScratch.data());
+		};
+
+		const std::vector<uint32_t>& order = mCompiler.GetExecutionOrder();
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			flushBarriers(i);
+
+			ScopedPerfMarker marker(cmdList, mCompiler.GetPassName(order[i]).c_str());
+			mPassExecutes[order[i]](*this);
+		}
+		flushBarriers(order.size());
+	}
+
+	void RenderGraph::ReleaseTransients()
+	{
+		mTransientCache.clear();
+		mTransientHeap.Reset();
+		mTransientHeapSize = 0;
+		mRetired.clear();
+	}
+
+	void RenderGraph::Retire(ComPtr<ID3D12Pageable> object)
+	{
+		if (object)
+			mRetired.emplace_back(mFrameIndex, std::move(object));
+	}
+}
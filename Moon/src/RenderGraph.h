@@ -0,0 +1,97 @@
+#pragma once
+#include "dx_utils.h"
+#include "RenderGraphCompiler.h"
+
+#include <functional>
+#include <map>
+
+namespace Moon
+{
+	using RenderGraphResource = uint32_t;
+
+	// Frame graph on top of RenderGraphCompiler.
+	// Rebuilt every frame: import or create resources, add passes that declare what they read and write,
+	// then Compile() and Execute(). Barriers are derived from the declarations and submitted in one
+	// ResourceBarrier call per pass boundary, transient textures are placed in a shared heap.
+	class RenderGraph
+	{
+	public:
+		class PassBuilder
+		{
+		public:
+			void Read(RenderGraphResource resource, D3D12_RESOURCE_STATES state);
+			void Write(RenderGraphResource resource, D3D12_RESOURCE_STATES state);
+			// Write of a pass that clears or discards the whole resource first, which the first pass of a transient must be.
+			void Clear(RenderGraphResource resource, D3D12_RESOURCE_STATES state);
+
+		private:
+			friend class RenderGraph;
+			PassBuilder(RenderGraphCompiler& compiler, uint32_t pass) : mCompiler(compiler), mPass(pass) {}
+
+			RenderGraphCompiler& mCompiler;
+			uint32_t mPass;
+		};
+
+		using SetupFn = std::function<void(PassBuilder&)>;
+		using ExecuteFn = std::function<void(RenderGraph&)>;
+
+		RenderGraph(ID3D12Device* device);
+		RenderGraph(const RenderGraph& rhs) = delete;
+		RenderGraph& operator=(const RenderGraph& rhs) = delete;
+
+		// Starts a new frame. Transients created by earlier frames are kept and reused when their placement does not change.
+		void Reset();
+
+		RenderGraphResource ImportResource(const std::string& name, ID3D12Resource* resource,
+			D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState);
+		// Transient render target or depth texture. Its first pass must declare a Clear(), and clear or discard it,
+		// since the memory may have been used by another transient just before: Compile() throws otherwise.
+		RenderGraphResource CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr);
+
+		void AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute, bool hasSideEffects = false);
+
+		void Compile();
+		void Execute(ID3D12GraphicsCommandList* cmdList);
+
+		// Only valid between Compile() and the end of Execute().
+		ID3D12Resource* GetResource(RenderGraphResource resource) const { return mResources[resource]; }
+		const RenderGraphCompiler& GetCompiler() const { return mCompiler; }
+
+		// Drops every transient, the GPU must be idle.
+		void ReleaseTransients();
+
+	private:
+		struct TransientTexture
+		{
+			D3D12_RESOURCE_DESC Desc;
+			bool HasClearValue = false;
+			D3D12_CLEAR_VALUE ClearValue;
+		};
+
+		struct CachedTransient
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+			D3D12_RESOURCE_DESC Desc;
+			uint64_t HeapOffset = 0;
+			uint32_t State = 0;
+		};
+
+		void CreateTransients();
+		void Retire(Microsoft::WRL::ComPtr<ID3D12Pageable> object);
+
+		ID3D12Device* mDevice = nullptr;
+		RenderGraphCompiler mCompiler;
+		std::vector<ID3D12Resource*> mResources;
+		std::vector<TransientTexture> mTransientDescs;
+		std::vector<ExecuteFn> mPassExecutes;
+		std::vector<D3D12_RESOURCE_BARRIER> mBarrierScratch;
+
+		Microsoft::WRL::ComPtr<ID3D12Heap> mTransientHeap;
+		uint64_t mTransientHeapSize = 0;
+		std::map<std::string, CachedTransient> mTransientCache;
+
+		// Objects replaced while frames in flight may still use them.
+		std::vector<std::pair<uint64_t, Microsoft::WRL::ComPtr<ID3D12Pageable>>> mRetired;
+		uint64_t mFrameIndex = 0;
+	};
+}
@@ -0,0 +1,401 @@
+#include "mnpch.h"
+#include "RenderGraphCompiler.h"
+
+#include <queue>
+#include <stdexcept>
+
+namespace Moon
+{
+	namespace
+	{
+		inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+		}
+
+		inline bool LifetimesOverlap(const RenderGraphLifetime& a, const RenderGraphLifetime& b)
+		{
+			return !(a.LastUse < b.FirstUse || b.LastUse < a.FirstUse);
+		}
+	}
+
+	void RenderGraphCompiler::Reset()
+	{
+		mPasses.clear();
+		mResources.clear();
+		mExecutionOrder.clear();
+		mBarrierBatches.clear();
+		mTransientHeapSize = 0;
+	}
+
+	uint32_t RenderGraphCompiler::AddResource(const RenderGraphResourceDesc& desc)
+	{
+		Resource resource;
+		resource.Desc = desc;
+		mResources.push_back(resource);
+		return (uint32_t)mResources.size() - 1;
+	}
+
+	uint32_t RenderGraphCompiler::AddPass(const std::string& name, bool hasSideEffects)
+	{
+		Pass pass;
+		pass.Name = name;
+		pass.HasSideEffects = hasSideEffects;
+		mPasses.push_back(pass);
+		return (uint32_t)mPasses.size() - 1;
+	}
+
+	void RenderGraphCompiler::AddRead(uint32_t pass, uint32_t resource, uint32_t state)
+	{
+		mPasses[pass].Accesses.push_back({ resource, state, false, false });
+	}
+
+	void RenderGraphCompiler::AddWrite(uint32_t pass, uint32_t resource, uint32_t state)
+	{
+		mPasses[pass].Accesses.push_back({ resource, state, true, false });
+	}
+
+	void RenderGraphCompiler::AddClear(uint32_t pass, uint32_t resource, uint32_t state)
+	{
+		mPasses[pass].Accesses.push_back({ resource, state, true, true });
+	}
+
+	void RenderGraphCompiler::Compile()
+	{
+		CullPasses();
+		SortPasses();
+		ComputeLifetimes();
+		ValidateTransients();
+		AssignHeapOffsets();
+		BuildBarriers();
+	}
+
+	void RenderGraphCompiler::CullPasses()
+	{
+		// Walk backwards from the passes that produce something visible outside of the graph,
+		// a pass is kept when a kept pass after it reads one of its outputs.
+		std::vector<bool> resourceNeeded(mResources.size(), false);
+
+		for (size_t p = mPasses.size(); p-- > 0;)
+		{
+			Pass& pass = mPasses[p];
+
+			bool keep = pass.HasSideEffects;
+			for (const Access& access : pass.Accesses)
+			{
+				if (access.Write && (mResources[access.Resource].Desc.Imported || resourceNeeded[access.Resource]))
+					keep = true;
+			}
+
+			pass.Culled = !keep;
+			if (keep)
+			{
+				for (const Access& access : pass.Accesses)
+				{
+					if (!access.Write)
+						resourceNeeded[access.Resource] = true;
+				}
+			}
+		}
+	}
+
+	void RenderGraphCompiler::SortPasses()
+	{
+		const uint32_t passCount = GetPassCount();
+		std::vector<std::vector<uint32_t>> edges(passCount);
+		std::vector<uint32_t> inDegree(passCount, 0);
+
+		auto addEdge = [&](uint32_t from, uint32_t to)
+		{
+			if (from == InvalidRenderGraphIndex || from == to)
+				return;
+			edges[from].push_back(to);
+			inDegree[to]++;
+		};
+
+		// Read after write, write after read and write after write hazards, in declaration order.
+		for (uint32_t r = 0; r < GetResourceCount(); ++r)
+		{
+			uint32_t lastWriter = InvalidRenderGraphIndex;
+			std::vector<uint32_t> readers;
+
+			for (uint32_t p = 0; p < passCount; ++p)
+			{
+				if (mPasses[p].Culled)
+					continue;
+
+				bool reads = false;
+				bool writes = false;
+				for (const Access& access : mPasses[p].Accesses)
+				{
+					if (access.Resource == r)
+						(access.Write ? writes : reads) = true;
+				}
+
+				if (writes)
+				{
+					addEdge(lastWriter, p);
+					for (uint32_t reader : readers)
+						addEdge(reader, p);
+					readers.clear();
+					lastWriter = p;
+				}
+				else if (reads)
+				{
+					addEdge(lastWriter, p);
+					readers.push_back(p);
+				}
+			}
+		}
+
+		// Kahn's algorithm, ties go to the pass declared first so the order is deterministic.
+		std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+		for (uint32_t p = 0; p < passCount; ++p)
+		{
+			if (!mPasses[p].Culled && inDegree[p] == 0)
+				ready.push(p);
+		}
+
+		mExecutionOrder.clear();
+		while (!ready.empty())
+		{
+			const uint32_t p = ready.top();
+			ready.pop();
+			mExecutionOrder.push_back(p);
+
+			for (uint32_t next : edges[p])
+			{
+				if (--inDegree[next] == 0)
+					ready.push(next);
+			}
+		}
+	}
+
+	void RenderGraphCompiler::ComputeLifetimes()
+	{
+		for (Resource& resource : mResources)
+			resource.Lifetime = RenderGraphLifetime();
+
+		for (uint32_t i = 0; i < (uint32_t)mExecutionOrder.size(); ++i)
+		{
+			for (const Access& access : mPasses[mExecutionOrder[i]].Accesses)
+			{
+				RenderGraphLifetime& lifetime = mResources[access.Resource].Lifetime;
+				if (lifetime.FirstUse == InvalidRenderGraphIndex)
+					lifetime.FirstUse = i;
+				lifetime.LastUse = i;
+			}
+		}
+	}
+
+	void RenderGraphCompiler::ValidateTransients() const
+	{
+		for (uint32_t r = 0; r < GetResourceCount(); ++r)
+		{
+			const Resource& resource = mResources[r];
+			if (resource.Desc.Imported || resource.Lifetime.FirstUse == InvalidRenderGraphIndex)
+				continue;
+
+			const Pass& pass = mPasses[mExecutionOrder[resource.Lifetime.FirstUse]];
+			bool cleared = false;
+			for (const Access& access : pass.Accesses)
+				cleared |= (access.Resource == r && access.Clear);
+			if (!cleared)
+				throw std::runtime_error("Transient " + resource.Desc.Name + " is first used by " + pass.Name + " without a clear or discard");
+		}
+	}
+
+	void RenderGraphCompiler::AssignHeapOffsets()
+	{
+		std::vector<uint32_t> transients;
+		for (uint32_t r = 0; r < GetResourceCount(); ++r)
+		{
+			if (!mResources[r].Desc.Imported && mResources[r].Lifetime.FirstUse != InvalidRenderGraphIndex)
+				transients.push_back(r);
+		}
+
+		// Biggest first, smaller resources then fill the holes left between them.
+		std::stable_sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b)
+		{
+			return mResources[a].Desc.SizeInBytes > mResources[b].Desc.SizeInBytes;
+		});
+
+		std::vector<uint32_t> placed;
+		mTransientHeapSize = 0;
+
+		for (uint32_t r : transients)
+		{
+			Resource& resource = mResources[r];
+			const uint64_t size = resource.Desc.SizeInBytes;
+			const uint64_t alignment = resource.Desc.Alignment;
+
+			// Only resources alive at the same time compete for memory.
+			std::vector<uint32_t> concurrent;
+			std::vector<uint64_t> candidates = { 0 };
+			for (uint32_t other : placed)
+			{
+				if (LifetimesOverlap(resource.Lifetime, mResources[other].Lifetime))
+				{
+					concurrent.push_back(other);
+					candidates.push_back(AlignUp(mResources[other].HeapOffset + mResources[other].Desc.SizeInBytes, alignment));
+				}
+			}
+			std::sort(candidates.begin(), candidates.end());
+
+			for (uint64_t offset : candidates)
+			{
+				bool fits = true;
+				for (uint32_t other : concurrent)
+				{
+					const uint64_t otherBegin = mResources[other].HeapOffset;
+					const uint64_t otherEnd = otherBegin + mResources[other].Desc.SizeInBytes;
+					if (offset < otherEnd && otherBegin < offset + size)
+					{
+						fits = false;
+						break;
+					}
+				}
+
+				if (fits)
+				{
+					resource.HeapOffset = offset;
+					break;
+				}
+			}
+
+			placed.push_back(r);
+			mTransientHeapSize = std::max(mTransientHeapSize, resource.HeapOffset + size);
+		}
+	}
+
+	void RenderGraphCompiler::AddTransition(uint32_t resource, uint32_t before, uint32_t after, uint32_t previousUse, uint32_t use)
+	{
+		RenderGraphBarrier barrier;
+		barrier.Resource = resource;
+		barrier.StateBefore = before;
+		barrier.StateAfter = after;
+
+		// Begin the transition right after the previous use when passes sit in between,
+		// the driver can then overlap it with their work.
+		const uint32_t beginBatch = previousUse == InvalidRenderGraphIndex ? 0 : previousUse + 1;
+		if (beginBatch < use)
+		{
+			barrier.SplitFlag = RenderGraphBarrier::Split::Begin;
+			mBarrierBatches[beginBatch].push_back(barrier);
+			barrier.SplitFlag = RenderGraphBarrier::Split::End;
+		}
+		mBarrierBatches[use].push_back(barrier);
+	}
+
+	void RenderGraphCompiler::BuildBarriers()
+	{
+		const uint32_t passCount = (uint32_t)mExecutionOrder.size();
+		mBarrierBatches.assign(passCount + 1, {});
+
+		// Aliasing barriers go first in their batch, before any transition on the new resource.
+		for (uint32_t r = 0; r < GetResourceCount(); ++r)
+		{
+			const Resource& resource = mResources[r];
+			if (resource.Desc.Imported || resource.Lifetime.FirstUse == InvalidRenderGraphIndex)
+				continue;
+
+			bool sharesMemory = false;
+			bool hasPredecessor = false;
+			for (uint32_t other = 0; other < GetResourceCount(); ++other)
+			{
+				const Resource& o = mResources[other];
+				if (other == r || o.Desc.Imported || o.Lifetime.FirstUse == InvalidRenderGraphIndex)
+					continue;
+
+				const bool memoryOverlap = resource.HeapOffset < o.HeapOffset + o.Desc.SizeInBytes
+					&& o.HeapOffset < resource.HeapOffset + resource.Desc.SizeInBytes;
+				if (!memoryOverlap)
+					continue;
+
+				sharesMemory = true;
+				if (o.Lifetime.LastUse < resource.Lifetime.FirstUse)
+				{
+					RenderGraphBarrier barrier;
+					barrier.BarrierType = RenderGraphBarrier::Type::Aliasing;
+					barrier.ResourceBefore = other;
+					barrier.Resource = r;
+					mBarrierBatches[resource.Lifetime.FirstUse].push_back(barrier);
+					hasPredecessor = true;
+				}
+			}
+
+			// First user of shared memory in this frame, whatever used it last frame is unknown here.
+			if (sharesMemory && !hasPredecessor)
+			{
+				RenderGraphBarrier barrier;
+				barrier.BarrierType = RenderGraphBarrier::Type::Aliasing;
+				barrier.Resource = r;
+				mBarrierBatches[resource.Lifetime.FirstUse].push_back(barrier);
+			}
+		}
+
+		// State of each resource for every pass using it, in execution order.
+		struct Use
+		{
+			uint32_t Position;
+			uint32_t State;
+		};
+		std::vector<std::vector<Use>> uses(GetResourceCount());
+		for (uint32_t i = 0; i < passCount; ++i)
+		{
+			const Pass& pass = mPasses[mExecutionOrder[i]];
+			for (const Access& access : pass.Accesses)
+			{
+				std::vector<Use>& resourceUses = uses[access.Resource];
+				if (resourceUses.empty() || resourceUses.back().Position != i)
+				{
+					resourceUses.push_back({ i, access.State });
+					continue;
+				}
+
+				// Several declarations in one pass: read states combine, a write state wins over reads.
+				bool passWrites = false;
+				for (const Access& a : pass.Accesses)
+					passWrites |= (a.Resource == access.Resource && a.Write);
+
+				Use& use = resourceUses.back();
+				if (!passWrites)
+					use.State |= access.State;
+				else if (access.Write)
+					use.State = access.State;
+			}
+		}
+
+		for (uint32_t r = 0; r < GetResourceCount(); ++r)
+		{
+			Resource& resource = mResources[r];
+			const std::vector<Use>& resourceUses = uses[r];
+
+			if (!resource.Desc.Imported && resourceUses.empty())
+				continue;
+
+			// A transient keeps the state of its last use from one frame to the next. It is never transitioned
+			// after that use since its memory may already belong to another resource by then.
+			uint32_t state = resource.Desc.Imported ? resource.Desc.InitialState : resourceUses.back().State;
+			uint32_t previousUse = InvalidRenderGraphIndex;
+			if (!resource.Desc.Imported)
+			{
+				resource.TransientState = state;
+				// Right after the aliasing barrier of its first use, never split.
+				const uint32_t firstUse = resourceUses[0].Position;
+				previousUse = firstUse > 0 ? firstUse - 1 : InvalidRenderGraphIndex;
+			}
+
+			for (const Use& use : resourceUses)
+			{
+				if (use.State != state)
+					AddTransition(r, state, use.State, previousUse, use.Position);
+				state = use.State;
+				previousUse = use.Position;
+			}
+
+			if (resource.Desc.Imported && state != resource.Desc.FinalState)
+				AddTransition(r, state, resource.Desc.FinalState, previousUse, passCount);
+		}
+	}
+}
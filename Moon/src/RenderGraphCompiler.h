@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	constexpr uint32_t InvalidRenderGraphIndex = UINT32_MAX;
+
+	// Resource states are plain bitmasks with the same values as D3D12_RESOURCE_STATES,
+	// which keeps the compiler free of any graphics API.
+	struct RenderGraphResourceDesc
+	{
+		std::string Name;
+
+		// Imported resources live outside the graph (back buffer, persistent depth...).
+		// Their state is InitialState when the graph starts and must be FinalState when it ends.
+		bool Imported = false;
+		uint32_t InitialState = 0;
+		uint32_t FinalState = 0;
+
+		// Transient resources are placed in a shared heap, memory is reused between resources whose lifetimes do not overlap.
+		uint64_t SizeInBytes = 0;
+		uint64_t Alignment = 0;
+	};
+
+	struct RenderGraphBarrier
+	{
+		enum class Type : uint8_t
+		{
+			Transition,
+			Aliasing,
+		};
+
+		enum class Split : uint8_t
+		{
+			None,
+			Begin,
+			End,
+		};
+
+		Type BarrierType = Type::Transition;
+		Split SplitFlag = Split::None;
+		uint32_t Resource = InvalidRenderGraphIndex;
+		// Aliasing only: the resource that used the memory before.
+		uint32_t ResourceBefore = InvalidRenderGraphIndex;
+		uint32_t StateBefore = 0;
+		uint32_t StateAfter = 0;
+	};
+
+	struct RenderGraphLifetime
+	{
+		// Positions in the execution order, InvalidRenderGraphIndex when the resource is never used.
+		uint32_t FirstUse = InvalidRenderGraphIndex;
+		uint32_t LastUse = InvalidRenderGraphIndex;
+	};
+
+	// Builds the execution plan of a frame graph: pass culling, topological order,
+	// resource lifetimes, memory aliasing and batched (optionally split) barriers.
+	class RenderGraphCompiler
+	{
+	public:
+		void Reset();
+
+		uint32_t AddResource(const RenderGraphResourceDesc& desc);
+		// Passes with side effects (present, readback, UI...) are never culled.
+		uint32_t AddPass(const std::string& name, bool hasSideEffects = false);
+		void AddRead(uint32_t pass, uint32_t resource, uint32_t state);
+		void AddWrite(uint32_t pass, uint32_t resource, uint32_t state);
+		// Write that overwrites the whole resource whatever it held, a clear or a discard.
+		void AddClear(uint32_t pass, uint32_t resource, uint32_t state);
+
+		// Throws std::runtime_error when a transient's first pass does not clear it: its memory may hold another transient.
+		void Compile();
+
+		bool IsPassCulled(uint32_t pass) const { return mPasses[pass].Culled; }
+		// Indices of the passes to run, in order.
+		const std::vector<uint32_t>& GetExecutionOrder() const { return mExecutionOrder; }
+		// Barriers to submit, in a single call, before the i-th pass of the execution order.
+		// GetBarrierBatch(GetExecutionOrder().size()) holds the barriers to submit after the last pass.
+		const std::vector<RenderGraphBarrier>& GetBarrierBatch(size_t i) const { return mBarrierBatches[i]; }
+
+		const RenderGraphLifetime& GetLifetime(uint32_t resource) const { return mResources[resource].Lifetime; }
+		uint64_t GetHeapOffset(uint32_t resource) const { return mResources[resource].HeapOffset; }
+		uint64_t GetTransientHeapSize() const { return mTransientHeapSize; }
+		// State a transient resource is left in after its last use, and found in before its first one.
+		// It is also the state to create it in.
+		uint32_t GetTransientState(uint32_t resource) const { return mResources[resource].TransientState; }
+
+		uint32_t GetResourceCount() const { return (uint32_t)mResources.size(); }
+		uint32_t GetPassCount() const { return (uint32_t)mPasses.size(); }
+		const std::string& GetPassName(uint32_t pass) const { return mPasses[pass].Name; }
+		const RenderGraphResourceDesc& GetResourceDesc(uint32_t resource) const { return mResources[resource].Desc; }
+
+	private:
+		struct Access
+		{
+			uint32_t Resource;
+			uint32_t State;
+			bool Write;
+			bool Clear;
+		};
+
+		struct Pass
+		{
+			std::string Name;
+			bool HasSideEffects = false;
+			bool Culled = false;
+			std::vector<Access> Accesses;
+		};
+
+		struct Resource
+		{
+			RenderGraphResourceDesc Desc;
+			RenderGraphLifetime Lifetime;
+			uint64_t HeapOffset = 0;
+			uint32_t TransientState = 0;
+		};
+
+		void CullPasses();
+		void SortPasses();
+		void ComputeLifetimes();
+		void ValidateTransients() const;
+		void AssignHeapOffsets();
+		void BuildBarriers();
+		void AddTransition(uint32_t resource, uint32_t before, uint32_t after, uint32_t previousUse, uint32_t use);
+
+		std::vector<Pass> mPasses;
+		std::vector<Resource> mResources;
+		std::vector<uint32_t> mExecutionOrder;
+		std::vector<std::vector<RenderGraphBarrier>> mBarrierBatches;
+		uint64_t mTransientHeapSize = 0;
+	};
+}
@@ -0,0 +1,221 @@
+#include "mnpch.h"
+#include "ResourceStateTracker.h"
+
+namespace Moon
+{
+	namespace
+	{
+		// RENDER_TARGET | UNORDERED_ACCESS | DEPTH_WRITE | STREAM_OUT | COPY_DEST | RESOLVE_DEST
+		constexpr uint32_t WriteStates = 0x4 | 0x8 | 0x10 | 0x100 | 0x400 | 0x1000;
+
+		// A read only state that already contains every requested read bit needs no transition,
+		// e.g. GENERIC_READ for an index buffer.
+		inline bool IsStateSatisfied(uint32_t current, uint32_t required)
+		{
+			if (current == required)
+				return true;
+			return required != 0 && (current & required) == required && (current & WriteStates) == 0;
+		}
+	}
+
+	void SubresourceStates::Set(uint32_t subresource, uint32_t state)
+	{
+		if (IsUniform())
+		{
+			if (state == mState)
+				return;
+			if (mCount == 1)
+			{
+				mState = state;
+				return;
+			}
+			mPerSubresource.assign(mCount, mState);
+		}
+
+		mPerSubresource[subresource] = state;
+		for (uint32_t s : mPerSubresource)
+		{
+			if (s != state)
+				return;
+		}
+		mState = state;
+		mPerSubresource.clear();
+	}
+
+	void ResourceStateRegistry::Register(const void* resource, uint32_t subresourceCount, uint32_t initialState)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStates[resource] = SubresourceStates(subresourceCount, initialState);
+	}
+
+	void ResourceStateRegistry::Unregister(const void* resource)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStates.erase(resource);
+	}
+
+	bool ResourceStateRegistry::IsRegistered(const void* resource) const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mStates.find(resource) != mStates.end();
+	}
+
+	uint32_t ResourceStateRegistry::GetSubresourceCount(const void* resource) const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto it = mStates.find(resource);
+		if (it == mStates.end())
+			throw std::runtime_error("Resource is not registered in the state registry.");
+		return it->second.GetCount();
+	}
+
+	uint32_t ResourceStateRegistry::GetState(const void* resource, uint32_t subresource) const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto it = mStates.find(resource);
+		if (it == mStates.end())
+			throw std::runtime_error("Resource is not registered in the state registry.");
+		return it->second.Get(subresource);
+	}
+
+	ResourceStateTracker::TrackedResource& ResourceStateTracker::GetTracked(const void* resource)
+	{
+		auto it = mTracked.find(resource);
+		if (it != mTracked.end())
+			return it->second;
+
+		const uint32_t subresourceCount = mRegistry.GetSubresourceCount(resource);
+		TrackedResource& tracked = mTracked[resource];
+		tracked.Expected = SubresourceStates(subresourceCount, UnknownState);
+		tracked.Current = SubresourceStates(subresourceCount, UnknownState);
+		return tracked;
+	}
+
+	void ResourceStateTracker::Require(const void* resource, uint32_t state, uint32_t subresource)
+	{
+		TrackedResource& tracked = GetTracked(resource);
+		const uint32_t subresourceCount = tracked.Current.GetCount();
+		if (subresourceCount == 1)
+			subresource = AllSubresources;
+
+		if (subresource != AllSubresources)
+		{
+			RequireSubresource(resource, tracked, subresource, state);
+			return;
+		}
+
+		if (!tracked.Current.IsUniform())
+		{
+			for (uint32_t s = 0; s < subresourceCount; ++s)
+				RequireSubresource(resource, tracked, s, state);
+			return;
+		}
+
+		const uint32_t current = tracked.Current.Get(0);
+		if (current == UnknownState)
+		{
+			// First use in this list, the transition to it is only known at submit time.
+			tracked.Expected = SubresourceStates(subresourceCount, state);
+			tracked.Current = SubresourceStates(subresourceCount, state);
+		}
+		else if (!IsStateSatisfied(current, state))
+		{
+			QueueBarrier(tracked, { resource, AllSubresources, current, state });
+			tracked.Current = SubresourceStates(subresourceCount, state);
+		}
+	}
+
+	void ResourceStateTracker::RequireSubresource(const void* resource, TrackedResource& tracked, uint32_t subresource, uint32_t state)
+	{
+		const uint32_t current = tracked.Current.Get(subresource);
+		if (current == UnknownState)
+		{
+			tracked.Expected.Set(subresource, state);
+			tracked.Current.Set(subresource, state);
+		}
+		else if (!IsStateSatisfied(current, state))
+		{
+			QueueBarrier(tracked, { resource, subresource, current, state });
+			tracked.Current.Set(subresource, state);
+		}
+	}
+
+	void ResourceStateTracker::QueueBarrier(TrackedResource& tracked, const ResourceTransition& barrier)
+	{
+		tracked.Transitioned = true;
+		// Nothing can be recorded between two queued barriers, A -> B then B -> C is A -> C.
+		if (barrier.Subresource == AllSubresources && tracked.PendingBarrier != UINT32_MAX)
+		{
+			mPendingBarriers[tracked.PendingBarrier].StateAfter = barrier.StateAfter;
+			return;
+		}
+
+		tracked.PendingBarrier = barrier.Subresource == AllSubresources ? (uint32_t)mPendingBarriers.size() : UINT32_MAX;
+		mPendingBarriers.push_back(barrier);
+	}
+
+	void ResourceStateTracker::FlushBarriers(std::vector<ResourceTransition>& barriers)
+	{
+		for (const ResourceTransition& barrier : mPendingBarriers)
+		{
+			// Merged back to where it started.
+			if (barrier.StateBefore != barrier.StateAfter)
+				barriers.push_back(barrier);
+			mTracked[barrier.Resource].PendingBarrier = UINT32_MAX;
+		}
+		mPendingBarriers.clear();
+	}
+
+	void ResourceStateTracker::Resolve(std::vector<ResourceTransition>& barriers)
+	{
+		if (!mPendingBarriers.empty())
+			throw std::runtime_error("Resource barriers were required but never flushed.");
+
+		std::lock_guard<std::mutex> lock(mRegistry.mMutex);
+		for (const auto& entry : mTracked)
+		{
+			const void* resource = entry.first;
+			const TrackedResource& tracked = entry.second;
+
+			// Released since, nothing left to transition.
+			auto it = mRegistry.mStates.find(resource);
+			if (it == mRegistry.mStates.end())
+				continue;
+			SubresourceStates& known = it->second;
+
+			if (tracked.Expected.IsUniform() && tracked.Current.IsUniform() && known.IsUniform())
+			{
+				const uint32_t expected = tracked.Expected.Get(0);
+				// Only read in the list and the known state covers it: no barrier, and the resource stays in the known state.
+				if (expected != UnknownState && !tracked.Transitioned && IsStateSatisfied(known.Get(0), expected))
+					continue;
+				if (expected != UnknownState && expected != known.Get(0))
+					barriers.push_back({ resource, AllSubresources, known.Get(0), expected });
+				if (tracked.Current.Get(0) != UnknownState)
+					known = SubresourceStates(known.GetCount(), tracked.Current.Get(0));
+				continue;
+			}
+
+			for (uint32_t s = 0; s < known.GetCount(); ++s)
+			{
+				const uint32_t expected = tracked.Expected.Get(s);
+				if (expected != UnknownState && !tracked.Transitioned && IsStateSatisfied(known.Get(s), expected))
+					continue;
+				if (expected != UnknownState && expected != known.Get(s))
+					barriers.push_back({ resource, s, known.Get(s), expected });
+
+				const uint32_t current = tracked.Current.Get(s);
+				if (current != UnknownState)
+					known.Set(s, current);
+			}
+		}
+
+		Reset();
+	}
+
+	void ResourceStateTracker::Reset()
+	{
+		mTracked.clear();
+		mPendingBarriers.clear();
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Moon
+{
+	// Same value as D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES.
+	constexpr uint32_t AllSubresources = UINT32_MAX;
+
+	// Resources are opaque keys and states are plain bitmasks with the same values as D3D12_RESOURCE_STATES,
+	// like in RenderGraphCompiler, so the resolution logic does not depend on any graphics API.
+	struct ResourceTransition
+	{
+		const void* Resource = nullptr;
+		uint32_t Subresource = AllSubresources;
+		uint32_t StateBefore = 0;
+		uint32_t StateAfter = 0;
+	};
+
+	// State of every subresource of one resource. Stored as a single value while they all agree,
+	// which is the case for nearly every resource.
+	class SubresourceStates
+	{
+	public:
+		SubresourceStates() = default;
+		SubresourceStates(uint32_t subresourceCount, uint32_t state) : mCount(subresourceCount), mState(state) {}
+
+		uint32_t GetCount() const { return mCount; }
+		bool IsUniform() const { return mPerSubresource.empty(); }
+		uint32_t Get(uint32_t subresource) const { return IsUniform() ? mState : mPerSubresource[subresource]; }
+		void Set(uint32_t subresource, uint32_t state);
+
+	private:
+		uint32_t mCount = 1;
+		uint32_t mState = 0;
+		std::vector<uint32_t> mPerSubresource;
+	};
+
+	// Last known state of every resource, as left by the last command list submitted.
+	// Shared by every ResourceStateTracker, resources must be registered at creation and unregistered before release.
+	class ResourceStateRegistry
+	{
+	public:
+		void Register(const void* resource, uint32_t subresourceCount, uint32_t initialState);
+		void Unregister(const void* resource);
+
+		bool IsRegistered(const void* resource) const;
+		uint32_t GetSubresourceCount(const void* resource) const;
+		uint32_t GetState(const void* resource, uint32_t subresource = 0) const;
+
+	private:
+		friend class ResourceStateTracker;
+
+		mutable std::mutex mMutex;
+		std::unordered_map<const void*, SubresourceStates> mStates;
+	};
+
+	// Records the states a command list needs instead of explicit transitions.
+	// Transitions between two uses in the same list are known while recording, they are queued and handed out
+	// in one batch by FlushBarriers(). The state a resource must be in at its first use is only known once the
+	// lists submitted before are, Resolve() computes those transitions at submit time and publishes the final states.
+	class ResourceStateTracker
+	{
+	public:
+		ResourceStateTracker(ResourceStateRegistry& registry) : mRegistry(registry) {}
+		ResourceStateTracker(const ResourceStateTracker& rhs) = delete;
+		ResourceStateTracker& operator=(const ResourceStateTracker& rhs) = delete;
+
+		void Require(const void* resource, uint32_t state, uint32_t subresource = AllSubresources);
+
+		bool HasPendingBarriers() const { return !mPendingBarriers.empty(); }
+		// Barriers to record before the commands that follow the Require() calls. Empties the queue.
+		void FlushBarriers(std::vector<ResourceTransition>& barriers);
+
+		// Transitions to execute before the command list so its first uses find the states they expect.
+		// Must be called in submission order, the registry then holds the states the list leaves behind.
+		// Queued barriers must have been flushed, the tracker is reset for the next list.
+		void Resolve(std::vector<ResourceTransition>& barriers);
+
+		void Reset();
+
+	private:
+		static constexpr uint32_t UnknownState = UINT32_MAX;
+
+		struct TrackedResource
+		{
+			// State expected by the first use of each subresource, UnknownState until it is used.
+			SubresourceStates Expected;
+			SubresourceStates Current;
+			// Queued whole resource barrier that a new transition can be merged into.
+			uint32_t PendingBarrier = UINT32_MAX;
+			// A barrier was queued in this list. They start from the first use state, which Resolve() must then reach
+			// exactly even when the known state already covers it.
+			bool Transitioned = false;
+		};
+
+		TrackedResource& GetTracked(const void* resource);
+		void RequireSubresource(const void* resource, TrackedResource& tracked, uint32_t subresource, uint32_t state);
+		void QueueBarrier(TrackedResource& tracked, const ResourceTransition& barrier);
+
+		ResourceStateRegistry& mRegistry;
+		std::unordered_map<const void*, TrackedResource> mTracked;
+		std::vector<ResourceTransition> mPendingBarriers;
+	};
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+namespace Moon
+{
+	// Thin render hardware interface over device, queue, command list, buffers and descriptors.
+	// Only what the CPU side of a frame needs goes through it: culling, sorting, uploads and draw recording
+	// run unchanged against the D3D12 backend or the null one, which records in memory and needs no GPU.
+	// Resource states are plain bitmasks with the same values as D3D12_RESOURCE_STATES, like in RenderGraphCompiler.
+	namespace RhiState
+	{
+		constexpr uint32_t Common = 0;
+		constexpr uint32_t VertexAndConstantBuffer = 0x1;
+		constexpr uint32_t IndexBuffer = 0x2;
+		constexpr uint32_t RenderTarget = 0x4;
+		constexpr uint32_t UnorderedAccess = 0x8;
+		constexpr uint32_t DepthWrite = 0x10;
+		constexpr uint32_t DepthRead = 0x20;
+		constexpr uint32_t NonPixelShaderResource = 0x40;
+		constexpr uint32_t PixelShaderResource = 0x80;
+		constexpr uint32_t IndirectArgument = 0x200;
+		constexpr uint32_t CopyDest = 0x400;
+		constexpr uint32_t CopySource = 0x800;
+		constexpr uint32_t GenericRead = VertexAndConstantBuffer | IndexBuffer | NonPixelShaderResource | PixelShaderResource | IndirectArgument | CopySource;
+		constexpr uint32_t Present = 0;
+	}
+
+	enum class RhiBackend
+	{
+		D3D12,
+		Null,
+	};
+
+	enum class RhiHeapType
+	{
+		// GPU only.
+		Default,
+		// CPU writes, GPU reads. Stays mapped.
+		Upload,
+		// GPU writes, CPU reads.
+		Readback,
+	};
+
+	enum class RhiDescriptorHeapType
+	{
+		CbvSrvUav,
+		Sampler,
+		Rtv,
+		Dsv,
+	};
+
+	enum class RhiIndexFormat
+	{
+		Uint16,
+		Uint32,
+	};
+
+	struct RhiBufferDesc
+	{
+		uint64_t Size = 0;
+		RhiHeapType Heap = RhiHeapType::Default;
+		// Upload heaps must start in GenericRead and readback heaps in CopyDest, like in D3D12.
+		uint32_t InitialState = RhiState::Common;
+		const char* Name = nullptr;
+	};
+
+	struct RhiVertexBufferView
+	{
+		uint64_t Address = 0;
+		uint32_t Size = 0;
+		uint32_t Stride = 0;
+	};
+
+	struct RhiIndexBufferView
+	{
+		uint64_t Address = 0;
+		uint32_t Size = 0;
+		RhiIndexFormat Format = RhiIndexFormat::Uint32;
+	};
+
+	class RhiResource;
+
+	struct RhiBarrier
+	{
+		RhiResource* Resource = nullptr;
+		// Same value as D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES.
+		uint32_t Subresource = UINT32_MAX;
+		uint32_t StateBefore = RhiState::Common;
+		uint32_t StateAfter = RhiState::Common;
+	};
+
+	class RhiResource
+	{
+	public:
+		virtual ~RhiResource() = default;
+
+		// Upload and readback buffers only. The pointer stays valid until Unmap().
+		virtual void* Map() = 0;
+		virtual void Unmap() = 0;
+		virtual uint64_t GetGpuAddress() const = 0;
+		virtual uint64_t GetSize() const = 0;
+	};
+
+	class RhiDescriptorHeap
+	{
+	public:
+		virtual ~RhiDescriptorHeap() = default;
+
+		virtual RhiDescriptorHeapType GetType() const = 0;
+		virtual uint32_t GetCapacity() const = 0;
+		// Handles of descriptor index, 0 when the heap is not shader visible for the GPU one.
+		virtual uint64_t GetCpuHandle(uint32_t index) const = 0;
+		virtual uint64_t GetGpuHandle(uint32_t index) const = 0;
+	};
+
+	// Pipeline states and command signatures are still built by backend specific code (shaders, input layouts,
+	// root signatures), the command list only needs to bind them.
+	class RhiPipelineState
+	{
+	public:
+		virtual ~RhiPipelineState() = default;
+	};
+
+	class RhiCommandSignature
+	{
+	public:
+		virtual ~RhiCommandSignature() = default;
+		virtual uint32_t GetByteStride() const = 0;
+	};
+
+	class RhiCommandList
+	{
+	public:
+		virtual ~RhiCommandList() = default;
+
+		// Lists created by the device own their allocator and must be reset before recording.
+		virtual void Reset() = 0;
+		virtual void Close() = 0;
+
+		virtual void ResourceBarriers(const RhiBarrier* barriers, uint32_t count) = 0;
+		virtual void CopyBufferRegion(RhiResource* dst, uint64_t dstOffset, RhiResource* src, uint64_t srcOffset, uint64_t size) = 0;
+
+		virtual void SetPipelineState(RhiPipelineState* pipelineState) = 0;
+		virtual void SetVertexBuffer(const RhiVertexBufferView& view) = 0;
+		virtual void SetIndexBuffer(const RhiIndexBufferView& view) = 0;
+		virtual void SetGraphicsRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle) = 0;
+		virtual void SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t address) = 0;
+		virtual void SetGraphicsRoot32BitConstant(uint32_t rootIndex, uint32_t value, uint32_t offset) = 0;
+
+		virtual void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) = 0;
+		virtual void ExecuteIndirect(RhiCommandSignature* signature, uint32_t commandCount, RhiResource* arguments, uint64_t argumentOffset) = 0;
+	};
+
+	class RhiCommandQueue
+	{
+	public:
+		virtual ~RhiCommandQueue() = default;
+
+		// The list must be closed. Returns the fence value signaled once the GPU is done with it.
+		virtual uint64_t ExecuteCommandList(RhiCommandList* commandList) = 0;
+		virtual bool IsFenceComplete(uint64_t fenceValue) = 0;
+		virtual void WaitForFence(uint64_t fenceValue) = 0;
+		virtual void WaitForIdle() = 0;
+	};
+
+	class RhiDevice
+	{
+	public:
+		virtual ~RhiDevice() = default;
+
+		virtual RhiBackend GetBackend() const = 0;
+		virtual RhiCommandQueue* GetGraphicsQueue() = 0;
+
+		virtual std::unique_ptr<RhiResource> CreateBuffer(const RhiBufferDesc& desc) = 0;
+		virtual std::unique_ptr<RhiDescriptorHeap> CreateDescriptorHeap(RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible) = 0;
+		virtual std::unique_ptr<RhiCommandList> CreateCommandList() = 0;
+	};
+}
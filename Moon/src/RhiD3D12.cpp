@@ -0,0 +1,213 @@
+#include "mnpch.h"
+#include "RhiD3D12.h"
+
+namespace Moon
+{
+	namespace
+	{
+		D3D12_DESCRIPTOR_HEAP_TYPE ToD3D12(RhiDescriptorHeapType type)
+		{
+			switch (type)
+			{
+			case RhiDescriptorHeapType::CbvSrvUav: return D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+			case RhiDescriptorHeapType::Sampler: return D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+			case RhiDescriptorHeapType::Rtv: return D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+			case RhiDescriptorHeapType::Dsv: return D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+			}
+			return D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		}
+
+		D3D12_HEAP_TYPE ToD3D12(RhiHeapType type)
+		{
+			switch (type)
+			{
+			case RhiHeapType::Default: return D3D12_HEAP_TYPE_DEFAULT;
+			case RhiHeapType::Upload: return D3D12_HEAP_TYPE_UPLOAD;
+			case RhiHeapType::Readback: return D3D12_HEAP_TYPE_READBACK;
+			}
+			return D3D12_HEAP_TYPE_DEFAULT;
+		}
+	}
+
+	D3D12RhiResource::D3D12RhiResource(ID3D12Resource* resource)
+		: mResource(resource)
+		, mSize(resource->GetDesc().Width)
+	{
+	}
+
+	D3D12RhiResource::~D3D12RhiResource()
+	{
+		Unmap();
+	}
+
+	void* D3D12RhiResource::Map()
+	{
+		if (!mMappedData)
+			DX_CHECK(mResource->Map(0, nullptr, &mMappedData));
+		return mMappedData;
+	}
+
+	void D3D12RhiResource::Unmap()
+	{
+		if (mMappedData)
+		{
+			mResource->Unmap(0, nullptr);
+			mMappedData = nullptr;
+		}
+	}
+
+	D3D12RhiDescriptorHeap::D3D12RhiDescriptorHeap(ID3D12Device* device, RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible)
+		: mType(type)
+		, mCapacity(capacity)
+		, mShaderVisible(shaderVisible)
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+		heapDesc.Type = ToD3D12(type);
+		heapDesc.NumDescriptors = capacity;
+		heapDesc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		DX_CHECK(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+		mDescriptorSize = device->GetDescriptorHandleIncrementSize(heapDesc.Type);
+	}
+
+	uint64_t D3D12RhiDescriptorHeap::GetCpuHandle(uint32_t index) const
+	{
+		return mHeap->GetCPUDescriptorHandleForHeapStart().ptr + (uint64_t)index * mDescriptorSize;
+	}
+
+	uint64_t D3D12RhiDescriptorHeap::GetGpuHandle(uint32_t index) const
+	{
+		return mShaderVisible ? mHeap->GetGPUDescriptorHandleForHeapStart().ptr + (uint64_t)index * mDescriptorSize : 0;
+	}
+
+	D3D12RhiCommandList::D3D12RhiCommandList(ID3D12Device* device)
+	{
+		DX_CHECK(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mAllocator)));
+		DX_CHECK(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mAllocator.Get(), nullptr, IID_PPV_ARGS(&mCommandList)));
+		DX_CHECK(mCommandList->Close());
+	}
+
+	D3D12RhiCommandList::D3D12RhiCommandList(ID3D12GraphicsCommandList* commandList)
+		: mCommandList(commandList)
+	{
+	}
+
+	void D3D12RhiCommandList::Reset()
+	{
+		if (!mAllocator)
+			throw std::runtime_error("This command list is reset by its owner");
+
+		DX_CHECK(mAllocator->Reset());
+		DX_CHECK(mCommandList->Reset(mAllocator.Get(), nullptr));
+	}
+
+	void D3D12RhiCommandList::Close()
+	{
+		DX_CHECK(mCommandList->Close());
+	}
+
+	void D3D12RhiCommandList::ResourceBarriers(const RhiBarrier* barriers, uint32_t count)
+	{
+		mBarriers.clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(static_cast<D3D12RhiResource*>(barriers[i].Resource)->GetNative(),
+				(D3D12_RESOURCE_STATES)barriers[i].StateBefore, (D3D12_RESOURCE_STATES)barriers[i].StateAfter, barriers[i].Subresource));
+		}
+		if (!mBarriers.empty())
+			mCommandList->ResourceBarrier((UINT)mBarriers.size(), mBarriers.data());
+	}
+
+	void D3D12RhiCommandList::CopyBufferRegion(RhiResource* dst, uint64_t dstOffset, RhiResource* src, uint64_t srcOffset, uint64_t size)
+	{
+		mCommandList->CopyBufferRegion(static_cast<D3D12RhiResource*>(dst)->GetNative(), dstOffset,
+			static_cast<D3D12RhiResource*>(src)->GetNative(), srcOffset, size);
+	}
+
+	void D3D12RhiCommandList::SetPipelineState(RhiPipelineState* pipelineState)
+	{
+		mCommandList->SetPipelineState(static_cast<D3D12RhiPipelineState*>(pipelineState)->GetNative());
+	}
+
+	void D3D12RhiCommandList::SetVertexBuffer(const RhiVertexBufferView& view)
+	{
+		D3D12_VERTEX_BUFFER_VIEW vbv;
+		vbv.BufferLocation = view.Address;
+		vbv.SizeInBytes = view.Size;
+		vbv.StrideInBytes = view.Stride;
+		mCommandList->IASetVertexBuffers(0, 1, &vbv);
+	}
+
+	void D3D12RhiCommandList::SetIndexBuffer(const RhiIndexBufferView& view)
+	{
+		D3D12_INDEX_BUFFER_VIEW ibv;
+		ibv.BufferLocation = view.Address;
+		ibv.SizeInBytes = view.Size;
+		ibv.Format = view.Format == RhiIndexFormat::Uint16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		mCommandList->IASetIndexBuffer(&ibv);
+	}
+
+	void D3D12RhiCommandList::SetGraphicsRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle)
+	{
+		D3D12_GPU_DESCRIPTOR_HANDLE handle;
+		handle.ptr = gpuHandle;
+		mCommandList->SetGraphicsRootDescriptorTable(rootIndex, handle);
+	}
+
+	void D3D12RhiCommandList::SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t address)
+	{
+		mCommandList->SetGraphicsRootConstantBufferView(rootIndex, address);
+	}
+
+	void D3D12RhiCommandList::SetGraphicsRoot32BitConstant(uint32_t rootIndex, uint32_t value, uint32_t offset)
+	{
+		mCommandList->SetGraphicsRoot32BitConstant(rootIndex, value, offset);
+	}
+
+	void D3D12RhiCommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+	{
+		mCommandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+	}
+
+	void D3D12RhiCommandList::ExecuteIndirect(RhiCommandSignature* signature, uint32_t commandCount, RhiResource* arguments, uint64_t argumentOffset)
+	{
+		mCommandList->ExecuteIndirect(static_cast<D3D12RhiCommandSignature*>(signature)->GetNative(), commandCount,
+			static_cast<D3D12RhiResource*>(arguments)->GetNative(), argumentOffset, nullptr, 0);
+	}
+
+	uint64_t D3D12RhiCommandQueue::ExecuteCommandList(RhiCommandList* commandList)
+	{
+		return mQueue->ExecuteCommandList(static_cast<D3D12RhiCommandList*>(commandList)->GetNative());
+	}
+
+	D3D12RhiDevice::D3D12RhiDevice(ID3D12Device* device, CommandQueue* graphicsQueue)
+		: mDevice(device)
+		, mGraphicsQueue(graphicsQueue)
+	{
+	}
+
+	std::unique_ptr<RhiResource> D3D12RhiDevice::CreateBuffer(const RhiBufferDesc& desc)
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+		DX_CHECK(mDevice->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(ToD3D12(desc.Heap)),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(desc.Size),
+			(D3D12_RESOURCE_STATES)desc.InitialState,
+			nullptr,
+			IID_PPV_ARGS(&buffer)));
+		if (desc.Name)
+			buffer->SetName(AnsiToWString(desc.Name).c_str());
+
+		return std::make_unique<D3D12RhiResource>(buffer.Get());
+	}
+
+	std::unique_ptr<RhiDescriptorHeap> D3D12RhiDevice::CreateDescriptorHeap(RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible)
+	{
+		return std::make_unique<D3D12RhiDescriptorHeap>(mDevice, type, capacity, shaderVisible);
+	}
+
+	std::unique_ptr<RhiCommandList> D3D12RhiDevice::CreateCommandList()
+	{
+		return std::make_unique<D3D12RhiCommandList>(mDevice);
+	}
+}
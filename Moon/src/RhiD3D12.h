@@ -0,0 +1,136 @@
+#pragma once
+#include "Rhi.h"
+#include "dx_utils.h"
+#include "CommandQueue.h"
+
+namespace Moon
+{
+	class D3D12RhiResource : public RhiResource
+	{
+	public:
+		// Takes a reference on resource.
+		D3D12RhiResource(ID3D12Resource* resource);
+		~D3D12RhiResource();
+
+		void* Map() override;
+		void Unmap() override;
+		uint64_t GetGpuAddress() const override { return mResource->GetGPUVirtualAddress(); }
+		uint64_t GetSize() const override { return mSize; }
+
+		ID3D12Resource* GetNative() const { return mResource.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Resource> mResource;
+		uint64_t mSize = 0;
+		void* mMappedData = nullptr;
+	};
+
+	class D3D12RhiDescriptorHeap : public RhiDescriptorHeap
+	{
+	public:
+		D3D12RhiDescriptorHeap(ID3D12Device* device, RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible);
+
+		RhiDescriptorHeapType GetType() const override { return mType; }
+		uint32_t GetCapacity() const override { return mCapacity; }
+		uint64_t GetCpuHandle(uint32_t index) const override;
+		uint64_t GetGpuHandle(uint32_t index) const override;
+
+		ID3D12DescriptorHeap* GetNative() const { return mHeap.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
+		RhiDescriptorHeapType mType;
+		uint32_t mCapacity;
+		uint32_t mDescriptorSize;
+		bool mShaderVisible;
+	};
+
+	class D3D12RhiPipelineState : public RhiPipelineState
+	{
+	public:
+		D3D12RhiPipelineState(ID3D12PipelineState* pipelineState) : mPipelineState(pipelineState) {}
+		ID3D12PipelineState* GetNative() const { return mPipelineState.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> mPipelineState;
+	};
+
+	class D3D12RhiCommandSignature : public RhiCommandSignature
+	{
+	public:
+		D3D12RhiCommandSignature(ID3D12CommandSignature* signature, uint32_t byteStride) : mSignature(signature), mByteStride(byteStride) {}
+		uint32_t GetByteStride() const override { return mByteStride; }
+		ID3D12CommandSignature* GetNative() const { return mSignature.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12CommandSignature> mSignature;
+		uint32_t mByteStride;
+	};
+
+	class D3D12RhiCommandList : public RhiCommandList
+	{
+	public:
+		// Owns its allocator, created closed.
+		D3D12RhiCommandList(ID3D12Device* device);
+		// Records into a list reset by its owner, Reset() is not available.
+		D3D12RhiCommandList(ID3D12GraphicsCommandList* commandList);
+
+		// The GPU must be done with the previous recording, the allocator is reset too.
+		void Reset() override;
+		void Close() override;
+
+		void ResourceBarriers(const RhiBarrier* barriers, uint32_t count) override;
+		void CopyBufferRegion(RhiResource* dst, uint64_t dstOffset, RhiResource* src, uint64_t srcOffset, uint64_t size) override;
+
+		void SetPipelineState(RhiPipelineState* pipelineState) override;
+		void SetVertexBuffer(const RhiVertexBufferView& view) override;
+		void SetIndexBuffer(const RhiIndexBufferView& view) override;
+		void SetGraphicsRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle) override;
+		void SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t address) override;
+		void SetGraphicsRoot32BitConstant(uint32_t rootIndex, uint32_t value, uint32_t offset) override;
+
+		void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override;
+		void ExecuteIndirect(RhiCommandSignature* signature, uint32_t commandCount, RhiResource* arguments, uint64_t argumentOffset) override;
+
+		ID3D12GraphicsCommandList* GetNative() const { return mCommandList.Get(); }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mAllocator;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCommandList;
+		std::vector<D3D12_RESOURCE_BARRIER> mBarriers;
+	};
+
+	class D3D12RhiCommandQueue : public RhiCommandQueue
+	{
+	public:
+		D3D12RhiCommandQueue(CommandQueue* queue) : mQueue(queue) {}
+
+		uint64_t ExecuteCommandList(RhiCommandList* commandList) override;
+		bool IsFenceComplete(uint64_t fenceValue) override { return mQueue->IsFenceComplete(fenceValue); }
+		void WaitForFence(uint64_t fenceValue) override { mQueue->WaitForFenceCPUBlocking(fenceValue); }
+		void WaitForIdle() override { mQueue->WaitForIdle(); }
+
+	private:
+		CommandQueue* mQueue;
+	};
+
+	// Sits on top of the application's device and queues, it does not own them.
+	class D3D12RhiDevice : public RhiDevice
+	{
+	public:
+		D3D12RhiDevice(ID3D12Device* device, CommandQueue* graphicsQueue);
+
+		RhiBackend GetBackend() const override { return RhiBackend::D3D12; }
+		RhiCommandQueue* GetGraphicsQueue() override { return &mGraphicsQueue; }
+
+		std::unique_ptr<RhiResource> CreateBuffer(const RhiBufferDesc& desc) override;
+		std::unique_ptr<RhiDescriptorHeap> CreateDescriptorHeap(RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible) override;
+		std::unique_ptr<RhiCommandList> CreateCommandList() override;
+
+		ID3D12Device* GetNative() const { return mDevice; }
+
+	private:
+		ID3D12Device* mDevice;
+		D3D12RhiCommandQueue mGraphicsQueue;
+	};
+}
@@ -0,0 +1,170 @@
+#include "mnpch.h"
+#include "RhiNull.h"
+
+namespace Moon
+{
+	namespace
+	{
+		// Same placement alignment as a D3D12 buffer.
+		constexpr uint64_t BufferAlignment = 64 * 1024;
+		// Mapped data is read and written with aligned SIMD loads/stores, keep the host copy aligned like a constant buffer.
+		constexpr uint64_t MappedAlignment = 256;
+		constexpr uint64_t DescriptorSize = 32;
+
+		uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	NullRhiResource::NullRhiResource(const RhiBufferDesc& desc, uint64_t gpuAddress)
+		: mDesc(desc)
+		, mGpuAddress(gpuAddress)
+	{
+		if (desc.Heap != RhiHeapType::Default)
+		{
+			mStorage.resize(desc.Size + MappedAlignment);
+			mData = mStorage.data() + (AlignUp((uint64_t)(uintptr_t)mStorage.data(), MappedAlignment) - (uint64_t)(uintptr_t)mStorage.data());
+		}
+	}
+
+	void* NullRhiResource::Map()
+	{
+		if (!mData)
+			throw std::runtime_error("Only upload and readback buffers can be mapped");
+		return mData;
+	}
+
+	NullRhiDescriptorHeap::NullRhiDescriptorHeap(RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible, uint64_t baseHandle)
+		: mType(type)
+		, mCapacity(capacity)
+		, mShaderVisible(shaderVisible)
+		, mBaseHandle(baseHandle)
+	{
+	}
+
+	uint64_t NullRhiDescriptorHeap::GetCpuHandle(uint32_t index) const
+	{
+		return mBaseHandle + index * DescriptorSize;
+	}
+
+	uint64_t NullRhiDescriptorHeap::GetGpuHandle(uint32_t index) const
+	{
+		return mShaderVisible ? mBaseHandle + index * DescriptorSize : 0;
+	}
+
+	void NullRhiCommandList::Reset()
+	{
+		mCommands.clear();
+		mDrawCount = 0;
+		mBarrierCount = 0;
+		mClosed = false;
+	}
+
+	void NullRhiCommandList::Record(NullRhiCommandType type, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3, uint64_t a4)
+	{
+		if (mClosed)
+			throw std::runtime_error("Recording into a closed command list");
+		mCommands.push_back({ type, { a0, a1, a2, a3, a4 } });
+	}
+
+	void NullRhiCommandList::ResourceBarriers(const RhiBarrier* barriers, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			Record(NullRhiCommandType::ResourceBarrier, (uint64_t)(uintptr_t)barriers[i].Resource, barriers[i].Subresource,
+				barriers[i].StateBefore, barriers[i].StateAfter);
+		}
+		mBarrierCount += count;
+	}
+
+	void NullRhiCommandList::CopyBufferRegion(RhiResource* dst, uint64_t dstOffset, RhiResource* src, uint64_t srcOffset, uint64_t size)
+	{
+		Record(NullRhiCommandType::CopyBufferRegion, (uint64_t)(uintptr_t)dst, dstOffset, (uint64_t)(uintptr_t)src, srcOffset, size);
+	}
+
+	void NullRhiCommandList::SetPipelineState(RhiPipelineState* pipelineState)
+	{
+		Record(NullRhiCommandType::SetPipelineState, (uint64_t)(uintptr_t)pipelineState);
+	}
+
+	void NullRhiCommandList::SetVertexBuffer(const RhiVertexBufferView& view)
+	{
+		Record(NullRhiCommandType::SetVertexBuffer, view.Address, view.Size, view.Stride);
+	}
+
+	void NullRhiCommandList::SetIndexBuffer(const RhiIndexBufferView& view)
+	{
+		Record(NullRhiCommandType::SetIndexBuffer, view.Address, view.Size, (uint64_t)view.Format);
+	}
+
+	void NullRhiCommandList::SetGraphicsRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle)
+	{
+		Record(NullRhiCommandType::SetGraphicsRootDescriptorTable, rootIndex, gpuHandle);
+	}
+
+	void NullRhiCommandList::SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t address)
+	{
+		Record(NullRhiCommandType::SetGraphicsRootConstantBufferView, rootIndex, address);
+	}
+
+	void NullRhiCommandList::SetGraphicsRoot32BitConstant(uint32_t rootIndex, uint32_t value, uint32_t offset)
+	{
+		Record(NullRhiCommandType::SetGraphicsRoot32BitConstant, rootIndex, value, offset);
+	}
+
+	void NullRhiCommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+	{
+		Record(NullRhiCommandType::DrawIndexedInstanced, indexCount, instanceCount, startIndex, (uint64_t)(int64_t)baseVertex, startInstance);
+		mDrawCount++;
+	}
+
+	void NullRhiCommandList::ExecuteIndirect(RhiCommandSignature* signature, uint32_t commandCount, RhiResource* arguments, uint64_t argumentOffset)
+	{
+		if (argumentOffset + (uint64_t)commandCount * signature->GetByteStride() > arguments->GetSize())
+			throw std::runtime_error("ExecuteIndirect reads past the end of its argument buffer");
+
+		Record(NullRhiCommandType::ExecuteIndirect, (uint64_t)(uintptr_t)signature, commandCount, (uint64_t)(uintptr_t)arguments, argumentOffset);
+		mDrawCount += commandCount;
+	}
+
+	uint64_t NullRhiCommandQueue::ExecuteCommandList(RhiCommandList* commandList)
+	{
+		NullRhiCommandList* list = static_cast<NullRhiCommandList*>(commandList);
+		if (!list->IsClosed())
+			throw std::runtime_error("Executing a command list that was not closed");
+
+		mStats.CommandListsExecuted++;
+		mStats.Commands += list->GetCommands().size();
+		mStats.Draws += list->GetDrawCount();
+		mStats.Barriers += list->GetBarrierCount();
+		return ++mLastFenceValue;
+	}
+
+	std::unique_ptr<RhiResource> NullRhiDevice::CreateBuffer(const RhiBufferDesc& desc)
+	{
+		const uint64_t gpuAddress = mNextGpuAddress.fetch_add(AlignUp(std::max<uint64_t>(desc.Size, 1), BufferAlignment));
+		return std::make_unique<NullRhiResource>(desc, gpuAddress);
+	}
+
+	std::unique_ptr<RhiDescriptorHeap> NullRhiDevice::CreateDescriptorHeap(RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible)
+	{
+		const uint64_t baseHandle = mNextDescriptorHandle.fetch_add(AlignUp((uint64_t)capacity * DescriptorSize + 1, BufferAlignment));
+		return std::make_unique<NullRhiDescriptorHeap>(type, capacity, shaderVisible, baseHandle);
+	}
+
+	std::unique_ptr<RhiCommandList> NullRhiDevice::CreateCommandList()
+	{
+		return std::make_unique<NullRhiCommandList>();
+	}
+
+	std::unique_ptr<RhiPipelineState> NullRhiDevice::CreatePipelineState()
+	{
+		return std::make_unique<NullRhiPipelineState>();
+	}
+
+	std::unique_ptr<RhiCommandSignature> NullRhiDevice::CreateCommandSignature(uint32_t byteStride)
+	{
+		return std::make_unique<NullRhiCommandSignature>(byteStride);
+	}
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "Rhi.h"
+
+#include <atomic>
+#include <vector>
+
+namespace Moon
+{
+	enum class NullRhiCommandType : uint8_t
+	{
+		ResourceBarrier,
+		CopyBufferRegion,
+		SetPipelineState,
+		SetVertexBuffer,
+		SetIndexBuffer,
+		SetGraphicsRootDescriptorTable,
+		SetGraphicsRootConstantBufferView,
+		SetGraphicsRoot32BitConstant,
+		DrawIndexedInstanced,
+		ExecuteIndirect,
+		Count
+	};
+
+	// One recorded call, its arguments in call order. Resources and pipeline states are stored as their address.
+	struct NullRhiCommand
+	{
+		NullRhiCommandType Type;
+		uint64_t Args[5];
+	};
+
+	struct NullRhiStats
+	{
+		uint64_t CommandListsExecuted = 0;
+		uint64_t Commands = 0;
+		// DrawIndexedInstanced calls plus the commands of every ExecuteIndirect.
+		uint64_t Draws = 0;
+		uint64_t Barriers = 0;
+	};
+
+	// Upload and readback buffers get host memory so mapped writes can be checked, default buffers only get an address.
+	class NullRhiResource : public RhiResource
+	{
+	public:
+		NullRhiResource(const RhiBufferDesc& desc, uint64_t gpuAddress);
+
+		void* Map() override;
+		void Unmap() override {}
+		uint64_t GetGpuAddress() const override { return mGpuAddress; }
+		uint64_t GetSize() const override { return mDesc.Size; }
+
+	private:
+		RhiBufferDesc mDesc;
+		uint64_t mGpuAddress;
+		std::vector<uint8_t> mStorage;
+		uint8_t* mData = nullptr;
+	};
+
+	class NullRhiDescriptorHeap : public RhiDescriptorHeap
+	{
+	public:
+		NullRhiDescriptorHeap(RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible, uint64_t baseHandle);
+
+		RhiDescriptorHeapType GetType() const override { return mType; }
+		uint32_t GetCapacity() const override { return mCapacity; }
+		uint64_t GetCpuHandle(uint32_t index) const override;
+		uint64_t GetGpuHandle(uint32_t index) const override;
+
+	private:
+		RhiDescriptorHeapType mType;
+		uint32_t mCapacity;
+		bool mShaderVisible;
+		uint64_t mBaseHandle;
+	};
+
+	class NullRhiPipelineState : public RhiPipelineState
+	{
+	};
+
+	class NullRhiCommandSignature : public RhiCommandSignature
+	{
+	public:
+		NullRhiCommandSignature(uint32_t byteStride) : mByteStride(byteStride) {}
+		uint32_t GetByteStride() const override { return mByteStride; }
+
+	private:
+		uint32_t mByteStride;
+	};
+
+	class NullRhiCommandList : public RhiCommandList
+	{
+	public:
+		void Reset() override;
+		void Close() override { mClosed = true; }
+
+		void ResourceBarriers(const RhiBarrier* barriers, uint32_t count) override;
+		void CopyBufferRegion(RhiResource* dst, uint64_t dstOffset, RhiResource* src, uint64_t srcOffset, uint64_t size) override;
+
+		void SetPipelineState(RhiPipelineState* pipelineState) override;
+		void SetVertexBuffer(const RhiVertexBufferView& view) override;
+		void SetIndexBuffer(const RhiIndexBufferView& view) override;
+		void SetGraphicsRootDescriptorTable(uint32_t rootIndex, uint64_t gpuHandle) override;
+		void SetGraphicsRootConstantBufferView(uint32_t rootIndex, uint64_t address) override;
+		void SetGraphicsRoot32BitConstant(uint32_t rootIndex, uint32_t value, uint32_t offset) override;
+
+		void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance) override;
+		void ExecuteIndirect(RhiCommandSignature* signature, uint32_t commandCount, RhiResource* arguments, uint64_t argumentOffset) override;
+
+		bool IsClosed() const { return mClosed; }
+		const std::vector<NullRhiCommand>& GetCommands() const { return mCommands; }
+		uint64_t GetDrawCount() const { return mDrawCount; }
+		uint64_t GetBarrierCount() const { return mBarrierCount; }
+
+	private:
+		void Record(NullRhiCommandType type, uint64_t a0 = 0, uint64_t a1 = 0, uint64_t a2 = 0, uint64_t a3 = 0, uint64_t a4 = 0);
+
+		// Kept between resets, a steady-state frame does not allocate.
+		std::vector<NullRhiCommand> mCommands;
+		uint64_t mDrawCount = 0;
+		uint64_t mBarrierCount = 0;
+		bool mClosed = false;
+	};
+
+	// Command lists complete as soon as they are submitted.
+	class NullRhiCommandQueue : public RhiCommandQueue
+	{
+	public:
+		uint64_t ExecuteCommandList(RhiCommandList* commandList) override;
+		bool IsFenceComplete(uint64_t fenceValue) override { return fenceValue <= mLastFenceValue; }
+		void WaitForFence(uint64_t /*fenceValue*/) override {}
+		void WaitForIdle() override {}
+
+		const NullRhiStats& GetStats() const { return mStats; }
+		void ResetStats() { mStats = NullRhiStats(); }
+
+	private:
+		uint64_t mLastFenceValue = 0;
+		NullRhiStats mStats;
+	};
+
+	class NullRhiDevice : public RhiDevice
+	{
+	public:
+		RhiBackend GetBackend() const override { return RhiBackend::Null; }
+		RhiCommandQueue* GetGraphicsQueue() override { return &mGraphicsQueue; }
+
+		std::unique_ptr<RhiResource> CreateBuffer(const RhiBufferDesc& desc) override;
+		std::unique_ptr<RhiDescriptorHeap> CreateDescriptorHeap(RhiDescriptorHeapType type, uint32_t capacity, bool shaderVisible) override;
+		std::unique_ptr<RhiCommandList> CreateCommandList() override;
+
+		std::unique_ptr<RhiPipelineState> CreatePipelineState();
+		std::unique_ptr<RhiCommandSignature> CreateCommandSignature(uint32_t byteStride);
+
+		NullRhiCommandQueue& GetNullGraphicsQueue() { return mGraphicsQueue; }
+		const NullRhiCommandQueue& GetNullGraphicsQueue() const { return mGraphicsQueue; }
+
+	private:
+		NullRhiCommandQueue mGraphicsQueue;
+		// Fake addresses, never 0 so they still read as valid ones.
+		std::atomic<uint64_t> mNextGpuAddress{ 1ull << 32 };
+		std::atomic<uint64_t> mNextDescriptorHandle{ 1ull << 32 };
+	};
+}
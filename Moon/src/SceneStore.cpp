@@ -0,0 +1,145 @@
+#include "mnpch.h"
+#include "SceneStore.h"
+
+using namespace DirectX;
+
+namespace Moon
+{
+	namespace
+	{
+		template<typename T>
+		void SwapRemove(std::vector<T>& v, uint32_t index)
+		{
+			if (index != v.size() - 1)
+				v[index] = std::move(v.back());
+			v.pop_back();
+		}
+	}
+
+	SceneStore::SceneStore(uint8_t framesInFlight)
+		: mFramesInFlight(framesInFlight)
+	{
+	}
+
+	void SceneStore::Reserve(uint32_t count)
+	{
+		mWorlds.reserve(count);
+		mTexTransforms.reserve(count);
+		mWorldBounds.reserve(count);
+		mNumFramesDirty.reserve(count);
+		mMaterialIds.reserve(count);
+		mGeometryIds.reserve(count);
+		mIndexCounts.reserve(count);
+		mStartIndexLocations.reserve(count);
+		mBaseVertexLocations.reserve(count);
+		mLocalBounds.reserve(count);
+		mNames.reserve(count);
+		mDenseToSlot.reserve(count);
+	}
+
+	SceneHandle SceneStore::Create(const SceneObjectDesc& desc)
+	{
+		uint32_t slot;
+		if (!mFreeSlots.empty())
+		{
+			slot = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		}
+		else
+		{
+			slot = (uint32_t)mSlots.size();
+			mSlots.emplace_back();
+		}
+
+		const uint32_t index = Size();
+		mSlots[slot].DenseIndex = index;
+
+		mWorlds.push_back(desc.World);
+		mTexTransforms.push_back(desc.TexTransform);
+		mWorldBounds.emplace_back();
+		mNumFramesDirty.push_back(mFramesInFlight);
+		mMaterialIds.push_back(desc.MaterialId);
+		mGeometryIds.push_back(desc.GeometryId);
+		mIndexCounts.push_back(desc.IndexCount);
+		mStartIndexLocations.push_back(desc.StartIndexLocation);
+		mBaseVertexLocations.push_back(desc.BaseVertexLocation);
+		mLocalBounds.push_back(desc.LocalBounds);
+		mNames.push_back(desc.Name);
+		mDenseToSlot.push_back(slot);
+
+		UpdateWorldBounds(index);
+
+		return { slot, mSlots[slot].Generation };
+	}
+
+	void SceneStore::Destroy(SceneHandle handle)
+	{
+		if (!IsValid(handle))
+			return;
+
+		const uint32_t index = mSlots[handle.Slot].DenseIndex;
+		const uint32_t last = Size() - 1;
+
+		SwapRemove(mWorlds, index);
+		SwapRemove(mTexTransforms, index);
+		SwapRemove(mWorldBounds, index);
+		SwapRemove(mNumFramesDirty, index);
+		SwapRemove(mMaterialIds, index);
+		SwapRemove(mGeometryIds, index);
+		SwapRemove(mIndexCounts, index);
+		SwapRemove(mStartIndexLocations, index);
+		SwapRemove(mBaseVertexLocations, index);
+		SwapRemove(mLocalBounds, index);
+		SwapRemove(mNames, index);
+		SwapRemove(mDenseToSlot, index);
+
+		if (index != last)
+		{
+			// The moved object now lives in another constant buffer slot, every frame resource needs a fresh copy.
+			mSlots[mDenseToSlot[index]].DenseIndex = index;
+			MarkDirty(index);
+		}
+
+		Slot& slot = mSlots[handle.Slot];
+		slot.DenseIndex = UINT32_MAX;
+		slot.Generation++;
+		mFreeSlots.push_back(handle.Slot);
+	}
+
+	bool SceneStore::IsValid(SceneHandle handle) const
+	{
+		return handle.Slot < mSlots.size()
+			&& mSlots[handle.Slot].Generation == handle.Generation
+			&& mSlots[handle.Slot].DenseIndex != UINT32_MAX;
+	}
+
+	uint32_t SceneStore::GetDenseIndex(SceneHandle handle) const
+	{
+		assert(IsValid(handle));
+		return mSlots[handle.Slot].DenseIndex;
+	}
+
+	void SceneStore::SetWorld(SceneHandle handle, const XMFLOAT4X4& world)
+	{
+		SetWorld(GetDenseIndex(handle), world);
+	}
+
+	void SceneStore::SetWorld(uint32_t index, const XMFLOAT4X4& world)
+	{
+		mWorlds[index] = world;
+		UpdateWorldBounds(index);
+		MarkDirty(index);
+	}
+
+	void SceneStore::SetTexTransform(SceneHandle handle, const XMFLOAT4X4& texTransform)
+	{
+		const uint32_t index = GetDenseIndex(handle);
+		mTexTransforms[index] = texTransform;
+		MarkDirty(index);
+	}
+
+	void SceneStore::UpdateWorldBounds(uint32_t index)
+	{
+		mLocalBounds[index].Transform(mWorldBounds[index], XMLoadFloat4x4(&mWorlds[index]));
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Math.h"
+#include <DirectXCollision.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	// Stays valid while the object lives, even when Destroy() moves other objects around in the dense arrays.
+	struct SceneHandle
+	{
+		uint32_t Slot = UINT32_MAX;
+		uint32_t Generation = 0;
+	};
+
+	struct SceneObjectDesc
+	{
+		std::string Name;
+		DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+		DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+		DirectX::BoundingBox LocalBounds;
+
+		uint32_t MaterialId = 0;
+		uint32_t GeometryId = 0;
+		uint32_t IndexCount = 0;
+		uint32_t StartIndexLocation = 0;
+		int32_t BaseVertexLocation = 0;
+	};
+
+	// Structure of arrays storage for every drawable object of the scene.
+	// Dense index i refers to the same object in every array, and is also its slot in the object constant buffer.
+	class SceneStore
+	{
+	public:
+		SceneStore(uint8_t framesInFlight);
+
+		SceneHandle Create(const SceneObjectDesc& desc);
+		void Destroy(SceneHandle handle);
+		void Reserve(uint32_t count);
+
+		bool IsValid(SceneHandle handle) const;
+		uint32_t GetDenseIndex(SceneHandle handle) const;
+		uint32_t Size() const { return (uint32_t)mWorlds.size(); }
+
+		void SetWorld(SceneHandle handle, const DirectX::XMFLOAT4X4& world);
+		void SetWorld(uint32_t index, const DirectX::XMFLOAT4X4& world);
+		void SetTexTransform(SceneHandle handle, const DirectX::XMFLOAT4X4& texTransform);
+		void MarkDirty(uint32_t index) { mNumFramesDirty[index] = mFramesInFlight; }
+
+		const DirectX::XMFLOAT4X4* GetWorlds() const { return mWorlds.data(); }
+		const DirectX::XMFLOAT4X4* GetTexTransforms() const { return mTexTransforms.data(); }
+		const DirectX::BoundingBox* GetWorldBounds() const { return mWorldBounds.data(); }
+		uint8_t* GetNumFramesDirty() { return mNumFramesDirty.data(); }
+		const uint32_t* GetMaterialIds() const { return mMaterialIds.data(); }
+		const uint32_t* GetGeometryIds() const { return mGeometryIds.data(); }
+		const uint32_t* GetIndexCounts() const { return mIndexCounts.data(); }
+		const uint32_t* GetStartIndexLocations() const { return mStartIndexLocations.data(); }
+		const int32_t* GetBaseVertexLocations() const { return mBaseVertexLocations.data(); }
+		const std::string& GetName(uint32_t index) const { return mNames[index]; }
+
+	private:
+		struct Slot
+		{
+			uint32_t DenseIndex = UINT32_MAX;
+			uint32_t Generation = 0;
+		};
+
+		void UpdateWorldBounds(uint32_t index);
+
+		uint8_t mFramesInFlight;
+
+		// Hot data, walked every frame.
+		std::vector<DirectX::XMFLOAT4X4> mWorlds;
+		std::vector<DirectX::XMFLOAT4X4> mTexTransforms;
+		std::vector<DirectX::BoundingBox> mWorldBounds;
+		std::vector<uint8_t> mNumFramesDirty;
+		std::vector<uint32_t> mMaterialIds;
+		std::vector<uint32_t> mGeometryIds;
+		std::vector<uint32_t> mIndexCounts;
+		std::vector<uint32_t> mStartIndexLocations;
+		std::vector<int32_t> mBaseVertexLocations;
+
+		// Cold data, only touched on create/destroy or for debug markers.
+		std::vector<DirectX::BoundingBox> mLocalBounds;
+		std::vector<std::string> mNames;
+		std::vector<uint32_t> mDenseToSlot;
+		std::vector<Slot> mSlots;
+		std::vector<uint32_t> mFreeSlots;
+	};
+}
@@ -0,0 +1,94 @@
+#include "mnpch.h"
+#include "StartupProfiler.h"
+#include "Utils.h"
+
+#include <iomanip>
+
+namespace Moon
+{
+	void StartupProfiler::Start()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPhases.clear();
+		mThreads.clear();
+		mThreads.push_back(std::this_thread::get_id());
+		mStart = CpuProfiler::Now();
+		mEnd = mStart;
+		mFinished = false;
+	}
+
+	void StartupProfiler::Finish()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mEnd = CpuProfiler::Now();
+		mFinished = true;
+		std::sort(mPhases.begin(), mPhases.end(), [](const StartupPhase& a, const StartupPhase& b)
+		{
+			return a.Begin != b.Begin ? a.Begin < b.Begin : a.End > b.End;
+		});
+	}
+
+	uint32_t StartupProfiler::GetThreadIndex(std::thread::id thread)
+	{
+		for (uint32_t i = 0; i < (uint32_t)mThreads.size(); ++i)
+		{
+			if (mThreads[i] == thread)
+				return i;
+		}
+		mThreads.push_back(thread);
+		return (uint32_t)mThreads.size() - 1;
+	}
+
+	void StartupProfiler::Record(const char* name, uint64_t begin, uint64_t end)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mFinished || begin < mStart)
+			return;
+
+		StartupPhase phase;
+		phase.Name = name;
+		phase.Thread = GetThreadIndex(std::this_thread::get_id());
+		phase.Begin = begin - mStart;
+		phase.End = end - mStart;
+		mPhases.push_back(std::move(phase));
+	}
+
+	void StartupProfiler::Print(std::ostream& out) const
+	{
+		out << "Startup: " << std::fixed << std::setprecision(2) << GetTotalMS() << " ms\n";
+		for (const StartupPhase& phase : mPhases)
+		{
+			out << "  " << std::string(phase.Thread * 2, ' ') << std::left << std::setw(24) << phase.Name << std::right
+				<< " +" << std::setw(8) << phase.Begin / 1000000.0 << " ms  " << std::setw(8) << phase.GetMS() << " ms"
+				<< (phase.Thread ? "  (job)" : "") << "\n";
+		}
+		out << std::defaultfloat;
+	}
+
+	void StartupProfiler::WriteJSON(std::ostream& out) const
+	{
+		out << "{\"total_ms\":" << GetTotalMS() << ",\"phases\":[";
+		for (size_t i = 0; i < mPhases.size(); ++i)
+		{
+			const StartupPhase& phase = mPhases[i];
+			out << (i ? "," : "") << "{\"name\":";
+			WriteJSONString(out, phase.Name);
+			out << ",\"thread\":" << phase.Thread
+				<< ",\"begin_ms\":" << phase.Begin / 1000000.0 << ",\"ms\":" << phase.GetMS() << "}";
+		}
+		out << "]}";
+	}
+
+	ScopedStartupPhase::ScopedStartupPhase(StartupProfiler& profiler, const char* name)
+		: mProfiler(profiler)
+		, mName(name)
+		, mBegin(CpuProfiler::Now())
+		, mZone(name)
+	{
+	}
+
+	ScopedStartupPhase::~ScopedStartupPhase()
+	{
+		mProfiler.Record(mName, mBegin, CpuProfiler::Now());
+	}
+}
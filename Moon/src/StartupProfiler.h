@@ -0,0 +1,72 @@
+#pragma once
+#include "CpuProfiler.h"
+
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Moon
+{
+	struct StartupPhase
+	{
+		std::string Name;
+		// 0 is the thread that called Start(), others are numbered as they record their first phase.
+		uint32_t Thread = 0;
+		// Nanoseconds since Start().
+		uint64_t Begin = 0;
+		uint64_t End = 0;
+
+		float GetMS() const { return (float)((End - Begin) / 1000000.0); }
+	};
+
+	// Wall clock of every initialization phase, whichever thread it runs on. Thread safe.
+	class StartupProfiler
+	{
+	public:
+		void Start();
+		// Closes the startup, phases recorded afterwards are ignored.
+		void Finish();
+
+		void Record(const char* name, uint64_t begin, uint64_t end);
+
+		bool IsFinished() const { return mFinished; }
+		// Start() to Finish(), in milliseconds.
+		float GetTotalMS() const { return (float)((mEnd - mStart) / 1000000.0); }
+		// Sorted by begin time once finished.
+		const std::vector<StartupPhase>& GetPhases() const { return mPhases; }
+
+		// One line per phase, indented by thread.
+		void Print(std::ostream& out) const;
+		// {"total_ms":...,"phases":[{"name":...,"thread":...,"begin_ms":...,"ms":...}]}
+		void WriteJSON(std::ostream& out) const;
+
+	private:
+		uint32_t GetThreadIndex(std::thread::id thread);
+
+		std::mutex mMutex;
+		std::vector<StartupPhase> mPhases;
+		std::vector<std::thread::id> mThreads;
+		uint64_t mStart = 0;
+		uint64_t mEnd = 0;
+		bool mFinished = false;
+	};
+
+	// Records a startup phase and the matching CPU profiler zone.
+	class ScopedStartupPhase
+	{
+	public:
+		ScopedStartupPhase(StartupProfiler& profiler, const char* name);
+		~ScopedStartupPhase();
+
+	private:
+		StartupProfiler& mProfiler;
+		const char* mName;
+		uint64_t mBegin;
+		ScopedCpuZone mZone;
+	};
+}
+
+#define STARTUP_PHASE(profiler, name) ::Moon::ScopedStartupPhase MN_PROFILE_CONCAT(startupPhase, __LINE__)(profiler, name)
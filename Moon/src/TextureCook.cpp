@@ -0,0 +1,168 @@
+#include "mnpch.h"
+#include "TextureCook.h"
+#include "ContentHash.h"
+#include "DDSLayout.h"
+#include "Utils.h"
+
+#include <cctype>
+#include <stdexcept>
+
+using namespace DirectX;
+
+namespace Moon
+{
+	namespace
+	{
+		enum class SourceKind { Unsupported, DDS, TGA, HDR };
+
+		SourceKind GetSourceKind(const std::filesystem::path& path)
+		{
+			std::string extension = path.extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+			if (extension == ".dds")
+				return SourceKind::DDS;
+			if (extension == ".tga")
+				return SourceKind::TGA;
+			if (extension == ".hdr")
+				return SourceKind::HDR;
+			return SourceKind::Unsupported;
+		}
+
+	}
+
+	DXGI_FORMAT TextureCookSettings::GetWorkingFormat() const
+	{
+		if (Format == DXGI_FORMAT_BC6H_UF16)
+			return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		return IsSRGB(Format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	TEX_COMPRESS_FLAGS TextureCookSettings::GetCompressFlags() const
+	{
+		if (!FastEncoder || Format == DXGI_FORMAT_BC6H_UF16)
+			return TEX_COMPRESS_DEFAULT;
+		if (Format == DXGI_FORMAT_BC7_UNORM || Format == DXGI_FORMAT_BC7_UNORM_SRGB)
+			return TEX_COMPRESS_BC7_FAST;
+		return TEX_COMPRESS_BC_FAST;
+	}
+
+	std::string TextureCookSettings::GetSignature() const
+	{
+		return "format=" + std::to_string((uint32_t)Format)
+			+ " encoder=" + (FastEncoder ? "fast" : "reference")
+			+ " rdo=" + std::to_string(RdoLambda)
+			+ " lz=" + (Lz ? "1" : "0");
+	}
+
+	bool IsCookableTexture(const std::filesystem::path& path)
+	{
+		return GetSourceKind(path) != SourceKind::Unsupported;
+	}
+
+	uint64_t GetTextureCookKey(const void* source, size_t size, const TextureCookSettings& settings)
+	{
+		ContentHasher hasher(TextureCookVersion);
+		hasher.Update(settings.GetSignature());
+		hasher.Update(source, size);
+		return hasher.Finish();
+	}
+
+	HRESULT GetTextureSourceMetadata(const std::filesystem::path& path, const void* source, size_t size, TexMetadata& metadata)
+	{
+		switch (GetSourceKind(path))
+		{
+		case SourceKind::DDS: return GetMetadataFromDDSMemory(source, size, DDS_FLAGS_NONE, metadata);
+		case SourceKind::TGA: return GetMetadataFromTGAMemory(source, size, TGA_FLAGS_NONE, metadata);
+		case SourceKind::HDR: return GetMetadataFromHDRMemory(source, size, metadata);
+		default: return E_INVALIDARG;
+		}
+	}
+
+	uint64_t EstimateTextureCookMemory(const TexMetadata& source, const TextureCookSettings& settings)
+	{
+		// A full 2D chain adds a third of the pixels, a 3D one less.
+		const uint64_t pixels = (uint64_t)source.width * source.height * source.depth * source.arraySize;
+		const uint64_t chainPixels = pixels + pixels / 3;
+		const uint64_t sourceBytes = pixels * std::max<size_t>(BitsPerPixel(source.format), 8) / 8;
+		const uint64_t workingBytes = chainPixels * BitsPerPixel(settings.GetWorkingFormat()) / 8;
+		return sourceBytes * 2 + workingBytes + chainPixels * 2;
+	}
+
+	ScratchImage LoadTextureSource(const std::filesystem::path& path, const void* source, size_t size,
+		const TextureCookSettings& settings, bool parallel)
+	{
+		ScratchImage image;
+		switch (GetSourceKind(path))
+		{
+		case SourceKind::DDS: CheckHResult(LoadFromDDSMemory(source, size, DDS_FLAGS_NONE, nullptr, image), "LoadFromDDSMemory"); break;
+		case SourceKind::TGA: CheckHResult(LoadFromTGAMemory(source, size, TGA_FLAGS_NONE, nullptr, image), "LoadFromTGAMemory"); break;
+		case SourceKind::HDR: CheckHResult(LoadFromHDRMemory(source, size, nullptr, image), "LoadFromHDRMemory"); break;
+		default: throw std::runtime_error("Only DDS, TGA and HDR textures cook, not " + path.filename().string());
+		}
+
+		TEX_FILTER_FLAGS filter = TEX_FILTER_FORCE_NON_WIC;
+		if (parallel)
+			filter |= TEX_FILTER_PARALLEL;
+
+		if (IsCompressed(image.GetMetadata().format))
+		{
+			ScratchImage decompressed;
+			CheckHResult(Decompress(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DXGI_FORMAT_UNKNOWN, filter & TEX_FILTER_PARALLEL,
+				decompressed), "Decompress");
+			image = std::move(decompressed);
+		}
+
+		const DXGI_FORMAT workingFormat = settings.GetWorkingFormat();
+		if (image.GetMetadata().format != workingFormat)
+		{
+			ScratchImage converted;
+			CheckHResult(Convert(image.GetImages(), image.GetImageCount(), image.GetMetadata(), workingFormat, filter,
+				TEX_THRESHOLD_DEFAULT, converted), "Convert");
+			image = std::move(converted);
+		}
+		return image;
+	}
+
+	std::vector<uint8_t> CookTexture(const std::filesystem::path& path, const void* source, size_t size,
+		const TextureCookSettings& settings, bool parallel, TexMetadata* cooked)
+	{
+		ScratchImage image = LoadTextureSource(path, source, size, settings, parallel);
+
+		// Cooked mips take the integer box average, within 1 of the float one.
+		TEX_FILTER_FLAGS filter = TEX_FILTER_FORCE_NON_WIC | TEX_FILTER_BOX_INTEGER;
+		if (parallel)
+			filter |= TEX_FILTER_PARALLEL;
+
+		const TexMetadata& working = image.GetMetadata();
+		if (working.mipLevels == 1 && (working.width > 1 || working.height > 1 || working.depth > 1))
+		{
+			ScratchImage mipChain;
+			if (working.dimension == TEX_DIMENSION_TEXTURE3D)
+				CheckHResult(GenerateMipMaps3D(image.GetImages(), image.GetImageCount(), working, filter, 0, mipChain), "GenerateMipMaps3D");
+			else
+				CheckHResult(GenerateMipMaps(image.GetImages(), image.GetImageCount(), working, filter, 0, mipChain), "GenerateMipMaps");
+			image = std::move(mipChain);
+		}
+
+		ScratchImage compressed;
+		TEX_COMPRESS_FLAGS compress = settings.GetCompressFlags();
+		if (parallel)
+			compress |= TEX_COMPRESS_PARALLEL;
+		CheckHResult(Compress(image.GetImages(), image.GetImageCount(), image.GetMetadata(), settings.Format, compress,
+			TEX_THRESHOLD_DEFAULT, compressed), "Compress");
+		if (settings.RdoLambda > 0.0f)
+		{
+			CheckHResult(RateDistortionOptimize(image.GetImages(), compressed.GetImages(), image.GetImageCount(), compress,
+				settings.RdoLambda), "RateDistortionOptimize");
+		}
+
+		Blob blob;
+		CheckHResult(SaveToDDSMemory(compressed.GetImages(), compressed.GetImageCount(), compressed.GetMetadata(), DDS_FLAGS_NONE, blob), "SaveToDDSMemory");
+		if (cooked)
+			*cooked = compressed.GetMetadata();
+
+		if (settings.Lz)
+			return CompressDDS(blob.GetConstBufferPointer(), blob.GetBufferSize());
+		return std::vector<uint8_t>(blob.GetConstBufferPointer(), blob.GetConstBufferPointer() + blob.GetBufferSize());
+	}
+}
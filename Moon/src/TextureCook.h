@@ -0,0 +1,54 @@
+#pragma once
+#include "DirectXTex/DirectXTex.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	// Bump when a change of the pipeline changes the files it cooks, so that every texture cooks again.
+	constexpr uint32_t TextureCookVersion = 3;
+
+	struct TextureCookSettings
+	{
+		// BC1, BC3 or BC7, UNORM or UNORM_SRGB, BC4_UNORM, BC5_UNORM or BC6H_UF16.
+		DXGI_FORMAT Format = DXGI_FORMAT_BC7_UNORM;
+		// The integer encoders (TEX_COMPRESS_BC_FAST, TEX_COMPRESS_BC7_FAST) rather than the reference ones.
+		bool FastEncoder = true;
+		// RateDistortionOptimize() lambda, 0 leaves the blocks as Compress made them.
+		float RdoLambda = 0.0f;
+		// DDSZ files (CompressDDS()) rather than plain DDS ones.
+		bool Lz = false;
+
+		// Every setting that changes the cooked file.
+		std::string GetSignature() const;
+		// Mips are filtered in, and the blocks encoded from, this format.
+		DXGI_FORMAT GetWorkingFormat() const;
+		// Encoder flags of Format, TEX_COMPRESS_PARALLEL aside.
+		DirectX::TEX_COMPRESS_FLAGS GetCompressFlags() const;
+	};
+
+	// .dds, .tga and .hdr files, the formats DirectXTex reads without WIC.
+	bool IsCookableTexture(const std::filesystem::path& path);
+	// Derived data key of a source file: its bytes, the settings and TextureCookVersion.
+	uint64_t GetTextureCookKey(const void* source, size_t size, const TextureCookSettings& settings);
+
+	// Reads the header of a source file, the extension of path tells its format.
+	HRESULT GetTextureSourceMetadata(const std::filesystem::path& path, const void* source, size_t size, DirectX::TexMetadata& metadata);
+	// Bytes cooking the source holds at its peak, about: the loaded image and its converted copy, the mip chain, the blocks
+	// and the file holding them again.
+	uint64_t EstimateTextureCookMemory(const DirectX::TexMetadata& source, const TextureCookSettings& settings);
+
+	// Loads the source and converts it to the working format of settings, decompressing BC sources first: the images the
+	// blocks are encoded from, before any mip is added. Throws std::runtime_error.
+	DirectX::ScratchImage LoadTextureSource(const std::filesystem::path& path, const void* source, size_t size,
+		const TextureCookSettings& settings, bool parallel);
+
+	// Loads the source, filters a full mip chain unless it has mips already, compresses it and returns the DDS file. Only
+	// DirectXTex's own codecs and filters run (no WIC), so every platform cooks the same bytes. parallel lets DirectXTex
+	// spread the work over its own threads. Throws std::runtime_error.
+	std::vector<uint8_t> CookTexture(const std::filesystem::path& path, const void* source, size_t size,
+		const TextureCookSettings& settings, bool parallel, DirectX::TexMetadata* cooked = nullptr);
+}
@@ -0,0 +1,339 @@
+#include "mnpch.h"
+#include "TextureStreamer.h"
+#include "CpuProfiler.h"
+
+namespace Moon
+{
+	namespace
+	{
+		uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	TextureStreamer::TextureStreamer(ID3D12Device* device, CommandQueue* queue, ResourceStateRegistry& registry,
+		uint64_t frameBudget, uint64_t tailBytes)
+		: mDevice(device)
+		, mQueue(queue)
+		, mRegistry(registry)
+		, mFrameBudget(frameBudget)
+		, mTailBytes(tailBytes)
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+		heapDesc.NumDescriptors = MaxTextures;
+		heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		DX_CHECK(mDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mStagingHeap)));
+		mDescriptorSize = mDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		// The owner waits for the GPU to be idle first, in flight upload buffers can be released.
+		for (const std::unique_ptr<StreamedTexture>& texture : mTextures)
+			mRegistry.Unregister(texture->Resource.Get());
+	}
+
+	StreamedTexture* TextureStreamer::Load(const std::wstring& filename, DirectX::DDSFileMapping&& file, ID3D12GraphicsCommandList* cmdList,
+		ResourceStateTracker& stateTracker, const std::array<D3D12_CPU_DESCRIPTOR_HANDLE, BACKBUFFER_COUNT>& frameSrvs)
+	{
+		if (mTextures.size() >= MaxTextures)
+			throw std::runtime_error("Too many streamed textures");
+
+		auto texture = std::make_unique<StreamedTexture>();
+		texture->Filename = filename;
+		texture->Layout = DDSLayout::Parse(file.GetData(), file.GetSize());
+		texture->File = std::move(file);
+		texture->FrameSrvs = frameSrvs;
+		texture->StagingSrv = CD3DX12_CPU_DESCRIPTOR_HANDLE(mStagingHeap->GetCPUDescriptorHandleForHeapStart(), (INT)mTextures.size(), mDescriptorSize);
+
+		const DDSLayout& layout = texture->Layout;
+		if (layout.Dimension != DDSLayout::DimensionTexture2D || layout.IsCubeMap)
+			throw std::runtime_error("Only 2D textures and 2D texture arrays can be streamed");
+
+		// Created readable, the missing mips are never sampled thanks to the clamp.
+		DX_CHECK(mDevice->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Tex2D((DXGI_FORMAT)layout.Format, layout.Width, layout.Height, (UINT16)layout.ArraySize, (UINT16)layout.MipCount),
+			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+			nullptr,
+			IID_PPV_ARGS(&texture->Resource)));
+		texture->Resource->SetName(filename.c_str());
+		mRegistry.Register(texture->Resource.Get(), layout.MipCount * layout.ArraySize, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+		const uint32_t tailMip = layout.GetTailMip(mTailBytes);
+		texture->ResidentMip = tailMip;
+		texture->RequestedMip = tailMip;
+
+		Batch batch;
+		for (uint32_t mip = tailMip; mip < layout.MipCount; ++mip)
+			batch.Copies.push_back({ texture.get(), mip });
+		RecordCopies(batch, cmdList, stateTracker);
+		mRecorded.push_back(std::move(batch));
+
+		// Nothing sampled the texture yet and its tail lands before any later command of the list,
+		// every frame can be clamped to the tail right away.
+		WriteSrv(*texture);
+		for (uint32_t frame = 0; frame < BACKBUFFER_COUNT; ++frame)
+		{
+			mDevice->CopyDescriptorsSimple(1, texture->FrameSrvs[frame], texture->StagingSrv, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+			texture->FrameSrvMips[frame] = texture->ResidentMip;
+		}
+
+		if (tailMip > 0)
+		{
+			mStreaming.push_back(texture.get());
+			mPendingMips += tailMip;
+		}
+		else
+		{
+			texture->File.Close();
+		}
+
+		mTextures.push_back(std::move(texture));
+		return mTextures.back().get();
+	}
+
+	void TextureStreamer::Update(ID3D12GraphicsCommandList* cmdList, ResourceStateTracker& stateTracker, uint32_t frameIndex)
+	{
+		PROFILE_ZONE("Texture Streaming");
+		RetireCompletedBatches();
+		mFrameIndex = frameIndex;
+		UpdateFrameSrvs(frameIndex);
+
+		mLastFrameBytes = 0;
+		if (mStreaming.empty())
+			return;
+
+		Batch batch;
+		uint64_t bytes = 0;
+		bool budgetReached = false;
+		while (!mStreaming.empty() && !budgetReached)
+		{
+			StreamedTexture* texture = mStreaming.front();
+			while (texture->RequestedMip > 0)
+			{
+				const uint64_t mipSize = texture->Layout.GetMipSize(texture->RequestedMip - 1);
+				if (bytes > 0 && bytes + mipSize > mFrameBudget)
+				{
+					budgetReached = true;
+					break;
+				}
+
+				--texture->RequestedMip;
+				--mPendingMips;
+				bytes += mipSize;
+				batch.Copies.push_back({ texture, texture->RequestedMip });
+			}
+
+			if (texture->RequestedMip == 0)
+				mStreaming.erase(mStreaming.begin());
+		}
+
+		RecordCopies(batch, cmdList, stateTracker);
+		mRecorded.push_back(std::move(batch));
+		mLastFrameBytes = bytes;
+
+		// The copies read from the upload buffer from now on, the files are not needed anymore.
+		for (const MipCopy& copy : mRecorded.back().Copies)
+		{
+			if (copy.Mip == 0)
+				copy.Texture->File.Close();
+		}
+	}
+
+	void TextureStreamer::OnSubmitted(uint64_t fenceValue)
+	{
+		mFrameFences[mFrameIndex] = fenceValue;
+		for (Batch& batch : mRecorded)
+		{
+			batch.FenceValue = fenceValue;
+			mInFlight.push_back(std::move(batch));
+		}
+		mRecorded.clear();
+	}
+
+	void TextureStreamer::RecordCopies(Batch& batch, ID3D12GraphicsCommandList* cmdList, ResourceStateTracker& stateTracker)
+	{
+		// Every subresource of the batch, packed in one upload buffer.
+		mFootprints.clear();
+		uint64_t uploadSize = 0;
+		for (const MipCopy& copy : batch.Copies)
+		{
+			const D3D12_RESOURCE_DESC desc = copy.Texture->Resource->GetDesc();
+			for (uint32_t slice = 0; slice < copy.Texture->Layout.ArraySize; ++slice)
+			{
+				D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+				UINT64 totalBytes = 0;
+				mDevice->GetCopyableFootprints(&desc, copy.Texture->Layout.GetSubresourceIndex(copy.Mip, slice), 1, uploadSize,
+					&footprint, nullptr, nullptr, &totalBytes);
+				mFootprints.push_back(footprint);
+				uploadSize = AlignUp(footprint.Offset + totalBytes, (uint64_t)D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+			}
+		}
+		batch.Upload = AcquireUploadBuffer(uploadSize);
+
+		// Straight from the file mapping to the upload buffer, row by row as the pitches differ.
+		// Compressed streams decode straight to the upload buffer too, their rows are at the pitch of the footprint already.
+		size_t footprintIndex = 0;
+		for (const MipCopy& copy : batch.Copies)
+		{
+			const DDSLayout& layout = copy.Texture->Layout;
+			const uint8_t* fileData = copy.Texture->File.GetData();
+			for (uint32_t slice = 0; slice < layout.ArraySize; ++slice)
+			{
+				const DDSSubresource& sub = layout.GetSubresource(copy.Mip, slice);
+				const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = mFootprints[footprintIndex++];
+				const uint8_t* src = fileData + sub.Offset;
+				uint32_t srcRowPitch = sub.RowPitch;
+				if (layout.IsCompressed)
+				{
+					uint8_t* dst = batch.Upload.Data + footprint.Offset;
+					if (footprint.Footprint.RowPitch == sub.GetUploadRowPitch())
+					{
+						LZDecompress(src, (size_t)sub.CompressedSize, dst, (size_t)sub.GetUploadSize());
+						mTotalBytes += sub.Size;
+						continue;
+					}
+
+					// Not expected from D3D12, but the pitch of the footprint is the driver's to choose.
+					mScratch.resize((size_t)sub.GetUploadSize());
+					LZDecompress(src, (size_t)sub.CompressedSize, mScratch.data(), mScratch.size());
+					src = mScratch.data();
+					srcRowPitch = sub.GetUploadRowPitch();
+				}
+
+				for (uint32_t z = 0; z < sub.Depth; ++z)
+				{
+					const uint8_t* srcSlice = src + (uint64_t)z * srcRowPitch * sub.RowCount;
+					uint8_t* dst = batch.Upload.Data + footprint.Offset + (uint64_t)z * footprint.Footprint.RowPitch * sub.RowCount;
+					for (uint32_t row = 0; row < sub.RowCount; ++row)
+						memcpy(dst + (uint64_t)row * footprint.Footprint.RowPitch, srcSlice + (uint64_t)row * srcRowPitch, sub.RowPitch);
+				}
+				mTotalBytes += sub.Size;
+			}
+		}
+
+		footprintIndex = 0;
+		for (const MipCopy& copy : batch.Copies)
+		{
+			for (uint32_t slice = 0; slice < copy.Texture->Layout.ArraySize; ++slice)
+				stateTracker.Require(copy.Texture->Resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, copy.Texture->Layout.GetSubresourceIndex(copy.Mip, slice));
+		}
+		FlushResourceBarriers(cmdList, stateTracker);
+
+		for (const MipCopy& copy : batch.Copies)
+		{
+			for (uint32_t slice = 0; slice < copy.Texture->Layout.ArraySize; ++slice)
+			{
+				const uint32_t subresource = copy.Texture->Layout.GetSubresourceIndex(copy.Mip, slice);
+				CD3DX12_TEXTURE_COPY_LOCATION dst(copy.Texture->Resource.Get(), subresource);
+				CD3DX12_TEXTURE_COPY_LOCATION src(batch.Upload.Resource.Get(), mFootprints[footprintIndex++]);
+				cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+
+				// Flushed with the next barriers the owner records, before anything samples the texture.
+				stateTracker.Require(copy.Texture->Resource.Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, subresource);
+			}
+		}
+	}
+
+	TextureStreamer::UploadBuffer TextureStreamer::AcquireUploadBuffer(uint64_t size)
+	{
+		// Smallest free buffer that fits.
+		size_t best = mFreeUploadBuffers.size();
+		for (size_t i = 0; i < mFreeUploadBuffers.size(); ++i)
+		{
+			if (mFreeUploadBuffers[i].Size >= size && (best == mFreeUploadBuffers.size() || mFreeUploadBuffers[i].Size < mFreeUploadBuffers[best].Size))
+				best = i;
+		}
+		if (best < mFreeUploadBuffers.size())
+		{
+			UploadBuffer buffer = std::move(mFreeUploadBuffers[best]);
+			mFreeUploadBuffers.erase(mFreeUploadBuffers.begin() + best);
+			return buffer;
+		}
+
+		// At least a full budget, so steady streaming keeps reusing the same few buffers.
+		UploadBuffer buffer;
+		buffer.Size = AlignUp(std::max(size, mFrameBudget), (uint64_t)D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+		DX_CHECK(mDevice->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(buffer.Size),
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&buffer.Resource)));
+		buffer.Resource->SetName(L"TextureStreamerUpload");
+
+		CD3DX12_RANGE readRange(0, 0);
+		DX_CHECK(buffer.Resource->Map(0, &readRange, reinterpret_cast<void**>(&buffer.Data)));
+		return buffer;
+	}
+
+	void TextureStreamer::RetireCompletedBatches()
+	{
+		// Submitted in order, the first batch still running stops the walk.
+		size_t retired = 0;
+		for (; retired < mInFlight.size() && mQueue->IsFenceComplete(mInFlight[retired].FenceValue); ++retired)
+		{
+			Batch& batch = mInFlight[retired];
+			for (const MipCopy& copy : batch.Copies)
+			{
+				if (copy.Mip < copy.Texture->ResidentMip)
+				{
+					copy.Texture->ResidentMip = copy.Mip;
+					WriteSrv(*copy.Texture);
+				}
+			}
+			mFreeUploadBuffers.push_back(std::move(batch.Upload));
+		}
+		mInFlight.erase(mInFlight.begin(), mInFlight.begin() + retired);
+
+		// Streaming is over until the next Load(), the upload memory goes back.
+		if (mStreaming.empty() && mInFlight.empty() && mRecorded.empty())
+			mFreeUploadBuffers.clear();
+	}
+
+	void TextureStreamer::WriteSrv(const StreamedTexture& texture)
+	{
+		const DDSLayout& layout = texture.Layout;
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Format = (DXGI_FORMAT)layout.Format;
+		if (layout.ArraySize > 1)
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+			srvDesc.Texture2DArray.MostDetailedMip = 0;
+			srvDesc.Texture2DArray.MipLevels = layout.MipCount;
+			srvDesc.Texture2DArray.FirstArraySlice = 0;
+			srvDesc.Texture2DArray.ArraySize = layout.ArraySize;
+			srvDesc.Texture2DArray.ResourceMinLODClamp = (float)texture.ResidentMip;
+		}
+		else
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Texture2D.MostDetailedMip = 0;
+			srvDesc.Texture2D.MipLevels = layout.MipCount;
+			srvDesc.Texture2D.ResourceMinLODClamp = (float)texture.ResidentMip;
+		}
+		mDevice->CreateShaderResourceView(texture.Resource.Get(), &srvDesc, texture.StagingSrv);
+	}
+
+	void TextureStreamer::UpdateFrameSrvs(uint32_t frameIndex)
+	{
+		// The GPU may still read them: they keep their older clamp, which stays valid, until a later frame.
+		if (!mQueue->IsFenceComplete(mFrameFences[frameIndex]))
+			return;
+
+		for (const std::unique_ptr<StreamedTexture>& texture : mTextures)
+		{
+			if (texture->FrameSrvMips[frameIndex] != texture->ResidentMip)
+			{
+				mDevice->CopyDescriptorsSimple(1, texture->FrameSrvs[frameIndex], texture->StagingSrv, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+				texture->FrameSrvMips[frameIndex] = texture->ResidentMip;
+			}
+		}
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "dx_utils.h"
+#include "CommandQueue.h"
+#include "DDSLayout.h"
+#include "DDSTextureLoader.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	// A texture created with all its mips, whose mips become resident from the smallest up.
+	struct StreamedTexture
+	{
+		std::wstring Filename;
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		DDSLayout Layout;
+		// One SRV per frame in flight in the shader visible heap: the GPU may still read the previous frames' ones.
+		std::array<D3D12_CPU_DESCRIPTOR_HANDLE, BACKBUFFER_COUNT> FrameSrvs = {};
+
+		// Most detailed mip the SRV is clamped to. Lowered once the GPU is done copying the mip.
+		uint32_t ResidentMip = 0;
+		// Most detailed mip whose copy has been recorded.
+		uint32_t RequestedMip = 0;
+
+		bool IsFullyResident() const { return ResidentMip == 0; }
+
+	private:
+		friend class TextureStreamer;
+		// Closed once every mip has been copied to an upload buffer.
+		DirectX::DDSFileMapping File;
+		// SRV with the current clamp, in the streamer's CPU only heap, copied to the frame SRVs.
+		D3D12_CPU_DESCRIPTOR_HANDLE StagingSrv = {};
+		// Clamp each frame SRV was last written with.
+		std::array<uint32_t, BACKBUFFER_COUNT> FrameSrvMips = {};
+	};
+
+	// Streams DDS mips from memory mapped files, plain or written by CompressDDS(). Loading a texture copies its smallest mips
+	// right away, so it can be sampled in the same frame. The next mips are copied over the following frames, least detailed
+	// first, within a per frame byte budget. The SRV's ResourceMinLODClamp follows the most detailed mip the GPU is done copying.
+	// Every subresource stays in PIXEL_SHADER_RESOURCE outside of its copy, the clamp alone keeps the missing mips from being sampled.
+	// A new clamp is written to a CPU only heap, then copied to the SRV of a frame once that frame's last submission is complete.
+	class TextureStreamer
+	{
+	public:
+		// Bytes of the smallest mips copied by Load(), and of the mips copied by each Update().
+		static constexpr uint64_t DefaultTailBytes = 256 * 1024;
+		static constexpr uint64_t DefaultFrameBudget = 4 * 1024 * 1024;
+		static constexpr uint32_t MaxTextures = 256;
+
+		TextureStreamer(ID3D12Device* device, CommandQueue* queue, ResourceStateRegistry& registry,
+			uint64_t frameBudget = DefaultFrameBudget, uint64_t tailBytes = DefaultTailBytes);
+		~TextureStreamer();
+		TextureStreamer(const TextureStreamer& rhs) = delete;
+		TextureStreamer& operator=(const TextureStreamer& rhs) = delete;
+
+		// Creates the texture from a mapped DDS file, records the copy of its smallest mips and writes its SRV at every
+		// frameSrvs, which no frame may be reading yet. Only 2D textures and 2D texture arrays stream, MaxTextures at most.
+		// Throws std::runtime_error on an invalid or unsupported file.
+		StreamedTexture* Load(const std::wstring& filename, DirectX::DDSFileMapping&& file, ID3D12GraphicsCommandList* cmdList,
+			ResourceStateTracker& stateTracker, const std::array<D3D12_CPU_DESCRIPTOR_HANDLE, BACKBUFFER_COUNT>& frameSrvs);
+
+		// Lowers the clamp of the textures whose copies the GPU is done with, updates the SRVs of frameIndex when its last
+		// submission is complete, then records the copies of the next mips within the frame budget. A mip larger than the
+		// whole budget is copied alone in its frame.
+		void Update(ID3D12GraphicsCommandList* cmdList, ResourceStateTracker& stateTracker, uint32_t frameIndex);
+		// Fence signaled by the command list the last Load() and Update() calls recorded on.
+		void OnSubmitted(uint64_t fenceValue);
+
+		// Every texture fully resident and every copy retired.
+		bool IsIdle() const { return mPendingMips == 0 && mInFlight.empty() && mRecorded.empty(); }
+		uint64_t GetFrameBudget() const { return mFrameBudget; }
+		void SetFrameBudget(uint64_t frameBudget) { mFrameBudget = frameBudget; }
+		// Bytes copied by the last Update().
+		uint64_t GetLastFrameBytes() const { return mLastFrameBytes; }
+		uint64_t GetTotalBytes() const { return mTotalBytes; }
+		uint32_t GetPendingMipCount() const { return mPendingMips; }
+
+	private:
+		struct MipCopy
+		{
+			StreamedTexture* Texture;
+			uint32_t Mip;
+		};
+
+		// Persistently mapped.
+		struct UploadBuffer
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+			uint64_t Size = 0;
+			uint8_t* Data = nullptr;
+		};
+
+		// Copies recorded in one command list, with the upload buffer they read from.
+		struct Batch
+		{
+			UploadBuffer Upload;
+			std::vector<MipCopy> Copies;
+			uint64_t FenceValue = 0;
+		};
+
+		void RecordCopies(Batch& batch, ID3D12GraphicsCommandList* cmdList, ResourceStateTracker& stateTracker);
+		UploadBuffer AcquireUploadBuffer(uint64_t size);
+		void RetireCompletedBatches();
+		// Writes the staging SRV with the current clamp.
+		void WriteSrv(const StreamedTexture& texture);
+		void UpdateFrameSrvs(uint32_t frameIndex);
+
+		ID3D12Device* mDevice;
+		CommandQueue* mQueue;
+		ResourceStateRegistry& mRegistry;
+		uint64_t mFrameBudget;
+		uint64_t mTailBytes;
+
+		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mStagingHeap;
+		uint32_t mDescriptorSize = 0;
+		// Last fence submitted with each frame's SRVs bound, and the frame of the last Update().
+		std::array<uint64_t, BACKBUFFER_COUNT> mFrameFences = {};
+		uint32_t mFrameIndex = 0;
+
+		std::vector<std::unique_ptr<StreamedTexture>> mTextures;
+		// Textures whose copies are not all recorded yet, served in load order.
+		std::vector<StreamedTexture*> mStreaming;
+		uint32_t mPendingMips = 0;
+
+		// Recorded but not submitted yet, then in flight until their fence passes.
+		std::vector<Batch> mRecorded;
+		std::vector<Batch> mInFlight;
+		// Upload buffers of retired batches, reused before creating new ones.
+		std::vector<UploadBuffer> mFreeUploadBuffers;
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> mFootprints;
+		// Decoded subresources of compressed files whose rows are not at the pitch of their footprint.
+		std::vector<uint8_t> mScratch;
+
+		uint64_t mLastFrameBytes = 0;
+		uint64_t mTotalBytes = 0;
+	};
+}
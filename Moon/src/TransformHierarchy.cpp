@@ -0,0 +1,211 @@
+#include "mnpch.h"
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace Moon
+{
+	namespace
+	{
+		// Nodes per job, small enough to spread a wide level over the workers.
+		constexpr uint32_t UpdateGrainSize = 1024;
+
+		template<typename T>
+		void Permute(std::vector<T>& v, const std::vector<uint32_t>& newToOld)
+		{
+			std::vector<T> sorted(v.size());
+			for (size_t i = 0; i < newToOld.size(); ++i)
+				sorted[i] = v[newToOld[i]];
+			v.swap(sorted);
+		}
+	}
+
+	TransformNode TransformHierarchy::AddNode(TransformNode parent)
+	{
+		const TransformNode node = (TransformNode)mNodeToIndex.size();
+		const uint32_t index = Size();
+		const uint32_t parentIndex = parent != InvalidTransformNode ? mNodeToIndex[parent] : UINT32_MAX;
+
+		mTranslations.push_back({ 0.0f, 0.0f, 0.0f });
+		mRotations.push_back({ 0.0f, 0.0f, 0.0f, 1.0f });
+		mScales.push_back({ 1.0f, 1.0f, 1.0f });
+		mWorlds.push_back(MathHelper::Identity4x4());
+		mParents.push_back(parentIndex);
+		mDepths.push_back(parentIndex != UINT32_MAX ? mDepths[parentIndex] + 1 : 0);
+		mLocalDirty.push_back(1);
+		mChanged.push_back(0);
+		mSceneObjects.emplace_back();
+		mIndexToNode.push_back(node);
+		mNodeToIndex.push_back(index);
+
+		mNeedsSort = true;
+		return node;
+	}
+
+	void TransformHierarchy::SetTranslation(TransformNode node, const XMFLOAT3& translation)
+	{
+		const uint32_t index = mNodeToIndex[node];
+		mTranslations[index] = translation;
+		mLocalDirty[index] = 1;
+	}
+
+	void TransformHierarchy::SetRotation(TransformNode node, const XMFLOAT4& rotationQuat)
+	{
+		const uint32_t index = mNodeToIndex[node];
+		mRotations[index] = rotationQuat;
+		mLocalDirty[index] = 1;
+	}
+
+	void TransformHierarchy::SetScale(TransformNode node, const XMFLOAT3& scale)
+	{
+		const uint32_t index = mNodeToIndex[node];
+		mScales[index] = scale;
+		mLocalDirty[index] = 1;
+	}
+
+	void TransformHierarchy::SetLocal(TransformNode node, const XMFLOAT3& translation, const XMFLOAT4& rotationQuat, const XMFLOAT3& scale)
+	{
+		const uint32_t index = mNodeToIndex[node];
+		mTranslations[index] = translation;
+		mRotations[index] = rotationQuat;
+		mScales[index] = scale;
+		mLocalDirty[index] = 1;
+	}
+
+	void TransformHierarchy::BindSceneObject(TransformNode node, SceneHandle object)
+	{
+		const uint32_t index = mNodeToIndex[node];
+		mSceneObjects[index] = object;
+		// Make sure the object gets the current world matrix even if the node does not move.
+		mLocalDirty[index] = 1;
+	}
+
+	void TransformHierarchy::Update(JobSystem* jobSystem)
+	{
+		if (mNeedsSort)
+			SortByDepth();
+
+		for (size_t level = 0; level + 1 < mLevelOffsets.size(); ++level)
+		{
+			const uint32_t begin = mLevelOffsets[level];
+			const uint32_t end = mLevelOffsets[level + 1];
+
+			if (jobSystem)
+			{
+				jobSystem->ParallelFor(end - begin, UpdateGrainSize, [this, begin](uint32_t b, uint32_t e)
+				{
+					UpdateRange(begin + b, begin + e);
+				});
+			}
+			else
+			{
+				UpdateRange(begin, end);
+			}
+		}
+
+		mChangedRanges.clear();
+		const uint32_t count = Size();
+		for (uint32_t i = 0; i < count;)
+		{
+			if (!mChanged[i])
+			{
+				++i;
+				continue;
+			}
+
+			Range range;
+			range.Begin = i;
+			while (i < count && mChanged[i])
+				++i;
+			range.Count = i - range.Begin;
+			mChangedRanges.push_back(range);
+		}
+	}
+
+	void TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const uint32_t parent = mParents[i];
+			const bool parentChanged = parent != UINT32_MAX && mChanged[parent];
+
+			if (!mLocalDirty[i] && !parentChanged)
+			{
+				mChanged[i] = 0;
+				continue;
+			}
+
+			XMMATRIX local = XMMatrixAffineTransformation(
+				XMLoadFloat3(&mScales[i]),
+				XMVectorZero(),
+				XMLoadFloat4(&mRotations[i]),
+				XMLoadFloat3(&mTranslations[i]));
+
+			if (parent != UINT32_MAX)
+				local = XMMatrixMultiply(local, XMLoadFloat4x4(&mWorlds[parent]));
+
+			XMStoreFloat4x4(&mWorlds[i], local);
+			mLocalDirty[i] = 0;
+			mChanged[i] = 1;
+		}
+	}
+
+	void TransformHierarchy::WriteChanged(SceneStore& scene) const
+	{
+		for (const Range& range : mChangedRanges)
+		{
+			for (uint32_t i = range.Begin; i < range.Begin + range.Count; ++i)
+			{
+				if (scene.IsValid(mSceneObjects[i]))
+					scene.SetWorld(mSceneObjects[i], mWorlds[i]);
+			}
+		}
+	}
+
+	void TransformHierarchy::SortByDepth()
+	{
+		const uint32_t count = Size();
+
+		uint32_t maxDepth = 0;
+		for (uint32_t i = 0; i < count; ++i)
+			maxDepth = std::max(maxDepth, mDepths[i]);
+
+		// Stable counting sort, nodes keep their creation order inside a level.
+		mLevelOffsets.assign(maxDepth + 2, 0);
+		for (uint32_t i = 0; i < count; ++i)
+			mLevelOffsets[mDepths[i] + 1]++;
+		for (size_t level = 1; level < mLevelOffsets.size(); ++level)
+			mLevelOffsets[level] += mLevelOffsets[level - 1];
+
+		std::vector<uint32_t> cursor(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+		std::vector<uint32_t> newToOld(count);
+		std::vector<uint32_t> oldToNew(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const uint32_t dst = cursor[mDepths[i]]++;
+			newToOld[dst] = i;
+			oldToNew[i] = dst;
+		}
+
+		Permute(mTranslations, newToOld);
+		Permute(mRotations, newToOld);
+		Permute(mScales, newToOld);
+		Permute(mWorlds, newToOld);
+		Permute(mParents, newToOld);
+		Permute(mDepths, newToOld);
+		Permute(mLocalDirty, newToOld);
+		Permute(mChanged, newToOld);
+		Permute(mSceneObjects, newToOld);
+		Permute(mIndexToNode, newToOld);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (mParents[i] != UINT32_MAX)
+				mParents[i] = oldToNew[mParents[i]];
+			mNodeToIndex[mIndexToNode[i]] = i;
+		}
+
+		mNeedsSort = false;
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "Math.h"
+#include "SceneStore.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Moon
+{
+	class JobSystem;
+
+	using TransformNode = uint32_t;
+	constexpr TransformNode InvalidTransformNode = UINT32_MAX;
+
+	// Parent/child transforms stored as local TRS.
+	// Nodes are kept sorted by depth so one level only depends on the levels before it,
+	// and each level is updated in parallel once the previous one is done.
+	class TransformHierarchy
+	{
+	public:
+		struct Range
+		{
+			uint32_t Begin = 0;
+			uint32_t Count = 0;
+		};
+
+		// parent must already exist, which guarantees a parent always sorts before its children.
+		TransformNode AddNode(TransformNode parent = InvalidTransformNode);
+		uint32_t Size() const { return (uint32_t)mParents.size(); }
+
+		void SetTranslation(TransformNode node, const DirectX::XMFLOAT3& translation);
+		void SetRotation(TransformNode node, const DirectX::XMFLOAT4& rotationQuat);
+		void SetScale(TransformNode node, const DirectX::XMFLOAT3& scale);
+		void SetLocal(TransformNode node, const DirectX::XMFLOAT3& translation, const DirectX::XMFLOAT4& rotationQuat, const DirectX::XMFLOAT3& scale);
+
+		// Scene object that receives this node's world matrix in WriteChanged().
+		void BindSceneObject(TransformNode node, SceneHandle object);
+
+		// Recomputes the world matrix of every dirty node and of all of their descendants.
+		void Update(JobSystem* jobSystem = nullptr);
+
+		// Runs of consecutive nodes whose world matrix changed in the last Update(), in sorted order.
+		const std::vector<Range>& GetChangedRanges() const { return mChangedRanges; }
+		const DirectX::XMFLOAT4X4& GetWorld(TransformNode node) const { return mWorlds[mNodeToIndex[node]]; }
+
+		// Copies the changed world matrices to their bound scene objects, which marks them dirty for upload.
+		void WriteChanged(SceneStore& scene) const;
+
+	private:
+		void SortByDepth();
+		void UpdateRange(uint32_t begin, uint32_t end);
+
+		// Indexed by sorted position.
+		std::vector<DirectX::XMFLOAT3> mTranslations;
+		std::vector<DirectX::XMFLOAT4> mRotations;
+		std::vector<DirectX::XMFLOAT3> mScales;
+		std::vector<DirectX::XMFLOAT4X4> mWorlds;
+		std::vector<uint32_t> mParents;
+		std::vector<uint32_t> mDepths;
+		std::vector<uint8_t> mLocalDirty;
+		std::vector<uint8_t> mChanged;
+		std::vector<SceneHandle> mSceneObjects;
+		std::vector<TransformNode> mIndexToNode;
+
+		// Indexed by TransformNode.
+		std::vector<uint32_t> mNodeToIndex;
+
+		// mLevelOffsets[d] is the sorted position of the first node at depth d.
+		std::vector<uint32_t> mLevelOffsets;
+		std::vector<Range> mChangedRanges;
+		bool mNeedsSort = false;
+	};
+}
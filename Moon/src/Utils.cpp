@@ -0,0 +1,58 @@
+#include "mnpch.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace Moon
+{
+	void CheckHResult(int32_t hr, const char* step)
+	{
+		if (hr < 0)
+		{
+			char code[16];
+			snprintf(code, sizeof(code), "%08X", (uint32_t)hr);
+			throw std::runtime_error(std::string(step) + " failed with 0x" + code);
+		}
+	}
+
+	std::vector<uint8_t> ReadFileBytes(const std::filesystem::path& path, size_t maxSize)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+			throw std::runtime_error("Unable to open " + path.string());
+
+		const size_t size = std::min((size_t)file.tellg(), maxSize);
+		std::vector<uint8_t> data(size);
+		file.seekg(0);
+		if (!file.read((char*)data.data(), (std::streamsize)size))
+			throw std::runtime_error("Unable to read " + path.string());
+		return data;
+	}
+
+	void WriteJSONString(std::ostream& out, const std::string& str)
+	{
+		out << '"';
+		for (char c : str)
+		{
+			if (c == '"' || c == '\\')
+				out << '\\' << c;
+			else if ((unsigned char)c < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04X", (unsigned char)c);
+				out << escaped;
+			}
+			else
+				out << c;
+		}
+		out << '"';
+	}
+
+	float ElapsedMS(uint64_t begin, uint64_t end)
+	{
+		return (float)((double)(end - begin) / 1000000.0);
+	}
+}
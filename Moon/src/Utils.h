@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	// Throws std::runtime_error "<step> failed with 0x<code>" when hr is a failure code. An int32_t rather than an HRESULT,
+	// so that the header builds without windows.h.
+	void CheckHResult(int32_t hr, const char* step);
+
+	// maxSize bytes at most. Throws std::runtime_error.
+	std::vector<uint8_t> ReadFileBytes(const std::filesystem::path& path, size_t maxSize = SIZE_MAX);
+
+	// Escapes quotes, backslashes and control characters.
+	void WriteJSONString(std::ostream& out, const std::string& str);
+
+	// Between two CpuProfiler::Now() stamps.
+	float ElapsedMS(uint64_t begin, uint64_t end);
+}
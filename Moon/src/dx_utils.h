@@ -21,24 +21,38 @@
 
 #include <comdef.h>
 
+#include "CpuProfiler.h"
+
+namespace Moon
+{
+	// Forwarded to the active GpuProfiler, if any.
+	void BeginGpuProfileScope(ID3D12GraphicsCommandList* cmdList, const char* name);
+	void EndGpuProfileScope(ID3D12GraphicsCommandList* cmdList);
+}
+
 #define BACKBUFFER_COUNT 2
 
 struct ScopedPerfMarker
 {
 	operator bool() { return true; }
 
+	// Also opens a CPU profiler zone and a GPU timestamp scope, the name must outlive the marker.
 	ScopedPerfMarker(ID3D12GraphicsCommandList* commandList, const char* name)
 		: mCommandList(commandList)
+		, mCpuZone(name)
 	{
 		PIXBeginEvent(commandList, 0, name);
+		Moon::BeginGpuProfileScope(commandList, name);
 	}
 
 	~ScopedPerfMarker()
 	{
+		Moon::EndGpuProfileScope(mCommandList);
 		PIXEndEvent(mCommandList);
 	}
 
 	ID3D12GraphicsCommandList* mCommandList;
+	Moon::ScopedCpuZone mCpuZone;
 };
 
 #define RENDER_PASS(name) \
@@ -124,6 +138,16 @@ public:
 		memcpy(&mMappedData[elementIndex * mElementByteSize], &data, sizeof(T));
 	}
 
+	BYTE* GetMappedData()const
+	{
+		return mMappedData;
+	}
+
+	UINT GetElementByteSize()const
+	{
+		return mElementByteSize;
+	}
+
 private:
 	Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
 	BYTE* mMappedData = nullptr;
@@ -1,20 +1,37 @@
 #include "Application.h"
+#include "Benchmark.h"
 #include "dx_utils.h"
 
+#include <iostream>
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance,
 	PSTR cmdLine, int showCmd)
 {
 	try
 	{
+		const Moon::BenchmarkOptions benchmark = Moon::BenchmarkOptions::Parse(cmdLine);
+		if (benchmark.Headless)
+		{
+			Moon::HeadlessBenchmark headless(benchmark);
+			return headless.Run() ? 0 : 1;
+		}
+
 		Moon::Application engine;
-		engine.Init();
-		engine.Run();
+		engine.Init(benchmark);
+		const int exitCode = engine.Run();
 		engine.Cleanup();
-		return 0;
+		return exitCode;
 	}
 	catch (DxException e)
 	{
 		MessageBox(nullptr, e.ToString().c_str(), L"DX12 Error", MB_OK);
 		return -1;
 	}
-}
\ No newline at end of file
+	catch (const std::runtime_error& e)
+	{
+		// No message box, a benchmark run from a script would wait on it forever.
+		std::cerr << e.what() << std::endl;
+		OutputDebugStringA(e.what());
+		return -1;
+	}
+}
@@ -18,6 +18,9 @@
 #include <utility>
 #include <vector>
 
+// The tools built for Linux share the platform independent modules.
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
 #define MN_BIND_EVENT_FN(x) [this](auto&&... args) -> decltype(auto) { return this->x(std::forward<decltype(args)>(args)...); }
@@ -0,0 +1,32 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// moonbenchmark [--frames N] [--warmup N] [--timestep S] [--objects N] [--camera-path FILE] [--output FILE]:
+// the headless benchmark of Moon --headless, without a window nor a device.
+int main(int argc, char** argv)
+{
+	std::string commandLine = "--headless";
+	for (int i = 1; i < argc; ++i)
+		commandLine += std::string(" \"") + argv[i] + "\"";
+
+	try
+	{
+		const Moon::BenchmarkOptions options = Moon::BenchmarkOptions::Parse(commandLine);
+		Moon::HeadlessBenchmark benchmark(options);
+		if (!benchmark.Run())
+		{
+			std::cerr << "Could not write " << options.OutputFile << std::endl;
+			return 1;
+		}
+		std::cout << "Report written to " << options.OutputFile << std::endl;
+		return 0;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
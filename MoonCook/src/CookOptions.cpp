@@ -0,0 +1,166 @@
+#include "CookOptions.h"
+
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace Moon
+{
+	namespace
+	{
+		struct CookFormat
+		{
+			const char* Name;
+			DXGI_FORMAT Format;
+			DXGI_FORMAT SrgbFormat;
+		};
+
+		const CookFormat CookFormats[] =
+		{
+			{ "bc1", DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC1_UNORM_SRGB },
+			{ "bc3", DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC3_UNORM_SRGB },
+			{ "bc4", DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_UNKNOWN },
+			{ "bc5", DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_UNKNOWN },
+			{ "bc6h", DXGI_FORMAT_BC6H_UF16, DXGI_FORMAT_UNKNOWN },
+			{ "bc7", DXGI_FORMAT_BC7_UNORM, DXGI_FORMAT_BC7_UNORM_SRGB },
+		};
+
+		uint32_t ParseCount(const std::string& option, const std::string& value, uint32_t minValue)
+		{
+			char* end = nullptr;
+			const unsigned long long count = strtoull(value.c_str(), &end, 10);
+			if (value.empty() || *end != '\0' || value[0] == '-' || count < minValue || count > UINT32_MAX)
+				throw std::runtime_error(option + " expects an integer >= " + std::to_string(minValue) + ", got \"" + value + "\"");
+			return (uint32_t)count;
+		}
+	}
+
+	CookOptions CookOptions::Parse(int argc, char** argv)
+	{
+		CookOptions options;
+		std::vector<std::string> positional;
+		std::vector<std::string> formats;
+		bool srgb = false;
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+			auto value = [&]() -> std::string
+			{
+				if (i + 1 >= argc)
+					throw std::runtime_error(arg + " expects a value");
+				return argv[++i];
+			};
+
+			if (arg == "--format")
+				formats.push_back(value());
+			else if (arg == "--srgb")
+				srgb = true;
+			else if (arg == "--encoder")
+			{
+				const std::string encoder = value();
+				if (encoder != "fast" && encoder != "reference")
+					throw std::runtime_error("--encoder expects fast or reference, got \"" + encoder + "\"");
+				options.Settings.FastEncoder = encoder == "fast";
+			}
+			else if (arg == "--rdo")
+			{
+				const std::string lambda = value();
+				char* end = nullptr;
+				options.Settings.RdoLambda = strtof(lambda.c_str(), &end);
+				if (lambda.empty() || *end != '\0' || !(options.Settings.RdoLambda >= 0.0f))
+					throw std::runtime_error("--rdo expects a lambda >= 0, got \"" + lambda + "\"");
+			}
+			else if (arg == "--lz")
+				options.Settings.Lz = true;
+			else if (arg == "--jobs")
+				options.Jobs = ParseCount(arg, value(), 1);
+			else if (arg == "--memory-mb")
+				options.MemoryBudget = (uint64_t)ParseCount(arg, value(), 1) << 20;
+			else if (arg == "--force")
+				options.Force = true;
+			else if (arg == "--cache")
+				options.CacheDir = value();
+			else if (arg == "--cache-mb")
+				options.CacheCapacity = (uint64_t)ParseCount(arg, value(), 1) << 20;
+			else if (arg == "--quality-report")
+				options.QualityReport = value();
+			else if (!arg.empty() && arg[0] == '-')
+				throw std::runtime_error("Unknown argument \"" + arg + "\"");
+			else
+				positional.push_back(arg);
+		}
+
+		if (options.QualityReport.empty())
+		{
+			if (positional.size() != 2)
+				throw std::runtime_error("Expected an input and an output directory");
+			options.InputDir = positional[0];
+			options.OutputDir = positional[1];
+		}
+		else
+		{
+			if (positional.size() != 1)
+				throw std::runtime_error("Expected an input directory alone with --quality-report");
+			options.InputDir = positional[0];
+		}
+
+		if (formats.empty())
+		{
+			for (const CookFormat& cookFormat : CookFormats)
+			{
+				if (!srgb || cookFormat.SrgbFormat != DXGI_FORMAT_UNKNOWN)
+					options.QualityFormats.push_back(srgb ? cookFormat.SrgbFormat : cookFormat.Format);
+			}
+			options.Settings.Format = srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+		}
+		for (const std::string& format : formats)
+		{
+			const CookFormat* cookFormat = nullptr;
+			for (const CookFormat& candidate : CookFormats)
+			{
+				if (format == candidate.Name)
+					cookFormat = &candidate;
+			}
+			if (!cookFormat)
+				throw std::runtime_error("Unknown format \"" + format + "\"");
+			if (srgb && cookFormat->SrgbFormat == DXGI_FORMAT_UNKNOWN)
+				throw std::runtime_error("--srgb does not apply to " + format);
+			options.Settings.Format = srgb ? cookFormat->SrgbFormat : cookFormat->Format;
+			options.QualityFormats.push_back(options.Settings.Format);
+		}
+
+		return options;
+	}
+
+	const char* CookOptions::GetUsage()
+	{
+		return
+			"mooncook <input dir> <output dir> [options]\n"
+			"Cooks the .dds, .tga and .hdr files of the input directory, recursively, to mipmapped BC compressed DDS files.\n"
+			"  --format bc1|bc3|bc4|bc5|bc6h|bc7  block format (bc7)\n"
+			"  --srgb                             sRGB variant of bc1, bc3 or bc7\n"
+			"  --encoder fast|reference           integer encoders or the reference ones (fast)\n"
+			"  --rdo LAMBDA                       rate-distortion optimization of the blocks, for --lz (0)\n"
+			"  --lz                               LZ compressed DDSZ files\n"
+			"  --jobs N                           files cooked at once (one per hardware thread)\n"
+			"  --memory-mb N                      memory budget of the files in flight (4096)\n"
+			"  --force                            cook up to date and cached files too\n"
+			"  --cache DIR                        derived data cache, shared with other cooks and the app (none)\n"
+			"  --cache-mb N                       size past which the least recently used cache entries go (10240)\n"
+			"mooncook <input dir> --quality-report FILE [--format F]... [--srgb] [--encoder fast|reference] [--rdo LAMBDA]\n"
+			"Compresses and decompresses the top mips of the input files in every format given (all of them by default), and writes\n"
+			"the PSNR and the encode and decode throughput of every file and format to FILE as JSON.\n";
+	}
+
+	std::string CookOptions::GetFormatName(DXGI_FORMAT format)
+	{
+		for (const CookFormat& cookFormat : CookFormats)
+		{
+			if (format == cookFormat.Format)
+				return cookFormat.Name;
+			if (format == cookFormat.SrgbFormat)
+				return std::string(cookFormat.Name) + "_srgb";
+		}
+		return std::to_string((uint32_t)format);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "TextureCook.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	struct CookOptions
+	{
+		std::filesystem::path InputDir;
+		std::filesystem::path OutputDir;
+		TextureCookSettings Settings;
+		// Files cooked at once, 0 for one per hardware thread.
+		uint32_t Jobs = 0;
+		// Files only start once their estimated working set fits next to the ones in flight. A file bigger than
+		// the whole budget waits until nothing else runs.
+		uint64_t MemoryBudget = 4096ull << 20;
+		// Cooks every input, up to date or cached or not.
+		bool Force = false;
+		// Derived data cache shared with other cooks and the app, none when empty.
+		std::filesystem::path CacheDir;
+		uint64_t CacheCapacity = 10240ull << 20;
+		// Compresses and decompresses the inputs instead of cooking them, and writes their PSNR and throughput there.
+		// No output directory then.
+		std::filesystem::path QualityReport;
+		// Of the quality report: every --format given, or every format when none is.
+		std::vector<DXGI_FORMAT> QualityFormats;
+
+		// "<input dir> <output dir> [--format bc1|bc3|bc4|bc5|bc6h|bc7] [--srgb] [--encoder fast|reference] [--rdo LAMBDA] [--lz]
+		// [--jobs N] [--memory-mb N] [--force] [--cache DIR] [--cache-mb N]" or "<input dir> --quality-report FILE [--format F]...
+		// [--srgb] [--encoder fast|reference] [--rdo LAMBDA]". The last --format given is the cooked one. Throws std::runtime_error on an unknown
+		// argument or a bad value.
+		static CookOptions Parse(int argc, char** argv);
+		static const char* GetUsage();
+		// "bc7", "bc7_srgb"...
+		static std::string GetFormatName(DXGI_FORMAT format);
+	};
+}
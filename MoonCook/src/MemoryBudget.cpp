@@ -0,0 +1,29 @@
+#include "MemoryBudget.h"
+
+#include <algorithm>
+
+namespace Moon
+{
+	void MemoryBudget::Acquire(uint64_t bytes)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mReleasedCV.wait(lock, [&]() { return mUsed == 0 || mUsed + bytes <= mCapacity; });
+		mUsed += bytes;
+		mPeak = std::max(mPeak, mUsed);
+	}
+
+	void MemoryBudget::Release(uint64_t bytes)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mUsed -= bytes;
+		}
+		mReleasedCV.notify_all();
+	}
+
+	uint64_t MemoryBudget::GetPeak() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mPeak;
+	}
+}
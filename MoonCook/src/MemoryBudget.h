@@ -0,0 +1,47 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace Moon
+{
+	// Bytes the files in flight may use together. Acquire() blocks until the request fits next to the bytes held,
+	// or until nothing is held at all, so that a request bigger than the budget still goes through, alone.
+	class MemoryBudget
+	{
+	public:
+		explicit MemoryBudget(uint64_t capacity) : mCapacity(capacity) {}
+
+		MemoryBudget(const MemoryBudget& rhs) = delete;
+		MemoryBudget& operator=(const MemoryBudget& rhs) = delete;
+
+		void Acquire(uint64_t bytes);
+		void Release(uint64_t bytes);
+
+		uint64_t GetCapacity() const { return mCapacity; }
+		// Most bytes held at once so far.
+		uint64_t GetPeak() const;
+
+		// Holds bytes of the budget for its lifetime.
+		class Scope
+		{
+		public:
+			Scope(MemoryBudget& budget, uint64_t bytes) : mBudget(budget), mBytes(bytes) { mBudget.Acquire(mBytes); }
+			~Scope() { mBudget.Release(mBytes); }
+
+			Scope(const Scope& rhs) = delete;
+			Scope& operator=(const Scope& rhs) = delete;
+
+		private:
+			MemoryBudget& mBudget;
+			uint64_t mBytes;
+		};
+
+	private:
+		const uint64_t mCapacity;
+		uint64_t mUsed = 0;
+		uint64_t mPeak = 0;
+		mutable std::mutex mMutex;
+		std::condition_variable mReleasedCV;
+	};
+}
@@ -0,0 +1,298 @@
+#include "QualityReport.h"
+#include "CpuProfiler.h"
+#include "TextureCook.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace DirectX;
+
+namespace Moon
+{
+	namespace
+	{
+		// Channels a format stores, counted from red, and the ComputeMSE flags that leave the others out.
+		uint32_t GetStoredChannels(DXGI_FORMAT format, CMSE_FLAGS& flags)
+		{
+			switch (format)
+			{
+			case DXGI_FORMAT_BC4_UNORM:
+				flags = CMSE_IGNORE_GREEN | CMSE_IGNORE_BLUE | CMSE_IGNORE_ALPHA;
+				return 1;
+			case DXGI_FORMAT_BC5_UNORM:
+				flags = CMSE_IGNORE_BLUE | CMSE_IGNORE_ALPHA;
+				return 2;
+			case DXGI_FORMAT_BC6H_UF16:
+				flags = CMSE_IGNORE_ALPHA;
+				return 3;
+			default:
+				flags = CMSE_DEFAULT;
+				return 4;
+			}
+		}
+
+		// Peak of 1, the top of the UNORM range. Lossless gives no finite value: null.
+		void WritePSNR(std::ostream& out, double mse)
+		{
+			if (mse > 0.0)
+				out << 10.0 * std::log10(1.0 / mse);
+			else
+				out << "null";
+		}
+
+		double MPixelsPerSecond(uint64_t pixels, double ms)
+		{
+			return ms > 0.0 ? (double)pixels / (ms * 1000.0) : 0.0;
+		}
+	}
+
+	QualityReporter::QualityReporter(const CookOptions& options)
+		: mOptions(options)
+	{
+	}
+
+	QualityStats QualityReporter::Run()
+	{
+		const uint64_t begin = CpuProfiler::Now();
+
+		QualityStats stats;
+		std::vector<FileResult> files;
+		for (const std::filesystem::path& source : CollectInputs())
+		{
+			FileResult file = MeasureFile(source);
+			std::string line = file.Name + ":";
+			for (const FormatResult& result : file.Formats)
+			{
+				char psnr[32];
+				if (result.Failed)
+					snprintf(psnr, sizeof(psnr), "failed");
+				else if (result.MSE > 0.0)
+					snprintf(psnr, sizeof(psnr), "%.2f dB", 10.0 * std::log10(1.0 / result.MSE));
+				else
+					snprintf(psnr, sizeof(psnr), "lossless");
+				line += " " + CookOptions::GetFormatName(result.Format) + " " + psnr;
+				if (result.Failed)
+					++stats.Failed;
+			}
+			std::cout << line << std::endl;
+
+			++stats.Files;
+			files.push_back(std::move(file));
+		}
+
+		if (mOptions.QualityReport.has_parent_path())
+			std::filesystem::create_directories(mOptions.QualityReport.parent_path());
+		std::ofstream out(mOptions.QualityReport, std::ios::trunc);
+		WriteReport(out, files);
+		if (!out)
+			throw std::runtime_error("Could not write " + mOptions.QualityReport.string());
+
+		stats.Seconds = ElapsedMS(begin, CpuProfiler::Now()) / 1000.0;
+		return stats;
+	}
+
+	std::vector<std::filesystem::path> QualityReporter::CollectInputs() const
+	{
+		std::vector<std::filesystem::path> inputs;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(mOptions.InputDir))
+		{
+			if (entry.is_regular_file() && IsCookableTexture(entry.path()))
+				inputs.push_back(entry.path());
+		}
+		std::sort(inputs.begin(), inputs.end());
+		return inputs;
+	}
+
+	QualityReporter::FileResult QualityReporter::MeasureFile(const std::filesystem::path& source)
+	{
+		FileResult file;
+		file.Name = source.lexically_relative(mOptions.InputDir).generic_string();
+
+		std::vector<uint8_t> data;
+		try
+		{
+			data = ReadFileBytes(source);
+			TexMetadata metadata;
+			CheckHResult(GetTextureSourceMetadata(source, data.data(), data.size(), metadata), "GetTextureSourceMetadata");
+			file.Width = (uint32_t)metadata.width;
+			file.Height = (uint32_t)metadata.height;
+			file.Pixels = (uint64_t)metadata.width * metadata.height * metadata.depth * metadata.arraySize;
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << file.Name << ": " << e.what() << std::endl;
+			data.clear();
+		}
+
+		for (DXGI_FORMAT format : mOptions.QualityFormats)
+		{
+			if (data.empty())
+			{
+				FormatResult result;
+				result.Format = format;
+				result.Failed = true;
+				file.Formats.push_back(result);
+				continue;
+			}
+
+			try
+			{
+				file.Formats.push_back(MeasureFormat(source, data, format));
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << file.Name << " (" << CookOptions::GetFormatName(format) << "): " << e.what() << std::endl;
+				FormatResult result;
+				result.Format = format;
+				result.Failed = true;
+				file.Formats.push_back(result);
+			}
+		}
+		return file;
+	}
+
+	QualityReporter::FormatResult QualityReporter::MeasureFormat(const std::filesystem::path& source, const std::vector<uint8_t>& data,
+		DXGI_FORMAT format) const
+	{
+		TextureCookSettings settings = mOptions.Settings;
+		settings.Format = format;
+
+		ScratchImage image = LoadTextureSource(source, data.data(), data.size(), settings, true);
+
+		// The top mip of every array slice, or every slice of the top mip of a volume: a chain the source came with
+		// would weigh its small mips in otherwise.
+		TexMetadata top = image.GetMetadata();
+		const size_t count = top.dimension == TEX_DIMENSION_TEXTURE3D ? top.depth : top.arraySize;
+		std::vector<Image> images;
+		for (size_t index = 0; index < count; ++index)
+		{
+			const Image* img = top.dimension == TEX_DIMENSION_TEXTURE3D ? image.GetImage(0, 0, index) : image.GetImage(0, index, 0);
+			if (!img)
+				throw std::runtime_error("Missing top mip image");
+			images.push_back(*img);
+		}
+		top.mipLevels = 1;
+
+		FormatResult result;
+		result.Format = format;
+
+		const TEX_COMPRESS_FLAGS compress = settings.GetCompressFlags() | TEX_COMPRESS_PARALLEL;
+		ScratchImage compressed;
+		const uint64_t encodeBegin = CpuProfiler::Now();
+		CheckHResult(Compress(images.data(), images.size(), top, format, compress, TEX_THRESHOLD_DEFAULT, compressed), "Compress");
+		if (settings.RdoLambda > 0.0f)
+			CheckHResult(RateDistortionOptimize(images.data(), compressed.GetImages(), images.size(), compress, settings.RdoLambda), "RateDistortionOptimize");
+		result.EncodeMS = ElapsedMS(encodeBegin, CpuProfiler::Now());
+
+		ScratchImage decompressed;
+		const uint64_t decodeBegin = CpuProfiler::Now();
+		CheckHResult(Decompress(compressed.GetImages(), compressed.GetImageCount(), compressed.GetMetadata(), top.format, TEX_FILTER_PARALLEL,
+			decompressed), "Decompress");
+		result.DecodeMS = ElapsedMS(decodeBegin, CpuProfiler::Now());
+
+		CMSE_FLAGS flags;
+		const uint32_t channels = GetStoredChannels(format, flags);
+		double sum = 0.0;
+		uint64_t pixels = 0;
+		for (size_t index = 0; index < images.size(); ++index)
+		{
+			float mse = 0.0f;
+			CheckHResult(ComputeMSE(images[index], decompressed.GetImages()[index], mse, nullptr, flags | CMSE_PARALLEL), "ComputeMSE");
+			const uint64_t imagePixels = (uint64_t)images[index].width * images[index].height;
+			sum += (double)mse * (double)imagePixels;
+			pixels += imagePixels;
+		}
+		result.MSE = pixels ? sum / (double)pixels / channels : 0.0;
+		return result;
+	}
+
+	void QualityReporter::WriteReport(std::ostream& out, const std::vector<FileResult>& files) const
+	{
+		out << "{\n";
+		out << "  \"encoder\": \"" << (mOptions.Settings.FastEncoder ? "fast" : "reference") << "\",\n";
+		out << "  \"rdo_lambda\": " << mOptions.Settings.RdoLambda << ",\n";
+		out << "  \"threads\": " << std::max(1u, std::thread::hardware_concurrency()) << ",\n";
+
+		// Every file weighs its pixels in the corpus PSNR and throughput, the worst file shows a regression a large one hides.
+		out << "  \"formats\": [";
+		for (size_t f = 0; f < mOptions.QualityFormats.size(); ++f)
+		{
+			uint32_t measured = 0;
+			uint32_t failed = 0;
+			double weightedMSE = 0.0;
+			uint64_t pixels = 0;
+			double encodeMS = 0.0;
+			double decodeMS = 0.0;
+			const FileResult* worst = nullptr;
+			for (const FileResult& file : files)
+			{
+				const FormatResult& result = file.Formats[f];
+				if (result.Failed)
+				{
+					++failed;
+					continue;
+				}
+				++measured;
+				weightedMSE += result.MSE * (double)file.Pixels;
+				pixels += file.Pixels;
+				encodeMS += result.EncodeMS;
+				decodeMS += result.DecodeMS;
+				if (!worst || result.MSE > worst->Formats[f].MSE)
+					worst = &file;
+			}
+
+			out << (f ? "," : "") << "\n    {\"format\": \"" << CookOptions::GetFormatName(mOptions.QualityFormats[f]) << "\""
+				<< ", \"files\": " << measured << ", \"failed\": " << failed << ", \"psnr_db\": ";
+			if (pixels)
+				WritePSNR(out, weightedMSE / (double)pixels);
+			else
+				out << "null";
+			out << ", \"worst_psnr_db\": ";
+			if (worst)
+				WritePSNR(out, worst->Formats[f].MSE);
+			else
+				out << "null";
+			out << ", \"worst_file\": ";
+			if (worst)
+				WriteJSONString(out, worst->Name);
+			else
+				out << "null";
+			out << ", \"encode_mpixels_per_second\": " << MPixelsPerSecond(pixels, encodeMS)
+				<< ", \"decode_mpixels_per_second\": " << MPixelsPerSecond(pixels, decodeMS) << "}";
+		}
+		out << "\n  ],\n";
+
+		out << "  \"files\": [";
+		for (size_t i = 0; i < files.size(); ++i)
+		{
+			const FileResult& file = files[i];
+			out << (i ? "," : "") << "\n    {\"name\": ";
+			WriteJSONString(out, file.Name);
+			out << ", \"width\": " << file.Width << ", \"height\": " << file.Height << ", \"pixels\": " << file.Pixels << ", \"results\": [";
+			for (size_t f = 0; f < file.Formats.size(); ++f)
+			{
+				const FormatResult& result = file.Formats[f];
+				out << (f ? ", " : "") << "{\"format\": \"" << CookOptions::GetFormatName(result.Format) << "\"";
+				if (result.Failed)
+				{
+					out << ", \"failed\": true}";
+					continue;
+				}
+				out << ", \"psnr_db\": ";
+				WritePSNR(out, result.MSE);
+				out << ", \"rmse\": " << std::sqrt(result.MSE)
+					<< ", \"encode_ms\": " << result.EncodeMS << ", \"decode_ms\": " << result.DecodeMS
+					<< ", \"encode_mpixels_per_second\": " << MPixelsPerSecond(file.Pixels, result.EncodeMS)
+					<< ", \"decode_mpixels_per_second\": " << MPixelsPerSecond(file.Pixels, result.DecodeMS) << "}";
+			}
+			out << "]}";
+		}
+		out << "\n  ]\n}\n";
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "CookOptions.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Moon
+{
+	struct QualityStats
+	{
+		uint32_t Files = 0;
+		// File and format pairs that failed to load, compress or decompress.
+		uint32_t Failed = 0;
+		double Seconds = 0.0;
+	};
+
+	// Image quality regression report of a corpus: the top mips of every input, loaded like CookTexture() loads them,
+	// are compressed in every format, decompressed and compared to what they were encoded from. The blocks do not depend
+	// on the thread count, so two runs on the same corpus, encoder and library give the same PSNRs and any change is a
+	// change of quality. Compress, Decompress and ComputeMSE all run on every core, one file at a time, to time them.
+	class QualityReporter
+	{
+	public:
+		explicit QualityReporter(const CookOptions& options);
+
+		// A file that fails is reported and counted, the others go on. Throws std::runtime_error when the input
+		// directory can not be listed or the report can not be written.
+		QualityStats Run();
+
+	private:
+		struct FormatResult
+		{
+			DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+			bool Failed = false;
+			// Over the channels the format stores, of values in [0, 1] for the UNORM formats, in linear light for the sRGB ones.
+			double MSE = 0.0;
+			double EncodeMS = 0.0;
+			double DecodeMS = 0.0;
+		};
+
+		struct FileResult
+		{
+			// Relative to the input directory, '/' separated.
+			std::string Name;
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			// Of the top mip of every array slice, or of every slice of a volume.
+			uint64_t Pixels = 0;
+			std::vector<FormatResult> Formats;
+		};
+
+		// Sorted by name, two reports of the same corpus list the files in the same order.
+		std::vector<std::filesystem::path> CollectInputs() const;
+		FileResult MeasureFile(const std::filesystem::path& source);
+		FormatResult MeasureFormat(const std::filesystem::path& source, const std::vector<uint8_t>& data, DXGI_FORMAT format) const;
+		void WriteReport(std::ostream& out, const std::vector<FileResult>& files) const;
+
+		const CookOptions mOptions;
+	};
+}
@@ -0,0 +1,274 @@
+#include "TextureCooker.h"
+#include "ContentHash.h"
+#include "JobSystem.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace Moon
+{
+	namespace
+	{
+		// Enough for the headers of DDS, TGA and HDR files, all the memory estimate of a file needs.
+		constexpr size_t HeaderProbeSize = 64 * 1024;
+
+		// Formats only WIC reads, worth a warning rather than silence.
+		bool NeedsWIC(const std::filesystem::path& path)
+		{
+			std::string extension = path.extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+			return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp"
+				|| extension == ".tif" || extension == ".tiff";
+		}
+
+		// Through a temporary file renamed over path, so that an interrupted cook never leaves half a file behind.
+		void WriteFileAtomic(const std::filesystem::path& path, const void* data, size_t size)
+		{
+			static std::atomic<uint32_t> sTempIndex{ 0 };
+
+			if (path.has_parent_path())
+				std::filesystem::create_directories(path.parent_path());
+			std::filesystem::path temp = path;
+			temp += ".tmp" + std::to_string(sTempIndex.fetch_add(1));
+			{
+				std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+				file.write((const char*)data, (std::streamsize)size);
+				if (!file)
+					throw std::runtime_error("Could not write " + temp.string());
+			}
+
+			std::error_code error;
+			std::filesystem::rename(temp, path, error);
+			if (error)
+			{
+				std::filesystem::remove(temp, error);
+				throw std::runtime_error("Could not replace " + path.string());
+			}
+		}
+
+		// Counts the files past their up to date and cache checks.
+		class ActiveCook
+		{
+		public:
+			explicit ActiveCook(std::atomic<uint32_t>& count) : mCount(count) { mCount.fetch_add(1); }
+			~ActiveCook() { mCount.fetch_sub(1); }
+
+			ActiveCook(const ActiveCook& rhs) = delete;
+			ActiveCook& operator=(const ActiveCook& rhs) = delete;
+
+		private:
+			std::atomic<uint32_t>& mCount;
+		};
+	}
+
+	TextureCooker::TextureCooker(const CookOptions& options)
+		: mOptions(options), mBudget(options.MemoryBudget)
+	{
+		if (!mOptions.CacheDir.empty())
+		{
+			mCache = std::make_unique<DerivedDataCache>(mOptions.CacheDir, mOptions.CacheCapacity);
+			if (!mCache->IsEnabled())
+				throw std::runtime_error("Could not create the cache directory " + mOptions.CacheDir.string());
+		}
+	}
+
+	CookStats TextureCooker::Run()
+	{
+		const auto begin = std::chrono::steady_clock::now();
+
+		LoadManifest();
+		const std::vector<CookInput> inputs = CollectInputs();
+		std::vector<CookResult> results(inputs.size());
+
+		auto cook = [&](size_t index)
+		{
+			const CookInput& input = inputs[index];
+			try
+			{
+				results[index] = CookFile(input);
+			}
+			catch (const std::exception& e)
+			{
+				results[index].Status = CookStatus::Failed;
+				Log("Failed " + input.Name + ": " + e.what(), true);
+			}
+		};
+
+		const uint32_t jobs = mOptions.Jobs ? mOptions.Jobs : std::max(std::thread::hardware_concurrency(), 1u);
+		if (jobs == 1 || inputs.size() < 2)
+		{
+			for (size_t i = 0; i < inputs.size(); ++i)
+				cook(i);
+		}
+		else
+		{
+			// The calling thread cooks too while it waits.
+			JobSystem jobSystem(std::min<uint32_t>(jobs, (uint32_t)inputs.size()) - 1);
+			JobGroup group;
+			for (size_t i = 0; i < inputs.size(); ++i)
+				jobSystem.Run(group, [&cook, i]() { cook(i); });
+			jobSystem.Wait(group);
+		}
+
+		SaveManifest(inputs, results);
+
+		CookStats stats;
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			switch (results[i].Status)
+			{
+			case CookStatus::Failed:
+				++stats.Failed;
+				break;
+			case CookStatus::Cooked:
+			case CookStatus::Fetched:
+				++(results[i].Status == CookStatus::Cooked ? stats.Cooked : stats.Fetched);
+				stats.InputBytes += inputs[i].Size;
+				stats.OutputBytes += results[i].OutputBytes;
+				break;
+			case CookStatus::UpToDate:
+				++stats.UpToDate;
+				break;
+			}
+		}
+		stats.PeakMemory = mBudget.GetPeak();
+		stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		return stats;
+	}
+
+	std::vector<TextureCooker::CookInput> TextureCooker::CollectInputs() const
+	{
+		namespace fs = std::filesystem;
+
+		// The outputs of an output directory inside the input one are not inputs.
+		const fs::path outputDir = fs::weakly_canonical(mOptions.OutputDir);
+		std::vector<CookInput> inputs;
+		std::unordered_map<std::string, std::string> outputNames;
+		for (const fs::directory_entry& entry : fs::recursive_directory_iterator(mOptions.InputDir))
+		{
+			if (!entry.is_regular_file())
+				continue;
+
+			const fs::path relativeToOutput = fs::weakly_canonical(entry.path()).lexically_relative(outputDir);
+			if (!relativeToOutput.empty() && *relativeToOutput.begin() != "..")
+				continue;
+
+			const fs::path relative = entry.path().lexically_relative(mOptions.InputDir);
+			if (!IsCookableTexture(entry.path()))
+			{
+				if (NeedsWIC(entry.path()))
+					std::cerr << "Skipped " << relative.generic_string() << ": only WIC reads it, convert it to TGA" << std::endl;
+				continue;
+			}
+
+			CookInput input;
+			input.Source = entry.path();
+			input.Name = relative.generic_string();
+			input.Output = mOptions.OutputDir / fs::path(relative).replace_extension(".dds");
+			input.Size = entry.file_size();
+
+			const auto inserted = outputNames.emplace(input.Output.generic_string(), input.Name);
+			if (!inserted.second)
+				throw std::runtime_error(input.Name + " and " + inserted.first->second + " would both cook to " + input.Output.string());
+
+			inputs.push_back(std::move(input));
+		}
+
+		std::stable_sort(inputs.begin(), inputs.end(), [](const CookInput& a, const CookInput& b) { return a.Size > b.Size; });
+		return inputs;
+	}
+
+	void TextureCooker::LoadManifest()
+	{
+		// One "<hash> <name>" line per output, a missing manifest just cooks everything.
+		std::ifstream file(mOptions.OutputDir / ManifestFileName);
+		std::string line;
+		while (std::getline(file, line))
+		{
+			uint64_t hash;
+			if (line.size() > 17 && line[16] == ' ' && ParseContentHash(line.substr(0, 16), hash))
+				mManifest[line.substr(17)] = hash;
+		}
+	}
+
+	void TextureCooker::SaveManifest(const std::vector<CookInput>& inputs, const std::vector<CookResult>& results) const
+	{
+		// Failed files are left out, so that the next run tries them again, and so are the inputs that are gone.
+		std::vector<std::string> lines;
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			if (results[i].Status != CookStatus::Failed)
+				lines.push_back(FormatContentHash(results[i].Hash) + " " + inputs[i].Name + "\n");
+		}
+		std::sort(lines.begin(), lines.end(), [](const std::string& a, const std::string& b) { return a.compare(17, std::string::npos, b, 17, std::string::npos) < 0; });
+
+		std::string manifest;
+		for (const std::string& line : lines)
+			manifest += line;
+		WriteFileAtomic(mOptions.OutputDir / ManifestFileName, manifest.data(), manifest.size());
+	}
+
+	TextureCooker::CookResult TextureCooker::CookFile(const CookInput& input)
+	{
+		// A header the loaders reject leaves the estimate at the file size, cooking reports the error.
+		uint64_t estimate = input.Size;
+		const std::vector<uint8_t> header = ReadFileBytes(input.Source, HeaderProbeSize);
+		DirectX::TexMetadata metadata;
+		if (SUCCEEDED(GetTextureSourceMetadata(input.Source, header.data(), header.size(), metadata)))
+			estimate += EstimateTextureCookMemory(metadata, mOptions.Settings);
+		MemoryBudget::Scope memory(mBudget, estimate);
+
+		const std::vector<uint8_t> source = ReadFileBytes(input.Source);
+		CookResult result;
+		result.Hash = GetTextureCookKey(source.data(), source.size(), mOptions.Settings);
+		if (!mOptions.Force)
+		{
+			const auto previous = mManifest.find(input.Name);
+			std::error_code error;
+			if (previous != mManifest.end() && previous->second == result.Hash && std::filesystem::exists(input.Output, error))
+			{
+				result.Status = CookStatus::UpToDate;
+				return result;
+			}
+
+			std::vector<uint8_t> cached;
+			if (mCache && mCache->Get(result.Hash, "dds", cached))
+			{
+				WriteFileAtomic(input.Output, cached.data(), cached.size());
+				result.Status = CookStatus::Fetched;
+				result.OutputBytes = cached.size();
+				Log("Fetched " + input.Name);
+				return result;
+			}
+		}
+
+		ActiveCook active(mActiveCooks);
+		const auto begin = std::chrono::steady_clock::now();
+
+		DirectX::TexMetadata cooked;
+		const std::vector<uint8_t> file = CookTexture(input.Source, source.data(), source.size(), mOptions.Settings, IsCookingAlone(), &cooked);
+		WriteFileAtomic(input.Output, file.data(), file.size());
+		if (mCache)
+			mCache->Put(result.Hash, "dds", file.data(), file.size());
+
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		Log("Cooked " + input.Name + " " + std::to_string(cooked.width) + "x" + std::to_string(cooked.height)
+			+ ", " + std::to_string(cooked.mipLevels) + " mips, " + std::to_string((uint64_t)ms) + " ms");
+
+		result.Status = CookStatus::Cooked;
+		result.OutputBytes = file.size();
+		return result;
+	}
+
+	void TextureCooker::Log(const std::string& line, bool error)
+	{
+		std::lock_guard<std::mutex> lock(mLogMutex);
+		(error ? std::cerr : std::cout) << line << std::endl;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "CookOptions.h"
+#include "DerivedDataCache.h"
+#include "MemoryBudget.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Moon
+{
+	struct CookStats
+	{
+		uint32_t Cooked = 0;
+		// Copied from the derived data cache.
+		uint32_t Fetched = 0;
+		uint32_t UpToDate = 0;
+		uint32_t Failed = 0;
+		// Of the cooked and fetched files.
+		uint64_t InputBytes = 0;
+		uint64_t OutputBytes = 0;
+		// Most memory budget in use at once.
+		uint64_t PeakMemory = 0;
+		double Seconds = 0.0;
+	};
+
+	// Cooks the source images of a directory to mipmapped, BC compressed DDS files with CookTexture(), many files at once.
+	// The output directory keeps a manifest of the derived data key every output was cooked from: an input whose bytes and
+	// settings still hash to it is skipped, as long as its output is there. Other inputs are copied from the derived data
+	// cache when it has their key, and stored there once cooked.
+	class TextureCooker
+	{
+	public:
+		static constexpr const char* ManifestFileName = "mooncook.manifest";
+
+		explicit TextureCooker(const CookOptions& options);
+
+		// A file that fails to cook is reported and counted, the others go on. Throws std::runtime_error when
+		// the input directory can not be listed or the manifest can not be written.
+		CookStats Run();
+
+	private:
+		struct CookInput
+		{
+			std::filesystem::path Source;
+			// Relative to the input directory, '/' separated: the manifest key.
+			std::string Name;
+			std::filesystem::path Output;
+			uint64_t Size = 0;
+		};
+
+		enum class CookStatus { Failed, Cooked, Fetched, UpToDate };
+
+		struct CookResult
+		{
+			CookStatus Status = CookStatus::Failed;
+			uint64_t Hash = 0;
+			uint64_t OutputBytes = 0;
+		};
+
+		// Largest files first, they set how long the batch takes.
+		std::vector<CookInput> CollectInputs() const;
+		void LoadManifest();
+		void SaveManifest(const std::vector<CookInput>& inputs, const std::vector<CookResult>& results) const;
+
+		// Throws std::runtime_error.
+		CookResult CookFile(const CookInput& input);
+		// A file cooking alone spreads its mips and blocks over DirectXTex's own threads: the last files of a batch,
+		// or the one file an incremental cook has to redo, would leave the other cores idle otherwise.
+		bool IsCookingAlone() const { return mActiveCooks.load() == 1; }
+		void Log(const std::string& line, bool error = false);
+
+		const CookOptions mOptions;
+		MemoryBudget mBudget;
+		std::unique_ptr<DerivedDataCache> mCache;
+		// Read only once the files start cooking.
+		std::unordered_map<std::string, uint64_t> mManifest;
+		std::atomic<uint32_t> mActiveCooks{ 0 };
+		std::mutex mLogMutex;
+	};
+}
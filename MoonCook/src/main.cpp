@@ -0,0 +1,52 @@
+#include "CookOptions.h"
+#include "QualityReport.h"
+#include "TextureCooker.h"
+
+#include <iostream>
+#include <stdexcept>
+
+int main(int argc, char** argv)
+{
+	Moon::CookOptions options;
+	try
+	{
+		options = Moon::CookOptions::Parse(argc, argv);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << "\n\n" << Moon::CookOptions::GetUsage();
+		return 2;
+	}
+
+	if (!options.QualityReport.empty())
+	{
+		try
+		{
+			Moon::QualityReporter reporter(options);
+			const Moon::QualityStats stats = reporter.Run();
+			std::cout << stats.Files << " files, " << options.QualityFormats.size() << " formats, " << stats.Failed << " failed in "
+				<< stats.Seconds << " s, report written to " << options.QualityReport.string() << std::endl;
+			return stats.Failed ? 1 : 0;
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		Moon::TextureCooker cooker(options);
+		const Moon::CookStats stats = cooker.Run();
+		std::cout << stats.Cooked << " cooked, " << stats.Fetched << " fetched, " << stats.UpToDate << " up to date, " << stats.Failed << " failed in "
+			<< stats.Seconds << " s (" << (stats.InputBytes >> 20) << " MB in, " << (stats.OutputBytes >> 20) << " MB out, "
+			<< (stats.PeakMemory >> 20) << " MB peak budget)" << std::endl;
+		return stats.Failed ? 1 : 0;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,59 @@
+#include "TestFramework.h"
+#include "BCTestBlocks.h"
+
+#include <cfloat>
+
+using namespace DirectX;
+using namespace Moon;
+
+namespace
+{
+	// Fastest to best quality.
+	const uint32_t BC7Profiles[] = { BC_FLAGS_BC7_ULTRAFAST, BC_FLAGS_BC7_FAST, BC_FLAGS_BC7_BASIC, BC_FLAGS_BC7_SLOW };
+
+	std::vector<XMFLOAT4> RoundTripBC7(const std::vector<XMFLOAT4>& source, uint32_t profile)
+	{
+		std::vector<XMFLOAT4> decoded(source.size());
+		for (size_t i = 0; i < source.size(); i += NUM_PIXELS_PER_BLOCK)
+		{
+			XMVECTOR texels[NUM_PIXELS_PER_BLOCK];
+			uint8_t block[16];
+			LoadTestBlock(&source[i], texels);
+			D3DXEncodeBC7Fast(block, texels, profile);
+			D3DXDecodeBC7(texels, block);
+			StoreTestBlock(texels, &decoded[i]);
+		}
+		return decoded;
+	}
+}
+
+MN_TEST(BC7FastProfilesRoundTrip)
+{
+	const std::vector<XMFLOAT4> source = MakeTestBlocks(1234);
+	double previous = DBL_MAX;
+	for (uint32_t profile : BC7Profiles)
+	{
+		// 3.6 for ultrafast down to 3.4 for slow, about the noise of the blocks.
+		const double rmse = ComputeBlockRMSE(source, RoundTripBC7(source, profile), 4);
+		MN_CHECK(rmse < 4.5);
+		MN_CHECK(rmse <= previous);
+		previous = rmse;
+	}
+}
+
+MN_TEST(BC7FastKeepsOpaqueBlocksOpaque)
+{
+	std::vector<XMFLOAT4> source = MakeTestBlocks(5678);
+	for (XMFLOAT4& texel : source)
+		texel.w = 1.0f;
+
+	for (uint32_t profile : BC7Profiles)
+	{
+		const std::vector<XMFLOAT4> decoded = RoundTripBC7(source, profile);
+
+		// Mode 6 stores alpha with the p-bits of the colors, a cleared one decodes 254.
+		for (const XMFLOAT4& texel : decoded)
+			MN_CHECK(texel.w > 254.5f / 255.0f);
+		MN_CHECK(ComputeBlockRMSE(source, decoded, 3) < 4.5);
+	}
+}
@@ -0,0 +1,103 @@
+#include "TestFramework.h"
+#include "BCTestBlocks.h"
+
+using namespace DirectX;
+using namespace Moon;
+
+namespace
+{
+	typedef void (*EncodeFunc)(uint8_t* pBC, const XMVECTOR* pColor, uint32_t flags);
+	typedef void (*DecodeFunc)(XMVECTOR* pColor, const uint8_t* pBC);
+
+	std::vector<XMFLOAT4> RoundTrip(const std::vector<XMFLOAT4>& source, EncodeFunc encode, DecodeFunc decode, uint32_t flags)
+	{
+		std::vector<XMFLOAT4> decoded(source.size());
+		for (size_t i = 0; i < source.size(); i += NUM_PIXELS_PER_BLOCK)
+		{
+			XMVECTOR texels[NUM_PIXELS_PER_BLOCK];
+			uint8_t block[16];
+			LoadTestBlock(&source[i], texels);
+			encode(block, texels, flags);
+			decode(texels, block);
+			StoreTestBlock(texels, &decoded[i]);
+		}
+		return decoded;
+	}
+
+	// Without and with BC_FLAGS_FAST_REFINE, the refit may only make things better.
+	void CheckRoundTrip(EncodeFunc encode, DecodeFunc decode, uint32_t channels, double maxRMSE, double maxRefinedRMSE)
+	{
+		const std::vector<XMFLOAT4> source = MakeTestBlocks(1234);
+		const double rmse = ComputeBlockRMSE(source, RoundTrip(source, encode, decode, BC_FLAGS_NONE), channels);
+		const double refinedRMSE = ComputeBlockRMSE(source, RoundTrip(source, encode, decode, BC_FLAGS_FAST_REFINE), channels);
+		MN_CHECK(rmse < maxRMSE);
+		MN_CHECK(refinedRMSE < maxRefinedRMSE);
+		MN_CHECK(refinedRMSE <= rmse);
+	}
+
+	void EncodeBC1Opaque(uint8_t* pBC, const XMVECTOR* pColor, uint32_t flags)
+	{
+		D3DXEncodeBC1Fast(pBC, pColor, 0.0f, flags);
+	}
+
+	void EncodeBC1Threshold(uint8_t* pBC, const XMVECTOR* pColor, uint32_t flags)
+	{
+		D3DXEncodeBC1Fast(pBC, pColor, 0.5f, flags);
+	}
+}
+
+// The bounds are about 1.25 times the RMSE measured without and with the refit, in 8-bit steps.
+MN_TEST(BC1FastRoundTrip)
+{
+	// 11.3 and 8.6, 4 colors on a line for blocks with noise in every channel.
+	CheckRoundTrip(EncodeBC1Opaque, D3DXDecodeBC1, 3, 14.0, 11.0);
+
+	// No threshold, so the 4 color blocks, opaque whatever the source alpha.
+	const std::vector<XMFLOAT4> source = MakeTestBlocks(1234);
+	for (const XMFLOAT4& texel : RoundTrip(source, EncodeBC1Opaque, D3DXDecodeBC1, BC_FLAGS_NONE))
+		MN_CHECK(texel.w > 0.5f);
+}
+
+MN_TEST(BC1FastAlphaThreshold)
+{
+	const std::vector<XMFLOAT4> source = MakeTestBlocks(1234);
+	for (uint32_t flags : { (uint32_t)BC_FLAGS_NONE, (uint32_t)BC_FLAGS_FAST_REFINE })
+	{
+		const std::vector<XMFLOAT4> decoded = RoundTrip(source, EncodeBC1Threshold, D3DXDecodeBC1, flags);
+
+		// Texels under the threshold, and only them, decode transparent; the others keep their colors.
+		std::vector<XMFLOAT4> opaqueSource, opaqueDecoded;
+		for (size_t i = 0; i < source.size(); ++i)
+		{
+			const bool transparent = source[i].w < 0.5f;
+			MN_CHECK(transparent == (decoded[i].w < 0.5f));
+			if (!transparent)
+			{
+				opaqueSource.push_back(source[i]);
+				opaqueDecoded.push_back(decoded[i]);
+			}
+		}
+		MN_CHECK(!opaqueSource.empty() && opaqueSource.size() < source.size());
+
+		// 9.7 and 7.6, the 3 color blocks have one less color to share.
+		MN_CHECK(ComputeBlockRMSE(opaqueSource, opaqueDecoded, 3) < (flags ? 10.0 : 12.0));
+	}
+}
+
+MN_TEST(BC3FastRoundTrip)
+{
+	// 10.1 and 7.7, BC1 colors and BC4 alpha.
+	CheckRoundTrip(D3DXEncodeBC3Fast, D3DXDecodeBC3, 4, 13.0, 10.0);
+}
+
+MN_TEST(BC4UFastRoundTrip)
+{
+	// 4.2 and 3.6.
+	CheckRoundTrip(D3DXEncodeBC4UFast, D3DXDecodeBC4U, 1, 5.5, 4.5);
+}
+
+MN_TEST(BC5UFastRoundTrip)
+{
+	// 4.1 and 3.5.
+	CheckRoundTrip(D3DXEncodeBC5UFast, D3DXDecodeBC5U, 2, 5.5, 4.5);
+}
@@ -0,0 +1,62 @@
+#include "BCTestBlocks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace Moon
+{
+	std::vector<DirectX::XMFLOAT4> MakeTestBlocks(uint32_t seed)
+	{
+		// The raw engine output, the distributions of <random> differ between standard libraries.
+		std::mt19937 random(seed);
+		std::vector<DirectX::XMFLOAT4> texels(TestBlockCount * NUM_PIXELS_PER_BLOCK);
+		for (size_t block = 0; block < TestBlockCount; ++block)
+		{
+			int from[4], to[4];
+			for (uint32_t ch = 0; ch < 4; ++ch)
+			{
+				from[ch] = (int)(random() & 255);
+				to[ch] = (int)(random() & 255);
+			}
+
+			for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+			{
+				// 0 to 6 along the diagonal of the block.
+				const int step = (int)((i & 3) + (i >> 2));
+				float* value = &texels[block * NUM_PIXELS_PER_BLOCK + i].x;
+				for (uint32_t ch = 0; ch < 4; ++ch)
+				{
+					const int noisy = (from[ch] * (6 - step) + to[ch] * step + 3) / 6 + (int)(random() % 13) - 6;
+					value[ch] = (float)std::clamp(noisy, 0, 255) / 255.0f;
+				}
+			}
+		}
+		return texels;
+	}
+
+	void LoadTestBlock(const DirectX::XMFLOAT4* texels, DirectX::XMVECTOR* block)
+	{
+		for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+			block[i] = DirectX::XMLoadFloat4(&texels[i]);
+	}
+
+	void StoreTestBlock(const DirectX::XMVECTOR* block, DirectX::XMFLOAT4* texels)
+	{
+		for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+			DirectX::XMStoreFloat4(&texels[i], block[i]);
+	}
+
+	double ComputeBlockRMSE(const std::vector<DirectX::XMFLOAT4>& source, const std::vector<DirectX::XMFLOAT4>& decoded, uint32_t channels)
+	{
+		double squares = 0.0;
+		for (size_t i = 0; i < source.size(); ++i)
+		{
+			const float* a = &source[i].x;
+			const float* b = &decoded[i].x;
+			for (uint32_t ch = 0; ch < channels; ++ch)
+				squares += ((double)a[ch] - b[ch]) * ((double)a[ch] - b[ch]);
+		}
+		return 255.0 * std::sqrt(squares / ((double)source.size() * channels));
+	}
+}
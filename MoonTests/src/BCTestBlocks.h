@@ -0,0 +1,20 @@
+#pragma once
+#include "DirectXTex/DirectXTexP.h"
+#include "DirectXTex/BC.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Moon
+{
+	constexpr size_t TestBlockCount = 256;
+
+	// TestBlockCount blocks of 16 texels, row by row: a gradient between two random RGBA colors plus up to 6 steps of
+	// noise per channel, like the smooth blocks of real textures. The same blocks for the same seed.
+	std::vector<DirectX::XMFLOAT4> MakeTestBlocks(uint32_t seed);
+	// The 16 texels of a block, to and from what the encoders and decoders of BC.h take.
+	void LoadTestBlock(const DirectX::XMFLOAT4* texels, DirectX::XMVECTOR* block);
+	void StoreTestBlock(const DirectX::XMVECTOR* block, DirectX::XMFLOAT4* texels);
+	// In 8-bit steps, over the first channels of each texel.
+	double ComputeBlockRMSE(const std::vector<DirectX::XMFLOAT4>& source, const std::vector<DirectX::XMFLOAT4>& decoded, uint32_t channels);
+}
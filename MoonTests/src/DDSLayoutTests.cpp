@@ -0,0 +1,188 @@
+#include "TestFramework.h"
+#include "DDSLayout.h"
+
+#include <cstring>
+
+using namespace Moon;
+
+namespace
+{
+	constexpr uint32_t FormatR8G8B8A8 = 28;
+	constexpr uint32_t FormatBC1 = 71;
+
+	constexpr uint32_t MakeFourCC(char c0, char c1, char c2, char c3)
+	{
+		return (uint32_t)(uint8_t)c0 | ((uint32_t)(uint8_t)c1 << 8) | ((uint32_t)(uint8_t)c2 << 16) | ((uint32_t)(uint8_t)c3 << 24);
+	}
+
+	// Magic then DDS_HEADER, as 32 uint32_t; the word indices below are those of the file.
+	enum : size_t
+	{
+		WordMagic = 0,
+		WordSize = 1,
+		WordHeight = 3,
+		WordWidth = 4,
+		WordMipCount = 7,
+		WordPixelFormatSize = 19,
+		WordPixelFormatFlags = 20,
+		WordFourCC = 21,
+		WordCaps2 = 28,
+		WordCount = 32,
+	};
+
+	std::vector<uint8_t> MakeHeader(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t fourCC)
+	{
+		uint32_t words[WordCount] = {};
+		words[WordMagic] = MakeFourCC('D', 'D', 'S', ' ');
+		words[WordSize] = 124;
+		words[WordHeight] = height;
+		words[WordWidth] = width;
+		words[WordMipCount] = mipCount;
+		words[WordPixelFormatSize] = 32;
+		words[WordPixelFormatFlags] = 0x4;
+		words[WordFourCC] = fourCC;
+
+		std::vector<uint8_t> file(sizeof(words));
+		memcpy(file.data(), words, sizeof(words));
+		return file;
+	}
+
+	void SetWord(std::vector<uint8_t>& file, size_t word, uint32_t value)
+	{
+		memcpy(file.data() + word * sizeof(uint32_t), &value, sizeof(value));
+	}
+
+	// Every byte its own offset in the file, so a wrong offset shows in the data.
+	void AppendData(std::vector<uint8_t>& file, size_t size)
+	{
+		for (size_t i = 0; i < size; ++i)
+			file.push_back((uint8_t)(file.size() * 7));
+	}
+
+	// 8x8 BC1 with its 4 mips: 2x2 blocks, then one block for each of the others.
+	std::vector<uint8_t> MakeBC1File()
+	{
+		std::vector<uint8_t> file = MakeHeader(8, 8, 4, MakeFourCC('D', 'X', 'T', '1'));
+		AppendData(file, 32 + 8 + 8 + 8);
+		return file;
+	}
+}
+
+MN_TEST(DDSLayoutParsesBlockCompressedMips)
+{
+	const std::vector<uint8_t> file = MakeBC1File();
+	const DDSLayout layout = DDSLayout::Parse(file.data(), file.size());
+
+	MN_CHECK(layout.Format == FormatBC1);
+	MN_CHECK(layout.Dimension == DDSLayout::DimensionTexture2D);
+	MN_CHECK(layout.Width == 8 && layout.Height == 8 && layout.MipCount == 4 && layout.ArraySize == 1);
+	MN_CHECK(!layout.IsCompressed && !layout.IsCubeMap);
+	MN_CHECK(layout.Subresources.size() == 4);
+
+	const DDSSubresource& top = layout.GetSubresource(0, 0);
+	MN_CHECK(top.Offset == 128);
+	MN_CHECK(top.RowPitch == 16 && top.RowCount == 2 && top.Size == 32);
+	const uint64_t offsets[] = { 128, 160, 168, 176 };
+	for (uint32_t mip = 0; mip < 4; ++mip)
+	{
+		MN_CHECK(layout.GetSubresource(mip, 0).Offset == offsets[mip]);
+		MN_CHECK(layout.GetMipSize(mip) == (mip ? 8u : 32u));
+	}
+	// Mips smaller than a block still take one.
+	MN_CHECK(layout.GetSubresource(3, 0).Width == 1 && layout.GetSubresource(3, 0).RowCount == 1);
+}
+
+MN_TEST(DDSLayoutParsesTextureArrays)
+{
+	// DX10 header: 4x2 RGBA8, 3 slices of 2 mips.
+	std::vector<uint8_t> file = MakeHeader(4, 2, 2, MakeFourCC('D', 'X', '1', '0'));
+	const uint32_t dxt10[] = { FormatR8G8B8A8, DDSLayout::DimensionTexture2D, 0, 3, 0 };
+	file.insert(file.end(), (const uint8_t*)dxt10, (const uint8_t*)dxt10 + sizeof(dxt10));
+	AppendData(file, 3 * (32 + 8));
+
+	const DDSLayout layout = DDSLayout::Parse(file.data(), file.size());
+	MN_CHECK(layout.Format == FormatR8G8B8A8);
+	MN_CHECK(layout.ArraySize == 3 && layout.MipCount == 2);
+	MN_CHECK(layout.Subresources.size() == 6);
+
+	// Slice after slice in the file, each with its own mips; indexed mip + slice * MipCount like D3D12.
+	MN_CHECK(layout.GetSubresourceIndex(1, 2) == 5);
+	MN_CHECK(layout.GetSubresource(0, 0).Offset == 148);
+	MN_CHECK(layout.GetSubresource(1, 0).Offset == 180);
+	MN_CHECK(layout.GetSubresource(0, 1).Offset == 188);
+	MN_CHECK(layout.GetSubresource(1, 2).Offset == 260);
+	MN_CHECK(layout.GetSubresource(0, 0).RowPitch == 16 && layout.GetSubresource(1, 0).RowPitch == 8);
+	MN_CHECK(layout.GetMipSize(0) == 96 && layout.GetMipSize(1) == 24);
+}
+
+MN_TEST(DDSLayoutFindsTheMipTail)
+{
+	const std::vector<uint8_t> file = MakeBC1File();
+	const DDSLayout layout = DDSLayout::Parse(file.data(), file.size());
+
+	// 8 + 8 + 8 bytes fit in 24, the 32 bytes of the top mip do not.
+	MN_CHECK(layout.GetTailMip(24) == 1);
+	MN_CHECK(layout.GetTailMip(56) == 0);
+	// The last mip even when it alone is over the budget.
+	MN_CHECK(layout.GetTailMip(0) == 3);
+}
+
+MN_TEST(DDSLayoutRejectsMalformedFiles)
+{
+	const std::vector<uint8_t> valid = MakeBC1File();
+	MN_CHECK_THROWS(DDSLayout::Parse(nullptr, 0));
+	MN_CHECK_THROWS(DDSLayout::Parse(valid.data(), 64));
+
+	std::vector<uint8_t> file = valid;
+	SetWord(file, WordMagic, MakeFourCC('D', 'D', 'S', 'X'));
+	MN_CHECK_THROWS(DDSLayout::Parse(file.data(), file.size()));
+
+	// One byte short of the last mip.
+	MN_CHECK_THROWS(DDSLayout::Parse(valid.data(), valid.size() - 1));
+
+	file = valid;
+	SetWord(file, WordMipCount, 5);
+	MN_CHECK_THROWS(DDSLayout::Parse(file.data(), file.size()));
+
+	file = valid;
+	SetWord(file, WordFourCC, MakeFourCC('Y', 'U', 'Y', '2'));
+	MN_CHECK_THROWS(DDSLayout::Parse(file.data(), file.size()));
+
+	// Cube map with only the +X face.
+	file = valid;
+	SetWord(file, WordCaps2, 0x200 | 0x400);
+	MN_CHECK_THROWS(DDSLayout::Parse(file.data(), file.size()));
+
+	// DX10 cube array whose face count, 6 * 0x2AAAAAAB, wraps to 2 in 32 bits.
+	file = MakeHeader(4, 4, 1, MakeFourCC('D', 'X', '1', '0'));
+	const uint32_t dxt10[] = { FormatR8G8B8A8, DDSLayout::DimensionTexture2D, 0x4, 0x2AAAAAAB, 0 };
+	file.insert(file.end(), (const uint8_t*)dxt10, (const uint8_t*)dxt10 + sizeof(dxt10));
+	AppendData(file, 2 * 64);
+	MN_CHECK_THROWS(DDSLayout::Parse(file.data(), file.size()));
+}
+
+MN_TEST(DDSLayoutReadsCompressedFiles)
+{
+	const std::vector<uint8_t> file = MakeBC1File();
+	const DDSLayout plain = DDSLayout::Parse(file.data(), file.size());
+	const std::vector<uint8_t> compressed = CompressDDS(file.data(), file.size());
+	const DDSLayout layout = DDSLayout::Parse(compressed.data(), compressed.size());
+
+	MN_CHECK(layout.IsCompressed);
+	MN_CHECK(layout.Subresources.size() == plain.Subresources.size());
+	MN_CHECK_THROWS(CompressDDS(compressed.data(), compressed.size()));
+
+	// Every stream decodes to the rows of the plain file, at the upload pitch.
+	for (size_t index = 0; index < layout.Subresources.size(); ++index)
+	{
+		const DDSSubresource& sub = layout.Subresources[index];
+		const DDSSubresource& source = plain.Subresources[index];
+		MN_CHECK(sub.Size == source.Size && sub.RowPitch == source.RowPitch);
+		MN_CHECK(sub.GetUploadRowPitch() == DDSLayout::UploadPitchAlignment);
+
+		std::vector<uint8_t> upload((size_t)sub.GetUploadSize());
+		LZDecompress(compressed.data() + sub.Offset, (size_t)sub.CompressedSize, upload.data(), upload.size());
+		for (uint32_t row = 0; row < sub.RowCount; ++row)
+			MN_CHECK(memcmp(upload.data() + (size_t)row * sub.GetUploadRowPitch(), file.data() + source.Offset + (size_t)row * source.RowPitch, source.RowPitch) == 0);
+	}
+}
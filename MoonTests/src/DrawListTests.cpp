@@ -0,0 +1,43 @@
+#include "TestFramework.h"
+#include "DrawList.h"
+
+using namespace Moon;
+
+namespace
+{
+	constexpr float NearZ = 1.0f;
+	constexpr float FarZ = 1000.0f;
+	constexpr uint32_t MaxDepth = (1u << DrawSortKey::DepthBits) - 1;
+}
+
+MN_TEST(DrawSortKeyQuantizesTheFarPlaneLast)
+{
+	MN_CHECK(DrawSortKey::QuantizeDepth(NearZ, NearZ, FarZ) == 0);
+	MN_CHECK(DrawSortKey::QuantizeDepth(FarZ, NearZ, FarZ) == MaxDepth);
+	// Clamped to the far plane, not wrapped to the near one.
+	MN_CHECK(DrawSortKey::QuantizeDepth(2.0f * FarZ, NearZ, FarZ) == MaxDepth);
+	MN_CHECK(DrawSortKey::QuantizeDepth(0.5f * (NearZ + FarZ), NearZ, FarZ) < MaxDepth);
+
+	const uint64_t key = DrawSortKey::Make(1, 2, 3, 4, DrawSortKey::QuantizeDepth(FarZ, NearZ, FarZ));
+	MN_CHECK(DrawSortKey::GetDepth(key) == MaxDepth);
+	MN_CHECK(DrawSortKey::GetPass(key) == 1);
+	MN_CHECK(DrawSortKey::GetPipeline(key) == 2);
+	MN_CHECK(DrawSortKey::GetMaterial(key) == 3);
+	MN_CHECK(DrawSortKey::GetGeometry(key) == 4);
+}
+
+MN_TEST(DrawListSortsFrontToBackWithinAState)
+{
+	const float depths[] = { FarZ, 10.0f, 2.0f * FarZ, NearZ, 500.0f };
+	DrawList drawList;
+	for (uint32_t i = 0; i < 5; ++i)
+		drawList.Add(DrawSortKey::Make(0, 1, 2, 3, DrawSortKey::QuantizeDepth(depths[i], NearZ, FarZ)), i);
+	// A different material sorts after every depth of the first one.
+	drawList.Add(DrawSortKey::Make(0, 1, 3, 0, 0), 5);
+	drawList.Sort();
+
+	const uint32_t expected[] = { 3, 1, 4, 0, 2, 5 };
+	MN_CHECK(drawList.Size() == 6);
+	for (uint32_t i = 0; i < 6; ++i)
+		MN_CHECK(drawList.GetItem(i) == expected[i]);
+}
@@ -0,0 +1,228 @@
+#include "TestFramework.h"
+#include "RenderGraphCompiler.h"
+
+#include <algorithm>
+
+using namespace Moon;
+
+namespace
+{
+	// D3D12_RESOURCE_STATES values.
+	constexpr uint32_t StatePresent = 0x0;
+	constexpr uint32_t StateRenderTarget = 0x4;
+	constexpr uint32_t StatePixelShaderResource = 0x80;
+
+	uint32_t AddImported(RenderGraphCompiler& compiler, const char* name)
+	{
+		RenderGraphResourceDesc desc;
+		desc.Name = name;
+		desc.Imported = true;
+		desc.InitialState = StatePresent;
+		desc.FinalState = StatePresent;
+		return compiler.AddResource(desc);
+	}
+
+	uint32_t AddTransient(RenderGraphCompiler& compiler, const char* name, uint64_t size)
+	{
+		RenderGraphResourceDesc desc;
+		desc.Name = name;
+		desc.SizeInBytes = size;
+		desc.Alignment = 256;
+		return compiler.AddResource(desc);
+	}
+
+	size_t GetPosition(const RenderGraphCompiler& compiler, uint32_t pass)
+	{
+		const std::vector<uint32_t>& order = compiler.GetExecutionOrder();
+		return std::find(order.begin(), order.end(), pass) - order.begin();
+	}
+}
+
+MN_TEST(RenderGraphCullsPassesWithoutVisibleOutput)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t backBuffer = AddImported(compiler, "BackBuffer");
+	const uint32_t unused = AddTransient(compiler, "Unused", 1024);
+	const uint32_t scratch = AddTransient(compiler, "Scratch", 1024);
+
+	const uint32_t dead = compiler.AddPass("Dead");
+	compiler.AddClear(dead, unused, StateRenderTarget);
+	const uint32_t producer = compiler.AddPass("Producer");
+	compiler.AddClear(producer, scratch, StateRenderTarget);
+	const uint32_t consumer = compiler.AddPass("Consumer");
+	compiler.AddRead(consumer, scratch, StatePixelShaderResource);
+	compiler.AddWrite(consumer, backBuffer, StateRenderTarget);
+	const uint32_t readback = compiler.AddPass("Readback", true);
+	compiler.Compile();
+
+	MN_CHECK(compiler.IsPassCulled(dead));
+	MN_CHECK(!compiler.IsPassCulled(producer));
+	MN_CHECK(!compiler.IsPassCulled(consumer));
+	MN_CHECK(!compiler.IsPassCulled(readback));
+	MN_CHECK(compiler.GetExecutionOrder().size() == 3);
+	MN_CHECK(compiler.GetLifetime(unused).FirstUse == InvalidRenderGraphIndex);
+}
+
+MN_TEST(RenderGraphOrdersPassesByHazards)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t backBuffer = AddImported(compiler, "BackBuffer");
+	const uint32_t history = AddImported(compiler, "History");
+	const uint32_t a = AddTransient(compiler, "A", 1024);
+	const uint32_t b = AddTransient(compiler, "B", 1024);
+
+	const uint32_t drawA = compiler.AddPass("DrawA");
+	compiler.AddClear(drawA, a, StateRenderTarget);
+	const uint32_t temporal = compiler.AddPass("Temporal");
+	compiler.AddRead(temporal, a, StatePixelShaderResource);
+	compiler.AddRead(temporal, history, StatePixelShaderResource);
+	compiler.AddWrite(temporal, backBuffer, StateRenderTarget);
+	const uint32_t dead = compiler.AddPass("Dead");
+	compiler.AddClear(dead, b, StateRenderTarget);
+	// Write after read: History is only overwritten once Temporal is done with it.
+	const uint32_t copyHistory = compiler.AddPass("CopyHistory");
+	compiler.AddRead(copyHistory, backBuffer, StatePixelShaderResource);
+	compiler.AddWrite(copyHistory, history, StateRenderTarget);
+	compiler.Compile();
+
+	// Hazards only ever point forward in declaration order, ties go to the pass declared first: the order is the
+	// declaration order of the passes that are kept.
+	const std::vector<uint32_t> expected = { drawA, temporal, copyHistory };
+	MN_CHECK(compiler.IsPassCulled(dead));
+	MN_CHECK(compiler.GetExecutionOrder() == expected);
+	MN_CHECK(GetPosition(compiler, copyHistory) > GetPosition(compiler, temporal));
+
+	// History is alive from its read to its write.
+	MN_CHECK(compiler.GetLifetime(history).FirstUse == 1 && compiler.GetLifetime(history).LastUse == 2);
+	MN_CHECK(compiler.GetLifetime(a).FirstUse == 0 && compiler.GetLifetime(a).LastUse == 1);
+}
+
+MN_TEST(RenderGraphAliasesTransientsWithDisjointLifetimes)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t backBuffer = AddImported(compiler, "BackBuffer");
+	const uint32_t first = AddTransient(compiler, "First", 1024);
+	const uint32_t second = AddTransient(compiler, "Second", 1024);
+	const uint32_t third = AddTransient(compiler, "Third", 1000);
+
+	const uint32_t p0 = compiler.AddPass("P0");
+	compiler.AddClear(p0, first, StateRenderTarget);
+	const uint32_t p1 = compiler.AddPass("P1");
+	compiler.AddRead(p1, first, StatePixelShaderResource);
+	compiler.AddClear(p1, second, StateRenderTarget);
+	const uint32_t p2 = compiler.AddPass("P2");
+	compiler.AddRead(p2, second, StatePixelShaderResource);
+	compiler.AddClear(p2, third, StateRenderTarget);
+	const uint32_t p3 = compiler.AddPass("P3");
+	compiler.AddRead(p3, third, StatePixelShaderResource);
+	compiler.AddWrite(p3, backBuffer, StateRenderTarget);
+	compiler.Compile();
+
+	MN_CHECK(compiler.GetLifetime(first).FirstUse == 0 && compiler.GetLifetime(first).LastUse == 1);
+	MN_CHECK(compiler.GetLifetime(third).FirstUse == 2 && compiler.GetLifetime(third).LastUse == 3);
+
+	// First and Second are alive together in P1, Third reuses the memory of First.
+	MN_CHECK(compiler.GetHeapOffset(first) == 0);
+	MN_CHECK(compiler.GetHeapOffset(second) == 1024);
+	MN_CHECK(compiler.GetHeapOffset(third) == 0);
+	MN_CHECK(compiler.GetTransientHeapSize() == 2048);
+
+	// Aliasing barriers come first in the batch of the new resource's first use.
+	const std::vector<RenderGraphBarrier>& batch = compiler.GetBarrierBatch(2);
+	MN_CHECK(!batch.empty());
+	MN_CHECK(batch[0].BarrierType == RenderGraphBarrier::Type::Aliasing);
+	MN_CHECK(batch[0].ResourceBefore == first && batch[0].Resource == third);
+
+	// First is the first user of the memory this frame, whatever had it before is unknown.
+	const std::vector<RenderGraphBarrier>& firstBatch = compiler.GetBarrierBatch(0);
+	MN_CHECK(!firstBatch.empty());
+	MN_CHECK(firstBatch[0].BarrierType == RenderGraphBarrier::Type::Aliasing);
+	MN_CHECK(firstBatch[0].ResourceBefore == InvalidRenderGraphIndex && firstBatch[0].Resource == first);
+}
+
+MN_TEST(RenderGraphSplitsBarriersAcrossIdlePasses)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t backBuffer = AddImported(compiler, "BackBuffer");
+	const uint32_t shadow = AddTransient(compiler, "Shadow", 1024);
+
+	const uint32_t shadowPass = compiler.AddPass("Shadow");
+	compiler.AddClear(shadowPass, shadow, StateRenderTarget);
+	const uint32_t sky = compiler.AddPass("Sky");
+	compiler.AddWrite(sky, backBuffer, StateRenderTarget);
+	const uint32_t lighting = compiler.AddPass("Lighting");
+	compiler.AddRead(lighting, shadow, StatePixelShaderResource);
+	compiler.AddWrite(lighting, backBuffer, StateRenderTarget);
+	compiler.Compile();
+
+	const std::vector<uint32_t> expected = { shadowPass, sky, lighting };
+	MN_CHECK(compiler.GetExecutionOrder() == expected);
+
+	auto findTransition = [&](size_t batchIndex, uint32_t resource, RenderGraphBarrier::Split split) -> const RenderGraphBarrier*
+	{
+		for (const RenderGraphBarrier& barrier : compiler.GetBarrierBatch(batchIndex))
+		{
+			if (barrier.BarrierType == RenderGraphBarrier::Type::Transition && barrier.Resource == resource && barrier.SplitFlag == split)
+				return &barrier;
+		}
+		return nullptr;
+	};
+
+	// Sky does not touch Shadow: the transition to PIXEL_SHADER_RESOURCE begins after its last write and ends before its read.
+	const RenderGraphBarrier* begin = findTransition(1, shadow, RenderGraphBarrier::Split::Begin);
+	const RenderGraphBarrier* end = findTransition(2, shadow, RenderGraphBarrier::Split::End);
+	MN_CHECK(begin && begin->StateBefore == StateRenderTarget && begin->StateAfter == StatePixelShaderResource);
+	MN_CHECK(end && end->StateBefore == StateRenderTarget && end->StateAfter == StatePixelShaderResource);
+
+	// A transient is created in, and left in, the state of its last use. Its first transition is never split.
+	MN_CHECK(compiler.GetTransientState(shadow) == StatePixelShaderResource);
+	const RenderGraphBarrier* first = findTransition(0, shadow, RenderGraphBarrier::Split::None);
+	MN_CHECK(first && first->StateBefore == StatePixelShaderResource && first->StateAfter == StateRenderTarget);
+
+	// An imported resource is in its initial state from the start of the frame, Shadow runs while it transitions.
+	// It goes back to PRESENT right after the last pass.
+	MN_CHECK(findTransition(0, backBuffer, RenderGraphBarrier::Split::Begin));
+	const RenderGraphBarrier* toRenderTarget = findTransition(1, backBuffer, RenderGraphBarrier::Split::End);
+	MN_CHECK(toRenderTarget && toRenderTarget->StateBefore == StatePresent && toRenderTarget->StateAfter == StateRenderTarget);
+	const RenderGraphBarrier* toPresent = findTransition(3, backBuffer, RenderGraphBarrier::Split::None);
+	MN_CHECK(toPresent && toPresent->StateBefore == StateRenderTarget && toPresent->StateAfter == StatePresent);
+}
+
+MN_TEST(RenderGraphRejectsTransientsNotClearedFirst)
+{
+	{
+		RenderGraphCompiler compiler;
+		const uint32_t backBuffer = AddImported(compiler, "BackBuffer");
+		const uint32_t target = AddTransient(compiler, "Target", 1024);
+		const uint32_t draw = compiler.AddPass("Draw");
+		compiler.AddWrite(draw, target, StateRenderTarget);
+		const uint32_t composite = compiler.AddPass("Composite");
+		compiler.AddRead(composite, target, StatePixelShaderResource);
+		compiler.AddWrite(composite, backBuffer, StateRenderTarget);
+		MN_CHECK_THROWS(compiler.Compile());
+	}
+
+	// Cleared, but only after a pass already read whatever the memory held.
+	{
+		RenderGraphCompiler compiler;
+		const uint32_t backBuffer = AddImported(compiler, "BackBuffer");
+		const uint32_t target = AddTransient(compiler, "Target", 1024);
+		const uint32_t read = compiler.AddPass("Read");
+		compiler.AddRead(read, target, StatePixelShaderResource);
+		compiler.AddWrite(read, backBuffer, StateRenderTarget);
+		const uint32_t clear = compiler.AddPass("Clear");
+		compiler.AddClear(clear, target, StateRenderTarget);
+		compiler.AddWrite(clear, backBuffer, StateRenderTarget);
+		MN_CHECK_THROWS(compiler.Compile());
+	}
+
+	// Imported resources hold what the frame before left in them, a plain write is fine.
+	{
+		RenderGraphCompiler compiler;
+		const uint32_t backBuffer = AddImported(compiler, "BackBuffer");
+		const uint32_t draw = compiler.AddPass("Draw");
+		compiler.AddWrite(draw, backBuffer, StateRenderTarget);
+		compiler.Compile();
+		MN_CHECK(compiler.GetExecutionOrder().size() == 1);
+	}
+}
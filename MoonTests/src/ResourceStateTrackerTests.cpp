@@ -0,0 +1,181 @@
+#include "TestFramework.h"
+#include "ResourceStateTracker.h"
+
+using namespace Moon;
+
+namespace
+{
+	// D3D12_RESOURCE_STATES values.
+	constexpr uint32_t StateCommon = 0x0;
+	constexpr uint32_t StateIndexBuffer = 0x2;
+	constexpr uint32_t StateRenderTarget = 0x4;
+	constexpr uint32_t StatePixelShaderResource = 0x80;
+	constexpr uint32_t StateCopyDest = 0x400;
+	constexpr uint32_t StateGenericRead = 0xac3;
+
+	bool IsTransition(const ResourceTransition& barrier, const void* resource, uint32_t subresource, uint32_t before, uint32_t after)
+	{
+		return barrier.Resource == resource && barrier.Subresource == subresource && barrier.StateBefore == before && barrier.StateAfter == after;
+	}
+}
+
+MN_TEST(StateTrackerResolvesFirstUseAtSubmit)
+{
+	ResourceStateRegistry registry;
+	int texture = 0;
+	registry.Register(&texture, 1, StateCommon);
+
+	ResourceStateTracker tracker(registry);
+	tracker.Require(&texture, StateRenderTarget);
+	tracker.Require(&texture, StatePixelShaderResource);
+
+	// The first use is only known to the list, the second one is a transition inside it.
+	std::vector<ResourceTransition> barriers;
+	tracker.FlushBarriers(barriers);
+	MN_CHECK(barriers.size() == 1);
+	MN_CHECK(IsTransition(barriers[0], &texture, AllSubresources, StateRenderTarget, StatePixelShaderResource));
+
+	std::vector<ResourceTransition> resolved;
+	tracker.Resolve(resolved);
+	MN_CHECK(resolved.size() == 1);
+	MN_CHECK(IsTransition(resolved[0], &texture, AllSubresources, StateCommon, StateRenderTarget));
+	MN_CHECK(registry.GetState(&texture) == StatePixelShaderResource);
+
+	// The next list starts from the state the last one left, which is what it needs: nothing to resolve.
+	tracker.Require(&texture, StatePixelShaderResource);
+	resolved.clear();
+	tracker.Resolve(resolved);
+	MN_CHECK(resolved.empty());
+}
+
+MN_TEST(StateTrackerMergesQueuedBarriers)
+{
+	ResourceStateRegistry registry;
+	int texture = 0;
+	registry.Register(&texture, 1, StateRenderTarget);
+
+	ResourceStateTracker tracker(registry);
+	tracker.Require(&texture, StateRenderTarget);
+	tracker.Require(&texture, StatePixelShaderResource);
+	tracker.Require(&texture, StateCopyDest);
+
+	// Nothing recorded in between: RENDER_TARGET -> PIXEL_SHADER_RESOURCE -> COPY_DEST is one barrier.
+	std::vector<ResourceTransition> barriers;
+	tracker.FlushBarriers(barriers);
+	MN_CHECK(barriers.size() == 1);
+	MN_CHECK(IsTransition(barriers[0], &texture, AllSubresources, StateRenderTarget, StateCopyDest));
+
+	// Back to where it started before the flush: no barrier at all.
+	tracker.Require(&texture, StatePixelShaderResource);
+	tracker.Require(&texture, StateCopyDest);
+	barriers.clear();
+	tracker.FlushBarriers(barriers);
+	MN_CHECK(barriers.empty());
+	MN_CHECK(!tracker.HasPendingBarriers());
+}
+
+MN_TEST(StateTrackerKeepsReadStatesThatCoverTheRequest)
+{
+	ResourceStateRegistry registry;
+	int buffer = 0;
+	registry.Register(&buffer, 1, StateGenericRead);
+
+	ResourceStateTracker tracker(registry);
+	tracker.Require(&buffer, StateGenericRead);
+	// GENERIC_READ includes INDEX_BUFFER and no write state.
+	tracker.Require(&buffer, StateIndexBuffer);
+	MN_CHECK(!tracker.HasPendingBarriers());
+
+	tracker.Require(&buffer, StateCopyDest);
+	tracker.Require(&buffer, StateCopyDest);
+	std::vector<ResourceTransition> barriers;
+	tracker.FlushBarriers(barriers);
+	MN_CHECK(barriers.size() == 1);
+	MN_CHECK(IsTransition(barriers[0], &buffer, AllSubresources, StateGenericRead, StateCopyDest));
+}
+
+MN_TEST(StateTrackerResolvesNothingForACoveredFirstUse)
+{
+	ResourceStateRegistry registry;
+	int buffer = 0;
+	registry.Register(&buffer, 1, StateGenericRead);
+
+	// Left in GENERIC_READ by the lists before, which covers INDEX_BUFFER.
+	ResourceStateTracker tracker(registry);
+	tracker.Require(&buffer, StateIndexBuffer);
+	std::vector<ResourceTransition> resolved;
+	tracker.Resolve(resolved);
+	MN_CHECK(resolved.empty());
+	MN_CHECK(registry.GetState(&buffer) == StateGenericRead);
+
+	// Transitioned in the list, the barrier starts from INDEX_BUFFER: that state must be reached first.
+	tracker.Require(&buffer, StateIndexBuffer);
+	tracker.Require(&buffer, StateCopyDest);
+	std::vector<ResourceTransition> barriers;
+	tracker.FlushBarriers(barriers);
+	tracker.Resolve(resolved);
+	MN_CHECK(resolved.size() == 1);
+	MN_CHECK(IsTransition(resolved[0], &buffer, AllSubresources, StateGenericRead, StateIndexBuffer));
+	MN_CHECK(registry.GetState(&buffer) == StateCopyDest);
+}
+
+MN_TEST(StateTrackerTracksSubresources)
+{
+	ResourceStateRegistry registry;
+	int texture = 0;
+	registry.Register(&texture, 3, StatePixelShaderResource);
+
+	ResourceStateTracker tracker(registry);
+	tracker.Require(&texture, StateCopyDest, 1);
+	tracker.Require(&texture, StatePixelShaderResource);
+
+	// Only the subresource that was copied to goes back.
+	std::vector<ResourceTransition> barriers;
+	tracker.FlushBarriers(barriers);
+	MN_CHECK(barriers.size() == 1);
+	MN_CHECK(IsTransition(barriers[0], &texture, 1, StateCopyDest, StatePixelShaderResource));
+
+	std::vector<ResourceTransition> resolved;
+	tracker.Resolve(resolved);
+	MN_CHECK(resolved.size() == 1);
+	MN_CHECK(IsTransition(resolved[0], &texture, 1, StatePixelShaderResource, StateCopyDest));
+	for (uint32_t subresource = 0; subresource < 3; ++subresource)
+		MN_CHECK(registry.GetState(&texture, subresource) == StatePixelShaderResource);
+
+	// A whole resource request on diverging subresources transitions each of them.
+	tracker.Require(&texture, StateCopyDest, 2);
+	tracker.Require(&texture, StateRenderTarget);
+	barriers.clear();
+	tracker.FlushBarriers(barriers);
+	MN_CHECK(barriers.size() == 1);
+	MN_CHECK(IsTransition(barriers[0], &texture, 2, StateCopyDest, StateRenderTarget));
+	resolved.clear();
+	tracker.Resolve(resolved);
+	MN_CHECK(resolved.size() == 3);
+	MN_CHECK(registry.GetState(&texture, 0) == StateRenderTarget && registry.GetState(&texture, 2) == StateRenderTarget);
+}
+
+MN_TEST(StateTrackerRejectsMisuse)
+{
+	ResourceStateRegistry registry;
+	int texture = 0;
+	int unregistered = 0;
+	registry.Register(&texture, 1, StateCommon);
+
+	ResourceStateTracker tracker(registry);
+	MN_CHECK_THROWS(tracker.Require(&unregistered, StateRenderTarget));
+
+	// Resolving with barriers still queued would lose them.
+	tracker.Require(&texture, StateRenderTarget);
+	tracker.Require(&texture, StatePixelShaderResource);
+	std::vector<ResourceTransition> resolved;
+	MN_CHECK_THROWS(tracker.Resolve(resolved));
+
+	// A resource released after its list was recorded is skipped.
+	tracker.Reset();
+	tracker.Require(&texture, StateRenderTarget);
+	registry.Unregister(&texture);
+	resolved.clear();
+	tracker.Resolve(resolved);
+	MN_CHECK(resolved.empty());
+}
@@ -0,0 +1,70 @@
+#include "TestFramework.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Moon
+{
+	namespace
+	{
+		struct TestCase
+		{
+			const char* Name;
+			void (*Run)();
+		};
+
+		class TestFailure : public std::runtime_error
+		{
+		public:
+			using std::runtime_error::runtime_error;
+		};
+
+		// Function local, registrations from other translation units may run before any global here is constructed.
+		std::vector<TestCase>& GetTests()
+		{
+			static std::vector<TestCase> tests;
+			return tests;
+		}
+	}
+
+	void RegisterTest(const char* name, void (*test)())
+	{
+		GetTests().push_back({ name, test });
+	}
+
+	void FailTest(const char* file, int line, const std::string& message)
+	{
+		throw TestFailure(std::string(file) + "(" + std::to_string(line) + "): " + message);
+	}
+
+	int RunTests(const std::string& filter)
+	{
+		int run = 0;
+		int failed = 0;
+		for (const TestCase& test : GetTests())
+		{
+			if (std::string(test.Name).find(filter) == std::string::npos)
+				continue;
+
+			++run;
+			try
+			{
+				test.Run();
+				std::cout << "[ ok ] " << test.Name << std::endl;
+			}
+			catch (const TestFailure& e)
+			{
+				++failed;
+				std::cout << "[FAIL] " << test.Name << ": " << e.what() << std::endl;
+			}
+			catch (const std::exception& e)
+			{
+				++failed;
+				std::cout << "[FAIL] " << test.Name << ": unexpected exception: " << e.what() << std::endl;
+			}
+		}
+		std::cout << run - failed << "/" << run << " tests passed" << std::endl;
+		return failed;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <exception>
+#include <string>
+
+namespace Moon
+{
+	// Called by MN_TEST before main().
+	void RegisterTest(const char* name, void (*test)());
+	// Runs every test whose name contains filter, in registration order. Returns the number of failed tests.
+	int RunTests(const std::string& filter);
+	// Throws the failure the runner reports, MN_CHECK() calls it.
+	[[noreturn]] void FailTest(const char* file, int line, const std::string& message);
+}
+
+#define MN_TEST(name) \
+	static void name(); \
+	static const bool name##Registered = (::Moon::RegisterTest(#name, name), true); \
+	static void name()
+
+#define MN_CHECK(expression) \
+	do { if (!(expression)) ::Moon::FailTest(__FILE__, __LINE__, #expression); } while (0)
+
+// Any std::exception will do.
+#define MN_CHECK_THROWS(expression) \
+	do \
+	{ \
+		bool thrown = false; \
+		try { expression; } \
+		catch (const std::exception&) { thrown = true; } \
+		if (!thrown) \
+			::Moon::FailTest(__FILE__, __LINE__, #expression " did not throw"); \
+	} while (0)
@@ -0,0 +1,7 @@
+#include "TestFramework.h"
+
+// moontests [filter]: runs the tests whose name contains filter, all of them by default.
+int main(int argc, char** argv)
+{
+	return Moon::RunTests(argc > 1 ? argv[1] : "") == 0 ? 0 : 1;
+}
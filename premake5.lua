@@ -13,6 +13,10 @@ IncludeDir["imgui"] = "libs/imgui/"
 IncludeDir["pix"] = "libs/pix/"
 IncludeDir["RenderDoc"] = "libs/RenderDoc/"
 IncludeDir["tinyobjloader"] = "libs/tinyobjloader/"
+-- Linux builds of the tools only, Windows has both in its SDK.
+IncludeDir["DirectXHeaders"] = "libs/DirectX-Headers/include"
+IncludeDir["DirectXHeadersWsl"] = "libs/DirectX-Headers/include/wsl/stubs"
+IncludeDir["DirectXMath"] = "libs/DirectXMath/Inc"
 
 LibraryDir = {}
 LibraryDir["assimp"] = "../libs/assimp/bin/Release/assimp-vc142-mt.lib"
@@ -86,3 +90,272 @@ project "Moon"
 		runtime "Release"
 		optimize "on"
 
+
+-- Headless texture cook: DirectXTex's CPU paths and the DDS/LZ modules, no window nor device, builds on Linux too.
+project "MoonCook"
+	location "MoonCook"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "on"
+	targetname "mooncook"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("obj/" .. outputdir .. "/%{prj.name}")
+
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp",
+		"Moon/src/ContentHash.h",
+		"Moon/src/ContentHash.cpp",
+		"Moon/src/CpuProfiler.h",
+		"Moon/src/CpuProfiler.cpp",
+		"Moon/src/DDSLayout.h",
+		"Moon/src/DDSLayout.cpp",
+		"Moon/src/DerivedDataCache.h",
+		"Moon/src/DerivedDataCache.cpp",
+		"Moon/src/JobSystem.h",
+		"Moon/src/JobSystem.cpp",
+		"Moon/src/LZCodec.h",
+		"Moon/src/LZCodec.cpp",
+		"Moon/src/TextureCook.h",
+		"Moon/src/TextureCook.cpp",
+		"Moon/src/Utils.h",
+		"Moon/src/Utils.cpp",
+		"Moon/src/DirectXTex/BC.cpp",
+		"Moon/src/DirectXTex/BC4BC5.cpp",
+		"Moon/src/DirectXTex/BC6HBC7.cpp",
+		"Moon/src/DirectXTex/BCFast.cpp",
+		"Moon/src/DirectXTex/DirectXTexCompress.cpp",
+		"Moon/src/DirectXTex/DirectXTexConvert.cpp",
+		"Moon/src/DirectXTex/DirectXTexDDS.cpp",
+		"Moon/src/DirectXTex/DirectXTexHDR.cpp",
+		"Moon/src/DirectXTex/DirectXTexImage.cpp",
+		"Moon/src/DirectXTex/DirectXTexMipmaps.cpp",
+		"Moon/src/DirectXTex/DirectXTexMisc.cpp",
+		"Moon/src/DirectXTex/DirectXTexNormalMaps.cpp",
+		"Moon/src/DirectXTex/DirectXTexPMAlpha.cpp",
+		"Moon/src/DirectXTex/DirectXTexResize.cpp",
+		"Moon/src/DirectXTex/DirectXTexTGA.cpp",
+		"Moon/src/DirectXTex/DirectXTexUtil.cpp",
+	}
+
+	defines
+	{
+		"_CRT_SECURE_NO_WARNINGS",
+	}
+
+	includedirs
+	{
+		"Moon/src",
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "system:linux"
+		includedirs
+		{
+			"%{IncludeDir.DirectXHeaders}",
+			"%{IncludeDir.DirectXHeadersWsl}",
+			"%{IncludeDir.DirectXMath}",
+		}
+
+		links
+		{
+			"pthread",
+		}
+
+	filter "configurations:Debug"
+		defines {"DEBUG", "_DEBUG"}
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines {"NDEBUG","_RELEASE"}
+		runtime "Release"
+		optimize "on"
+
+
+-- Unit tests of the platform independent modules, builds on Linux too. Run bin/<config>/MoonTests/moontests [filter].
+project "MoonTests"
+	location "MoonTests"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "on"
+	targetname "moontests"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("obj/" .. outputdir .. "/%{prj.name}")
+
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp",
+		"Moon/src/RenderGraphCompiler.h",
+		"Moon/src/RenderGraphCompiler.cpp",
+		"Moon/src/ResourceStateTracker.h",
+		"Moon/src/ResourceStateTracker.cpp",
+		"Moon/src/CpuProfiler.h",
+		"Moon/src/CpuProfiler.cpp",
+		"Moon/src/DDSLayout.h",
+		"Moon/src/DDSLayout.cpp",
+		"Moon/src/DrawList.h",
+		"Moon/src/DrawList.cpp",
+		"Moon/src/JobSystem.h",
+		"Moon/src/JobSystem.cpp",
+		"Moon/src/LZCodec.h",
+		"Moon/src/LZCodec.cpp",
+		"Moon/src/Utils.h",
+		"Moon/src/Utils.cpp",
+		"Moon/src/DirectXTex/BC.cpp",
+		"Moon/src/DirectXTex/BC4BC5.cpp",
+		"Moon/src/DirectXTex/BC6HBC7.cpp",
+		"Moon/src/DirectXTex/BCFast.cpp",
+	}
+
+	includedirs
+	{
+		"Moon/src",
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "system:linux"
+		includedirs
+		{
+			"%{IncludeDir.DirectXHeaders}",
+			"%{IncludeDir.DirectXHeadersWsl}",
+			"%{IncludeDir.DirectXMath}",
+		}
+
+		links
+		{
+			"pthread",
+		}
+
+	filter "configurations:Debug"
+		defines {"DEBUG", "_DEBUG"}
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines {"NDEBUG","_RELEASE"}
+		runtime "Release"
+		optimize "on"
+
+
+-- Headless benchmark of the frame CPU work and the texture paths against the null RHI, builds on Linux too.
+-- Same report as Moon --headless.
+project "MoonBenchmark"
+	location "MoonBenchmark"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "on"
+	targetname "moonbenchmark"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("obj/" .. outputdir .. "/%{prj.name}")
+
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp",
+		"Moon/src/Benchmark.h",
+		"Moon/src/Benchmark.cpp",
+		"Moon/src/BenchmarkCommon.h",
+		"Moon/src/BenchmarkCommon.cpp",
+		"Moon/src/Camera.h",
+		"Moon/src/Camera.cpp",
+		"Moon/src/CameraPath.h",
+		"Moon/src/CameraPath.cpp",
+		"Moon/src/CompressionBenchmark.h",
+		"Moon/src/CompressionBenchmark.cpp",
+		"Moon/src/ConvertBenchmark.h",
+		"Moon/src/ConvertBenchmark.cpp",
+		"Moon/src/CpuProfiler.h",
+		"Moon/src/CpuProfiler.cpp",
+		"Moon/src/DrawList.h",
+		"Moon/src/DrawList.cpp",
+		"Moon/src/Event.h",
+		"Moon/src/FrameStats.h",
+		"Moon/src/FrameStats.cpp",
+		"Moon/src/FrustumCuller.h",
+		"Moon/src/FrustumCuller.cpp",
+		"Moon/src/IndirectDrawBuilder.h",
+		"Moon/src/IndirectDrawBuilder.cpp",
+		"Moon/src/JobSystem.h",
+		"Moon/src/JobSystem.cpp",
+		"Moon/src/LZCodec.h",
+		"Moon/src/LZCodec.cpp",
+		"Moon/src/Math.h",
+		"Moon/src/ObjectConstantUploader.h",
+		"Moon/src/ObjectConstantUploader.cpp",
+		"Moon/src/PayloadBenchmark.h",
+		"Moon/src/PayloadBenchmark.cpp",
+		"Moon/src/Rhi.h",
+		"Moon/src/RhiNull.h",
+		"Moon/src/RhiNull.cpp",
+		"Moon/src/SceneStore.h",
+		"Moon/src/SceneStore.cpp",
+		"Moon/src/TransformHierarchy.h",
+		"Moon/src/TransformHierarchy.cpp",
+		"Moon/src/Utils.h",
+		"Moon/src/Utils.cpp",
+		"Moon/src/DirectXTex/BC.cpp",
+		"Moon/src/DirectXTex/BC4BC5.cpp",
+		"Moon/src/DirectXTex/BC6HBC7.cpp",
+		"Moon/src/DirectXTex/BCFast.cpp",
+		"Moon/src/DirectXTex/DirectXTexCompress.cpp",
+		"Moon/src/DirectXTex/DirectXTexConvert.cpp",
+		"Moon/src/DirectXTex/DirectXTexDDS.cpp",
+		"Moon/src/DirectXTex/DirectXTexHDR.cpp",
+		"Moon/src/DirectXTex/DirectXTexImage.cpp",
+		"Moon/src/DirectXTex/DirectXTexMipmaps.cpp",
+		"Moon/src/DirectXTex/DirectXTexMisc.cpp",
+		"Moon/src/DirectXTex/DirectXTexNormalMaps.cpp",
+		"Moon/src/DirectXTex/DirectXTexPMAlpha.cpp",
+		"Moon/src/DirectXTex/DirectXTexResize.cpp",
+		"Moon/src/DirectXTex/DirectXTexTGA.cpp",
+		"Moon/src/DirectXTex/DirectXTexUtil.cpp",
+	}
+
+	defines
+	{
+		"_CRT_SECURE_NO_WARNINGS",
+	}
+
+	includedirs
+	{
+		"Moon/src",
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "system:linux"
+		includedirs
+		{
+			"%{IncludeDir.DirectXHeaders}",
+			"%{IncludeDir.DirectXHeadersWsl}",
+			"%{IncludeDir.DirectXMath}",
+		}
+
+		links
+		{
+			"pthread",
+		}
+
+	filter "configurations:Debug"
+		defines {"DEBUG", "_DEBUG"}
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines {"NDEBUG","_RELEASE"}
+		runtime "Release"
+		optimize "on"